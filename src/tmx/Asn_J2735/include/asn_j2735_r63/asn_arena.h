@@ -0,0 +1,86 @@
+/*
+ * asn_arena.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef	ASN_ARENA_H
+#define	ASN_ARENA_H
+
+#include <stddef.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+/*
+ * The size of each arena, which is enough for many decoded MAP or SPaT trees.
+ */
+#define	ASN_ARENA_SIZE		(4 * 1024 * 1024)
+
+/*
+ * The number of arenas in the process wide pool.  A decoding thread uses one.
+ */
+#define	ASN_ARENA_POOL_COUNT	32
+
+/*
+ * A bump allocator for the structures built by the decoders.
+ *
+ * While an arena is in use on a thread, every CALLOC, MALLOC and REALLOC made by
+ * the ASN.1 support code on that thread comes from the arena, and FREEMEM of arena
+ * memory does nothing.  A whole decoded tree is then discarded at once with
+ * asn_arena_reset.  A node that does not fit in the space left is allocated from
+ * the heap, which asn_arena_overflowed reports, so the tree must then be freed
+ * with ASN_STRUCT_FREE before the reset.
+ *
+ * All the arenas come from one mapping, so memory from any arena can be
+ * recognized, and safely passed to ASN_STRUCT_FREE or REALLOC, on any thread.
+ */
+typedef struct asn_arena asn_arena_t;
+
+/*
+ * Take an arena from the pool.
+ * Returns an empty arena, or NULL if all of them are taken.
+ */
+asn_arena_t *asn_arena_acquire(void);
+
+/*
+ * Return an arena to the pool.  Nothing allocated from it may still be in use.
+ */
+void asn_arena_release(asn_arena_t *arena);
+
+/*
+ * Allocate on the calling thread from the arena, or from the heap if NULL.
+ * Returns the arena that was in use before, if any.
+ */
+asn_arena_t *asn_arena_use(asn_arena_t *arena);
+
+/*
+ * Discard everything allocated from the arena.
+ */
+void asn_arena_reset(asn_arena_t *arena);
+
+/*
+ * Returns the number of bytes allocated from the arena since the last reset.
+ */
+size_t asn_arena_used(const asn_arena_t *arena);
+
+/*
+ * Returns non-zero if an allocation went to the heap since the last reset.
+ */
+int asn_arena_overflowed(const asn_arena_t *arena);
+
+/*
+ * The allocators behind the CALLOC, MALLOC, REALLOC and FREEMEM macros.
+ */
+void *asn_arena_calloc(size_t nmemb, size_t size);
+void *asn_arena_malloc(size_t size);
+void *asn_arena_realloc(void *ptr, size_t size);
+void asn_arena_free(void *ptr);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* ASN_ARENA_H */
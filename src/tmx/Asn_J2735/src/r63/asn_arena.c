@@ -0,0 +1,216 @@
+/*
+ * asn_arena.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "asn_arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+struct asn_arena {
+	char *base;
+	size_t used;
+	size_t last;		/* Offset of the last allocation, which can grow in place */
+	int inUse;
+	int overflowed;
+};
+
+/*
+ * Every allocation is preceded by its size, so REALLOC knows how much to copy.
+ * The header keeps the memory 16 byte aligned.
+ */
+typedef struct {
+	size_t size;
+	size_t reserved;
+} asn_arena_header_t;
+
+#define	ASN_ARENA_ALIGN(size)	(((size) + 15) & ~(size_t)15)
+
+static pthread_once_t asn_arena_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t asn_arena_lock = PTHREAD_MUTEX_INITIALIZER;
+static asn_arena_t asn_arena_pool[ASN_ARENA_POOL_COUNT];
+
+/* The mapping that holds every arena */
+static char *asn_arena_start = NULL;
+static char *asn_arena_end = NULL;
+
+static __thread asn_arena_t *asn_arena_current = NULL;
+
+static void
+asn_arena_init(void) {
+	size_t size = (size_t)ASN_ARENA_SIZE * ASN_ARENA_POOL_COUNT;
+	int i;
+
+	/* Pages are only backed by memory once they are touched */
+	void *map = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(map == MAP_FAILED)
+		return;
+
+	asn_arena_start = (char *)map;
+	asn_arena_end = asn_arena_start + size;
+
+	for(i = 0; i < ASN_ARENA_POOL_COUNT; i++) {
+		asn_arena_pool[i].base = asn_arena_start + (size_t)i * ASN_ARENA_SIZE;
+		asn_arena_pool[i].used = 0;
+		asn_arena_pool[i].last = 0;
+		asn_arena_pool[i].inUse = 0;
+		asn_arena_pool[i].overflowed = 0;
+	}
+}
+
+static int
+asn_arena_contains(const void *ptr) {
+	return (const char *)ptr >= asn_arena_start && (const char *)ptr < asn_arena_end;
+}
+
+asn_arena_t *
+asn_arena_acquire(void) {
+	asn_arena_t *arena = NULL;
+	int i;
+
+	pthread_once(&asn_arena_once, asn_arena_init);
+	if(asn_arena_start == NULL)
+		return NULL;
+
+	pthread_mutex_lock(&asn_arena_lock);
+	for(i = 0; i < ASN_ARENA_POOL_COUNT && arena == NULL; i++) {
+		if(!asn_arena_pool[i].inUse) {
+			arena = &asn_arena_pool[i];
+			arena->inUse = 1;
+			arena->used = 0;
+			arena->last = 0;
+			arena->overflowed = 0;
+		}
+	}
+	pthread_mutex_unlock(&asn_arena_lock);
+
+	return arena;
+}
+
+void
+asn_arena_release(asn_arena_t *arena) {
+	if(arena == NULL)
+		return;
+
+	if(asn_arena_current == arena)
+		asn_arena_current = NULL;
+
+	/* Give the pages back, since the arena may not be needed again for a long time */
+	madvise(arena->base, ASN_ARENA_SIZE, MADV_DONTNEED);
+
+	pthread_mutex_lock(&asn_arena_lock);
+	arena->used = 0;
+	arena->inUse = 0;
+	pthread_mutex_unlock(&asn_arena_lock);
+}
+
+asn_arena_t *
+asn_arena_use(asn_arena_t *arena) {
+	asn_arena_t *previous = asn_arena_current;
+	asn_arena_current = arena;
+	return previous;
+}
+
+void
+asn_arena_reset(asn_arena_t *arena) {
+	if(arena) {
+		arena->used = 0;
+		arena->last = 0;
+		arena->overflowed = 0;
+	}
+}
+
+size_t
+asn_arena_used(const asn_arena_t *arena) {
+	return arena ? arena->used : 0;
+}
+
+int
+asn_arena_overflowed(const asn_arena_t *arena) {
+	return arena ? arena->overflowed : 0;
+}
+
+void *
+asn_arena_malloc(size_t size) {
+	asn_arena_t *arena = asn_arena_current;
+
+	if(arena) {
+		size_t need = sizeof(asn_arena_header_t) + ASN_ARENA_ALIGN(size);
+		if(need > size && need <= ASN_ARENA_SIZE - arena->used) {
+			asn_arena_header_t *header = (asn_arena_header_t *)(arena->base + arena->used);
+			header->size = size;
+			arena->last = arena->used;
+			arena->used += need;
+			return header + 1;
+		}
+
+		arena->overflowed = 1;
+	}
+
+	return malloc(size);
+}
+
+void *
+asn_arena_calloc(size_t nmemb, size_t size) {
+	void *ptr;
+
+	if(asn_arena_current == NULL)
+		return calloc(nmemb, size);
+
+	if(size && nmemb > SIZE_MAX / size)
+		return NULL;
+
+	/* Arena memory is reused without being cleared */
+	ptr = asn_arena_malloc(nmemb * size);
+	if(ptr)
+		memset(ptr, 0, nmemb * size);
+	return ptr;
+}
+
+void *
+asn_arena_realloc(void *ptr, size_t size) {
+	asn_arena_header_t *header;
+	asn_arena_t *arena = asn_arena_current;
+	void *results;
+
+	if(ptr == NULL)
+		return asn_arena_malloc(size);
+
+	if(!asn_arena_contains(ptr))
+		return realloc(ptr, size);
+
+	header = (asn_arena_header_t *)ptr - 1;
+
+	/* The last allocation from the current arena can simply grow */
+	if(arena && (char *)header == arena->base + arena->last) {
+		size_t need = sizeof(asn_arena_header_t) + ASN_ARENA_ALIGN(size);
+		if(need > size && need <= ASN_ARENA_SIZE - arena->last) {
+			header->size = size;
+			arena->used = arena->last + need;
+			return ptr;
+		}
+	}
+
+	if(size <= header->size) {
+		header->size = size;
+		return ptr;
+	}
+
+	results = asn_arena_malloc(size);
+	if(results)
+		memcpy(results, ptr, header->size);
+	return results;
+}
+
+void
+asn_arena_free(void *ptr) {
+	/* Arena memory is only given back by a reset */
+	if(!asn_arena_contains(ptr))
+		free(ptr);
+}
@@ -51,73 +51,73 @@ public:
 	/// Message sub type for routing this message through TMX core.
 	static constexpr const char* MessageSubType = MSGSUBTYPE_LOCATION_STRING;
 
-	std_attribute(this->msg, std::string, Id, "", )
-	std_attribute(this->msg, location::SignalQualityTypes, SignalQuality, location::SignalQualityTypes::Invalid, )
+	struct_attribute(this->msg, std::string, Id, "", )
+	struct_attribute(this->msg, location::SignalQualityTypes, SignalQuality, location::SignalQualityTypes::Invalid, )
 	/**
 		 * $GPGGA Global Positioning System Fix Data.Time, position and fix related data for a GPS receiver.
 		 */
-	std_attribute(this->msg, std::string, SentenceIdentifier, "", )
+	struct_attribute(this->msg, std::string, SentenceIdentifier, "", )
 		/**
 		 * hhmmss.ss = UTC of position. (ex: 170834	        is  17:08:34 Z)
 		 */
-	std_attribute(this->msg, std::string, Time, "", )
+	struct_attribute(this->msg, std::string, Time, "", )
 		/**
 		 * llll.ll = latitude of position (ex: 4124.8963, N        is 	41d 24.8963' N or 41d 24' 54" N)
 		 * 	a = N or S
 		 */
-	std_attribute(this->msg, double, Latitude, 0.0, )
+	struct_attribute(this->msg, double, Latitude, 0.0, )
 		/**
 		 * 	yyyyy.yy = Longitude of position (ex: 08151.6838, W        is 81d 51.6838' W or 81d 51' 41" W)
 		 * a = E or W
 		 */
-	std_attribute(this->msg, double, Longitude, 0.0, )
+	struct_attribute(this->msg, double, Longitude, 0.0, )
 		/**
 		 * 	x = GPS Quality indicator (0=no fix, 1=GPS fix, 2=Dif. GPS fix)
 		 */
-	std_attribute(this->msg, location::FixTypes, FixQuality, location::FixTypes::Unknown, )
+	struct_attribute(this->msg, location::FixTypes, FixQuality, location::FixTypes::Unknown, )
 		/**
 		 * 	xx = number of satellites in use (ex: 	05	is 5 Satellites are in view)
 		 */
-	std_attribute(this->msg, int, NumSatellites, 0, )
+	struct_attribute(this->msg, int, NumSatellites, 0, )
 		/**
 		 * 	x.x = horizontal dilution of precision (ex: 1.5	is Relative accuracy of horizontal position)
 		 */
-	std_attribute(this->msg, double, HorizontalDOP, 0, )
+	struct_attribute(this->msg, double, HorizontalDOP, 0, )
 		/**
 		 * 	x.x = Antenna altitude above mean-sea-level (ex: 280.2, M	is   280.2 meters above mean sea level)
 	M = units of antenna altitude, meters
 		 */
-	std_attribute(this->msg, mMeas, Altitude, 0.0, )
+	struct_attribute(this->msg, mMeas, Altitude, 0.0, )
 		/**
 		 * x.x = Geoidal separation  - Height of geoid above WGS84 ellipsoid.  (ex: -34.0, M	is   -34.0 meters)
 	M = units of geoidal separation, meters
 		 */
-		//std_attribute(this->msg,double, GeoidalSeparation, 0, )
+		//struct_attribute(this->msg,double, GeoidalSeparation, 0, )
 		/**
 		 * Time since last DGPS update.
 		 * x.x = Age of Differential GPS data (seconds)
 		 */
-		//std_attribute(this->msg,int, SecSinceLastUpdate, 0, )
+		//struct_attribute(this->msg,int, SecSinceLastUpdate, 0, )
 		/**
 		 * DGPS reference station id
 		 * xxxx = Differential reference station ID
 		 */
-		//std_attribute(this->msg,std:string, RefStationId, 0, )
+		//struct_attribute(this->msg,std:string, RefStationId, 0, )
 		/**
 		 * Checksum. Used by program to check for transmission errors.
 		 */
-		//std_attribute(this->msg,int, Checksum, 0, )
+		//struct_attribute(this->msg,int, Checksum, 0, )
 
 		/**
 		 * x.x,K = Speed, m/s
 		 *  (ex: 010.2,K      Ground speed, meters per second)
 		 */
-	std_attribute(this->msg, mpsMeas, Speed, 0.0, )
+	struct_attribute(this->msg, mpsMeas, Speed, 0.0, )
 
 		/**
 		 * Heading in degrees.
 		 */
-	std_attribute(this->msg, degMeas, Heading, 0.0, )
+	struct_attribute(this->msg, degMeas, Heading, 0.0, )
 
 
 		//eg2. $--GGA,hhmmss.ss,llll.ll,a,yyyyy.yy,a,x,xx,x.x,x.x,M,x.x,M,x.x,xxxx
@@ -41,70 +41,70 @@ public:
 	static constexpr const char* MessageSubType = MSGSUBTYPE_BASIC_STRING;
 
 	/// The gear shift position.
-	std_attribute(this->msg, tmx::Enum<vehicleparam::GearState>, GearPosition, vehicleparam::GearState::GearUnknown, )
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::GearState>, GearPosition, vehicleparam::GearState::GearUnknown, )
 
 	/// Indicates whether the brake is currently applied.
-	std_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, Brake, vehicleparam::GenericState::Inactive, )
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, Brake, vehicleparam::GenericState::Inactive, )
 
 	/// Indicates whether the anti-lock brake system is currently applied.
-	std_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, ABS, vehicleparam::GenericState::Inactive, )
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, ABS, vehicleparam::GenericState::Inactive, )
 
 	/// Indicates whether the stability control system is currently applied.
-	std_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, StabilityControl, vehicleparam::GenericState::Inactive, )
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, StabilityControl, vehicleparam::GenericState::Inactive, )
 
 	/// The turn signal position.
-	std_attribute(this->msg, tmx::Enum<vehicleparam::TurnSignalState>, TurnSignalPosition, vehicleparam::TurnSignalState::SignalUnknown, )
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::TurnSignalState>, TurnSignalPosition, vehicleparam::TurnSignalState::SignalUnknown, )
 
 	/// The front door status
-	std_attribute(this->msg, tmx::Enum<vehicleparam::DoorState>, FrontDoors, vehicleparam::DoorState::Closed, );
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::DoorState>, FrontDoors, vehicleparam::DoorState::Closed, );
 
 	/// The rear door status
-	std_attribute(this->msg, tmx::Enum<vehicleparam::DoorState>, RearDoors, vehicleparam::DoorState::Closed, );
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::DoorState>, RearDoors, vehicleparam::DoorState::Closed, );
 
 	/// The status of the head lights
-	std_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, HeadLights, vehicleparam::GenericState::Inactive, );
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, HeadLights, vehicleparam::GenericState::Inactive, );
 
 	/// The status of the high beam headlights, i.e. the brights
-	std_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, HighBeam, vehicleparam::GenericState::Inactive, );
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, HighBeam, vehicleparam::GenericState::Inactive, );
 
 	/// The status of the tail lights
-	std_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, TailLights, vehicleparam::GenericState::Inactive, );
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, TailLights, vehicleparam::GenericState::Inactive, );
 
 	/// The status of the brake lights
-	std_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, BrakeLights, vehicleparam::GenericState::Inactive, );
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::GenericState>, BrakeLights, vehicleparam::GenericState::Inactive, );
 
 	/// The status of the wipers
-	std_attribute(this->msg, tmx::Enum<vehicleparam::WiperState>, Wipers, vehicleparam::WiperState::WiperUnknown, );
+	struct_attribute(this->msg, tmx::Enum<vehicleparam::WiperState>, Wipers, vehicleparam::WiperState::WiperUnknown, );
 
 	/// The steering wheel angle
-	std_attribute(this->msg, degMeas, SteeringWheelAngle, 0.0, );
+	struct_attribute(this->msg, degMeas, SteeringWheelAngle, 0.0, );
 
 	/// The accelerator pedal position
-	std_attribute(this->msg, pctMeas, AcceleratorPosition, 0.0, );
+	struct_attribute(this->msg, pctMeas, AcceleratorPosition, 0.0, );
 
 	/// The speed of the vehicle in meters per second
-	std_attribute(this->msg, mphMeas, Speed, 0.0, )
+	struct_attribute(this->msg, mphMeas, Speed, 0.0, )
 
 	/// The acceleration of the vehicle
-	std_attribute(this->msg, mperspersMeas, Acceleration, 0.0, );
+	struct_attribute(this->msg, mperspersMeas, Acceleration, 0.0, );
 
 	/// The speed of the left front wheelt
-	std_attribute(this->msg, rpmMeas, LeftFrontWheel, 0.0, );
+	struct_attribute(this->msg, rpmMeas, LeftFrontWheel, 0.0, );
 
 	/// The speed of the right front wheelt
-	std_attribute(this->msg, rpmMeas, RightFrontWheel, 0.0, );
+	struct_attribute(this->msg, rpmMeas, RightFrontWheel, 0.0, );
 
 	/// The speed of the left front wheelt
-	std_attribute(this->msg, rpmMeas, LeftRearWheel, 0.0, );
+	struct_attribute(this->msg, rpmMeas, LeftRearWheel, 0.0, );
 
 	/// The speed of the right front wheelt
-	std_attribute(this->msg, rpmMeas, RightRearWheel, 0.0, );
+	struct_attribute(this->msg, rpmMeas, RightRearWheel, 0.0, );
 
 	/// The length of the vehicle
-	std_attribute(this->msg, mMeas, VehicleLength, 0.0, );
+	struct_attribute(this->msg, mMeas, VehicleLength, 0.0, );
 
 	/// The outside air temperature
-	std_attribute(this->msg, CMeas, Temp, 0.0, );
+	struct_attribute(this->msg, CMeas, Temp, 0.0, );
 
 	/**
 	 * This function is only for backwards compatibility
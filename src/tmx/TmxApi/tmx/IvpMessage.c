@@ -6,6 +6,7 @@
  */
 
 #include "IvpMessage.h"
+#include "utils/HexCodec.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -72,6 +73,89 @@ IvpMessage *ivpMsg_addDsrcMetadata(IvpMessage *msg, int channel, int psid)
 	return msg;
 }
 
+static void ivpMsg_clearPayload(IvpMessage *msg)
+{
+	if (msg->payload != NULL) cJSON_Delete(msg->payload);
+	if (msg->payloadBytes != NULL) free(msg->payloadBytes);
+	msg->payload = NULL;
+	msg->payloadBytes = NULL;
+	msg->payloadLength = 0;
+}
+
+IvpMessage *ivpMsg_setPayload(IvpMessage *msg, cJSON *payload)
+{
+	assert(msg != NULL);
+	if (msg == NULL)
+		return msg;
+
+	ivpMsg_clearPayload(msg);
+	msg->payload = payload;
+
+	return msg;
+}
+
+IvpMessage *ivpMsg_setPayloadBytes(IvpMessage *msg, const uint8_t *bytes, size_t length)
+{
+	assert(msg != NULL);
+	if (msg == NULL)
+		return msg;
+
+	ivpMsg_clearPayload(msg);
+
+	if (length == 0)
+	{
+		msg->payload = cJSON_CreateString("");
+		return msg;
+	}
+
+	msg->payloadBytes = (uint8_t *)malloc(length);
+	assert(msg->payloadBytes != NULL);
+	if (msg->payloadBytes != NULL)
+	{
+		memcpy(msg->payloadBytes, bytes, length);
+		msg->payloadLength = length;
+	}
+
+	return msg;
+}
+
+static cJSON *ivpMsg_createHexString(const uint8_t *bytes, size_t length)
+{
+	char *hex = (char *)malloc(2 * length + 1);
+	if (hex == NULL)
+		return NULL;
+
+	hex[hexCodec_encode(bytes, length, hex)] = '\0';
+	cJSON *results = cJSON_CreateString(hex);
+	free(hex);
+
+	return results;
+}
+
+cJSON *ivpMsg_getPayload(IvpMessage *msg)
+{
+	assert(msg != NULL);
+	if (msg == NULL)
+		return NULL;
+
+	cJSON *payload = __atomic_load_n(&msg->payload, __ATOMIC_ACQUIRE);
+	if (payload == NULL && msg->payloadBytes != NULL)
+	{
+		// Readers on other threads may build the hex string at the same time, so only the
+		// first one is kept
+		cJSON *created = ivpMsg_createHexString(msg->payloadBytes, msg->payloadLength);
+		if (created == NULL)
+			return NULL;
+
+		if (__atomic_compare_exchange_n(&msg->payload, &payload, created, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			payload = created;
+		else
+			cJSON_Delete(created);
+	}
+
+	return payload;
+}
+
 IvpMessage *ivpMsg_parse(char *jsonmsg)
 {
 	assert(jsonmsg != NULL);
@@ -144,7 +228,10 @@ IvpMessage *ivpMsg_copy(IvpMessage *msg)
 		assert(copiedMsg->dsrcMetadata != NULL);
 		memcpy(copiedMsg->dsrcMetadata, msg->dsrcMetadata, sizeof(IvpDsrcMetadata));
 	}
-	if (msg->payload != NULL) copiedMsg->payload = cJSON_Duplicate(msg->payload, 1);
+	if (msg->payloadBytes != NULL)
+		ivpMsg_setPayloadBytes(copiedMsg, msg->payloadBytes, msg->payloadLength);
+	else if (msg->payload != NULL)
+		copiedMsg->payload = cJSON_Duplicate(msg->payload, 1);
 
 	pthread_mutex_lock(&ivpMsg_numberOfMessages_mutex);
 	ivpMsg_numberOfMessages++;
@@ -200,6 +287,8 @@ char *ivpMsg_createJsonString(IvpMessage *msg, IvpMsg_FormatOptions options)
 			}
 			cJSON_AddItemToObject(root, IVPMSG_FIELD_HEADER, header);
 			if (msg->payload != NULL) cJSON_AddItemToObject(root, IVPMSG_FIELD_PAYLOAD, cJSON_Duplicate(msg->payload, 1));
+			else if (msg->payloadBytes != NULL) cJSON_AddItemToObject(root, IVPMSG_FIELD_PAYLOAD,
+					ivpMsg_createHexString(msg->payloadBytes, msg->payloadLength));
 
 			if (options & IvpMsg_FormatOptions_formatted)
 				results = cJSON_Print(root);
@@ -224,7 +313,7 @@ void ivpMsg_destroy(IvpMessage *msg)
 	if (msg->source != NULL) free(msg->source);
 	if (msg->encoding != NULL) free(msg->encoding);
 	if (msg->dsrcMetadata != NULL) free(msg->dsrcMetadata);
-	if (msg->payload != NULL) cJSON_Delete(msg->payload);
+	ivpMsg_clearPayload(msg);
 
 	pthread_mutex_lock(&ivpMsg_numberOfMessages_mutex);
 	ivpMsg_numberOfMessages--;
@@ -9,6 +9,8 @@
 #define ivpMsg_H_
 
 #include "json/cJSONxtra.h"
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -34,6 +36,14 @@ typedef struct IvpMessage {
 	IvpMsgFlags flags;
 	IvpDsrcMetadata *dsrcMetadata;
 	cJSON *payload;
+
+	// A binary payload, such as an encoded J2735 message, is kept as raw bytes and only turned
+	// into the hex string payload for JSON.  When both are set, the bytes are the payload and
+	// the JSON is the hex string of them.  Use the functions below rather than setting these.
+	// These fields were added in TMX API 3.4.0 and change the size of the structure, so plugins
+	// built against an earlier API must be rebuilt.
+	uint8_t *payloadBytes;
+	size_t payloadLength;
 } IvpMessage;
 
 typedef enum {
@@ -66,6 +76,42 @@ IvpMessage *ivpMsg_create(const char *type, const char *subtype, const char *enc
 
 IvpMessage *ivpMsg_addDsrcMetadata(IvpMessage *msg, int channel, int psid);
 
+/*!
+ * Replaces the payload with a JSON payload.
+ *
+ * @param payload
+ * 		json payload.  The message takes ownership of the cJSON Object.  NULL is allowed.
+ *
+ * @requires
+ * 		msg != NULL
+ */
+IvpMessage *ivpMsg_setPayload(IvpMessage *msg, cJSON *payload);
+
+/*!
+ * Replaces the payload with a binary payload.  The bytes are sent as they are over the shared
+ * memory transport, and as a hex string in json messages.
+ *
+ * @param bytes
+ * 		The payload bytes.  The bytes are copied.  An empty payload is stored as an empty string.
+ *
+ * @requires
+ * 		msg != NULL
+ */
+IvpMessage *ivpMsg_setPayloadBytes(IvpMessage *msg, const uint8_t *bytes, size_t length);
+
+/*!
+ * Gets the json payload of a message.  A binary payload is converted to its hex string
+ * the first time, which is kept with the message.  So the message is changed even though
+ * the payload is only read, but it is safe to call from more than one thread at once.
+ *
+ * @returns
+ * 		The payload or NULL if there is none.  The message keeps ownership.
+ *
+ * @requires
+ * 		msg != NULL
+ */
+cJSON *ivpMsg_getPayload(IvpMessage *msg);
+
 /*!
  * Creates a new IvpMessage from a json string.
  *
@@ -7,7 +7,9 @@
 
 #include "IvpPlugin.h"
 #include "utils/MsgFramer.h"
+#include "utils/MsgArena.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <stdio.h>
@@ -21,6 +23,8 @@
 const IvpPluginInformation IVP_PLUGIN_INFORMATION_INITIALIZER = { .onMsgReceived = NULL, .onStateChange = NULL, .onError = NULL, .onConfigChanged = NULL, .manifestLocation = NULL };
 
 void ivp_broadcastAndDestroyMessage(IvpPlugin *plugin, IvpMessage *msg);
+int ivp_sendFramedMsg(IvpPlugin *plugin, const char *framedMsg, int framedLength);
+int ivp_buildMsgFrame(IvpMsgFrame *frame);
 char *ivp_getManifestFile(const char *filepath);
 void ivp_onError(IvpPlugin *plugin, IvpError err);
 void ivp_onErrorFromInfo(IvpPluginInformation *info, IvpError err);
@@ -28,6 +32,9 @@ void ivp_onStateChange(IvpPlugin *plugin, IvpPluginState state);
 void ivp_onMessageReceived(IvpPlugin *plugin, IvpMessage *msg);
 void ivp_onConfigChanged(IvpPlugin *plugin, const char *value, const char *key);
 void *ivp_receive(void *arg);
+void *ivp_shmReceive(void *arg);
+void ivp_startShm(IvpPlugin *plugin, IvpMessage *msg);
+void ivp_stopShm(IvpPlugin *plugin);
 
 IvpPlugin *ivp_create(IvpPluginInformation info)
 {
@@ -188,6 +195,34 @@ void ivp_broadcastMessage(IvpPlugin *plugin, IvpMessage *msg)
 	if (plugin->state != IvpPluginState_connected && plugin->state != IvpPluginState_registered)
 		return;
 
+	// Once ivpcore has accepted the shared memory transport, every message goes through the ring,
+	// so ivpcore reads them in order on a single thread.  While the ring is full, the sender waits
+	// for ivpcore to catch up, just as a send on a full socket would block.  The lock is only held
+	// for each attempt, so other senders are not blocked by the wait.
+	while (plugin->shmActive)
+	{
+		int shmResult = -2;
+		pthread_mutex_lock(&plugin->lock);
+		if (plugin->shmActive)
+			shmResult = shmTransport_send(&plugin->shm->toCore, msg);
+		pthread_mutex_unlock(&plugin->lock);
+
+		if (shmResult == 0)
+			return;
+
+		// The ring is far larger than a message framed for the socket can be, so a message
+		// that never fits in the ring could not be sent at all
+		if (shmResult == -1)
+		{
+			ivp_onError(plugin, ivpError_createError(IvpLogLevel_warn, IvpError_messageParse, EMSGSIZE));
+			return;
+		}
+
+		usleep(1000);
+	}
+
+	int switched = 0;
+
 	char *jsonMsg = ivpMsg_createJsonString(msg, IvpMsg_FormatOptions_none);
 	if (jsonMsg != NULL)
 	{
@@ -195,18 +230,140 @@ void ivp_broadcastMessage(IvpPlugin *plugin, IvpMessage *msg)
 		char *framedMsg = msgFramer_createFramedMsg(jsonMsg, strlen(jsonMsg), &framedLength);
 		if (framedMsg != NULL)
 		{
-			pthread_mutex_lock(&plugin->lock);
-			if (plugin->state == IvpPluginState_connected || plugin->state == IvpPluginState_registered)
-			{
-				if (send(plugin->socket, framedMsg, framedLength, 0) <= 0)
-					ivp_onStateChange(plugin, IvpPluginState_disconnected);
-			}
-			pthread_mutex_unlock(&plugin->lock);
-
+			switched = ivp_sendFramedMsg(plugin, framedMsg, framedLength);
 			free(framedMsg);
 		}
 		free(jsonMsg);
 	}
+
+	if (switched)
+		ivp_broadcastMessage(plugin, msg);
+}
+
+/*
+ * @returns
+ * 		1 if the message was not sent because the shared memory transport became active
+ * 		in the meantime, so the caller must send it through the ring instead, otherwise 0.
+ */
+int ivp_sendFramedMsg(IvpPlugin *plugin, const char *framedMsg, int framedLength)
+{
+	int switched = 0;
+
+	pthread_mutex_lock(&plugin->lock);
+	if (plugin->shmActive)
+	{
+		switched = 1;
+	}
+	else if (plugin->state == IvpPluginState_connected || plugin->state == IvpPluginState_registered)
+	{
+		if (send(plugin->socket, framedMsg, framedLength, 0) <= 0)
+			ivp_onStateChange(plugin, IvpPluginState_disconnected);
+	}
+	pthread_mutex_unlock(&plugin->lock);
+
+	return switched;
+}
+
+int ivp_buildMsgFrame(IvpMsgFrame *frame)
+{
+	if (frame->framedMsg != NULL)
+		free(frame->framedMsg);
+	frame->framedMsg = NULL;
+	frame->framedLength = 0;
+	frame->timestampOffset = 0;
+	frame->timestampLength = 0;
+
+	char *jsonMsg = ivpMsg_createJsonString(frame->msg, IvpMsg_FormatOptions_none);
+	if (jsonMsg == NULL)
+		return -1;
+
+	frame->framedMsg = msgFramer_createFramedMsg(jsonMsg, strlen(jsonMsg), &frame->framedLength);
+	free(jsonMsg);
+	if (frame->framedMsg == NULL)
+		return -1;
+
+	// The header is written before the payload, so the first timestamp field is the one in the header
+	const char *key = "\"timestamp\":";
+	char *found = strstr(frame->framedMsg, key);
+	if (found != NULL)
+	{
+		char *digits = found + strlen(key);
+		int length = 0;
+		while (digits[length] >= '0' && digits[length] <= '9')
+			length++;
+
+		if (length > 0)
+		{
+			frame->timestampOffset = digits - frame->framedMsg;
+			frame->timestampLength = length;
+		}
+	}
+
+	return 0;
+}
+
+IvpMsgFrame *ivp_createMsgFrame(IvpMessage *msg)
+{
+	assert(msg != NULL);
+	if (msg == NULL)
+		return NULL;
+
+	IvpMsgFrame *frame = calloc(1, sizeof(IvpMsgFrame));
+	if (frame == NULL)
+		return NULL;
+
+	frame->msg = ivpMsg_copy(msg);
+	if (frame->msg == NULL || ivp_buildMsgFrame(frame) != 0)
+	{
+		ivp_destroyMsgFrame(frame);
+		return NULL;
+	}
+
+	return frame;
+}
+
+void ivp_broadcastMsgFrame(IvpPlugin *plugin, IvpMsgFrame *frame, uint64_t timestamp)
+{
+	assert(plugin != NULL);
+	assert(frame != NULL);
+	if (plugin == NULL || frame == NULL || frame->msg == NULL)
+		return;
+
+	if (plugin->state != IvpPluginState_connected && plugin->state != IvpPluginState_registered)
+		return;
+
+	frame->msg->timestamp = timestamp;
+
+	// The shared memory transport copies the payload bytes or string as is, so the message is sent directly
+	if (plugin->shmActive)
+	{
+		ivp_broadcastMessage(plugin, frame->msg);
+		return;
+	}
+
+	char digits[24];
+	int length = snprintf(digits, sizeof(digits), "%llu", (unsigned long long)timestamp);
+
+	if (frame->timestampLength == length)
+		memcpy(frame->framedMsg + frame->timestampOffset, digits, length);
+	else if (ivp_buildMsgFrame(frame) != 0)
+		return;
+
+	if (ivp_sendFramedMsg(plugin, frame->framedMsg, frame->framedLength))
+		ivp_broadcastMessage(plugin, frame->msg);
+}
+
+void ivp_destroyMsgFrame(IvpMsgFrame *frame)
+{
+	assert(frame != NULL);
+	if (frame == NULL)
+		return;
+
+	if (frame->msg != NULL)
+		ivpMsg_destroy(frame->msg);
+	if (frame->framedMsg != NULL)
+		free(frame->framedMsg);
+	free(frame);
 }
 
 char *ivp_getCopyOfConfigurationValue(IvpPlugin *plugin, const char *key)
@@ -263,6 +420,8 @@ void ivp_destroy(IvpPlugin *plugin)
 	pthread_cancel(plugin->receiveThread);
 	pthread_join(plugin->receiveThread, NULL);
 
+	ivp_stopShm(plugin);
+
 	if (plugin->jsonManifest != NULL)
 		cJSON_Delete(plugin->jsonManifest);
 	if (plugin->filter != NULL)
@@ -378,6 +537,10 @@ void ivp_onMessageReceived(IvpPlugin *plugin, IvpMessage *msg)
 		IvpError err = ivpError_getError(msg);
 		ivp_onError(plugin, err);
 	}
+	else if (ivpShm_isShmMsg(msg))
+	{
+		ivp_startShm(plugin, msg);
+	}
 	else if(ivpConfig_isConfigMsg(msg))
 	{
 		IvpConfigCollection *collection = msg->payload;
@@ -464,10 +627,24 @@ void *ivp_receive(void *arg)
 		plugin->socket = fd;
 		ivp_onStateChange(plugin, IvpPluginState_connected);
 
-		ivp_broadcastAndDestroyMessage(plugin, ivpRegister_createMsgFromJson(plugin->jsonManifest));
+		IvpMessage *registerMsg = ivpRegister_createMsgFromJson(plugin->jsonManifest);
+		if (registerMsg != NULL)
+		{
+			const char *disableShm = getenv(SHM_TRANSPORT_DISABLE_ENV);
+			if (disableShm == NULL || strcmp(disableShm, "1") != 0)
+			{
+				plugin->shm = shmTransport_create(SHM_TRANSPORT_DEFAULT_RING_SIZE);
+				if (plugin->shm != NULL)
+					ivpShm_addOffer(registerMsg, getpid(), plugin->shm);
+			}
+		}
+		ivp_broadcastAndDestroyMessage(plugin, registerMsg);
 
 		MsgFramer framer = MSG_FRAMER_INITIALIZER;
 
+		// The JSON of each message is decoded into an arena that is reset once it is handled
+		MsgArena *arena = msgArena_acquire();
+
 		while(plugin->state == IvpPluginState_connected
 				|| plugin->state == IvpPluginState_registered)
 		{
@@ -488,7 +665,10 @@ void *ivp_receive(void *arg)
 
 				while((rawmsg = msgFramer_getNextMsg(&framer)) != NULL)
 				{
+					MsgArena *previous = msgArena_use(arena);
 					IvpMessage *msg = ivpMsg_parse(rawmsg);
+					msgArena_use(previous);
+
 					if (msg != NULL)
 					{
 						ivp_onMessageReceived(plugin, msg);
@@ -498,10 +678,16 @@ void *ivp_receive(void *arg)
 					{
 						ivp_onError(plugin, ivpError_createError(IvpLogLevel_warn, IvpError_messageParse, 0));
 					}
+
+					msgArena_reset(arena);
 				}
 			}
 		}
 
+		msgArena_release(arena);
+
+		ivp_stopShm(plugin);
+
 		close(fd);
 		plugin->socket = -1;
 	}
@@ -509,3 +695,85 @@ void *ivp_receive(void *arg)
 	return NULL;
 }
 
+void ivp_startShm(IvpPlugin *plugin, IvpMessage *msg)
+{
+	assert(plugin != NULL);
+	assert(msg != NULL);
+	if (plugin == NULL || msg == NULL || plugin->shm == NULL || plugin->shmActive)
+		return;
+
+	if (!ivpShm_isAccepted(msg))
+	{
+		ivp_stopShm(plugin);
+		return;
+	}
+
+	// A message that is already on its way to the socket is sent through the ring instead
+	// once this is set, so nothing reaches ivpcore over the socket after the first ring message
+	pthread_mutex_lock(&plugin->lock);
+	plugin->shmActive = 1;
+	pthread_mutex_unlock(&plugin->lock);
+
+	int err = pthread_create(&plugin->shmReceiveThread, NULL, ivp_shmReceive, plugin);
+	if (err != 0)
+	{
+		pthread_mutex_lock(&plugin->lock);
+		plugin->shmActive = 0;
+		pthread_mutex_unlock(&plugin->lock);
+		ivp_onError(plugin, ivpError_createError(IvpLogLevel_error, IvpError_connectFail, err));
+
+		// ivpcore only sends through the ring from now on, so start over with a new connection
+		ivp_onStateChange(plugin, IvpPluginState_disconnected);
+	}
+}
+
+void ivp_stopShm(IvpPlugin *plugin)
+{
+	assert(plugin != NULL);
+	if (plugin == NULL)
+		return;
+
+	pthread_mutex_lock(&plugin->lock);
+	int wasActive = plugin->shmActive;
+	plugin->shmActive = 0;
+	pthread_mutex_unlock(&plugin->lock);
+
+	if (wasActive && !pthread_equal(pthread_self(), plugin->shmReceiveThread))
+		pthread_join(plugin->shmReceiveThread, NULL);
+
+	if (plugin->shm != NULL)
+	{
+		shmTransport_destroy(plugin->shm);
+		plugin->shm = NULL;
+	}
+}
+
+void *ivp_shmReceive(void *arg)
+{
+	IvpPlugin *plugin = (IvpPlugin *)arg;
+	assert(plugin != NULL);
+	if (plugin == NULL)
+		return NULL;
+
+	MsgArena *arena = msgArena_acquire();
+
+	while (plugin->shmActive)
+	{
+		MsgArena *previous = msgArena_use(arena);
+		IvpMessage *msg = shmTransport_receive(&plugin->shm->toPlugin, 100);
+		msgArena_use(previous);
+
+		if (msg != NULL)
+		{
+			ivp_onMessageReceived(plugin, msg);
+			ivpMsg_destroy(msg);
+		}
+
+		msgArena_reset(arena);
+	}
+
+	msgArena_release(arena);
+
+	return NULL;
+}
+
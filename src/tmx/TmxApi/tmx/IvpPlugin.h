@@ -16,6 +16,7 @@
 #include "apimessages/IvpRegister.h"
 #include "apimessages/IvpEventLog.h"
 #include "apimessages/IvpMessageType.h"
+#include "apimessages/IvpShm.h"
 #include <pthread.h>
 
 #ifdef __cplusplus
@@ -85,6 +86,9 @@ typedef struct IvpPlugin {
 	int socket;
 	pthread_t receiveThread;
 	pthread_mutex_t lock;
+	ShmTransport *shm;
+	pthread_t shmReceiveThread;
+	volatile int shmActive;
 } IvpPlugin;
 
 /*!
@@ -145,6 +149,47 @@ void ivp_addEventLog(IvpPlugin *plugin, IvpLogLevel level, const char *descripti
  */
 void ivp_broadcastMessage(IvpPlugin *plugin, IvpMessage *msg);
 
+/*!
+ * A message that has been serialized and framed once, so it can be broadcast many times
+ * with only a new timestamp written into the frame.
+ */
+typedef struct {
+	IvpMessage *msg;
+	char *framedMsg;
+	int framedLength;
+	/*! The position and length of the timestamp digits in the frame, or 0 if they were not found */
+	int timestampOffset;
+	int timestampLength;
+} IvpMsgFrame;
+
+/*!
+ * Serializes and frames a copy of a message for ivp_broadcastMsgFrame.
+ *
+ * @returns
+ * 		A malloc'ed frame, to be freed with ivp_destroyMsgFrame, or NULL on error.
+ *
+ * @requires
+ * 		msg != NULL
+ */
+IvpMsgFrame *ivp_createMsgFrame(IvpMessage *msg);
+
+/*!
+ * Broadcasts a prebuilt message frame with a new timestamp.  The timestamp is written into the
+ * existing frame, unless it has a different number of digits, in which case the frame is rebuilt.
+ *
+ * @requires
+ * 		plugin != NULL
+ * 		frame != NULL
+ */
+void ivp_broadcastMsgFrame(IvpPlugin *plugin, IvpMsgFrame *frame, uint64_t timestamp);
+
+/*!
+ *
+ * @requires
+ * 		frame != NULL
+ */
+void ivp_destroyMsgFrame(IvpMsgFrame *frame);
+
 /*!
  *
  * @requires
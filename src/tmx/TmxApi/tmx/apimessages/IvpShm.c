@@ -0,0 +1,92 @@
+/*
+ * IvpShm.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "IvpShm.h"
+#include <string.h>
+#include <assert.h>
+
+#define IVP_SHM_FIELD_OFFER "sharedMemory"
+#define IVP_SHM_FIELD_PID "pid"
+#define IVP_SHM_FIELD_MEMFD "memFd"
+#define IVP_SHM_FIELD_TOCORE "toCoreEvent"
+#define IVP_SHM_FIELD_TOPLUGIN "toPluginEvent"
+#define IVP_SHM_FIELD_ACCEPTED "accepted"
+
+
+void ivpShm_addOffer(IvpMessage *registerMsg, int pid, ShmTransport *transport)
+{
+	assert(registerMsg != NULL);
+	assert(transport != NULL);
+	if (registerMsg == NULL || registerMsg->payload == NULL || transport == NULL)
+		return;
+
+	cJSON *offer = cJSON_CreateObject();
+	assert(offer != NULL);
+	if (offer != NULL)
+	{
+		cJSON_AddNumberToObject(offer, IVP_SHM_FIELD_PID, pid);
+		cJSON_AddNumberToObject(offer, IVP_SHM_FIELD_MEMFD, transport->memFd);
+		cJSON_AddNumberToObject(offer, IVP_SHM_FIELD_TOCORE, transport->toCore.eventFd);
+		cJSON_AddNumberToObject(offer, IVP_SHM_FIELD_TOPLUGIN, transport->toPlugin.eventFd);
+
+		cJSON_AddItemToObject(registerMsg->payload, IVP_SHM_FIELD_OFFER, offer);
+	}
+}
+
+int ivpShm_getOffer(IvpMessage *registerMsg, IvpShmOffer *offer)
+{
+	assert(registerMsg != NULL);
+	assert(offer != NULL);
+	if (registerMsg == NULL || registerMsg->payload == NULL || offer == NULL)
+		return 0;
+
+	cJSON *item = cJSON_GetObjectItem(registerMsg->payload, IVP_SHM_FIELD_OFFER);
+	if (item == NULL || item->type != cJSON_Object)
+		return 0;
+
+	return cJSONxtra_tryGetInt(item, IVP_SHM_FIELD_PID, &offer->pid)
+			&& cJSONxtra_tryGetInt(item, IVP_SHM_FIELD_MEMFD, &offer->memFd)
+			&& cJSONxtra_tryGetInt(item, IVP_SHM_FIELD_TOCORE, &offer->toCoreEventFd)
+			&& cJSONxtra_tryGetInt(item, IVP_SHM_FIELD_TOPLUGIN, &offer->toPluginEventFd);
+}
+
+IvpMessage *ivpShm_createMsg(int accepted)
+{
+	IvpMessage *results = NULL;
+
+	cJSON *payload = cJSON_CreateObject();
+	assert(payload != NULL);
+	if (payload != NULL)
+	{
+		cJSON_AddBoolToObject(payload, IVP_SHM_FIELD_ACCEPTED, accepted);
+
+		results = ivpMsg_create(IVPMSG_TYPE_APIRESV_SHM, NULL, IVP_ENCODING_JSON, IvpMsgFlags_None, payload);
+		assert(results != NULL);
+
+		cJSON_Delete(payload);
+	}
+
+	return results;
+}
+
+inline int ivpShm_isShmMsg(IvpMessage *msg)
+{
+	assert(msg != NULL);
+	if (msg == NULL)
+		return 0;
+	return msg->type != NULL && strcmp(msg->type, IVPMSG_TYPE_APIRESV_SHM) == 0;
+}
+
+int ivpShm_isAccepted(IvpMessage *msg)
+{
+	assert(msg != NULL);
+	if (msg == NULL || !ivpShm_isShmMsg(msg) || msg->payload == NULL)
+		return 0;
+
+	cJSON *accepted = cJSON_GetObjectItem(msg->payload, IVP_SHM_FIELD_ACCEPTED);
+	return accepted != NULL && accepted->type == cJSON_True;
+}
@@ -0,0 +1,57 @@
+/*
+ * IvpShm.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef IVPSHM_H_
+#define IVPSHM_H_
+
+#include "../tmx.h"
+#include "../IvpMessage.h"
+#include "../utils/ShmTransport.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ * The shared memory transport that a plugin offers to ivpcore in its registration message.
+ * The file descriptors are only valid in the plugin process, identified by pid.
+ */
+typedef struct {
+	int pid;
+	int memFd;
+	int toCoreEventFd;
+	int toPluginEventFd;
+} IvpShmOffer;
+
+/*!
+ * Adds an offer for the transport to a registration message.  An ivpcore that does not
+ * support the shared memory transport ignores the offer.
+ */
+void ivpShm_addOffer(IvpMessage *registerMsg, int pid, ShmTransport *transport);
+
+/*!
+ * @returns
+ * 		1 if the registration message contains an offer, otherwise 0.
+ */
+int ivpShm_getOffer(IvpMessage *registerMsg, IvpShmOffer *offer);
+
+/*!
+ * Creates the reply to an offer.  All messages after an accepted reply are sent through the rings.
+ */
+IvpMessage *ivpShm_createMsg(int accepted);
+
+int ivpShm_isShmMsg(IvpMessage *msg);
+
+int ivpShm_isAccepted(IvpMessage *msg);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IVPSHM_H_ */
@@ -209,6 +209,94 @@ public:
 	}
 };
 
+/**
+ * An attribute that is kept as a native field of the object, instead of in the container,
+ * so getting or setting the value is only a copy.  The value is only cast to or from the
+ * untyped value of the tree when the tree is read or written, which requires a container
+ * with the struct backend.
+ *
+ * The field is bound to the container by the first set.  Until then, get reads the value
+ * from the tree each time, so getting a value never changes the object, and a message that
+ * is shared for reading is safe to read from more than one thread.
+ */
+template <typename Type,
+		  typename BackendType = CSTORE_TYPE,
+		  typename TraitsType = detected_traits<Type, BackendType> >
+class native_attribute {
+public:
+	typedef native_attribute<Type, BackendType, TraitsType> attr_type;
+	typedef typename Type::data_type data_type;
+	typedef basic_attribute_container<BackendType> container_type;
+	typedef TraitsType traits_type;
+	typedef typename traits_type::storage_type storage_type;
+	typedef typename storage_type::path_type path_type;
+	typedef typename storage_type::value_type value_type;
+
+	native_attribute(): _value(Type::default_value()), _owner(0), _generation(0) {
+		// Only register the type once, not for every object
+		static bool registered = register_type();
+		(void)registered;
+	}
+
+	static traits_type &traits() {
+		static traits_type t;
+		return t;
+	}
+
+	std::string name() { return traits().name; }
+	path_type path() { return traits().path; }
+
+	std::string data_type_name() {
+		static std::string name = type_id_name<data_type>();
+		return name;
+	}
+
+	inline data_type get(container_type &container) {
+		storage_type &storage = container.get_storage();
+		if (is_bound(storage))
+			return _value;
+
+		value_type untyped;
+		if (storage.lookup(traits().path, untyped))
+			return attribute_lexical_cast<data_type>(untyped);
+
+		return traits().default_value;
+	}
+
+	inline void set(container_type &container, const data_type &data) {
+		storage_type &storage = container.get_storage();
+		if (!is_bound(storage))
+			bind(storage);
+
+		_value = data;
+		storage.set_dirty();
+		container.touch();
+	}
+private:
+	static bool register_type() {
+		attribute_registry<storage_type>::get_instance().register_type(traits());
+		return true;
+	}
+
+	static void materialize(const void *field, typename storage_type::tree_backend_type &tree) {
+		const attr_type *attr = static_cast<const attr_type *>(field);
+		tree.store(traits().path, attribute_lexical_cast<value_type>(attr->_value));
+	}
+
+	inline bool is_bound(const storage_type &storage) const {
+		return _owner == &storage && _generation == storage.generation();
+	}
+
+	void bind(storage_type &storage) {
+		_generation = storage.bind(this, &attr_type::materialize);
+		_owner = &storage;
+	}
+
+	data_type _value;
+	const storage_type *_owner;
+	int _generation;
+};
+
 }} /* End namespace */
 
 #endif /* SRC_ATTRIBUTES_ATTRIBUTE_TYPE_HPP_ */
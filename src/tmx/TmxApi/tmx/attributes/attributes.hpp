@@ -82,6 +82,8 @@ public: \
 	rw_attribute(C, battelle::attributes::standard_attribute<Y>, X, Y, get_, D, set_, L)
 #define std_2level_attribute(C, X, Y, D, L) \
 	rw_attribute(C, battelle::attributes::standard_2level_attribute<Y>, X, Y, get_, D, set_, L)
+#define struct_attribute(C, X, Y, D, L) \
+	rw_attribute(C, battelle::attributes::native_attribute<Y>, X, Y, get_, D, set_, L)
 
 namespace battelle { namespace attributes {
 
@@ -8,6 +8,9 @@
 #ifndef SRC_ATTRIBUTES_CONTAINER_HPP_
 #define SRC_ATTRIBUTES_CONTAINER_HPP_
 
+#include <atomic>
+#include <cstddef>
+#include <mutex>
 #include <vector>
 #include <iostream>
 
@@ -56,6 +59,14 @@ public:
 		return storage_version;
 	}
 
+	/**
+	 * Change the version for an update that was not made through store, such as to
+	 * an attribute kept outside of the storage.
+	 */
+	inline void touch() {
+		storage_version++;
+	}
+
 	inline storage_type &get_storage()
 	{
 		return _storage;
@@ -117,11 +128,188 @@ private:
 	tree_type _tree;
 };
 
+/**
+ * A backend storage that keeps some attributes as native fields of the object that owns the
+ * container, instead of as strings in a boost::property_tree::ptree.  Such a field registers
+ * with the storage the first time it is set, and is only written into the tree when the tree
+ * itself is needed, i.e. to serialize the container to JSON or XML.  All other attributes are
+ * kept in the tree just as in the ptree backend.
+ *
+ * The first read of the tree after a field is set writes the fields into the tree and unbinds
+ * them, so a read does change the storage.  That is done under a lock, as is every look up or
+ * copy of the tree, so a container that is no longer being changed is as safe to read from more
+ * than one thread as the ptree backend.  A reference to the tree is only safe to use while no
+ * other thread is setting a value in the container, just as in the ptree backend.
+ *
+ * A field is located by its offset from the storage, so the fields and the container must be
+ * members of the same object.  A copy of the storage gets the values of the fields in its tree,
+ * but not the fields themselves.
+ */
+template <typename PtreePathType, typename PtreeValueType>
+class struct_backend {
+public:
+	typedef ptree_backend<PtreePathType, PtreeValueType> tree_backend_type;
+	typedef typename tree_backend_type::tree_type tree_type;
+	typedef typename tree_backend_type::path_type path_type;
+	typedef typename tree_backend_type::value_type value_type;
+
+	/// A function that writes the value of a field into the tree
+	typedef void (*materialize_function)(const void *field, tree_backend_type &tree);
+
+	struct_backend(): _dirty(false), _generation(1) {}
+
+	struct_backend(const struct_backend &other): _dirty(false), _generation(1) {
+		std::lock_guard<std::mutex> lock(other._lock);
+		_tree = other._tree;
+		other.materialize(_tree);
+	}
+
+	struct_backend &operator=(const struct_backend &other) {
+		if (this != &other) {
+			std::unique_lock<std::mutex> lock(_lock, std::defer_lock);
+			std::unique_lock<std::mutex> otherLock(other._lock, std::defer_lock);
+			std::lock(lock, otherLock);
+
+			_tree = other._tree;
+			other.materialize(_tree);
+			invalidate();
+		}
+		return *this;
+	}
+
+	static boost::property_tree::path get_path(const path_type &pathLoc) {
+		return tree_backend_type::get_path(pathLoc);
+	}
+
+	boost::optional<tree_type &> subtree(const path_type &pathLoc) {
+		// The sub-tree may be changed by the caller
+		std::lock_guard<std::mutex> lock(_lock);
+		flush();
+		invalidate();
+		return _tree.subtree(pathLoc);
+	}
+
+	void store(const path_type &pathLoc, const value_type &value) {
+		std::lock_guard<std::mutex> lock(_lock);
+		flush();
+		invalidate();
+		_tree.store(pathLoc, value);
+	}
+
+	value_type retrieve(const path_type &pathLoc, const value_type &default_value, bool set_on_missing) {
+		std::lock_guard<std::mutex> lock(_lock);
+		flush();
+		if (set_on_missing && !_tree.subtree(pathLoc))
+			invalidate();
+		return _tree.retrieve(pathLoc, default_value, set_on_missing);
+	}
+
+	/**
+	 * @return The tree, with the current value of every field.  Since the tree may be changed
+	 * by the caller, the fields read their values back from the tree the next time they are used.
+	 */
+	tree_type &get_tree() {
+		std::lock_guard<std::mutex> lock(_lock);
+		flush();
+		invalidate();
+		return _tree.get_tree();
+	}
+
+	/**
+	 * @return The generation of the tree, which changes whenever the tree may have been changed
+	 * outside of the fields, and the fields must be registered again
+	 */
+	inline int generation() const {
+		return _generation;
+	}
+
+	/**
+	 * Register a field, so its value is written into the tree when the tree is needed.
+	 *
+	 * @param field The field, which must be a member of the same object as the storage
+	 * @param fn The function to write the value of the field
+	 * @return The current generation
+	 */
+	int bind(const void *field, materialize_function fn) {
+		std::lock_guard<std::mutex> lock(_lock);
+		if (_fields.empty())
+			_fields.reserve(16);
+
+		_fields.push_back(native_field((const char *)field - (const char *)this, fn));
+		return _generation;
+	}
+
+	/**
+	 * Note that a field has changed, so the fields must be written into the tree when needed.
+	 */
+	inline void set_dirty() {
+		_dirty = true;
+	}
+
+	/**
+	 * Look up the value of a field in the tree, without writing the other fields.
+	 *
+	 * @param pathLoc The path of the field
+	 * @param value The value found
+	 * @return True if the path exists in the tree
+	 */
+	bool lookup(const path_type &pathLoc, value_type &value) {
+		std::lock_guard<std::mutex> lock(_lock);
+		boost::optional<tree_type &> subTree = _tree.subtree(pathLoc);
+		if (!subTree)
+			return false;
+
+		value = subTree.get().data();
+		return true;
+	}
+private:
+	struct native_field {
+		native_field(std::ptrdiff_t off, materialize_function func): offset(off), fn(func) {}
+
+		std::ptrdiff_t offset;
+		materialize_function fn;
+	};
+
+	// The caller must hold the lock
+	void materialize(tree_backend_type &tree) const {
+		if (!_dirty)
+			return;
+
+		for (std::size_t i = 0; i < _fields.size(); i++)
+			_fields[i].fn((const char *)this + _fields[i].offset, tree);
+	}
+
+	void flush() {
+		if (_dirty) {
+			materialize(_tree);
+			_dirty = false;
+		}
+	}
+
+	// With no fields bound, there is nothing to unbind, so leave the storage as it is
+	void invalidate() {
+		if (!_fields.empty()) {
+			_fields.clear();
+			_dirty = false;
+			_generation++;
+		}
+	}
+
+	tree_backend_type _tree;
+	std::vector<native_field> _fields;
+	bool _dirty;
+	std::atomic<int> _generation;
+	mutable std::mutex _lock;
+};
+
 typedef ptree_backend<std::string, std::string> standard_ptree_backend;
 typedef basic_attribute_container<standard_ptree_backend> ptree_backed_attribute_container;
 
-// Right now, this is the only option
-typedef ptree_backed_attribute_container attribute_container;
+typedef struct_backend<std::string, std::string> standard_struct_backend;
+typedef basic_attribute_container<standard_struct_backend> struct_backed_attribute_container;
+
+// The struct backend holds any attribute the ptree backend can, plus the native fields
+typedef struct_backed_attribute_container attribute_container;
 
 #define CSTORE_TYPE battelle::attributes::attribute_container::storage_type
 
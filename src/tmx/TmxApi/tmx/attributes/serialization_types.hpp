@@ -27,13 +27,13 @@ namespace battelle { namespace attributes {
 typedef struct {
 	static std::string name() { return "JSON"; }
 
-	template <class InputType> inline
-	void read(CSTORE_TYPE &container, InputType &in) {
+	template <class InputType, class StorageType> inline
+	void read(StorageType &container, InputType &in) {
 		read_json(in, container.get_tree());
 	}
 
-	template <class OutputType> inline
-	void write(CSTORE_TYPE &container, OutputType &out) {
+	template <class OutputType, class StorageType> inline
+	void write(StorageType &container, OutputType &out) {
 		write_json(out, container.get_tree(), false);
 	}
 } JSON;
@@ -44,14 +44,14 @@ typedef struct {
 typedef struct {
 	static std::string name() { return "XML"; }
 
-	template <class InputType> inline
-	void read(CSTORE_TYPE &container, InputType &in) {
+	template <class InputType, class StorageType> inline
+	void read(StorageType &container, InputType &in) {
 		// Make sure to get rid of excess white spaces, which cause problems in translations
 		read_xml(in, container.get_tree(), boost::property_tree::xml_parser::trim_whitespace);
 	}
 
-	template <class OutputType> inline
-	void write(CSTORE_TYPE &container, OutputType &out) {
+	template <class OutputType, class StorageType> inline
+	void write(StorageType &container, OutputType &out) {
 		write_xml(out, container.get_tree());
 	}
 } XML;
@@ -62,13 +62,13 @@ typedef struct {
 typedef struct {
 	static std::string name() { return "INI"; }
 
-	template <class InputType> inline
-	void read(CSTORE_TYPE &container, InputType &in) {
+	template <class InputType, class StorageType> inline
+	void read(StorageType &container, InputType &in) {
 		read_ini(in, container.get_tree());
 	}
 
-	template <class OutputType> inline
-	void write(CSTORE_TYPE &container, OutputType &out) {
+	template <class OutputType, class StorageType> inline
+	void write(StorageType &container, OutputType &out) {
 		write_ini(out, container.get_tree());
 	}
 } INI;
@@ -79,13 +79,13 @@ typedef struct {
 typedef struct {
 	static std::string name() { return "INFO"; }
 
-	template <class InputType> inline
-	void read(CSTORE_TYPE &container, InputType &in) {
+	template <class InputType, class StorageType> inline
+	void read(StorageType &container, InputType &in) {
 		read_info(in, container.get_tree());
 	}
 
-	template <class OutputType> inline
-	void write(CSTORE_TYPE &container, OutputType &out) {
+	template <class OutputType, class StorageType> inline
+	void write(StorageType &container, OutputType &out) {
 		write_info(out, container.get_tree());
 	}
 } INFO;
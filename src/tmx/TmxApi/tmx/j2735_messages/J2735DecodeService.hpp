@@ -0,0 +1,189 @@
+/*
+ * @file J2735DecodeService.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      @author: ivp
+ */
+
+#ifndef TMX_J2735_MESSAGES_J2735DECODESERVICE_HPP_
+#define TMX_J2735_MESSAGES_J2735DECODESERVICE_HPP_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <asn_arena.h>
+#include <tmx/messages/TmxJ2735Codec.hpp>
+
+namespace tmx {
+namespace messages {
+
+/**
+ * A service to decode J2735 messages in bulk.
+ *
+ * The structures of each decoded message are allocated from an arena that belongs to the calling
+ * thread, instead of one heap allocation for every node of the tree, and they are all released at
+ * once with Reset().  A decoded message is therefore only valid on the thread that decoded it, and
+ * only until the next Reset() on that thread.  Use TmxJ2735EncodedMessage for a message that must
+ * outlive that.
+ *
+ * The service has no state of its own, so one instance, or get_instance(), can be shared by any
+ * number of threads.  A thread takes an arena from the pool the first time it decodes, and gives
+ * it back when it exits.  If the pool is empty, the thread decodes onto the heap, and Reset() frees
+ * the messages in the usual way.
+ */
+class J2735DecodeService
+{
+public:
+	typedef MessageFrameMessage::message_type frame_type;
+
+	/**
+	 * @return The service shared by the whole process
+	 */
+	static J2735DecodeService &get_instance()
+	{
+		static J2735DecodeService theService;
+		return theService;
+	}
+
+	/**
+	 * Decode one message frame with the default encoding for this J2735 specification.
+	 *
+	 * @param data The encoded bytes
+	 * @param length The number of encoded bytes
+	 * @return The decoded frame, or NULL if the bytes could not be decoded
+	 */
+	frame_type *DecodeFrame(const uint8_t *data, size_t length)
+	{
+		return (frame_type *)decode(MessageFrameMessage::get_descriptor(), data, length);
+	}
+
+	/**
+	 * @see DecodeFrame(const uint8_t *, size_t)
+	 */
+	frame_type *DecodeFrame(const tmx::byte_stream &bytes)
+	{
+		return DecodeFrame(bytes.data(), bytes.size());
+	}
+
+	/**
+	 * Decode one message of the given type, e.g. Decode<BsmMessage>(bytes).  The bytes are
+	 * expected to be in a message frame, except for the older specifications.
+	 *
+	 * @param bytes The encoded bytes
+	 * @return The decoded message, or NULL if the bytes could not be decoded or hold another type
+	 */
+	template <typename MsgType>
+	typename MsgType::message_type *Decode(const tmx::byte_stream &bytes)
+	{
+#if SAEJ2735_SPEC < 63
+		return (typename MsgType::message_type *)decode(MsgType::get_descriptor(), bytes.data(), bytes.size());
+#else
+		frame_type *frame = DecodeFrame(bytes);
+		if (!frame)
+			return NULL;
+
+		return j2735::j2735_cast<typename MsgType::message_type>(frame);
+#endif
+	}
+
+	/**
+	 * Release every message decoded on the calling thread.
+	 */
+	void Reset()
+	{
+		thread_state &state = get_state();
+
+		// The nodes only have to be freed one by one if some came from the heap
+		if (!state.arena || asn_arena_overflowed(state.arena))
+		{
+			for (auto &decoded : state.decoded)
+				ASN_STRUCT_FREE(*decoded.first, decoded.second);
+		}
+
+		state.decoded.clear();
+		asn_arena_reset(state.arena);
+	}
+
+	/**
+	 * Decode a batch of message frames, passing each one that could be decoded to the handler
+	 * as handler(index, frame).  Each frame is released when the handler returns.
+	 *
+	 * @param batch The encoded messages
+	 * @param handler The function to call for each decoded frame
+	 * @return The number of messages decoded
+	 */
+	template <typename Handler>
+	size_t DecodeAll(const std::vector<tmx::byte_stream> &batch, Handler handler)
+	{
+		size_t count = 0;
+
+		Reset();
+		for (size_t i = 0; i < batch.size(); i++)
+		{
+			frame_type *frame = DecodeFrame(batch[i]);
+			if (frame)
+			{
+				count++;
+				handler(i, frame);
+			}
+
+			Reset();
+		}
+
+		return count;
+	}
+
+private:
+	// The arena and the messages decoded into it since the last reset, for one thread
+	struct thread_state
+	{
+		asn_arena_t *arena;
+		std::vector<std::pair<asn_TYPE_descriptor_t *, void *> > decoded;
+
+		thread_state(): arena(asn_arena_acquire()) { decoded.reserve(16); }
+
+		~thread_state()
+		{
+			if (!arena || asn_arena_overflowed(arena))
+			{
+				for (auto &d : decoded)
+					ASN_STRUCT_FREE(*d.first, d.second);
+			}
+
+			asn_arena_release(arena);
+		}
+	};
+
+	static thread_state &get_state()
+	{
+		static thread_local thread_state theState;
+		return theState;
+	}
+
+	void *decode(asn_TYPE_descriptor_t *descriptor, const uint8_t *data, size_t length)
+	{
+		thread_state &state = get_state();
+		void *obj = NULL;
+
+		// Only the decoder allocates from the arena
+		asn_arena_t *previous = asn_arena_use(state.arena);
+#if SAEJ2735_SPEC < 63
+		asn_dec_rval_t rval = ber_decode(0, descriptor, &obj, data, length);
+#else
+		asn_dec_rval_t rval = uper_decode_complete(0, descriptor, &obj, data, length);
+#endif
+		asn_arena_use(previous);
+
+		// Even a failed decode may leave a partial structure
+		if (obj)
+			state.decoded.push_back(std::make_pair(descriptor, obj));
+
+		return rval.code == RC_OK ? obj : NULL;
+	}
+};
+
+} /* End namespace messages */
+} /* End namespace tmx */
+
+#endif /* TMX_J2735_MESSAGES_J2735DECODESERVICE_HPP_ */
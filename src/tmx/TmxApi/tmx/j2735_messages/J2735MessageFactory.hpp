@@ -8,9 +8,11 @@
 #ifndef TMX_J2735_MESSAGES_J2735MESSAGEFACTORY_HPP_
 #define TMX_J2735_MESSAGES_J2735MESSAGEFACTORY_HPP_
 
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
-#include <map>
 #include <memory>
+#include <string>
 
 #include <tmx/apimessages/TmxEventLog.hpp>
 #include <tmx/messages/TmxJ2735.hpp>
@@ -69,139 +71,216 @@ using message_types = message_type_list<
 		TimMessage
 >;
 
-/// Base allocator type
-struct message_allocator
+/// The types the factory can create, which also includes the UPER frame for older specifications
+#if SAEJ2735_SPEC < 63
+template <class List, class... More> struct append_message_types;
+template <class... T, class... More>
+struct append_message_types<message_type_list<T...>, More...> { using type = message_type_list<T..., More...>; };
+
+using factory_message_types = append_message_types<message_types, UperFrameMessage>::type;
+#else
+using factory_message_types = message_types;
+#endif
+
+/// Create a new, empty encoded message of the type
+template <typename MessageType>
+TmxJ2735EncodedMessageBase *allocate_message() { return new TmxJ2735EncodedMessage<MessageType>(); }
+
+/// One message type in the registry
+struct message_registry_entry
 {
-	virtual ~message_allocator() {}
-
-	/// Get the J2735 message ID for the message
-	virtual int getMessageID() { return 0; };
-	/// Get the message type name for the message
-	virtual const char *getMessageType() { return ""; };
-	/// Create a new instance of the J2735 message
-	virtual TmxJ2735EncodedMessageBase *allocate() { return NULL; };
+	int messageId;
+	const char *messageType;
+	TmxJ2735EncodedMessageBase *(*allocate)();
 };
 
-/// Templated allocator implementation for the messages
-template <typename MessageType>
-struct message_allocator_impl: public message_allocator
+/// A fixed size table of indexes into the registry entries, which can be filled in at compile time
+template <size_t N>
+struct message_registry_index
 {
-	typedef MessageType type;
-
-	virtual ~message_allocator_impl() {}
-	/// @see TmxJ2735Message<>::get_default_msgId()
-	inline int getMessageID() { return type::get_default_messageId(); }
-	/// @see TmxJ2735Message<>::MessageSubType
-	inline const char *getMessageType() { return type::MessageSubType; }
-	/// @see TmxJ2735Message<>()
-	inline TmxJ2735EncodedMessageBase *allocate() { return new TmxJ2735EncodedMessage<type>(); }
+	int index[N];
 };
 
+/// FNV-1a hash of a message type name
+static constexpr uint32_t message_type_hash(const char *str)
+{
+	uint32_t hash = 2166136261u;
+	while (*str)
+		hash = (hash ^ (uint8_t)*str++) * 16777619u;
+	return hash;
+}
+
+static constexpr bool message_type_equal(const char *a, const char *b)
+{
+	while (*a && *a == *b)
+	{
+		a++;
+		b++;
+	}
+	return *a == *b;
+}
+
 /**
- * A factory class to create J2735 messages.  The trouble with the various messages is that the programmer must
- * know specifics about what type the message is in order to correctly send the message.  Therefore, this class
- * encompasses all the complexity of creating a new J2735 message type from either the type name or the message
- * ID.
+ * The registry of J2735 message types, built at compile time from a message type list.
+ *
+ * The lookup by message ID is a direct index into a table covering all the IDs, and the lookup by
+ * message type is a perfect hash of the name, followed by one string compare.  Neither lookup
+ * allocates, locks or throws, so they can be used from any thread.  As with the maps this replaces,
+ * a type later in the list takes the place of an earlier one with the same ID or name.
  */
-class J2735MessageFactory
+template <class List> struct message_registry;
+
+template <class... T>
+struct message_registry< message_type_list<T...> >
 {
-private:
-	using int_map = std::map<int, message_allocator *>;
-	using str_map = std::map<std::string, message_allocator *>;
+	static constexpr size_t size = sizeof...(T);
+	static constexpr message_registry_entry entries[size] = {
+			{ T::get_default_messageId(), T::MessageSubType, &allocate_message<T> }... };
+
+	/// The largest message ID in the registry
+	static constexpr int max_id()
+	{
+		int max = 0;
+		for (size_t i = 0; i < size; i++)
+			if (entries[i].messageId > max)
+				max = entries[i].messageId;
+		return max;
+	}
 
-	int_map &byInt;
-	str_map &byStr;
+	static constexpr size_t id_table_size = max_id() + 1;
 
-	/**
-	 * @return The only static instance of the map by message ID
-	 */
-	static int_map &get_int_map()
+	static constexpr message_registry_index<id_table_size> make_id_table()
+	{
+		message_registry_index<id_table_size> table {};
+		for (size_t i = 0; i < id_table_size; i++)
+			table.index[i] = -1;
+		for (size_t i = 0; i < size; i++)
+			if (entries[i].messageId >= 0)
+				table.index[entries[i].messageId] = i;
+		return table;
+	}
+
+	/// @return True if no two different names share a slot of a hash table of this size
+	static constexpr bool is_perfect(size_t slots)
+	{
+		for (size_t i = 0; i < size; i++)
+			for (size_t j = i + 1; j < size; j++)
+				if (message_type_hash(entries[i].messageType) % slots == message_type_hash(entries[j].messageType) % slots &&
+						!message_type_equal(entries[i].messageType, entries[j].messageType))
+					return false;
+		return true;
+	}
+
+	/// @return The smallest hash table size, from the number of types up, with no collisions
+	static constexpr size_t perfect_size()
+	{
+		for (size_t slots = size; slots < size * 64; slots++)
+			if (is_perfect(slots))
+				return slots;
+		return 0;
+	}
+
+	static constexpr size_t type_table_size = perfect_size();
+	static_assert(type_table_size > 0, "No perfect hash found for the J2735 message type names");
+
+	static constexpr message_registry_index<type_table_size> make_type_table()
 	{
-		static int_map theMap;
-		return theMap;
+		message_registry_index<type_table_size> table {};
+		for (size_t i = 0; i < type_table_size; i++)
+			table.index[i] = -1;
+		for (size_t i = 0; i < size; i++)
+			table.index[message_type_hash(entries[i].messageType) % type_table_size] = i;
+		return table;
 	}
 
+	static constexpr message_registry_index<id_table_size> by_id = make_id_table();
+	static constexpr message_registry_index<type_table_size> by_type = make_type_table();
+
 	/**
-	 * @return The only static instance of the map by message type
+	 * @return The registry entry for the J2735 message ID, or NULL if there is none
 	 */
-	static str_map &get_str_map()
+	static inline const message_registry_entry *find(int messageId)
 	{
-		static str_map theMap;
-		return theMap;
+		if (messageId < 0 || (size_t)messageId >= id_table_size || by_id.index[messageId] < 0)
+			return NULL;
+		return &entries[by_id.index[messageId]];
 	}
 
 	/**
-	 * A template function to build a new allocator for the message type and add it to both allocator maps
+	 * @return The registry entry for the J2735 message type name, or NULL if there is none
 	 */
-	template <class Msg>
-	inline void add_allocator_to_maps()
+	static inline const message_registry_entry *find(const char *messageType)
 	{
-		message_allocator_impl<Msg> *alloc = new message_allocator_impl<Msg>();
-		byInt[alloc->getMessageID()] = alloc;
-		byStr[alloc->getMessageType()] = alloc;
+		if (!messageType)
+			return NULL;
+
+		int i = by_type.index[message_type_hash(messageType) % type_table_size];
+		if (i < 0 || strcmp(entries[i].messageType, messageType) != 0)
+			return NULL;
+		return &entries[i];
 	}
+};
+
+template <class... T>
+constexpr message_registry_entry message_registry< message_type_list<T...> >::entries[];
+template <class... T>
+constexpr message_registry_index<message_registry< message_type_list<T...> >::id_table_size>
+	message_registry< message_type_list<T...> >::by_id;
+template <class... T>
+constexpr message_registry_index<message_registry< message_type_list<T...> >::type_table_size>
+	message_registry< message_type_list<T...> >::by_type;
+
+/// The registry of every type the factory can create
+using j2735_registry = message_registry<factory_message_types>;
 
+/**
+ * A factory class to create J2735 messages.  The trouble with the various messages is that the programmer must
+ * know specifics about what type the message is in order to correctly send the message.  Therefore, this class
+ * encompasses all the complexity of creating a new J2735 message type from either the type name or the message
+ * ID.
+ *
+ * The message types are looked up in the j2735_registry, which is built at compile time, and the last error
+ * is kept for each thread, so one factory can be shared by any number of threads.  Use get_instance() for the
+ * shared factory.
+ */
+class J2735MessageFactory
+{
+private:
 	/**
-	 * The variadic version of the initialize function that adds one message allocator, then
-	 * recurses across the others.
+	 * @return The last error that occurred on the calling thread
 	 */
-	template <class... Others, class Msg>
-	inline void initialize_maps()
+	static std::unique_ptr<J2735Exception> &error_message()
 	{
-		add_allocator_to_maps<Msg>();
-		initialize_maps<Others...>();	// Recursive call
+		static thread_local std::unique_ptr<J2735Exception> theError;
+		return theError;
 	}
 
-	/// An object to hold any error messages
-	std::unique_ptr<J2735Exception> error_message;
 public:
 	/**
-	 * Creates a new factory to use.  The allocator maps will only be initialized once.
+	 * Creates a new factory to use.  There is nothing to initialize, so this is cheap.
 	 */
-	J2735MessageFactory():
-		byInt(get_int_map()),
-		byStr(get_str_map())
-	{
-		if (byInt.size() <= 0 || byStr.size() <= 0)
-		{
-			add_allocator_to_maps<BsmMessage>();
-#if SAEJ2735_SPEC < 63
-			add_allocator_to_maps<BsmvMessage>();
-#endif
-			add_allocator_to_maps<CsrMessage>();
-			add_allocator_to_maps<EvaMessage>();
-			add_allocator_to_maps<IntersectionCollisionMessage>();
-			add_allocator_to_maps<MapDataMessage>();
-			add_allocator_to_maps<NmeaMessage>();
-			add_allocator_to_maps<PdmMessage>();
-#if SAEJ2735_SPEC < 63
-			add_allocator_to_maps<PmmMessage>();
-#endif
-			add_allocator_to_maps<PvdMessage>();
-			add_allocator_to_maps<PsmMessage>();
-			add_allocator_to_maps<RsaMessage>();
-			add_allocator_to_maps<RtcmMessage>();
-			add_allocator_to_maps<SrmMessage>();
-			add_allocator_to_maps<SsmMessage>();
-			add_allocator_to_maps<SpatMessage>();
-			add_allocator_to_maps<TimMessage>();
-#if SAEJ2735_SPEC < 63
-			add_allocator_to_maps<UperFrameMessage>();
-#endif
-		}
-	}
+	J2735MessageFactory() { }
 
 	~J2735MessageFactory()	{ }
 
 	/**
-	 * Return the last event that occurred.  This can be used to report on the
+	 * @return The factory shared by the whole process
+	 */
+	static J2735MessageFactory &get_instance()
+	{
+		static J2735MessageFactory theFactory;
+		return theFactory;
+	}
+
+	/**
+	 * Return the last event that occurred on the calling thread.  This can be used to report on the
 	 * error that happened while creating the message
 	 * @return The last event, or an empty event if none occurred
 	 */
 	inline J2735Exception get_event()
 	{
-		if (error_message)
-			return *error_message;
+		if (error_message())
+			return *error_message();
 		else
 			return J2735Exception("No event");
 	}
@@ -228,18 +307,15 @@ public:
 	 */
 	inline TmxJ2735EncodedMessageBase *NewMessage(int messageId)
 	{
-		error_message.reset();
+		error_message().reset();
 
-		try
-		{
-			return byInt.at(messageId)->allocate();
-		}
-		catch (std::exception &ex)
-		{
-			error_message.reset(new J2735Exception(ex));
-			*error_message << errmsg_info{"Unable to create new J2735 message from message ID " + std::to_string(messageId)};
-			return NULL;
-		}
+		const message_registry_entry *entry = j2735_registry::find(messageId);
+		if (entry)
+			return entry->allocate();
+
+		error_message().reset(new J2735Exception("Unknown message ID"));
+		*error_message() << errmsg_info{"Unable to create new J2735 message from message ID " + std::to_string(messageId)};
+		return NULL;
 	}
 
 	/**
@@ -250,34 +326,28 @@ public:
 	 */
 	inline TmxJ2735EncodedMessageBase *NewMessage(std::string messageType)
 	{
-		error_message.reset();
+		error_message().reset();
 
-		try
-		{
-			return byStr.at(messageType)->allocate();
-		}
-		catch (std::exception &ex)
-		{
-			error_message.reset(new J2735Exception(ex));
-			*error_message << errmsg_info{"Unable to create new J2735 message from message type " + messageType};
-			return NULL;
-		}
+		const message_registry_entry *entry = j2735_registry::find(messageType.c_str());
+		if (entry)
+			return entry->allocate();
+
+		error_message().reset(new J2735Exception("Unknown message type"));
+		*error_message() << errmsg_info{"Unable to create new J2735 message from message type " + messageType};
+		return NULL;
 	}
 
 	inline int GetMessageId(std::string messageType)
 	{
-		error_message.reset();
+		error_message().reset();
 
-		try
-		{
-			return byStr.at(messageType)->getMessageID();
-		}
-		catch (std::exception &ex)
-		{
-			error_message.reset(new J2735Exception(ex));
-			*error_message << errmsg_info{"Unable to find J2735 message ID from message type " + messageType};
-			return -1;
-		}
+		const message_registry_entry *entry = j2735_registry::find(messageType.c_str());
+		if (entry)
+			return entry->messageId;
+
+		error_message().reset(new J2735Exception("Unknown message type"));
+		*error_message() << errmsg_info{"Unable to find J2735 message ID from message type " + messageType};
+		return -1;
 	}
 
 	inline int GetMessageId(tmx::byte_stream &bytes)
@@ -288,18 +358,15 @@ public:
 
 	inline const char *MessageType(int messageId)
 	{
-		error_message.reset();
+		error_message().reset();
 
-		try
-		{
-			return byInt.at(messageId)->getMessageType();
-		}
-		catch (std::exception &ex)
-		{
-			error_message.reset(new J2735Exception(ex));
-			*error_message << errmsg_info{"Unable to find J2735 message type from message ID " + std::to_string(messageId)};
-			return NULL;
-		}
+		const message_registry_entry *entry = j2735_registry::find(messageId);
+		if (entry)
+			return entry->messageType;
+
+		error_message().reset(new J2735Exception("Unknown message ID"));
+		*error_message() << errmsg_info{"Unable to find J2735 message type from message ID " + std::to_string(messageId)};
+		return NULL;
 	}
 
 
@@ -312,7 +379,7 @@ public:
 	 */
 	inline TmxJ2735EncodedMessageBase *NewMessage(tmx::byte_stream &bytes)
 	{
-		error_message.reset();
+		error_message().reset();
 
 		std::string codec;
 		int id = GetCodecAndMessageId(codec, bytes);
@@ -329,8 +396,8 @@ public:
 			}
 		}
 
-		error_message.reset(new J2735Exception("Failed to create new J2735 message"));
-		*error_message << errmsg_info{"Unable to determine message ID from bytes: " +
+		error_message().reset(new J2735Exception("Failed to create new J2735 message"));
+		*error_message() << errmsg_info{"Unable to determine message ID from bytes: " +
 			battelle::attributes::attribute_lexical_cast<std::string>(bytes)};
 		return NULL;
 	}
@@ -338,7 +405,7 @@ public:
 private:
 	inline int GetCodecAndMessageId(std::string &codec, tmx::byte_stream &bytes)
 	{
-		error_message.reset();
+		error_message().reset();
 
 		// Always try the default encoding first
 		ASN1_CODEC<MessageFrameMessage> Codec;
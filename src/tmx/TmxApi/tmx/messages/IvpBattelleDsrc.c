@@ -10,6 +10,8 @@
 #include <assert.h>
 #include <string.h>
 
+#include "../utils/HexCodec.h"
+
 int ivpBattelleDsrc_isBattelleDsrcMsg(IvpMessage *msg)
 {
 	assert(msg != NULL);
@@ -24,46 +26,35 @@ IvpMessage *ivpBattelleDsrc_createMsg(uint8_t *msg, unsigned int msgLength, IvpB
 	if (msg == NULL)
 		return NULL;
 
-	char buf[msgLength * 2 + 1];
+	IvpMessage *results = NULL;
 
-	int i;
-	for(i = 0; i < msgLength; i++)
+	char *subtype;
+	switch(msgType)
 	{
-		snprintf(&buf[i*2], 3, "%02x", (uint8_t)msg[i]);
+		case IvpBattelleDsrcMsgType_GID:
+			subtype = "GID";
+			break;
+		case IvpBattelleDsrcMsgType_GID_J2735_r41:
+			subtype = "GID_J2735_r41";
+			break;
+		case IvpBattelleDsrcMsgType_SPAT:
+			subtype = "SPAT";
+			break;
+		case IvpBattelleDsrcMsgType_SPAT_J2735_r41:
+			subtype = "SPAT_J2735_r41";
+			break;
+		default:
+			subtype = NULL;
+			break;
 	}
 
-	IvpMessage *results = NULL;
-
-	cJSON *payload = cJSON_CreateString(buf);
-	assert(payload != NULL);
-	if (payload != NULL)
+	assert(subtype != NULL);
+	if (subtype != NULL)
 	{
-		char *subtype;
-		switch(msgType)
-		{
-			case IvpBattelleDsrcMsgType_GID:
-				subtype = "GID";
-				break;
-			case IvpBattelleDsrcMsgType_GID_J2735_r41:
-				subtype = "GID_J2735_r41";
-				break;
-			case IvpBattelleDsrcMsgType_SPAT:
-				subtype = "SPAT";
-				break;
-			case IvpBattelleDsrcMsgType_SPAT_J2735_r41:
-				subtype = "SPAT_J2735_r41";
-				break;
-			default:
-				subtype = NULL;
-				break;
-		}
-
-		assert(subtype != NULL);
-		if (subtype != NULL)
-		{
-			results = ivpMsg_create(IVPMSG_TYPE_BATTELLEDSRC, subtype, IVP_ENCODING_BYTEARRAY, flags, payload);
-			assert(results != NULL);
-		}
+		results = ivpMsg_create(IVPMSG_TYPE_BATTELLEDSRC, subtype, IVP_ENCODING_BYTEARRAY, flags, NULL);
+		assert(results != NULL);
+		if (results != NULL)
+			ivpMsg_setPayloadBytes(results, msg, msgLength);
 	}
 
 	return results;
@@ -78,11 +69,11 @@ IvpBattelleDsrcMsg *ivpBattelleDsrc_getBattelleDsrcMsg(IvpMessage *msg)
 		return NULL;
 
 	//TODO some of these checks (including subtype from above) can be moved into isJ2735Msg()
-	if (msg->payload == NULL)
+	if (msg->payload == NULL && msg->payloadBytes == NULL)
 		return NULL;
 
-	assert(msg->payload->type == cJSON_String);
-	if (msg->payload->type != cJSON_String)
+	assert(msg->payloadBytes != NULL || msg->payload->type == cJSON_String);
+	if (msg->payloadBytes == NULL && msg->payload->type != cJSON_String)
 		return NULL;
 
 	IvpBattelleDsrcMsg *results = (IvpBattelleDsrcMsg *)calloc(1, sizeof(IvpBattelleDsrcMsg));
@@ -90,7 +81,10 @@ IvpBattelleDsrcMsg *ivpBattelleDsrc_getBattelleDsrcMsg(IvpMessage *msg)
 	if (results != NULL)
 	{
 	
-		results->msgLength = strlen(msg->payload->valuestring)/2;
+		if (msg->payloadBytes != NULL)
+			results->msgLength = msg->payloadLength;
+		else
+			results->msgLength = strlen(msg->payload->valuestring)/2;
 		results->msg = (uint8_t *)malloc(results->msgLength);
 		assert(results->msg != NULL);
 		if (results->msg != NULL)
@@ -100,9 +94,10 @@ IvpBattelleDsrcMsg *ivpBattelleDsrc_getBattelleDsrcMsg(IvpMessage *msg)
 			else if (strcmp(msg->subtype, "SPAT") == 0) results->msgType = IvpBattelleDsrcMsgType_SPAT;
 			else results->msgType = IvpBattelleDsrcMsgType_reserved;
 
-			int i;
-			for(i = 0; i < results->msgLength; i++)
-				sscanf(&msg->payload->valuestring[2 * i], "%2hhx", &results->msg[i]);
+			if (msg->payloadBytes != NULL)
+				memcpy(results->msg, msg->payloadBytes, results->msgLength);
+			else
+				hexCodec_decode(msg->payload->valuestring, 2 * results->msgLength, results->msg);
 
 			return results;
 		}
@@ -8,6 +8,9 @@
 #include "IvpJ2735.h"
 
 #include <assert.h>
+#include <string.h>
+
+#include "../utils/HexCodec.h"
 
 //#include <asn_j2735/AlaCarte.h>
 #include <BasicSafetyMessage.h>
@@ -193,33 +196,24 @@ IvpMessage *ivpJ2735_createMsg(void *msgStructure, e_DSRCmsgID msgId, IvpMsgFlag
 	if (msgStructure == NULL || typeDescriptor == NULL)
 		return NULL;
 
-	char buf[4000];
+	uint8_t buf[2000];
 
-	asn_enc_rval_t encResults = der_encode_to_buffer(typeDescriptor, msgStructure, &buf[2000], 2000);
-	if (encResults.encoded == 0)
+	asn_enc_rval_t encResults = der_encode_to_buffer(typeDescriptor, msgStructure, buf, sizeof(buf));
+	if (encResults.encoded <= 0)
 		return NULL;
 
-	int i;
-	for(i = 0; i < encResults.encoded; i++)
-	{
-		snprintf(&buf[i*2], 3, "%02x", (uint8_t)buf[i + 2000]);
-	}
-
 	IvpMessage *results = NULL;
 
-	cJSON *payload = cJSON_CreateString(buf);
-	assert(payload != NULL);
-	if (payload != NULL)
+	const char *subtype = getMessageSubTypeFromMsgId(msgId);
+	assert(subtype != NULL);
+	if (subtype != NULL)
 	{
-		const char *subtype = getMessageSubTypeFromMsgId(msgId);
-		assert(subtype != NULL);
-		if (subtype != NULL)
-		{
-			results = ivpMsg_create(IVPMSG_TYPE_J2735, subtype, IVP_ENCODING_ASN1_BER, flags, payload);
-			assert(results != NULL);
-		}
+		results = ivpMsg_create(IVPMSG_TYPE_J2735, subtype, IVP_ENCODING_ASN1_BER, flags, NULL);
+		assert(results != NULL);
+		if (results != NULL)
+			ivpMsg_setPayloadBytes(results, buf, encResults.encoded);
 	}
-	cJSON_Delete(payload);
+
 	return results;
 }
 
@@ -234,11 +228,11 @@ IvpJ2735Msg *ivpJ2735_getJ2735Msg(IvpMessage *msg)
 		return NULL;
 
 	//TODO some of these checks (including subtype from above) can be moved into isJ2735Msg()
-	if (msg->payload == NULL)
+	if (msg->payload == NULL && msg->payloadBytes == NULL)
 		return NULL;
 
-	assert(msg->payload->type == cJSON_String);
-	if (msg->payload->type != cJSON_String)
+	assert(msg->payloadBytes != NULL || msg->payload->type == cJSON_String);
+	if (msg->payloadBytes == NULL && msg->payload->type != cJSON_String)
 		return NULL;
 
 	//vvv the actual working part of the code vvv
@@ -253,16 +247,22 @@ IvpJ2735Msg *ivpJ2735_getJ2735Msg(IvpMessage *msg)
 		return NULL;
 
 	uint8_t buf[2000];
-	int payloadLength = strlen(msg->payload->valuestring)/2;
-	if (payloadLength > sizeof(buf))
-		return NULL;
+	const uint8_t *payload = msg->payloadBytes;
+	size_t payloadLength = msg->payloadLength;
 
-	int i;
-	for(i = 0; i < payloadLength; i++)
-		sscanf(msg->payload->valuestring + (2 * i), "%2hhx", &buf[i]);
+	// Only a hex string payload needs to be converted
+	if (payload == NULL)
+	{
+		payloadLength = strlen(msg->payload->valuestring)/2;
+		if (payloadLength > sizeof(buf))
+			return NULL;
+
+		hexCodec_decode(msg->payload->valuestring, 2 * payloadLength, buf);
+		payload = buf;
+	}
 
 	void *msgStucture = NULL;
-	asn_dec_rval_t rval = ber_decode(NULL, typeDescriptor, (void **)&msgStucture, buf, payloadLength);
+	asn_dec_rval_t rval = ber_decode(NULL, typeDescriptor, (void **)&msgStucture, payload, payloadLength);
 	if (rval.code == RC_OK && msgStucture)
 	{
 		IvpJ2735Msg *results = calloc(1, sizeof(IvpJ2735Msg));
@@ -313,56 +313,32 @@ void ivpJ2735_destroyJ2735Msg(IvpJ2735Msg *msg)
 
 IvpMessage *ivpJ2735_createMsgFromEncoded(uint8_t *msg, unsigned int msgLength, IvpMsgFlags flags)
 {
-	char buf[4000];
-
-	int i;
-	for(i = 0; i < msgLength; i++)
-	{
-		snprintf(&buf[i*2], 3, "%02x", msg[i]);
-	}
-
 	IvpMessage *results = NULL;
 
-	cJSON *payload = cJSON_CreateString(buf);
-	assert(payload != NULL);
-	if (payload != NULL)
+	e_DSRCmsgID msgId = getMsgIdFromRaw(msg, msgLength);
+	if (msgId != DSRCmsgID_reserved)
 	{
-		e_DSRCmsgID msgId = getMsgIdFromRaw(msg, msgLength);
-		if (msgId != DSRCmsgID_reserved)
+		const char *subtype = getMessageSubTypeFromMsgId(msgId);
+		assert(subtype != NULL);
+		if (subtype != NULL)
 		{
-			const char *subtype = getMessageSubTypeFromMsgId(msgId);
-			assert(subtype != NULL);
-			if (subtype != NULL)
-			{
-				results = ivpMsg_create(IVPMSG_TYPE_J2735, subtype, IVP_ENCODING_ASN1_BER, flags, payload);
-				assert(results != NULL);
-			}
+			results = ivpMsg_create(IVPMSG_TYPE_J2735, subtype, IVP_ENCODING_ASN1_BER, flags, NULL);
+			assert(results != NULL);
+			if (results != NULL)
+				ivpMsg_setPayloadBytes(results, msg, msgLength);
 		}
 	}
-	cJSON_Delete(payload);
+
 	return results;
 }
 
 IvpMessage *ivpJ2735_createMsgFromEncodedwType(uint8_t *msg, unsigned int msgLength, IvpMsgFlags flags, const char * msgType)
 {
-	char buf[4000];
-
-	int i;
-	for(i = 0; i < msgLength; i++)
-	{
-		snprintf(&buf[i*2], 3, "%02x", msg[i]);
-	}
-
-	IvpMessage *results = NULL;
+	IvpMessage *results = ivpMsg_create(IVPMSG_TYPE_J2735, msgType, IVP_ENCODING_ASN1_BER, flags, NULL);
+	assert(results != NULL);
+	if (results != NULL)
+		ivpMsg_setPayloadBytes(results, msg, msgLength);
 
-	cJSON *payload = cJSON_CreateString(buf);
-	assert(payload != NULL);
-	if (payload != NULL)
-	{
-		results = ivpMsg_create(IVPMSG_TYPE_J2735, msgType, IVP_ENCODING_ASN1_BER, flags, payload);
-		assert(results != NULL);
-	}
-	cJSON_Delete(payload);
 	return results;
 }
 
@@ -376,11 +352,11 @@ IvpJ2735EncodedMsg *ivpJ2735_getJ2735EncodedMsg(IvpMessage *msg)
 		return NULL;
 
 	//TODO some of these checks (including subtype from above) can be moved into isJ2735Msg()
-	if (msg->payload == NULL)
+	if (msg->payload == NULL && msg->payloadBytes == NULL)
 		return NULL;
 
-	assert(msg->payload->type == cJSON_String);
-	if (msg->payload->type != cJSON_String)
+	assert(msg->payloadBytes != NULL || msg->payload->type == cJSON_String);
+	if (msg->payloadBytes == NULL && msg->payload->type != cJSON_String)
 		return NULL;
 
 	//vvv the actual working part of the code vvv
@@ -389,7 +365,7 @@ IvpJ2735EncodedMsg *ivpJ2735_getJ2735EncodedMsg(IvpMessage *msg)
 	if (msgId == DSRCmsgID_reserved)
 		return NULL;
 
-	int payloadLength = strlen(msg->payload->valuestring)/2;
+	int payloadLength = msg->payloadBytes != NULL ? msg->payloadLength : strlen(msg->payload->valuestring)/2;
 
 	IvpJ2735EncodedMsg *results = calloc(1, sizeof(IvpJ2735EncodedMsg));
 	if (results != NULL)
@@ -399,9 +375,10 @@ IvpJ2735EncodedMsg *ivpJ2735_getJ2735EncodedMsg(IvpMessage *msg)
 		results->msg = calloc(payloadLength, sizeof(uint8_t));
 		if (results->msg != NULL)
 		{
-			int i;
-			for(i = 0; i < payloadLength; i++)
-				sscanf(msg->payload->valuestring + (2 * i), "%2hhx", &results->msg[i]);
+			if (msg->payloadBytes != NULL)
+				memcpy(results->msg, msg->payloadBytes, payloadLength);
+			else
+				hexCodec_decode(msg->payload->valuestring, 2 * payloadLength, results->msg);
 
 			results->msgId = msgId;
 
@@ -6,6 +6,7 @@
  */
 
 #include "IvpRtcm.h"
+#include "../utils/HexCodec.h"
 #include <assert.h>
 #include <string.h>
 
@@ -63,7 +64,7 @@ IvpRtcmData *ivpRtcm_getRtcmData(IvpMessage *msg)
 	if (msg == NULL)
 		return NULL;
 
-	if (msg->payload == NULL || msg->payload->type != cJSON_String)
+	if (msg->payloadBytes == NULL && (msg->payload == NULL || msg->payload->type != cJSON_String))
 		return NULL;
 
 	if (msg->subtype == NULL)
@@ -79,14 +80,15 @@ IvpRtcmData *ivpRtcm_getRtcmData(IvpMessage *msg)
 		else
 			results->version = IvpRtcmVersion_Unknown;
 
-		int payloadLength = strlen(msg->payload->valuestring)/2;
+		int payloadLength = msg->payloadBytes != NULL ? msg->payloadLength : strlen(msg->payload->valuestring)/2;
 
 		uint8_t *data = calloc(1, payloadLength);
 		if (data != NULL)
 		{
-			int i;
-			for(i = 0; i < payloadLength; i++)
-				sscanf(msg->payload->valuestring + (2 * i), "%2hhx", &data[i]);
+			if (msg->payloadBytes != NULL)
+				memcpy(data, msg->payloadBytes, payloadLength);
+			else
+				hexCodec_decode(msg->payload->valuestring, 2 * payloadLength, data);
 
 			results->data = data;
 			results->dataLength = payloadLength;
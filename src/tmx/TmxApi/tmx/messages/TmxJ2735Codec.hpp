@@ -8,6 +8,7 @@
 #ifndef TMX_MESSAGES_TMXJ2735CODEC_HPP_
 #define TMX_MESSAGES_TMXJ2735CODEC_HPP_
 
+#include <mutex>
 #include <string>
 #include <tmx/messages/TmxJ2735.hpp>
 
@@ -28,6 +29,21 @@ typedef boost::error_info<struct tag_codec, std::string> codecerr_info;
 
 namespace codec {
 
+/**
+ * The ASN.1 encoder callback that appends the encoded bytes to a byte stream
+ * @param buffer The encoded bytes
+ * @param size The number of bytes
+ * @param key The byte stream to append to
+ * @return 0 for success
+ */
+inline int append_bytes(const void *buffer, size_t size, void *key)
+{
+	tmx::byte_stream *bytes = static_cast<tmx::byte_stream *>(key);
+	const tmx::byte_t *ptr = static_cast<const tmx::byte_t *>(buffer);
+	bytes->insert(bytes->end(), ptr, ptr + size);
+	return 0;
+}
+
 /**
  * A structure for ASN.1 DER encoding/decoding, a type of Basic Encoding rules (BER).
  * Attached to encoding type "asn.1-ber/hexstring"
@@ -61,16 +77,19 @@ struct der
 	}
 
 	/**
-	 * Encode the ASN.1 struct pointer for the specified message type to a byte stream
+	 * Encode the ASN.1 struct pointer for the specified message type to a byte stream.  The
+	 * byte stream is replaced with exactly the encoded bytes, and its capacity is reused, so
+	 * encoding with the same byte stream again does not allocate once it is large enough.
 	 * @param obj The struct pointer to encode
-	 * @param bytes The bytes to encode to with enough buffer space pre-allocated
+	 * @param bytes The bytes to encode to
 	 * @param typeDescriptor The ASN.1 struct type descriptor for the message type
 	 * @return The encode status return
 	 */
 	asn_enc_rval_t encode(const typename MsgType::message_type *obj, tmx::byte_stream &bytes,
 			asn_TYPE_descriptor_t *typeDescriptor = MsgType::get_descriptor())
 	{
-		return der_encode_to_buffer(typeDescriptor, (void *)obj, bytes.data(), bytes.max_size());
+		bytes.clear();
+		return der_encode(typeDescriptor, (void *)obj, append_bytes, &bytes);
 	}
 
 	/**
@@ -146,16 +165,19 @@ struct uper
 	}
 
 	/**
-	 * Encode the ASN.1 struct pointer for the specified message type to a byte stream
+	 * Encode the ASN.1 struct pointer for the specified message type to a byte stream.  The
+	 * byte stream is replaced with exactly the encoded bytes, and its capacity is reused, so
+	 * encoding with the same byte stream again does not allocate once it is large enough.
 	 * @param obj The struct pointer to encode
-	 * @param bytes The bytes to encode to with enough buffer space pre-allocated
+	 * @param bytes The bytes to encode to
 	 * @param typeDescriptor The ASN.1 struct type descriptor for the message type
 	 * @return The encode status return
 	 */
 	asn_enc_rval_t encode(const typename MsgType::message_type *obj, tmx::byte_stream &bytes,
 			asn_TYPE_descriptor_t *typeDescriptor = MsgType::get_descriptor())
 	{
-		asn_enc_rval_t ueRet = uper_encode_to_buffer(typeDescriptor, (void *)obj, bytes.data(), bytes.max_size());
+		bytes.clear();
+		asn_enc_rval_t ueRet = uper_encode(typeDescriptor, (void *)obj, append_bytes, &bytes);
 
 		// For UPER encoding, the number of bytes encoded must be adjusted
 		ueRet.encoded = (ueRet.encoded + 7) / 8;
@@ -171,7 +193,7 @@ struct uper
 	 */
 	static int decode_contentId(const tmx::byte_stream &bytes)
 	{
-		int id;
+		int id = -1;
 
 		MessageFrameMessage::message_type *frame = NULL;
 		asn_TYPE_descriptor_t *descriptor = NULL;
@@ -325,18 +347,18 @@ public:
 	}
 
 	/**
-	 * Encode the given message to a byte stream using a specific encoder type, which must
-	 * implement the encode() function.
+	 * Encode the given message to a caller supplied byte stream using a specific encoder type, which
+	 * must implement the encode() function.  The byte stream holds exactly the encoded bytes afterwards,
+	 * and can be reused for the next message without allocating again.
 	 * @param message The J2735 message to encode
-	 * @returns The encoded byte stream
+	 * @param bytes The byte stream to encode to
 	 */
 	template <typename EncType>
-	static tmx::byte_stream encode_j2735_message(const typename EncType::message_type *message)
+	static void encode_j2735_message(const typename EncType::message_type *message, tmx::byte_stream &bytes)
 	{
 		typedef typename EncType::type type;
 
 		EncType encoder;
-		tmx::byte_stream bytes(TMX_J2735_MAX_DATA_SIZE);
 		asn_enc_rval_t rval = encoder.encode(message, bytes);
 
 		if (rval.encoded <= 0)
@@ -344,15 +366,23 @@ public:
 			J2735Exception err("Unable to encode " +
 					std::string(j2735::get_messageTag< typename type::traits_type >()) + " to bytes.");
 			err << codecerr_info{EncType::Encoding};
-			err << errmsg_info{rval.failed_type->name};
+			err << errmsg_info{rval.failed_type ? rval.failed_type->name : "unknown"};
 			BOOST_THROW_EXCEPTION(err);
 		}
-		else
-		{
-			bytes.resize(rval.encoded);
-			bytes.shrink_to_fit();
-			return bytes;
-		}
+	}
+
+	/**
+	 * Encode the given message to a byte stream using a specific encoder type, which must
+	 * implement the encode() function.
+	 * @param message The J2735 message to encode
+	 * @returns The encoded byte stream
+	 */
+	template <typename EncType>
+	static tmx::byte_stream encode_j2735_message(const typename EncType::message_type *message)
+	{
+		tmx::byte_stream bytes;
+		encode_j2735_message<EncType>(message, bytes);
+		return bytes;
 	}
 
 	/**
@@ -432,11 +462,14 @@ public:
 	}
 
 	/**
-	 * Encode the given J2735 message to the data attribute using the default encoding type specified
-	 * in the encoding attribute.
+	 * Encode the given J2735 message to a caller supplied byte stream, using the default encoding type
+	 * specified in the encoding attribute.  The data attribute is not changed, so the bytes stay in binary
+	 * form until they are set in the message.  The byte stream holds exactly the encoded bytes afterwards,
+	 * and can be reused for the next message without allocating again.
 	 * @param message The J2735 message to encode
+	 * @param bytes The byte stream to encode to
 	 */
-	void encode_j2735_message(MsgType &message)
+	void encode_j2735_bytes(MsgType &message, tmx::byte_stream &bytes)
 	{
 		int msgId = get_msgId();
 
@@ -446,12 +479,12 @@ public:
 			{
 				std::shared_ptr<message_type> msgPtr = message.get_j2735_data();
 				std::unique_ptr<MessageFrame> frame { j2735::j2735_cast<MessageFrame>(msgPtr.get()) };
-				this->set_data(TmxJ2735EncodedMessage<MsgType>::encode_j2735_message<
-						codec::uper<MessageFrameMessage> >(frame.get()));
+				TmxJ2735EncodedMessage<MsgType>::encode_j2735_message<
+						codec::uper<MessageFrameMessage> >(frame.get(), bytes);
 			}
 			else
 			{
-				this->set_data(TmxJ2735EncodedMessage<MsgType>::encode_j2735_message<UperCodec>(message.get_j2735_data().get()));
+				TmxJ2735EncodedMessage<MsgType>::encode_j2735_message<UperCodec>(message.get_j2735_data().get(), bytes);
 			}
 		}
 		else if (is_der())
@@ -460,12 +493,12 @@ public:
 			{
 				std::shared_ptr<message_type> msgPtr = message.get_j2735_data();
 				std::unique_ptr<MessageFrame> frame { j2735::j2735_cast<MessageFrame>(msgPtr.get()) };
-				this->set_data(TmxJ2735EncodedMessage<MsgType>::encode_j2735_message<
-						codec::der<MessageFrameMessage> >(frame.get()));
+				TmxJ2735EncodedMessage<MsgType>::encode_j2735_message<
+						codec::der<MessageFrameMessage> >(frame.get(), bytes);
 			}
 			else
 			{
-				this->set_data(TmxJ2735EncodedMessage<MsgType>::encode_j2735_message<DerCodec>(message.get_j2735_data().get()));
+				TmxJ2735EncodedMessage<MsgType>::encode_j2735_message<DerCodec>(message.get_j2735_data().get(), bytes);
 			}
 		}
 		else
@@ -476,6 +509,20 @@ public:
 		}
 	}
 
+	/**
+	 * Encode the given J2735 message to the data attribute using the default encoding type specified
+	 * in the encoding attribute.
+	 * @param message The J2735 message to encode
+	 */
+	void encode_j2735_message(MsgType &message)
+	{
+		// Each thread reuses one buffer, so encoding does not allocate once it is large enough
+		static thread_local tmx::byte_stream bytes;
+
+		encode_j2735_bytes(message, bytes);
+		this->set_data(bytes);
+	}
+
 	/**
 	 * Override of the template function in tmx::routeable_message to ensure the correct message type
 	 * is decoded and extracted.  A compiler error should occur if trying to extract an incompatible type.
@@ -541,36 +588,47 @@ public:
 	}
 private:
 	// A class to manage pointers to the structures, and ultimate cleanup when
-	// the shared pointer references are exhausted
+	// the shared pointer references are exhausted.  The one registry is shared by
+	// the deleters of every pointer, on any thread.
 	struct _MemoryMgr {
 		// Create a new shared pointer from the message frame structure pointer
 		template <typename _T>
 		std::shared_ptr<_T> get(MessageFrame *frame) {
 			_T *ptr = j2735::j2735_cast<_T>(frame);
-			if (ptr)
+			if (ptr) {
+				std::lock_guard<std::mutex> lock(_lock);
 				_registry[(uintptr_t)(ptr)] = frame;
-			return std::shared_ptr<_T>(ptr, *this);
+			}
+			return std::shared_ptr<_T>(ptr, [this](_T *p) { (*this)(p); });
 		}
 
 		// Create a new shared pointer from the message structure pointer
 		template <typename _T>
 		std::shared_ptr<_T> get(_T *data) {
-			return std::shared_ptr<_T>(data, *this);
+			return std::shared_ptr<_T>(data, [this](_T *p) { (*this)(p); });
 		}
 
 		// The deleter will cleanup either the message pointer or the entire message frame, if applicable
 		template <typename _T>
 		void operator()(_T *ptr) {
-			uintptr_t x = (uintptr_t)(ptr);
-			if (_registry.count(x)) {
-				j2735::j2735_destroy<MessageFrameMessage::traits_type>(_registry[x]);
-				_registry.erase(x);
+			MessageFrame *frame = NULL;
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+				auto i = _registry.find((uintptr_t)(ptr));
+				if (i != _registry.end()) {
+					frame = i->second;
+					_registry.erase(i);
+				}
 			}
+
+			if (frame)
+				j2735::j2735_destroy<MessageFrameMessage::traits_type>(frame);
 			else if (ptr)
 				j2735::j2735_destroy<j2735::SaeJ2735Traits<_T> >(ptr);
 		}
 
 	private:
+		std::mutex _lock;
 		std::map<uintptr_t, MessageFrame *> _registry;
 	};
 
@@ -629,7 +687,7 @@ typename MessageFrameMessage::message_type *UperFrameEncode(const T *ptr)
 	if (ptr)
 	{
 		tmx::messages::codec::uper< TmxJ2735Message<T> > uperEncoder;
-		tmx::byte_stream uperFrameBytes(TMX_J2735_MAX_DATA_SIZE);
+		tmx::byte_stream uperFrameBytes;
 		asn_enc_rval_t ueRet = uperEncoder.encode(ptr, uperFrameBytes);
 		if (ueRet.encoded > 0)
 		{
@@ -637,8 +695,6 @@ typename MessageFrameMessage::message_type *UperFrameEncode(const T *ptr)
 					(typename MessageFrameMessage::message_type *)
 						calloc(1, sizeof(typename MessageFrameMessage::message_type));
 
-			uperFrameBytes.resize(ueRet.encoded);
-
 			uperFrame->msgID = get_default_messageId< MessageFrameTraits >();
 			uperFrame->contentID = get_default_messageId< SaeJ2735Traits<T> >();
 			uperFrame->msgBlob.buf = (uint8_t *) calloc(ueRet.encoded, sizeof(uint8_t));
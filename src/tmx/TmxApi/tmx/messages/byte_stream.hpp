@@ -15,6 +15,7 @@
 #include <vector>
 
 #include <tmx/attributes/attribute_cast.hpp>
+#include <tmx/utils/HexCodec.h>
 
 namespace tmx {
 
@@ -22,53 +23,57 @@ typedef uint8_t byte_t;
 
 typedef std::vector<byte_t> byte_stream;
 
-inline std::ostream &operator<<(std::ostream &os, const tmx::byte_stream &bytes)
+inline std::string byte_stream_encode(const tmx::byte_t *bytes, size_t length)
 {
-	char buf[3];
-	for(unsigned int i = 0; i < bytes.size(); i++)
-	{
-		std::snprintf(buf, 3, "%02x", bytes[i]);
-		os << buf;
-	}
+	std::string str(2 * length, '\0');
+	if (length > 0)
+		hexCodec_encode(bytes, length, &str[0]);
+	return str;
+}
 
-	return os;
+inline std::string byte_stream_encode(const tmx::byte_stream &bytes)
+{
+	return byte_stream_encode(bytes.data(), bytes.size());
 }
 
-inline std::istream &operator>>(std::istream &is, tmx::byte_stream &bytes)
+/**
+ * Append the bytes of a hex string to the byte stream.  A character that is not a hex digit
+ * ends its byte, the way strtoul() reads it.
+ */
+inline void byte_stream_decode(const char *str, size_t length, tmx::byte_stream &bytes)
 {
-	std::string str(std::istreambuf_iterator<typename std::istream::char_type>(is), {});
+	size_t start = bytes.size();
+	bytes.resize(start + (length + 1) / 2);
+
+	if (hexCodec_decode(str, length, bytes.data() + start) >= 0)
+		return;
 
 	char buf[3] = { '0', '0', '\0' };
-	tmx::byte_t b = 0;
-	for (std::string::iterator i = str.begin(); i != str.end(); i++)
+	for (size_t i = 0; i < length; i += 2)
 	{
-		buf[0] = *i;
-		i++;
-		if (i != str.end())
-			buf[1] = *i;
-		else
-			buf[1] = '0';
-
-		b = (tmx::byte_t)std::strtoul(buf, NULL, 16);
-		bytes.push_back(b);
+		buf[0] = str[i];
+		buf[1] = i + 1 < length ? str[i + 1] : '0';
+		bytes[start + i / 2] = (tmx::byte_t)std::strtoul(buf, NULL, 16);
 	}
+}
 
-	return is;
+inline tmx::byte_stream byte_stream_decode(const std::string &str)
+{
+	tmx::byte_stream bytes;
+	byte_stream_decode(str.data(), str.size(), bytes);
+	return bytes;
 }
 
-inline std::string byte_stream_encode(const tmx::byte_stream &bytes)
+inline std::ostream &operator<<(std::ostream &os, const tmx::byte_stream &bytes)
 {
-	std::ostringstream oss;
-	operator<<(oss, bytes);
-	return oss.str();
+	return os << byte_stream_encode(bytes);
 }
 
-inline tmx::byte_stream byte_stream_decode(const std::string &str)
+inline std::istream &operator>>(std::istream &is, tmx::byte_stream &bytes)
 {
-	tmx::byte_stream bytes;
-	std::istringstream iss(str);
-	operator>>(iss, bytes);
-	return bytes;
+	std::string str(std::istreambuf_iterator<typename std::istream::char_type>(is), {});
+	byte_stream_decode(str.data(), str.size(), bytes);
+	return is;
 }
 
 } /* End namespace tmx */
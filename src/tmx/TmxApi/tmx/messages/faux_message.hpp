@@ -25,6 +25,7 @@ private: \
 public: \
 	X attr_func_name(get_,Y)() { return attr_field_name(Y).value; } \
 	void attr_func_name(set_,Y)(const X value) { attr_field_name(Y).value = value; }
+#define struct_attribute(C, X, Y, D, L) std_attribute(C, X, Y, D, L)
 
 namespace tmx
 {
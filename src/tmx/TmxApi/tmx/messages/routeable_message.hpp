@@ -136,6 +136,11 @@ public:
 	{
 		std::string payloadStr;
 
+		// A binary payload is only converted to its hex string, which is written to the container
+		// when the message is serialized
+		if (ivpMsg->payloadBytes)
+			return byte_stream_encode(ivpMsg->payloadBytes, ivpMsg->payloadLength);
+
 		// The payload object is most recent
 		if (!ivpMsg->payload)
 			return payloadStr;
@@ -168,11 +173,22 @@ public:
 	}
 
 	/**
+	 * A binary payload is copied as it is, and a hex string payload is converted directly.
 	 * @see get_payload_str()
 	 * @return A byte stream representation of the payload string
 	 */
 	byte_stream get_payload_bytes()
 	{
+		if (ivpMsg->payloadBytes)
+			return byte_stream(ivpMsg->payloadBytes, ivpMsg->payloadBytes + ivpMsg->payloadLength);
+
+		if (ivpMsg->payload && ivpMsg->payload->type == cJSON_String && ivpMsg->payload->valuestring)
+		{
+			byte_stream bytes;
+			byte_stream_decode(ivpMsg->payload->valuestring, strlen(ivpMsg->payload->valuestring), bytes);
+			return bytes;
+		}
+
 		return battelle::attributes::attribute_lexical_cast<byte_stream>(this->get_payload_str());
 	}
 
@@ -196,8 +212,7 @@ public:
 			message_container_type container(payload.get_container());
 			std::stringstream ss;
 			container.template save<JSON>(ss);
-			if (this->ivpMsg->payload) cJSON_Delete(this->ivpMsg->payload);
-			this->ivpMsg->payload = cJSON_Parse(ss.str().c_str());
+			ivpMsg_setPayload(this->ivpMsg, cJSON_Parse(ss.str().c_str()));
 		}
 	}
 
@@ -228,8 +243,7 @@ public:
 	{
 		this->set_encoding(IVP_ENCODING_STRING);
 		this->msg.store(ATTR_PAYLOAD, payload);
-		if (this->ivpMsg->payload) cJSON_Delete(this->ivpMsg->payload);
-		this->ivpMsg->payload = cJSON_CreateString(payload.c_str());
+		ivpMsg_setPayload(this->ivpMsg, cJSON_CreateString(payload.c_str()));
 	}
 
 	/**
@@ -239,8 +253,7 @@ public:
 	{
 		this->set_encoding(IVP_ENCODING_STRING);
 		this->msg.store(ATTR_PAYLOAD, payload ? "1" : "0");
-		if (this->ivpMsg->payload) cJSON_Delete(this->ivpMsg->payload);
-		this->ivpMsg->payload = cJSON_CreateBool(payload ? 1 : 0);
+		ivpMsg_setPayload(this->ivpMsg, cJSON_CreateBool(payload ? 1 : 0));
 	}
 
 	/**
@@ -250,8 +263,7 @@ public:
 	{
 		this->set_encoding(IVP_ENCODING_STRING);
 		this->msg.store(ATTR_PAYLOAD, to_string(number));
-		if (this->ivpMsg->payload) cJSON_Delete(this->ivpMsg->payload);
-		this->ivpMsg->payload = cJSON_CreateNumber((double)number);
+		ivpMsg_setPayload(this->ivpMsg, cJSON_CreateNumber((double)number));
 	}
 
 	/**
@@ -261,18 +273,22 @@ public:
 	{
 		this->set_encoding(IVP_ENCODING_STRING);
 		this->msg.store(ATTR_PAYLOAD, to_string(number));
-		if (this->ivpMsg->payload) cJSON_Delete(this->ivpMsg->payload);
-		this->ivpMsg->payload = cJSON_CreateNumber(number);
+		ivpMsg_setPayload(this->ivpMsg, cJSON_CreateNumber(number));
 	}
 
 	/**
-	 * Set the payload with the given byte stream.  Note that the encoding type will be "bytearray/hexstring"
+	 * Set the payload with the given byte stream.  Note that the encoding type will be "bytearray/hexstring".
+	 * The bytes are kept as they are in the IVP message, and only converted to the hex string for JSON.
 	 * @param bytes The payload bytes
 	 */
 	void set_payload_bytes(const byte_stream &bytes)
 	{
-		set_payload(battelle::attributes::attribute_lexical_cast<std::string>(bytes));
 		this->set_encoding(IVP_ENCODING_BYTEARRAY);
+		ivpMsg_setPayloadBytes(this->ivpMsg, bytes.data(), bytes.size());
+
+		// The hex string is written to the container when the message is serialized
+		this->as_tree().get().erase(ATTR_PAYLOAD);
+		this->msg.touch();
 	}
 
 	/**
@@ -480,7 +496,25 @@ public:
 	}
 
 	virtual void flush() {
-		get_payload_str();
+		if (ivpMsg && ivpMsg->payloadBytes)
+			flush(this->msg);
+		else
+			get_payload_str();
+	}
+protected:
+	/**
+	 * Write a binary or string payload that is only in the IVP message to the container, so that it
+	 * is serialized with the message.
+	 */
+	virtual void flush(message_container_type &container) const
+	{
+		if (!ivpMsg || container.get_storage().get_tree().get_child_optional(ATTR_PAYLOAD))
+			return;
+
+		if (ivpMsg->payloadBytes)
+			container.store(ATTR_PAYLOAD, byte_stream_encode(ivpMsg->payloadBytes, ivpMsg->payloadLength));
+		else if (ivpMsg->payload && ivpMsg->payload->type == cJSON_String && ivpMsg->payload->valuestring)
+			container.store(ATTR_PAYLOAD, ivpMsg->payload->valuestring);
 	}
 
 private:
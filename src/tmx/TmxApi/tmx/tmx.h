@@ -14,6 +14,7 @@
 #define IVPMSG_TYPE_APIRESV_STATUS "__status"
 #define IVPMSG_TYPE_APIRESV_CONFIG "__config"
 #define IVPMSG_TYPE_APIRESV_EVENTLOG "__eventLog"
+#define IVPMSG_TYPE_APIRESV_SHM "__shm"
 
 #define IVP_STATUS_UNKNOWN "Unknown"
 #define IVP_STATUS_STARTED "Started, waiting for connection..."
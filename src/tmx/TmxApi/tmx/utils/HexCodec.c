@@ -0,0 +1,112 @@
+/*
+ * HexCodec.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "HexCodec.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static const char hexCodec_digits[] = "0123456789abcdef";
+
+static inline int hexCodec_nibble(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+#ifdef __SSE2__
+// The digit for each nibble, which is '0' + n, plus the distance from '9' to 'a' for 10 and up
+static inline __m128i hexCodec_toDigits(__m128i nibbles)
+{
+	__m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+	__m128i digits = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+	return _mm_add_epi8(digits, _mm_and_si128(letters, _mm_set1_epi8('a' - '0' - 10)));
+}
+
+// The value of each digit, and in valid a mask of the characters that are hex digits
+static inline __m128i hexCodec_toNibbles(__m128i chars, int *valid)
+{
+	// Digits are 0 to 9 after subtracting '0', and letters of either case are 0 to 5 after
+	// setting the lower case bit and subtracting 'a'.  Anything else ends up out of range.
+	__m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+	__m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+
+	__m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+	__m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+
+	*valid = _mm_movemask_epi8(_mm_or_si128(isDigit, isLetter));
+
+	return _mm_or_si128(_mm_and_si128(isDigit, digits),
+			_mm_and_si128(isLetter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+}
+
+// Each pair of nibbles, high then low, into one byte in the low half of a 16 bit lane
+static inline __m128i hexCodec_toBytes(__m128i nibbles)
+{
+	__m128i high = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+	return _mm_or_si128(high, _mm_srli_epi16(nibbles, 8));
+}
+#endif
+
+size_t hexCodec_encode(const uint8_t *bytes, size_t length, char *hex)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i in = _mm_loadu_si128((const __m128i *)(bytes + i));
+		__m128i high = _mm_and_si128(_mm_srli_epi16(in, 4), _mm_set1_epi8(0x0F));
+		__m128i low = _mm_and_si128(in, _mm_set1_epi8(0x0F));
+
+		_mm_storeu_si128((__m128i *)(hex + 2 * i), hexCodec_toDigits(_mm_unpacklo_epi8(high, low)));
+		_mm_storeu_si128((__m128i *)(hex + 2 * i + 16), hexCodec_toDigits(_mm_unpackhi_epi8(high, low)));
+	}
+#endif
+
+	for (; i < length; i++)
+	{
+		hex[2 * i] = hexCodec_digits[bytes[i] >> 4];
+		hex[2 * i + 1] = hexCodec_digits[bytes[i] & 0x0F];
+	}
+
+	return 2 * length;
+}
+
+long hexCodec_decode(const char *hex, size_t length, uint8_t *bytes)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	for (; i + 32 <= length; i += 32)
+	{
+		int valid1, valid2;
+		__m128i first = hexCodec_toNibbles(_mm_loadu_si128((const __m128i *)(hex + i)), &valid1);
+		__m128i second = hexCodec_toNibbles(_mm_loadu_si128((const __m128i *)(hex + i + 16)), &valid2);
+		if (valid1 != 0xFFFF || valid2 != 0xFFFF)
+			return -1;
+
+		_mm_storeu_si128((__m128i *)(bytes + i / 2),
+				_mm_packus_epi16(hexCodec_toBytes(first), hexCodec_toBytes(second)));
+	}
+#endif
+
+	for (; i < length; i += 2)
+	{
+		int high = hexCodec_nibble(hex[i]);
+		int low = i + 1 < length ? hexCodec_nibble(hex[i + 1]) : 0;
+		if (high < 0 || low < 0)
+			return -1;
+
+		bytes[i / 2] = (uint8_t)((high << 4) | low);
+	}
+
+	return (long)((length + 1) / 2);
+}
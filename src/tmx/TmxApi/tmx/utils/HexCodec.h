@@ -0,0 +1,51 @@
+/*
+ * HexCodec.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef HEXCODEC_H_
+#define HEXCODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ * Conversion between bytes and the hex strings used for binary payloads in JSON messages.
+ * Sixteen bytes are converted at a time with SSE2 when it is available.
+ */
+
+/*!
+ * Writes two lower case hex digits for each byte.  The digits are not null terminated.
+ *
+ * @param hex
+ * 		Room for twice as many characters as there are bytes.
+ *
+ * @returns
+ * 		The number of digits written.
+ */
+size_t hexCodec_encode(const uint8_t *bytes, size_t length, char *hex);
+
+/*!
+ * Reads the bytes from a string of hex digits in either case.  If there is an odd number of
+ * digits, the last one is the high half of the last byte.
+ *
+ * @param bytes
+ * 		Room for (length + 1) / 2 bytes.
+ *
+ * @returns
+ * 		The number of bytes read, or -1 if one of the characters is not a hex digit.
+ */
+long hexCodec_decode(const char *hex, size_t length, uint8_t *bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEXCODEC_H_ */
@@ -0,0 +1,143 @@
+/*
+ * MsgArena.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "MsgArena.h"
+#include "../json/cJSON.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+struct MsgArena {
+	char *base;
+	size_t used;
+	int inUse;
+};
+
+static pthread_once_t msgArena_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t msgArena_poolLock = PTHREAD_MUTEX_INITIALIZER;
+static MsgArena msgArena_pool[MSG_ARENA_POOL_COUNT];
+
+// The mapping that holds every arena, so a pointer into any of them is easy to recognize
+static char *msgArena_poolStart = NULL;
+static char *msgArena_poolEnd = NULL;
+
+static __thread MsgArena *msgArena_current = NULL;
+
+static void *msgArena_malloc(size_t size)
+{
+	MsgArena *arena = msgArena_current;
+	if (arena != NULL)
+	{
+		size_t aligned = (size + 15) & ~(size_t)15;
+		if (aligned >= size && aligned <= MSG_ARENA_SIZE - arena->used)
+		{
+			void *results = arena->base + arena->used;
+			arena->used += aligned;
+			return results;
+		}
+	}
+
+	return malloc(size);
+}
+
+static void msgArena_free(void *ptr)
+{
+	// Arena memory is only given back by a reset
+	if ((char *)ptr >= msgArena_poolStart && (char *)ptr < msgArena_poolEnd)
+		return;
+
+	free(ptr);
+}
+
+static void msgArena_init(void)
+{
+	size_t size = (size_t)MSG_ARENA_SIZE * MSG_ARENA_POOL_COUNT;
+
+	// Pages are only backed by memory once they are touched, so unused arenas cost nothing
+	void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (map == MAP_FAILED)
+		return;
+
+	msgArena_poolStart = (char *)map;
+	msgArena_poolEnd = msgArena_poolStart + size;
+
+	int i;
+	for (i = 0; i < MSG_ARENA_POOL_COUNT; i++)
+	{
+		msgArena_pool[i].base = msgArena_poolStart + (size_t)i * MSG_ARENA_SIZE;
+		msgArena_pool[i].used = 0;
+		msgArena_pool[i].inUse = 0;
+	}
+
+	// Memory from the heap still goes back to the heap, so the hooks can be changed at any time
+	cJSON_Hooks hooks = { msgArena_malloc, msgArena_free };
+	cJSON_InitHooks(&hooks);
+}
+
+MsgArena *msgArena_acquire(void)
+{
+	pthread_once(&msgArena_once, msgArena_init);
+	if (msgArena_poolStart == NULL)
+		return NULL;
+
+	MsgArena *results = NULL;
+
+	pthread_mutex_lock(&msgArena_poolLock);
+
+	int i;
+	for (i = 0; i < MSG_ARENA_POOL_COUNT && results == NULL; i++)
+	{
+		if (!msgArena_pool[i].inUse)
+		{
+			results = &msgArena_pool[i];
+			results->inUse = 1;
+			results->used = 0;
+		}
+	}
+
+	pthread_mutex_unlock(&msgArena_poolLock);
+
+	return results;
+}
+
+void msgArena_release(MsgArena *arena)
+{
+	if (arena == NULL)
+		return;
+
+	assert(msgArena_current != arena);
+	if (msgArena_current == arena)
+		msgArena_current = NULL;
+
+	// Give the pages back, since the arena may not be needed again for a long time
+	madvise(arena->base, MSG_ARENA_SIZE, MADV_DONTNEED);
+
+	pthread_mutex_lock(&msgArena_poolLock);
+	arena->used = 0;
+	arena->inUse = 0;
+	pthread_mutex_unlock(&msgArena_poolLock);
+}
+
+MsgArena *msgArena_use(MsgArena *arena)
+{
+	MsgArena *results = msgArena_current;
+	msgArena_current = arena;
+	return results;
+}
+
+void msgArena_reset(MsgArena *arena)
+{
+	if (arena != NULL)
+		arena->used = 0;
+}
+
+size_t msgArena_getUsed(MsgArena *arena)
+{
+	return arena == NULL ? 0 : arena->used;
+}
@@ -0,0 +1,80 @@
+/*
+ * MsgArena.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef MSGARENA_H_
+#define MSGARENA_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ * The size of each arena, which is enough for the JSON tree of any message that fits in a frame.
+ */
+#define MSG_ARENA_SIZE (256 * 1024)
+
+/*!
+ * The number of arenas in the process wide pool.  A plugin uses one for each receive thread.
+ */
+#define MSG_ARENA_POOL_COUNT 16
+
+/*!
+ * A bump allocator for the cJSON trees of received messages.
+ *
+ * While an arena is in use on a thread, every cJSON node and string allocated on that thread
+ * comes from the arena, and freeing them does nothing.  The whole arena is then discarded at once
+ * with msgArena_reset when the message has been handled, so decoding a message does not touch
+ * the heap.  A tree that does not fit in the space left in the arena is allocated from the heap.
+ *
+ * The arenas all come from one mapping made the first time one is acquired, so memory from any
+ * arena can be recognized, and safely passed to cJSON_Delete, on any thread.
+ */
+typedef struct MsgArena MsgArena;
+
+/*!
+ * Take an arena from the pool.
+ *
+ * @returns
+ * 		An empty arena, or NULL if all of them are taken.
+ */
+MsgArena *msgArena_acquire(void);
+
+/*!
+ * Return an arena to the pool.  Nothing allocated from it may still be in use.
+ */
+void msgArena_release(MsgArena *arena);
+
+/*!
+ * Allocate the cJSON trees made on the calling thread from the arena, until another arena is used.
+ *
+ * @param arena
+ * 		The arena to allocate from, or NULL to go back to the heap.
+ *
+ * @returns
+ * 		The arena that was in use before, if any.
+ */
+MsgArena *msgArena_use(MsgArena *arena);
+
+/*!
+ * Discard everything allocated from the arena.  Nothing allocated from it may still be in use.
+ */
+void msgArena_reset(MsgArena *arena);
+
+/*!
+ * @returns
+ * 		The number of bytes allocated from the arena since the last reset.
+ */
+size_t msgArena_getUsed(MsgArena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSGARENA_H_ */
@@ -0,0 +1,512 @@
+/*
+ * ShmTransport.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "ShmTransport.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+#define SHM_RECORD_WRAP 0xFFFFFFFFU
+
+#define SHM_PAYLOAD_NONE 0
+#define SHM_PAYLOAD_STRING 1
+#define SHM_PAYLOAD_JSON 2
+#define SHM_PAYLOAD_BYTES 3
+
+/*
+ * The first page of the mapping.  The two ring control blocks follow it, and then the data areas.
+ */
+typedef struct {
+	uint32_t magic;
+	uint32_t ringSize;
+} ShmTransportHeader;
+
+/*
+ * The binary form of an IvpMessage.  The string lengths are stored plus one, so that
+ * zero can mean NULL.  The strings and the payload follow the header, not null terminated.
+ */
+typedef struct {
+	uint64_t timestamp;
+	uint32_t flags;
+	uint32_t sourceId;
+	int32_t dsrcChannel;
+	int32_t dsrcPsid;
+	uint16_t typeLength;
+	uint16_t subtypeLength;
+	uint16_t sourceLength;
+	uint16_t encodingLength;
+	uint32_t payloadLength;
+	uint32_t payloadKind;
+} ShmMsgHeader;
+
+static inline uint64_t shmTransport_align8(uint64_t size)
+{
+	return (size + 7) & ~(uint64_t)7;
+}
+
+static size_t shmTransport_mapSize(uint32_t ringSize)
+{
+	return 4096 + 2 * sizeof(ShmRingControl) + 2 * (size_t)ringSize;
+}
+
+static void shmTransport_initRings(ShmTransport *transport, uint32_t ringSize)
+{
+	char *base = (char *)transport->map;
+	ShmRingControl *controls = (ShmRingControl *)(base + 4096);
+	char *data = (char *)(controls + 2);
+
+	transport->toCore.control = &controls[0];
+	transport->toCore.data = data;
+	transport->toCore.size = ringSize;
+
+	transport->toPlugin.control = &controls[1];
+	transport->toPlugin.data = data + ringSize;
+	transport->toPlugin.size = ringSize;
+}
+
+ShmTransport *shmTransport_create(uint32_t ringSize)
+{
+#ifdef SYS_memfd_create
+	ringSize = (uint32_t)shmTransport_align8(ringSize);
+
+	ShmTransport *results = calloc(1, sizeof(ShmTransport));
+	if (results == NULL)
+		return NULL;
+
+	results->memFd = -1;
+	results->toCore.eventFd = -1;
+	results->toPlugin.eventFd = -1;
+	results->mapSize = shmTransport_mapSize(ringSize);
+
+	results->memFd = syscall(SYS_memfd_create, "tmx-shm", MFD_CLOEXEC);
+	if (results->memFd < 0 || ftruncate(results->memFd, results->mapSize) != 0)
+	{
+		shmTransport_destroy(results);
+		return NULL;
+	}
+
+	results->map = mmap(NULL, results->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, results->memFd, 0);
+	if (results->map == MAP_FAILED)
+	{
+		results->map = NULL;
+		shmTransport_destroy(results);
+		return NULL;
+	}
+
+	results->toCore.eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	results->toPlugin.eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (results->toCore.eventFd < 0 || results->toPlugin.eventFd < 0)
+	{
+		shmTransport_destroy(results);
+		return NULL;
+	}
+
+	shmTransport_initRings(results, ringSize);
+	results->toCore.control->size = ringSize;
+	results->toPlugin.control->size = ringSize;
+
+	ShmTransportHeader *header = (ShmTransportHeader *)results->map;
+	header->ringSize = ringSize;
+	__atomic_store_n(&header->magic, SHM_TRANSPORT_MAGIC, __ATOMIC_RELEASE);
+
+	return results;
+#else
+	return NULL;
+#endif
+}
+
+ShmTransport *shmTransport_attach(int memFd, int toCoreEventFd, int toPluginEventFd)
+{
+	ShmTransport *results = calloc(1, sizeof(ShmTransport));
+	if (results == NULL)
+	{
+		close(memFd);
+		close(toCoreEventFd);
+		close(toPluginEventFd);
+		return NULL;
+	}
+
+	results->memFd = memFd;
+	results->toCore.eventFd = toCoreEventFd;
+	results->toPlugin.eventFd = toPluginEventFd;
+
+	ShmTransportHeader header;
+	if (pread(memFd, &header, sizeof(header), 0) != sizeof(header)
+			|| header.magic != SHM_TRANSPORT_MAGIC || header.ringSize == 0 || (header.ringSize & 7) != 0)
+	{
+		shmTransport_destroy(results);
+		return NULL;
+	}
+
+	results->mapSize = shmTransport_mapSize(header.ringSize);
+	results->map = mmap(NULL, results->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+	if (results->map == MAP_FAILED)
+	{
+		results->map = NULL;
+		shmTransport_destroy(results);
+		return NULL;
+	}
+
+	shmTransport_initRings(results, header.ringSize);
+	return results;
+}
+
+void shmTransport_destroy(ShmTransport *transport)
+{
+	assert(transport != NULL);
+	if (transport == NULL)
+		return;
+
+	if (transport->map != NULL)
+		munmap(transport->map, transport->mapSize);
+	if (transport->memFd >= 0)
+		close(transport->memFd);
+	if (transport->toCore.eventFd >= 0)
+		close(transport->toCore.eventFd);
+	if (transport->toPlugin.eventFd >= 0)
+		close(transport->toPlugin.eventFd);
+
+	free(transport);
+}
+
+int shmTransport_importFd(int pid, int fd)
+{
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_getfd)
+	int pidfd = syscall(SYS_pidfd_open, pid, 0);
+	if (pidfd < 0)
+		return -1;
+
+	int results = syscall(SYS_pidfd_getfd, pidfd, fd, 0);
+	close(pidfd);
+	return results;
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+static inline uint16_t shmTransport_stringLength(const char *str)
+{
+	if (str == NULL)
+		return 0;
+
+	size_t len = strlen(str);
+	return len >= UINT16_MAX ? UINT16_MAX : (uint16_t)(len + 1);
+}
+
+static inline char *shmTransport_copyString(char *dest, const char *str, uint16_t length)
+{
+	if (length > 1)
+		memcpy(dest, str, length - 1);
+	return dest + (length ? length - 1 : 0);
+}
+
+static inline char *shmTransport_readString(const char **src, uint16_t length)
+{
+	if (length == 0)
+		return NULL;
+
+	char *results = malloc(length);
+	if (results != NULL)
+	{
+		memcpy(results, *src, length - 1);
+		results[length - 1] = '\0';
+	}
+	*src += length - 1;
+	return results;
+}
+
+int shmTransport_send(ShmRing *ring, IvpMessage *msg)
+{
+	assert(ring != NULL);
+	assert(msg != NULL);
+	if (ring == NULL || ring->control == NULL || msg == NULL)
+		return -1;
+
+	ShmMsgHeader header;
+	memset(&header, 0, sizeof(header));
+	header.timestamp = msg->timestamp;
+	header.flags = msg->flags;
+	header.sourceId = msg->sourceId;
+	header.dsrcChannel = msg->dsrcMetadata ? msg->dsrcMetadata->channel : -1;
+	header.dsrcPsid = msg->dsrcMetadata ? msg->dsrcMetadata->psid : 0;
+	header.typeLength = shmTransport_stringLength(msg->type);
+	header.subtypeLength = shmTransport_stringLength(msg->subtype);
+	header.sourceLength = shmTransport_stringLength(msg->source);
+	header.encodingLength = shmTransport_stringLength(msg->encoding);
+
+	// Binary payloads, such as an encoded J2735 message, and string payloads are copied as is.
+	// Only other payloads need to be serialized.
+	char *json = NULL;
+	const char *payload = NULL;
+	if (msg->payloadBytes != NULL)
+	{
+		header.payloadKind = SHM_PAYLOAD_BYTES;
+		header.payloadLength = (uint32_t)msg->payloadLength;
+		payload = (const char *)msg->payloadBytes;
+
+		if (msg->payloadLength > ring->size)
+			return -1;
+	}
+	else if (msg->payload != NULL)
+	{
+		if (msg->payload->type == cJSON_String && msg->payload->valuestring != NULL)
+		{
+			header.payloadKind = SHM_PAYLOAD_STRING;
+			payload = msg->payload->valuestring;
+		}
+		else
+		{
+			header.payloadKind = SHM_PAYLOAD_JSON;
+			json = cJSON_PrintUnformatted(msg->payload);
+			payload = json;
+		}
+
+		if (payload != NULL)
+			header.payloadLength = strlen(payload);
+	}
+
+	uint64_t bodyLength = sizeof(ShmMsgHeader)
+			+ (header.typeLength ? header.typeLength - 1 : 0)
+			+ (header.subtypeLength ? header.subtypeLength - 1 : 0)
+			+ (header.sourceLength ? header.sourceLength - 1 : 0)
+			+ (header.encodingLength ? header.encodingLength - 1 : 0)
+			+ header.payloadLength;
+	uint64_t recordLength = shmTransport_align8(sizeof(uint32_t) + bodyLength);
+
+	if (recordLength > ring->size / 2)
+	{
+		if (json != NULL)
+			free(json);
+		return -1;
+	}
+
+	ShmRingControl *control = ring->control;
+	uint64_t head = control->head;
+	uint64_t tail = __atomic_load_n(&control->tail, __ATOMIC_ACQUIRE);
+	uint64_t pos = head % ring->size;
+	uint64_t contiguous = ring->size - pos;
+
+	// A record is never split across the end of the ring.  Instead, the rest of the ring
+	// is skipped with a wrap marker.
+	uint64_t needed = recordLength + (recordLength > contiguous ? contiguous : 0);
+	if (ring->size - (head - tail) < needed)
+	{
+		if (json != NULL)
+			free(json);
+		return -2;
+	}
+
+	if (recordLength > contiguous)
+	{
+		*(uint32_t *)(ring->data + pos) = SHM_RECORD_WRAP;
+		head += contiguous;
+		pos = 0;
+	}
+
+	char *ptr = ring->data + pos;
+	*(uint32_t *)ptr = (uint32_t)bodyLength;
+	ptr += sizeof(uint32_t);
+	memcpy(ptr, &header, sizeof(header));
+	ptr += sizeof(header);
+	ptr = shmTransport_copyString(ptr, msg->type, header.typeLength);
+	ptr = shmTransport_copyString(ptr, msg->subtype, header.subtypeLength);
+	ptr = shmTransport_copyString(ptr, msg->source, header.sourceLength);
+	ptr = shmTransport_copyString(ptr, msg->encoding, header.encodingLength);
+	if (header.payloadLength > 0)
+		memcpy(ptr, payload, header.payloadLength);
+
+	if (json != NULL)
+		free(json);
+
+	__atomic_store_n(&control->head, head + recordLength, __ATOMIC_RELEASE);
+
+	// Only wake the reader if it has said that it is going to sleep
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&control->readerWaiting, __ATOMIC_RELAXED))
+	{
+		uint64_t one = 1;
+		if (write(ring->eventFd, &one, sizeof(one)) < 0)
+		{
+			// The counter is already non-zero, so the reader will wake up anyway
+		}
+	}
+
+	return 0;
+}
+
+int shmTransport_sendWait(ShmRing *ring, IvpMessage *msg, int timeoutMs)
+{
+	int results = shmTransport_send(ring, msg);
+
+	int waited = 0;
+	while (results == -2 && waited < timeoutMs)
+	{
+		usleep(1000);
+		waited++;
+		results = shmTransport_send(ring, msg);
+	}
+
+	return results;
+}
+
+static IvpMessage *shmTransport_decode(const char *body, uint32_t bodyLength)
+{
+	if (bodyLength < sizeof(ShmMsgHeader))
+		return NULL;
+
+	ShmMsgHeader header;
+	memcpy(&header, body, sizeof(header));
+
+	// The header is written by the other process, so the lengths in it are not trusted
+	uint64_t expectedLength = sizeof(ShmMsgHeader)
+			+ (header.typeLength ? header.typeLength - 1 : 0)
+			+ (header.subtypeLength ? header.subtypeLength - 1 : 0)
+			+ (header.sourceLength ? header.sourceLength - 1 : 0)
+			+ (header.encodingLength ? header.encodingLength - 1 : 0)
+			+ (uint64_t)header.payloadLength;
+	if (expectedLength > bodyLength || header.payloadKind > SHM_PAYLOAD_BYTES)
+		return NULL;
+
+	IvpMessage *results = ivpMsg_create(NULL, NULL, NULL, header.flags, NULL);
+	if (results == NULL)
+		return NULL;
+
+	const char *ptr = body + sizeof(header);
+	results->type = shmTransport_readString(&ptr, header.typeLength);
+	results->subtype = shmTransport_readString(&ptr, header.subtypeLength);
+	results->source = shmTransport_readString(&ptr, header.sourceLength);
+	results->encoding = shmTransport_readString(&ptr, header.encodingLength);
+	results->timestamp = header.timestamp;
+	results->sourceId = header.sourceId;
+
+	if (header.dsrcChannel != -1)
+		ivpMsg_addDsrcMetadata(results, header.dsrcChannel, header.dsrcPsid);
+
+	if (header.payloadKind == SHM_PAYLOAD_BYTES)
+	{
+		ivpMsg_setPayloadBytes(results, (const uint8_t *)ptr, header.payloadLength);
+	}
+	else if (header.payloadKind != SHM_PAYLOAD_NONE)
+	{
+		char *payload = malloc(header.payloadLength + 1);
+		if (payload != NULL)
+		{
+			memcpy(payload, ptr, header.payloadLength);
+			payload[header.payloadLength] = '\0';
+
+			if (header.payloadKind == SHM_PAYLOAD_STRING)
+				results->payload = cJSON_CreateString(payload);
+			else
+				results->payload = cJSON_Parse(payload);
+
+			free(payload);
+		}
+	}
+
+	return results;
+}
+
+static IvpMessage *shmTransport_tryReceive(ShmRing *ring, int *empty)
+{
+	ShmRingControl *control = ring->control;
+	uint64_t tail = control->tail;
+
+	*empty = 0;
+	for (;;)
+	{
+		uint64_t head = __atomic_load_n(&control->head, __ATOMIC_ACQUIRE);
+		if (tail == head)
+		{
+			*empty = 1;
+			return NULL;
+		}
+
+		// The positions are in memory the other process can write, so make sure they describe a ring
+		if (head - tail > ring->size || (tail & 7) != 0)
+		{
+			__atomic_store_n(&control->tail, head, __ATOMIC_RELEASE);
+			*empty = 1;
+			return NULL;
+		}
+
+		uint64_t pos = tail % ring->size;
+		uint32_t bodyLength = *(uint32_t *)(ring->data + pos);
+		if (bodyLength == SHM_RECORD_WRAP)
+		{
+			tail += ring->size - pos;
+			__atomic_store_n(&control->tail, tail, __ATOMIC_RELEASE);
+			continue;
+		}
+
+		// A record that runs past the end of the ring or the written data is corrupt.
+		// Everything written so far is skipped, since the next record cannot be found.
+		uint64_t recordLength = shmTransport_align8(sizeof(uint32_t) + (uint64_t)bodyLength);
+		if (recordLength > ring->size - pos || recordLength > head - tail)
+		{
+			__atomic_store_n(&control->tail, head, __ATOMIC_RELEASE);
+			return NULL;
+		}
+
+		IvpMessage *results = shmTransport_decode(ring->data + pos + sizeof(uint32_t), bodyLength);
+
+		__atomic_store_n(&control->tail, tail + recordLength, __ATOMIC_RELEASE);
+		return results;
+	}
+}
+
+IvpMessage *shmTransport_receive(ShmRing *ring, int timeoutMs)
+{
+	assert(ring != NULL);
+	if (ring == NULL || ring->control == NULL)
+		return NULL;
+
+	int empty;
+	IvpMessage *results = shmTransport_tryReceive(ring, &empty);
+	if (!empty)
+		return results;
+
+	// Announce that the reader is about to sleep, then check once more so that a
+	// message written just before the announcement is not missed.
+	__atomic_store_n(&ring->control->readerWaiting, 1, __ATOMIC_SEQ_CST);
+
+	results = shmTransport_tryReceive(ring, &empty);
+	if (empty)
+	{
+		struct pollfd pfd;
+		pfd.fd = ring->eventFd;
+		pfd.events = POLLIN;
+
+		if (poll(&pfd, 1, timeoutMs) > 0)
+		{
+			uint64_t count;
+			if (read(ring->eventFd, &count, sizeof(count)) < 0)
+			{
+				// Nothing to do, the counter was reset by an earlier read
+			}
+		}
+
+		__atomic_store_n(&ring->control->readerWaiting, 0, __ATOMIC_SEQ_CST);
+		results = shmTransport_tryReceive(ring, &empty);
+	}
+	else
+	{
+		__atomic_store_n(&ring->control->readerWaiting, 0, __ATOMIC_SEQ_CST);
+	}
+
+	return results;
+}
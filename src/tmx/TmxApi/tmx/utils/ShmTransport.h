@@ -0,0 +1,127 @@
+/*
+ * ShmTransport.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SHMTRANSPORT_H_
+#define SHMTRANSPORT_H_
+
+#include "../IvpMessage.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SHM_TRANSPORT_MAGIC 0x314D4853 // "SHM1"
+#define SHM_TRANSPORT_DEFAULT_RING_SIZE (1024 * 1024)
+
+/*!
+ * Set this environment variable to 1 to keep a plugin from offering the shared memory transport.
+ */
+#define SHM_TRANSPORT_DISABLE_ENV "TMX_DISABLE_SHM"
+
+/*!
+ * The control block of a single producer, single consumer ring that lives in shared memory.
+ * The head is only written by the producer and the tail only by the consumer, and each is on its
+ * own cache line.  The consumer sets readerWaiting before it blocks on the event, so the producer
+ * only has to make a system call to wake it up when it is actually asleep.
+ */
+typedef struct {
+	volatile uint64_t head;
+	char pad1[56];
+	volatile uint64_t tail;
+	char pad2[56];
+	volatile uint32_t readerWaiting;
+	uint32_t size;
+	char pad3[56];
+} ShmRingControl;
+
+/*!
+ * A process local handle to one ring.
+ */
+typedef struct {
+	ShmRingControl *control;
+	char *data;
+	uint32_t size;
+	int eventFd;
+} ShmRing;
+
+/*!
+ * A pair of rings in one memfd backed mapping, one for each direction between a plugin and ivpcore.
+ */
+typedef struct ShmTransport {
+	void *map;
+	size_t mapSize;
+	int memFd;
+	ShmRing toCore;
+	ShmRing toPlugin;
+} ShmTransport;
+
+/*!
+ * Creates a new transport with a memfd for the rings and an eventfd for each direction.
+ *
+ * @param ringSize
+ * 		The size in bytes of the data area of each ring.  Rounded up to a multiple of 8.
+ *
+ * @returns
+ * 		A malloc'ed transport or NULL if memfd or eventfd is not supported or an error occurred.
+ */
+ShmTransport *shmTransport_create(uint32_t ringSize);
+
+/*!
+ * Maps a transport created by another process.  The file descriptors are owned by the
+ * transport after this call, even if it fails.
+ *
+ * @returns
+ * 		A malloc'ed transport or NULL if the memory is not a valid transport.
+ */
+ShmTransport *shmTransport_attach(int memFd, int toCoreEventFd, int toPluginEventFd);
+
+/*!
+ * Unmaps the rings and closes all of the file descriptors.
+ */
+void shmTransport_destroy(ShmTransport *transport);
+
+/*!
+ * Duplicates a file descriptor that is open in another process into this one with pidfd_getfd.
+ * This requires Linux 5.6 and permission to trace the other process.
+ *
+ * @returns
+ * 		The new file descriptor or -1 on error.
+ */
+int shmTransport_importFd(int pid, int fd);
+
+/*!
+ * Writes a message into a ring in binary form.  Does not block.
+ *
+ * @returns
+ * 		0 on success, -1 if the message can never fit in the ring, or -2 if the ring is currently full.
+ */
+int shmTransport_send(ShmRing *ring, IvpMessage *msg);
+
+/*!
+ * Writes a message into a ring, waiting up to the given time for the reader to make room.
+ *
+ * @returns
+ * 		0 on success, or the last result of shmTransport_send.
+ */
+int shmTransport_sendWait(ShmRing *ring, IvpMessage *msg, int timeoutMs);
+
+/*!
+ * Reads the next message from a ring, waiting up to the given time for one to arrive.
+ *
+ * @returns
+ * 		A malloc'ed IvpMessage or NULL if none arrived in time.
+ */
+IvpMessage *shmTransport_receive(ShmRing *ring, int timeoutMs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHMTRANSPORT_H_ */
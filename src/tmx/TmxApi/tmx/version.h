@@ -8,7 +8,7 @@
 #ifndef VERSION_H_
 #define VERSION_H_
 
-#define TMXAPI_VERSION "3.3.0"
+#define TMXAPI_VERSION "3.4.0"
 #define IVPAPI_VERSION IVPAPI_VERSION
 
 #endif /* VERSION_H_ */
@@ -0,0 +1,205 @@
+/*
+ * MessageRecorder.cpp
+ *
+ * Internal ivpcore plugin that records all messages routed through the system.
+ * Each message is appended to a segmented, memory-mapped log file along with a small binary
+ * header, and a sparse time index is kept for each segment.  The oldest segments are removed
+ * when the recording goes over the configured disk quota.
+ */
+
+#ifndef __CYGWIN__
+#include <sys/prctl.h>
+#endif
+#include "MessageRecorder.h"
+#include <assert.h>
+#include "version.h"
+#include "logger.h"
+
+#define MSGRECORDER_CONFIGKEY_ENABLE "Enable Recording"
+#define MSGRECORDER_CONFIGKEY_DIRECTORY "Recording Directory"
+#define MSGRECORDER_CONFIGKEY_SEGMENTSIZE "Segment Size (MB)"
+#define MSGRECORDER_CONFIGKEY_DISKQUOTA "Disk Quota (MB)"
+#define MSGRECORDER_CONFIGKEY_INDEXINTERVAL "Index Interval (ms)"
+
+#define MSGRECORDER_CONFIGDFLT_SEGMENTSIZE 64
+#define MSGRECORDER_CONFIGDFLT_DISKQUOTA 512
+#define MSGRECORDER_CONFIGDFLT_INDEXINTERVAL 1000
+
+#define MSGRECORDER_STATUS_INTERVAL 5
+
+using namespace std;
+using namespace tmx::utils;
+
+MessageRecorder::MessageRecorder(MessageRouter *messageRouter) : Plugin(messageRouter)
+{
+	RegistrationInformation info;
+	info.pluginInfo.name = "ivpcore.MessageRecorder";
+	info.pluginInfo.description = "Core element that is responsible for recording all routed messages for later replay";
+	info.pluginInfo.version = IVPCORE_VERSION;
+
+	info.configDefaultEntries.push_back(PluginConfigurationParameterEntry(MSGRECORDER_CONFIGKEY_ENABLE, "false", "Record every routed message to the flight recorder log.  Recording is off unless enabled here."));
+	info.configDefaultEntries.push_back(PluginConfigurationParameterEntry(MSGRECORDER_CONFIGKEY_DIRECTORY, "/var/log/tmx/recorder", "The directory where the flight recorder log segments are written."));
+	info.configDefaultEntries.push_back(PluginConfigurationParameterEntry(MSGRECORDER_CONFIGKEY_SEGMENTSIZE,
+			to_string(MSGRECORDER_CONFIGDFLT_SEGMENTSIZE),
+			"The size (in megabytes) of each log segment file."));
+	info.configDefaultEntries.push_back(PluginConfigurationParameterEntry(MSGRECORDER_CONFIGKEY_DISKQUOTA,
+			to_string(MSGRECORDER_CONFIGDFLT_DISKQUOTA),
+			"The maximum total size (in megabytes) of the log.  The oldest segments are deleted to stay under this size.  A value of zero disables the limit."));
+	info.configDefaultEntries.push_back(PluginConfigurationParameterEntry(MSGRECORDER_CONFIGKEY_INDEXINTERVAL,
+			to_string(MSGRECORDER_CONFIGDFLT_INDEXINTERVAL),
+			"The interval (in milliseconds) between entries in the time index used to seek within the log."));
+
+	try
+	{
+		this->registerPlugin(info);
+	}
+	catch (PluginException &e)
+	{
+		LOG_FATAL(e.what());
+		throw e;
+	}
+
+	pthread_mutex_init(&this->mLock, NULL);
+
+	this->openRecorder();
+
+	// Register for all messages.
+	vector<MessageFilterEntry> entries;
+	MessageFilterEntry entry;
+	entry.type = "*";
+	entries.push_back(entry);
+	this->subscribeForMessages(entries);
+
+	this->mStatusThread = boost::thread(&MessageRecorder::statusThreadEntry, this);
+}
+
+MessageRecorder::~MessageRecorder()
+{
+	// The status thread uses the recorder and the plugin, so it must stop first
+	this->mStatusThread.interrupt();
+	this->mStatusThread.join();
+
+	pthread_mutex_lock(&this->mLock);
+	this->mRecorder.reset();
+	pthread_mutex_unlock(&this->mLock);
+}
+
+uint64_t MessageRecorder::getConfigNumber(std::string key, uint64_t defaultValue)
+{
+	char *tailptr;
+	string value = this->getConfigValue(key);
+	uint64_t number = strtoull(value.c_str(), &tailptr, 10);
+	return (tailptr == value.c_str()) ? defaultValue : number;
+}
+
+void MessageRecorder::openRecorder()
+{
+	bool enabled = this->getConfigValue(MSGRECORDER_CONFIGKEY_ENABLE) == "true";
+	string directory = this->getConfigValue(MSGRECORDER_CONFIGKEY_DIRECTORY);
+	uint64_t segmentSize = this->getConfigNumber(MSGRECORDER_CONFIGKEY_SEGMENTSIZE, MSGRECORDER_CONFIGDFLT_SEGMENTSIZE);
+	uint64_t diskQuota = this->getConfigNumber(MSGRECORDER_CONFIGKEY_DISKQUOTA, MSGRECORDER_CONFIGDFLT_DISKQUOTA);
+	uint64_t indexInterval = this->getConfigNumber(MSGRECORDER_CONFIGKEY_INDEXINTERVAL, MSGRECORDER_CONFIGDFLT_INDEXINTERVAL);
+
+	if (segmentSize == 0)
+		segmentSize = MSGRECORDER_CONFIGDFLT_SEGMENTSIZE;
+
+	pthread_mutex_lock(&this->mLock);
+
+	this->mRecorder.reset();
+
+	if (enabled && !directory.empty())
+	{
+		try
+		{
+			this->mRecorder.reset(new FlightRecorder(directory, "ivpcore", segmentSize * 1024 * 1024,
+					diskQuota * 1024 * 1024, indexInterval));
+			LOG_INFO("<" << this->mInfo.pluginInfo.name << "> Recording messages to " << directory);
+		}
+		catch (exception &e)
+		{
+			LOG_WARN("<" << this->mInfo.pluginInfo.name << "> Unable to start recording: " << e.what());
+		}
+	}
+
+	pthread_mutex_unlock(&this->mLock);
+}
+
+void MessageRecorder::onConfigChanged(std::string key, std::string value)
+{
+	if (key == MSGRECORDER_CONFIGKEY_ENABLE || key == MSGRECORDER_CONFIGKEY_DIRECTORY)
+	{
+		this->openRecorder();
+		return;
+	}
+
+	pthread_mutex_lock(&this->mLock);
+
+	if (this->mRecorder)
+	{
+		if (key == MSGRECORDER_CONFIGKEY_SEGMENTSIZE)
+		{
+			uint64_t segmentSize = this->getConfigNumber(key, MSGRECORDER_CONFIGDFLT_SEGMENTSIZE);
+			this->mRecorder->set_SegmentSize((segmentSize == 0 ? MSGRECORDER_CONFIGDFLT_SEGMENTSIZE : segmentSize) * 1024 * 1024);
+		}
+		else if (key == MSGRECORDER_CONFIGKEY_DISKQUOTA)
+		{
+			this->mRecorder->set_DiskQuota(this->getConfigNumber(key, MSGRECORDER_CONFIGDFLT_DISKQUOTA) * 1024 * 1024);
+		}
+		else if (key == MSGRECORDER_CONFIGKEY_INDEXINTERVAL)
+		{
+			this->mRecorder->set_IndexInterval(this->getConfigNumber(key, MSGRECORDER_CONFIGDFLT_INDEXINTERVAL));
+		}
+	}
+
+	pthread_mutex_unlock(&this->mLock);
+}
+
+// Since MessageRecorder is subscribed to all messages, this method will be called for every message.
+// This method is executed on whatever thread the message was received on, so it only copies the
+// message into the mapped segment and never waits on the disk.
+void MessageRecorder::onMessageReceived(IvpMessage *msg)
+{
+	assert(msg != NULL);
+
+	// These are heartbeats. So don't record them.
+	if (msg->type == NULL)
+		return;
+
+	pthread_mutex_lock(&this->mLock);
+	if (this->mRecorder)
+		this->mRecorder->Record(msg);
+	pthread_mutex_unlock(&this->mLock);
+}
+
+void MessageRecorder::statusThreadEntry()
+{
+#ifndef __CYGWIN__
+	prctl(PR_SET_NAME, "MsgRecorder", 0, 0, 0);
+#endif
+
+	boost::this_thread::disable_interruption di;
+
+	while (!boost::this_thread::interruption_requested())
+	{
+		// Sleep in short steps, so the destructor does not wait out the whole interval
+		for (int i = 0; i < MSGRECORDER_STATUS_INTERVAL * 10 && !boost::this_thread::interruption_requested(); i++)
+			usleep(100000);
+
+		if (boost::this_thread::interruption_requested())
+			break;
+
+		map<string, string> statusItems;
+
+		pthread_mutex_lock(&this->mLock);
+		if (this->mRecorder)
+		{
+			statusItems["Records"] = to_string(this->mRecorder->get_RecordCount());
+			statusItems["Dropped"] = to_string(this->mRecorder->get_DroppedCount());
+			statusItems["MB Written"] = to_string(this->mRecorder->get_BytesWritten() / (1024 * 1024));
+		}
+		pthread_mutex_unlock(&this->mLock);
+
+		if (!statusItems.empty())
+			this->setStatusItems(statusItems);
+	}
+}
@@ -0,0 +1,41 @@
+/*
+ * MessageRecorder.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef MESSAGERECORDER_H_
+#define MESSAGERECORDER_H_
+
+#include "Plugin.h"
+#include <memory>
+#include <boost/thread.hpp>
+#include <FlightRecorder.h>
+
+/**
+ * A plugin that receives all the messages sent in the IVP System and appends them to a memory-mapped
+ * flight recorder log on disk, so that the traffic can later be replayed with the tmxreplay tool.
+ * \ingroup IVPCore
+ */
+class MessageRecorder : public Plugin
+{
+public:
+	MessageRecorder(MessageRouter *messageRouter);
+	~MessageRecorder();
+
+	virtual void onConfigChanged(std::string key, std::string value);
+	virtual void onMessageReceived(IvpMessage *msg);
+
+private:
+	uint64_t getConfigNumber(std::string key, uint64_t defaultValue);
+	void openRecorder();
+
+	pthread_mutex_t mLock;
+	std::unique_ptr<tmx::utils::FlightRecorder> mRecorder;
+	boost::thread mStatusThread;
+
+	void statusThreadEntry();
+};
+
+#endif /* MESSAGERECORDER_H_ */
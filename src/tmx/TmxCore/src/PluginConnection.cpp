@@ -14,6 +14,9 @@
 #include "tmx/utils/MsgFramer.h"
 #include "utils/PerformanceTimer.h"
 #include <assert.h>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
 using namespace std;
 
 // The PluginConnection class is instantiated by ivpcore when a Plugin opens a socket to ivpcore
@@ -26,6 +29,9 @@ PluginConnection::PluginConnection(MessageRouter *router, int socket) : Plugin(r
 	assert(socket != (int) NULL);
 
 	this->mSocket = socket;
+	this->mShm = NULL;
+	this->mShmActive = false;
+	this->mShmFullCount = 0;
 
 	mReceiverThread = boost::thread(&PluginConnection::receiverThread, this);
 	mFastProcessorThread = boost::thread(&PluginConnection::fastProcessorThread, this);
@@ -55,6 +61,56 @@ void PluginConnection::onConfigChanged(string key, string value)
 // Internal plugins like MessageProfiler and PluginMonitor directly derive from Plugin and override
 // onMessageReceived.
 void PluginConnection::onMessageReceived(IvpMessage *msg)
+{
+	// Once the plugin has accepted the shared memory transport, every message goes through the ring,
+	// so the plugin handles them in order on the one thread that reads it.  While the ring is full,
+	// the sender waits for the plugin to catch up, just as a write to a full socket would block.
+	// The lock is only held for each attempt, so other senders are not held up by the wait.
+	while (mShmActive)
+	{
+		int shmResult = -2;
+		{
+			boost::mutex::scoped_lock lock(mMutexShm);
+			if (mShmActive)
+				shmResult = shmTransport_send(&mShm->toPlugin, msg);
+
+			if (shmResult == -2 && mShmActive && (++mShmFullCount % 1000) == 1)
+			{
+				LOG_WARN("Shared memory ring to " << this->mInfo.pluginInfo.name << " is full, "
+						<< mShmFullCount << " message(s) waited for the plugin to catch up");
+			}
+		}
+
+		if (shmResult == 0)
+			return;
+
+		// The ring is far larger than a message framed for the socket can be, so a message
+		// that never fits in the ring could not be sent at all
+		if (shmResult == -1)
+		{
+			LOG_WARN("Message " << (msg->type ? msg->type : "") << "/" << (msg->subtype ? msg->subtype : "")
+					<< " is too large to send to " << this->mInfo.pluginInfo.name);
+			return;
+		}
+
+		usleep(1000);
+	}
+
+	boost::mutex::scoped_lock lock(mMutexSocket);
+
+	// The transport may have been switched while waiting for the lock.  See negotiateSharedMemory().
+	if (mShmActive)
+	{
+		lock.unlock();
+		this->onMessageReceived(msg);
+		return;
+	}
+
+	writeToSocket(msg);
+}
+
+// Write a message to the socket.  The caller must hold mMutexSocket.
+void PluginConnection::writeToSocket(IvpMessage *msg)
 {
 	struct pollfd poll_data;
 
@@ -110,6 +166,8 @@ void PluginConnection::receiverThread()
 			cout << "GUI connection closing..." << recvcount << endl;
 			close(mSocket);
 
+			closeSharedMemory();
+
 			mFastProcessorThread.interrupt();
 			mSlowProcessorThread.interrupt();
 			mEventContinueFastProcessor.Set();
@@ -142,31 +200,53 @@ void PluginConnection::receiverThread()
 				continue;
 			}
 
-			// Place the message on the appropriate queue for processing by another thread.
-			// Non-critical messages that are slower to process are placed on the slow processor thread
-			// and the others are placed on the fast processor thread.
-			// For instance, in one case, writing of status messages to the database was taking 9 ms.
-			// That is why status messages and event messages are processed in their own thread.
-			// Note that the IvpMessage is freed in the processor threads.
-
-			if (ivpPluginStatus_isStatusMsg(msg) ||	ivpEventLog_isEventLogMsg(msg))
-			{
-				mMutexSlowMessageQueue.lock();
-				mSlowMessageQueue.push(msg);
-				mMutexSlowMessageQueue.unlock();
-				mEventContinueSlowProcessor.Set();
-			}
-			else
-			{
-				mMutexFastMessageQueue.lock();
-				mFastMessageQueue.push(msg);
-				mMutexFastMessageQueue.unlock();
-				mEventContinueFastProcessor.Set();
-			}
+			queueMessage(msg);
 		}
 	}
 }
 
+// The shared memory receiver thread reads messages from the ring of a plugin that negotiated
+// the shared memory transport.  The messages are queued the same way as those read from the socket.
+void PluginConnection::shmReceiverThread()
+{
+#ifndef __CYGWIN__
+	prctl(PR_SET_NAME, "PluginConShm", 0, 0, 0);
+#endif
+
+	boost::this_thread::disable_interruption di;
+
+	while (!boost::this_thread::interruption_requested())
+	{
+		IvpMessage *msg = shmTransport_receive(&mShm->toCore, 100);
+		if (msg != NULL)
+			queueMessage(msg);
+	}
+}
+
+// Place the message on the appropriate queue for processing by another thread.
+// Non-critical messages that are slower to process are placed on the slow processor thread
+// and the others are placed on the fast processor thread.
+// For instance, in one case, writing of status messages to the database was taking 9 ms.
+// That is why status messages and event messages are processed in their own thread.
+// Note that the IvpMessage is freed in the processor threads.
+void PluginConnection::queueMessage(IvpMessage *msg)
+{
+	if (ivpPluginStatus_isStatusMsg(msg) ||	ivpEventLog_isEventLogMsg(msg))
+	{
+		mMutexSlowMessageQueue.lock();
+		mSlowMessageQueue.push(msg);
+		mMutexSlowMessageQueue.unlock();
+		mEventContinueSlowProcessor.Set();
+	}
+	else
+	{
+		mMutexFastMessageQueue.lock();
+		mFastMessageQueue.push(msg);
+		mMutexFastMessageQueue.unlock();
+		mEventContinueFastProcessor.Set();
+	}
+}
+
 // The fast processor thread handles all critical IVP messages.
 // Any non-critical messages that are slow to process are instead handled by the slow processor thread.
 void PluginConnection::fastProcessorThread()
@@ -349,6 +429,8 @@ void PluginConnection::processRegistrationMessage(IvpMessage *msg)
 			{
 				this->registerPlugin(info);
 
+				negotiateSharedMemory(msg);
+
 				map<string, PluginConfigurationParameterEntry> configEntries = this->getAllConfigValues();
 				IvpConfigCollection *collection = NULL;
 				for (map<string, PluginConfigurationParameterEntry>::iterator itr = configEntries.begin(); itr != configEntries.end(); itr++)
@@ -388,6 +470,160 @@ void PluginConnection::processRegistrationMessage(IvpMessage *msg)
 	}
 }
 
+// Returns true if the given process holds the other end of a loopback socket.  SO_PEERCRED
+// answers this directly for a local socket.  For TCP the kernel does not record the peer, so
+// the socket inode of the peer is found in /proc/net/tcp and must be open in the process.
+static bool isSocketPeer(int socket, pid_t pid)
+{
+	if (pid <= 0)
+		return false;
+
+	struct ucred cred;
+	socklen_t credLength = sizeof(cred);
+	if (getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &cred, &credLength) == 0 && cred.pid > 0)
+		return cred.pid == pid;
+
+	struct sockaddr_in local, peer;
+	socklen_t localLength = sizeof(local);
+	socklen_t peerLength = sizeof(peer);
+	if (getsockname(socket, (struct sockaddr *)&local, &localLength) != 0
+			|| getpeername(socket, (struct sockaddr *)&peer, &peerLength) != 0
+			|| local.sin_family != AF_INET || peer.sin_family != AF_INET)
+		return false;
+
+	// The socket of the plugin has the peer address as its local address
+	char localAddress[16], remoteAddress[16];
+	snprintf(localAddress, sizeof(localAddress), "%08X:%04X", peer.sin_addr.s_addr, ntohs(peer.sin_port));
+	snprintf(remoteAddress, sizeof(remoteAddress), "%08X:%04X", local.sin_addr.s_addr, ntohs(local.sin_port));
+
+	unsigned long inode = 0;
+	ifstream tcpTable("/proc/net/tcp");
+	string line;
+	getline(tcpTable, line);
+	while (inode == 0 && getline(tcpTable, line))
+	{
+		istringstream fields(line);
+		string slot, lineLocal, lineRemote, state, queues, timer, retransmits;
+		unsigned long uid, timeout, lineInode;
+		if (fields >> slot >> lineLocal >> lineRemote >> state >> queues >> timer >> retransmits >> uid >> timeout >> lineInode
+				&& lineLocal == localAddress && lineRemote == remoteAddress)
+			inode = lineInode;
+	}
+
+	if (inode == 0)
+		return false;
+
+	string fdPath = "/proc/" + to_string(pid) + "/fd";
+	string expected = "socket:[" + to_string(inode) + "]";
+	bool found = false;
+
+	DIR *dir = opendir(fdPath.c_str());
+	if (dir == NULL)
+		return false;
+
+	struct dirent *entry;
+	while (!found && (entry = readdir(dir)) != NULL)
+	{
+		char target[64];
+		ssize_t length = readlinkat(dirfd(dir), entry->d_name, target, sizeof(target) - 1);
+		if (length > 0)
+		{
+			target[length] = '\0';
+			found = (expected == target);
+		}
+	}
+
+	closedir(dir);
+	return found;
+}
+
+// A plugin running on the same host offers a shared memory transport in its registration message.
+// The file descriptors of the offer are duplicated into this process with pidfd_getfd.  The reply
+// is always sent over the socket, and if the transport is accepted everything after it goes
+// through the rings, so the reply is the last message the plugin reads from the socket.
+// If anything fails the plugin keeps using the socket.
+void PluginConnection::negotiateSharedMemory(IvpMessage *msg)
+{
+	IvpShmOffer offer;
+	if (mShm != NULL || !ivpShm_getOffer(msg, &offer))
+		return;
+
+	// The process ids in the offer only mean something for a plugin on this host, and the
+	// file descriptors are only taken from the process that is actually on the other end
+	struct sockaddr_in peer;
+	socklen_t peerLength = sizeof(peer);
+	if (getpeername(mSocket, (struct sockaddr *)&peer, &peerLength) != 0
+			|| peer.sin_family != AF_INET || (ntohl(peer.sin_addr.s_addr) >> 24) != 127)
+	{
+		// Not on this host, so the socket is used
+	}
+	else if (!isSocketPeer(mSocket, offer.pid))
+	{
+		LOG_WARN("Shared memory offer of " << this->mInfo.pluginInfo.name << " names process " << offer.pid
+				<< ", which is not the peer of the connection");
+	}
+	else
+	{
+		int memFd = shmTransport_importFd(offer.pid, offer.memFd);
+		int toCoreEventFd = shmTransport_importFd(offer.pid, offer.toCoreEventFd);
+		int toPluginEventFd = shmTransport_importFd(offer.pid, offer.toPluginEventFd);
+
+		if (memFd >= 0 && toCoreEventFd >= 0 && toPluginEventFd >= 0)
+		{
+			mShm = shmTransport_attach(memFd, toCoreEventFd, toPluginEventFd);
+		}
+		else
+		{
+			LOG_WARN("Unable to import the shared memory transport of " << this->mInfo.pluginInfo.name << " [" << strerror(errno) << "]");
+			if (memFd >= 0) close(memFd);
+			if (toCoreEventFd >= 0) close(toCoreEventFd);
+			if (toPluginEventFd >= 0) close(toPluginEventFd);
+		}
+	}
+
+	{
+		// No other message may be written to the socket between the reply and the switch to the
+		// ring, or the plugin could handle it at the same time as the first messages from the ring
+		boost::mutex::scoped_lock lock(mMutexSocket);
+
+		IvpMessage *reply = ivpShm_createMsg(mShm != NULL);
+		if (reply)
+		{
+			writeToSocket(reply);
+			ivpMsg_destroy(reply);
+		}
+
+		if (mShm != NULL)
+		{
+			boost::mutex::scoped_lock shmLock(mMutexShm);
+			mShmActive = true;
+		}
+	}
+
+	if (mShm != NULL)
+		mShmReceiverThread = boost::thread(&PluginConnection::shmReceiverThread, this);
+}
+
+void PluginConnection::closeSharedMemory()
+{
+	{
+		boost::mutex::scoped_lock lock(mMutexShm);
+		mShmActive = false;
+	}
+
+	if (mShmReceiverThread.joinable())
+	{
+		mShmReceiverThread.interrupt();
+		mShmReceiverThread.join();
+	}
+
+	if (mShm != NULL)
+	{
+		shmTransport_destroy(mShm);
+		mShm = NULL;
+	}
+}
+
 void PluginConnection::processSubscribeMessage(IvpMessage *msg)
 {
 	vector<MessageFilterEntry> filterEntries;
@@ -28,6 +28,7 @@
 #include "utils/AutoResetEvent.h"
 
 #include "Plugin.h"
+#include "tmx/utils/ShmTransport.h"
 #include <set>
 
 class PluginConnection : public Plugin
@@ -42,9 +43,15 @@ protected:
 
 private:
 	void receiverThread(void);
+	void shmReceiverThread(void);
 	void fastProcessorThread(void);
 	void slowProcessorThread(void);
 
+	void queueMessage(IvpMessage *msg);
+	void writeToSocket(IvpMessage *msg);
+	void negotiateSharedMemory(IvpMessage *msg);
+	void closeSharedMemory();
+
 	void processRegistrationMessage(IvpMessage *msg);
 	void processSubscribeMessage(IvpMessage *msg);
 	void processConfigMessage(IvpMessage *msg);
@@ -52,10 +59,21 @@ private:
 	void processEventLogMessage(IvpMessage *msg);
 
 	boost::thread mReceiverThread;
+	boost::thread mShmReceiverThread;
 	boost::thread mFastProcessorThread;
 	boost::thread mSlowProcessorThread;
 	int mSocket;
 
+	// Held while writing to the socket, so writes from different threads do not interleave.
+	boost::mutex mMutexSocket;
+
+	// The shared memory transport, when the plugin offered one and it could be mapped.
+	// The socket stays open to detect when the plugin goes away.
+	boost::mutex mMutexShm;
+	ShmTransport *mShm;
+	volatile bool mShmActive;
+	uint64_t mShmFullCount;
+
 	AutoResetEvent mEventContinueFastProcessor;
 	boost::mutex mMutexFastMessageQueue;
 	std::queue<IvpMessage*> mFastMessageQueue;
@@ -11,6 +11,7 @@
 #include "PluginConnection.h"
 #include "PluginMonitor.h"
 #include "MessageProfiler.h"
+#include "MessageRecorder.h"
 #include "logger.h"
 #include "HistoryManager.h"
 
@@ -170,6 +171,7 @@ int main()
 	PluginServer pluginServer(&messageRouter);
 	PluginMonitor pluginMonitor(&messageRouter);
 	MessageProfiler messageProfiler(&messageRouter);
+	MessageRecorder messageRecorder(&messageRouter);
 	HistoryManager historyManager(&messageRouter);
 
 	while(1) {
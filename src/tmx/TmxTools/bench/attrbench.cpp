@@ -0,0 +1,210 @@
+/*
+ * attrbench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <tmx/tmx.h>
+#include <DeadlineTimer.h>
+#include <DecodedBsmMessage.h>
+#include <PluginExec.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+namespace attrbench
+{
+
+template <typename Type>
+using ptree_attribute = battelle::attributes::standard_attribute<Type, battelle::attributes::standard_ptree_backend>;
+
+#define ptree_std_attribute(C, X, Y, D, L) \
+	rw_attribute(C, ptree_attribute<Y>, X, Y, get_, D, set_, L)
+
+/**
+ * The attributes of DecodedBsmMessage, kept in the property tree of a ptree backed container
+ * as every message did before the struct backend.
+ */
+class PtreeBsmMessage
+{
+public:
+	typedef battelle::attributes::ptree_backed_attribute_container container_type;
+
+	ptree_std_attribute(this->msg, uint8_t, MsgCount, 0, )
+	ptree_std_attribute(this->msg, int32_t, TemporaryId, 0, )
+	ptree_std_attribute(this->msg, double, Latitude, 0.0, )
+	ptree_std_attribute(this->msg, double, Longitude, 0.0, )
+	ptree_std_attribute(this->msg, double, Elevation_m, 0.0, )
+	ptree_std_attribute(this->msg, double, Speed, 0.0, )
+	ptree_std_attribute(this->msg, double, Heading, 0.0, )
+	ptree_std_attribute(this->msg, double, SteeringWheelAngle, 0.0, )
+	ptree_std_attribute(this->msg, uint16_t, SecondMark, 0, )
+	ptree_std_attribute(this->msg, bool, IsOutgoing, false, )
+	ptree_std_attribute(this->msg, bool, IsLocationValid, false, )
+	ptree_std_attribute(this->msg, bool, IsElevationValid, false, )
+	ptree_std_attribute(this->msg, bool, IsSpeedValid, false, )
+	ptree_std_attribute(this->msg, bool, IsHeadingValid, false, )
+	ptree_std_attribute(this->msg, bool, IsSteeringWheelAngleValid, false, )
+
+	/**
+	 * Serialize the same way as tmx::message, from a copy of the container
+	 */
+	std::string to_string()
+	{
+		container_type copy(msg);
+		std::stringstream ss;
+		copy.save<battelle::attributes::JSON>(ss);
+		return ss.str();
+	}
+
+private:
+	container_type msg;
+};
+
+/**
+ * Measures the cost of the attribute getters and setters, and of building a message and
+ * serializing it to JSON, for a BSM whose attributes are kept in the property tree and one
+ * whose attributes are native fields of the struct backend.
+ */
+class AttrBench: public Runnable
+{
+public:
+	AttrBench(): Runnable(INPUT_FILES_PARAM, "Unused")
+	{
+		AddOptions()
+			("count,n", boost::program_options::value<uint32_t>()->default_value(200000), "Number of messages for each test.");
+	}
+
+	inline int Main()
+	{
+		// Both backends must produce the same JSON
+		PtreeBsmMessage ptreeMsg;
+		DecodedBsmMessage structMsg;
+		Fill(ptreeMsg, 1);
+		Fill(structMsg, 1);
+
+		string ptreeJson = ptreeMsg.to_string();
+		string structJson = structMsg.to_string();
+		if (ptreeJson != structJson)
+		{
+			cerr << "JSON differs:" << endl << ptreeJson << endl << structJson << endl;
+			return -1;
+		}
+
+		cout << left << setw(10) << "Backend" << right << setw(14) << "set ns/msg" << setw(14) << "get ns/msg" <<
+				setw(16) << "new+set+JSON ns" << endl;
+
+		Run<PtreeBsmMessage>("ptree");
+		Run<DecodedBsmMessage>("struct");
+
+		return 0;
+	}
+
+	inline bool ProcessOptions(const boost::program_options::variables_map &opts)
+	{
+		Runnable::ProcessOptions(opts);
+
+		count = opts["count"].as<uint32_t>();
+		return count > 0;
+	}
+
+private:
+	template <typename MsgType>
+	static void Fill(MsgType &msg, uint32_t i)
+	{
+		msg.set_MsgCount(i % 128);
+		msg.set_TemporaryId(i);
+		msg.set_Latitude(38.9548 + (i % 100) * 0.0001);
+		msg.set_Longitude(-77.1481 + (i % 100) * 0.0001);
+		msg.set_Elevation_m(100.5);
+		msg.set_Speed(10 + i % 20);
+		msg.set_Heading(i % 360);
+		msg.set_SteeringWheelAngle(0);
+		msg.set_SecondMark((i * 100) % 60000);
+		msg.set_IsOutgoing(false);
+		msg.set_IsLocationValid(true);
+		msg.set_IsElevationValid(true);
+		msg.set_IsSpeedValid(true);
+		msg.set_IsHeadingValid(true);
+		msg.set_IsSteeringWheelAngleValid(false);
+	}
+
+	template <typename MsgType>
+	static double Read(MsgType &msg)
+	{
+		double sum = msg.get_MsgCount() + msg.get_TemporaryId() + msg.get_SecondMark();
+		sum += msg.get_Latitude() + msg.get_Longitude() + msg.get_Elevation_m();
+		sum += msg.get_Speed() + msg.get_Heading() + msg.get_SteeringWheelAngle();
+		sum += msg.get_IsOutgoing() + msg.get_IsLocationValid() + msg.get_IsElevationValid();
+		sum += msg.get_IsSpeedValid() + msg.get_IsHeadingValid() + msg.get_IsSteeringWheelAngleValid();
+		return sum;
+	}
+
+	template <typename MsgType>
+	void Run(const char *name)
+	{
+		MsgType msg;
+		double sum = 0;
+		size_t length = 0;
+
+		chrono::nanoseconds start = DeadlineTimer::Now();
+		for (uint32_t i = 0; i < count; i++)
+			Fill(msg, i);
+		double setNs = (DeadlineTimer::Now() - start).count() / (double)count;
+
+		// Every set changes the message, so each pass reads the new values
+		start = DeadlineTimer::Now();
+		for (uint32_t i = 0; i < count; i++)
+		{
+			msg.set_TemporaryId(i);
+			sum += Read(msg);
+		}
+		double getNs = (DeadlineTimer::Now() - start).count() / (double)count;
+
+		// As a plugin sends a message, create it, fill it in and serialize it
+		start = DeadlineTimer::Now();
+		for (uint32_t i = 0; i < count; i++)
+		{
+			MsgType newMsg;
+			Fill(newMsg, i);
+			length += newMsg.to_string().size();
+		}
+		double serializeNs = (DeadlineTimer::Now() - start).count() / (double)count;
+
+		cout << left << setw(10) << name << right << fixed << setprecision(0) << setw(14) << setNs <<
+				setw(14) << getNs << setw(16) << serializeNs << endl;
+
+		// Keep the results, so the loops are not optimized away
+		if (sum < 0 || length == 0)
+			cerr << sum << length << endl;
+	}
+
+	uint32_t count = 200000;
+};
+
+} /* End namespace */
+
+int main(int argc, char *argv[])
+{
+	FILELog::ReportingLevel() = logERROR;
+
+	try
+	{
+		attrbench::AttrBench myExec;
+		return run("", argc, argv, myExec);
+	}
+	catch (exception &ex)
+	{
+		cerr << ExceptionToString(ex) << endl;
+		throw;
+	}
+}
@@ -0,0 +1,203 @@
+/*
+ * j2735bench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <tmx/tmx.h>
+#include <tmx/j2735_messages/J2735DecodeService.hpp>
+#include <tmx/j2735_messages/J2735MessageFactory.hpp>
+#include <BsmConverter.h>
+#include <DeadlineTimer.h>
+#include <DecodedBsmMessage.h>
+#include <PluginExec.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+// Count every heap allocation, to show how many each decode costs
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static uint64_t allocations = 0;
+
+extern "C" void *malloc(size_t size)
+{
+	allocations++;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+	allocations++;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+	allocations++;
+	return __libc_realloc(ptr, size);
+}
+
+namespace j2735bench
+{
+
+/**
+ * Measures how many BSMs a single thread decodes per second, from the encoded bytes to the
+ * BasicSafetyMessage structure, with the decode and free done on the heap by TmxJ2735Codec and
+ * with the arenas of J2735DecodeService.  The target is 100,000 per second on one core.
+ */
+class J2735Bench: public Runnable
+{
+public:
+	J2735Bench(): Runnable(INPUT_FILES_PARAM, "Unused")
+	{
+		AddOptions()
+			("count,n", boost::program_options::value<uint32_t>()->default_value(1000000), "Number of BSMs to decode for each test.")
+			("vehicles,v", boost::program_options::value<uint32_t>()->default_value(1000), "Number of different BSMs to cycle through.")
+			("target,t", boost::program_options::value<uint32_t>()->default_value(100000), "Decodes per second to reach.");
+	}
+
+	inline int Main()
+	{
+		if (!BuildBsms())
+		{
+			cerr << "Unable to build the BSMs" << endl;
+			return -1;
+		}
+
+		cout << left << setw(10) << "Decoder" << right << setw(14) << "BSM/s" << setw(14) << "allocs/BSM" << setw(12) << "decoded" << endl;
+
+		Run("heap", false);
+		double perSecond = Run("arena", true);
+
+		cout << (perSecond >= target ? "PASS" : "FAIL") << ": " << fixed << setprecision(0) << perSecond <<
+				" BSM/s with the arena, target " << target << endl;
+
+		return perSecond >= target ? 0 : 1;
+	}
+
+	inline bool ProcessOptions(const boost::program_options::variables_map &opts)
+	{
+		Runnable::ProcessOptions(opts);
+
+		count = opts["count"].as<uint32_t>();
+		vehicles = opts["vehicles"].as<uint32_t>();
+		target = opts["target"].as<uint32_t>();
+
+		return count > 0 && vehicles > 0;
+	}
+
+private:
+	bool BuildBsms()
+	{
+		for (uint32_t i = 0; i < vehicles; i++)
+		{
+			DecodedBsmMessage decoded;
+			decoded.set_TemporaryId(i + 1);
+			decoded.set_MsgCount(i % 128);
+			decoded.set_SecondMark((i * 100) % 60000);
+			decoded.set_Latitude(38.9548 + (i % 100) * 0.0001);
+			decoded.set_Longitude(-77.1481 + (i / 100) * 0.0001);
+			decoded.set_IsLocationValid(true);
+			decoded.set_Elevation_m(100);
+			decoded.set_IsElevationValid(true);
+			decoded.set_Speed_mps(10 + i % 20);
+			decoded.set_IsSpeedValid(true);
+			decoded.set_Heading(i % 360);
+			decoded.set_IsHeadingValid(true);
+
+			BasicSafetyMessage *bsm = (BasicSafetyMessage *)calloc(1, sizeof(BasicSafetyMessage));
+			if (!bsm)
+				return false;
+			BsmConverter::ToBasicSafetyMessage(decoded, *bsm);
+
+			// Note that this constructor assumes control of cleaning up the J2735 structure pointer
+			BsmMessage bsmMsg(bsm);
+			BsmEncodedMessage encoded;
+			encoded.initialize(bsmMsg);
+
+			bsms.push_back(encoded.get_payload_bytes());
+		}
+
+		return true;
+	}
+
+	double Run(const char *name, bool arena)
+	{
+		J2735DecodeService &service = J2735DecodeService::get_instance();
+		ASN1_CODEC<MessageFrameMessage> codec;
+
+		// Warm up, which also takes the arena for this thread
+		service.DecodeAll(bsms, [](size_t, J2735DecodeService::frame_type *) {});
+
+		uint64_t decoded = 0;
+		uint64_t startAllocations = allocations;
+		chrono::nanoseconds start = DeadlineTimer::Now();
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const byte_stream &bytes = bsms[i % bsms.size()];
+
+			if (arena)
+			{
+				BasicSafetyMessage *bsm = service.Decode<BsmMessage>(bytes);
+				if (bsm && bsm->coreData.msgCnt >= 0)
+					decoded++;
+				service.Reset();
+			}
+			else
+			{
+				MessageFrameMessage::message_type *frame = NULL;
+				asn_dec_rval_t rval = codec.decode((void **)&frame, bytes);
+				BasicSafetyMessage *bsm = rval.code == RC_OK ?
+						j2735::j2735_cast<BasicSafetyMessage>(frame) : NULL;
+				if (bsm && bsm->coreData.msgCnt >= 0)
+					decoded++;
+				ASN_STRUCT_FREE(*MessageFrameMessage::get_descriptor(), frame);
+			}
+		}
+
+		double elapsed = (DeadlineTimer::Now() - start).count() / 1000000000.0;
+		double perSecond = elapsed > 0 ? count / elapsed : 0;
+
+		cout << left << setw(10) << name << right << fixed << setprecision(0) << setw(14) << perSecond <<
+				setprecision(1) << setw(14) << (double)(allocations - startAllocations) / count << setw(12) << decoded << endl;
+
+		return perSecond;
+	}
+
+	uint32_t count = 1000000;
+	uint32_t vehicles = 1000;
+	uint32_t target = 100000;
+	vector<byte_stream> bsms;
+};
+
+} /* End namespace */
+
+int main(int argc, char *argv[])
+{
+	FILELog::ReportingLevel() = logERROR;
+
+	try
+	{
+		j2735bench::J2735Bench myExec;
+		return run("", argc, argv, myExec);
+	}
+	catch (exception &ex)
+	{
+		cerr << ExceptionToString(ex) << endl;
+		throw;
+	}
+}
@@ -0,0 +1,314 @@
+/*
+ * rxbench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <tmx/tmx.h>
+#include <tmx/IvpMessage.h>
+#include <tmx/TmxApiMessages.h>
+#include <tmx/messages/routeable_message.hpp>
+#include <tmx/utils/MsgArena.h>
+#include <tmx/utils/MsgFramer.h>
+#include <DeadlineTimer.h>
+#include <LocationMessage.h>
+#include <MessageDispatcher.h>
+#include <PluginExec.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+// Count every heap allocation, to show how many each received message costs
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static uint64_t allocations = 0;
+
+extern "C" void *malloc(size_t size)
+{
+	allocations++;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+	allocations++;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+	allocations++;
+	return __libc_realloc(ptr, size);
+}
+
+namespace rxbench
+{
+
+/**
+ * A handler that builds the typed payload, as PluginClient does for a registered handler.
+ */
+template <typename MsgType>
+class Handler: public MessageDispatcher::handler
+{
+public:
+	string get_messageType()
+	{
+		return battelle::attributes::type_id_name<MsgType>();
+	}
+
+	void invokeHandler(routeable_message &routeableMsg)
+	{
+		MsgType msg = routeableMsg.get_payload<MsgType>();
+		handled++;
+	}
+
+	uint64_t handled = 0;
+};
+
+/**
+ * A handler for encoded J2735 messages, which only takes the bytes before decoding them.
+ */
+template <>
+void Handler<byte_stream>::invokeHandler(routeable_message &routeableMsg)
+{
+	byte_stream bytes = routeableMsg.get_payload_bytes();
+	handled += !bytes.empty();
+}
+
+/**
+ * A handler that takes a view of the message, and decodes the payload bytes into one buffer.
+ */
+class ViewHandler: public MessageDispatcher::handler
+{
+public:
+	string get_messageType()
+	{
+		return "view";
+	}
+
+	void invokeHandler(routeable_message &routeableMsg)
+	{
+		dispatch(MessageView(routeableMsg.get_message()));
+	}
+
+	void dispatch(const MessageView &view)
+	{
+		handled += view.get_payload_bytes(bytes);
+	}
+
+	uint64_t handled = 0;
+	byte_stream bytes;
+};
+
+/**
+ * Measures the receive path of a plugin, from the framed JSON read from the ivpcore socket to
+ * the typed message handler, for a stream of BSMs, locations and a type without a handler.
+ *
+ * The original path parses each message onto the heap, always builds a routeable message and
+ * finds the handler in an ordered map of type and subtype strings.  The pooled path decodes into
+ * an arena and finds the handler in the hash table of MessageDispatcher, which only builds the
+ * routeable message when there is a handler.  The view path is the pooled path with the BSM
+ * handler taking a view of the message, registered under an ID computed at compile time.
+ */
+class RxBench: public Runnable
+{
+public:
+	RxBench(): Runnable(INPUT_FILES_PARAM, "Unused")
+	{
+		AddOptions()
+			("count,n", boost::program_options::value<uint32_t>()->default_value(100000), "Number of messages for each test.")
+			("unhandled", boost::program_options::value<uint32_t>()->default_value(50), "Percent of the messages that have no handler.");
+	}
+
+	inline int Main()
+	{
+		BuildStream();
+
+		cout << left << setw(10) << "Path" << right << setw(14) << "msg/s" << setw(14) << "allocs/msg" << setw(12) << "handled" << endl;
+
+		Run("original", Original);
+		Run("pooled", Pooled);
+		Run("view", View);
+
+		return 0;
+	}
+
+	inline bool ProcessOptions(const boost::program_options::variables_map &opts)
+	{
+		Runnable::ProcessOptions(opts);
+
+		count = opts["count"].as<uint32_t>();
+		unhandled = std::min(opts["unhandled"].as<uint32_t>(), 100u);
+
+		return count > 0;
+	}
+
+private:
+	enum Path { Original, Pooled, View };
+
+	void Add(routeable_message &msg)
+	{
+		char *json = ivpMsg_createJsonString(const_cast<IvpMessage *>(msg.get_message()), IvpMsg_FormatOptions_none);
+		int framedLength;
+		char *framed = msgFramer_createFramedMsg(json, strlen(json), &framedLength);
+		stream.append(framed, framedLength);
+		free(framed);
+		free(json);
+	}
+
+	void BuildStream()
+	{
+		for (uint32_t i = 0; i < 100; i++)
+		{
+			routeable_message msg;
+
+			if (i < unhandled)
+			{
+				// A type that is subscribed to, but handled by overriding OnMessageReceived
+				msg.set_type(tmx::messages::api::MSGSUBTYPE_J2735_STRING);
+				msg.set_subtype("SPAT-P");
+				msg.set_encoding(IVP_ENCODING_ASN1_UPER);
+				msg.set_payload(string(200, 'A'));
+			}
+			else if (i % 2)
+			{
+				msg.set_type(tmx::messages::api::MSGSUBTYPE_J2735_STRING);
+				msg.set_subtype("BSM");
+				msg.set_encoding(IVP_ENCODING_ASN1_UPER);
+				msg.set_payload(string("0014250B2A0F6A46CD7F2A5E0FFFFFFFFF000000FFFFFFF07D7FFF8000000000000000000000"));
+			}
+			else
+			{
+				LocationMessage location;
+				location.set_Id("GPS");
+				location.set_Latitude(38.955 + i / 1e5);
+				location.set_Longitude(-77.149 - i / 1e5);
+				location.set_NumSatellites(9);
+				location.set_HorizontalDOP(0.8);
+				location.set_Speed(13.2);
+				location.set_Heading(271.5);
+				msg.initialize(location);
+			}
+
+			msg.set_source("rxbench");
+			Add(msg);
+		}
+	}
+
+	void Run(const char *name, Path path)
+	{
+		static constexpr message_id bsmId = MessageId(tmx::messages::api::MSGSUBTYPE_J2735_STRING, "BSM");
+
+		Handler<byte_stream> bsmHandler;
+		ViewHandler bsmViewHandler;
+		Handler<LocationMessage> locationHandler;
+		bool pooled = (path != Original);
+
+		// The previous handler table of PluginClient
+		map<pair<string, string>, MessageDispatcher::handler *> handlerMap;
+		handlerMap[pair<string, string>(tmx::messages::api::MSGSUBTYPE_J2735_STRING, "BSM")] = &bsmHandler;
+		handlerMap[pair<string, string>(LocationMessage::MessageType, LocationMessage::MessageSubType)] = &locationHandler;
+
+		MessageDispatcher dispatcher;
+		if (path == View)
+			dispatcher.Register(bsmId, tmx::messages::api::MSGSUBTYPE_J2735_STRING, "BSM", &bsmViewHandler);
+		else
+			dispatcher.Register(tmx::messages::api::MSGSUBTYPE_J2735_STRING, "BSM", &bsmHandler);
+		dispatcher.Register(LocationMessage::MessageType, LocationMessage::MessageSubType, &locationHandler);
+
+		MsgArena *arena = pooled ? msgArena_acquire() : NULL;
+		MsgFramer framer = MSG_FRAMER_INITIALIZER;
+
+		uint32_t received = 0;
+		size_t pos = 0;
+		uint64_t startAllocations = allocations;
+		chrono::nanoseconds start = DeadlineTimer::Now();
+
+		while (received < count)
+		{
+			// Copy in the bytes as a recv() on the socket would
+			size_t length = std::min((size_t)msgFramer_getBufLength(&framer), std::min((size_t)4096, stream.size() - pos));
+			memcpy(msgFramer_getBuf(&framer), stream.data() + pos, length);
+			msgFramer_incrementBufPos(&framer, length);
+			pos = (pos + length) % stream.size();
+
+			char *raw;
+			while (received < count && (raw = msgFramer_getNextMsg(&framer)) != NULL)
+			{
+				received++;
+
+				if (pooled)
+				{
+					MsgArena *previous = msgArena_use(arena);
+					IvpMessage *msg = ivpMsg_parse(raw);
+					msgArena_use(previous);
+
+					if (msg)
+					{
+						dispatcher.Dispatch(msg);
+						ivpMsg_destroy(msg);
+					}
+
+					msgArena_reset(arena);
+				}
+				else
+				{
+					IvpMessage *msg = ivpMsg_parse(raw);
+					if (msg)
+					{
+						routeable_message routeableMsg(msg);
+						MessageDispatcher::handler *h = handlerMap[pair<string, string>(routeableMsg.get_type(), routeableMsg.get_subtype())];
+						if (h)
+							h->invokeHandler(routeableMsg);
+						ivpMsg_destroy(msg);
+					}
+				}
+			}
+		}
+
+		double elapsed = (DeadlineTimer::Now() - start).count() / 1000000000.0;
+		double perMessage = (double)(allocations - startAllocations) / received;
+
+		msgArena_release(arena);
+
+		cout << left << setw(10) << name << right << fixed << setprecision(0) << setw(14) << (elapsed > 0 ? received / elapsed : 0) <<
+				setprecision(1) << setw(14) << perMessage << setw(12) << bsmHandler.handled + bsmViewHandler.handled + locationHandler.handled << endl;
+	}
+
+	uint32_t count = 100000;
+	uint32_t unhandled = 50;
+	string stream;
+};
+
+} /* End namespace */
+
+int main(int argc, char *argv[])
+{
+	FILELog::ReportingLevel() = logERROR;
+
+	try
+	{
+		rxbench::RxBench myExec;
+		return run("", argc, argv, myExec);
+	}
+	catch (exception &ex)
+	{
+		cerr << ExceptionToString(ex) << endl;
+		throw;
+	}
+}
@@ -0,0 +1,320 @@
+/*
+ * shmbench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <tmx/tmx.h>
+#include <tmx/IvpMessage.h>
+#include <tmx/utils/MsgFramer.h>
+#include <tmx/utils/ShmTransport.h>
+#include <DeadlineTimer.h>
+#include <PercentileStatistics.h>
+#include <PluginExec.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::utils;
+
+namespace shmbench
+{
+
+/**
+ * One side of a connection between a plugin and ivpcore, either a loopback TCP socket using the
+ * framed JSON messages of the plugin API or a pair of shared memory rings using the binary form.
+ */
+class Channel
+{
+public:
+	virtual ~Channel() { }
+	virtual bool Send(IvpMessage *msg) = 0;
+	virtual IvpMessage *Receive() = 0;
+};
+
+class TcpChannel: public Channel
+{
+public:
+	TcpChannel(int fd): _fd(fd) { }
+	~TcpChannel() { close(_fd); }
+
+	bool Send(IvpMessage *msg)
+	{
+		char *json = ivpMsg_createJsonString(msg, IvpMsg_FormatOptions_none);
+		if (!json)
+			return false;
+
+		int framedLength;
+		char *framed = msgFramer_createFramedMsg(json, strlen(json), &framedLength);
+		free(json);
+		if (!framed)
+			return false;
+
+		bool results = send(_fd, framed, framedLength, MSG_NOSIGNAL) == framedLength;
+		free(framed);
+		return results;
+	}
+
+	IvpMessage *Receive()
+	{
+		char *raw;
+		while ((raw = msgFramer_getNextMsg(&_framer)) == NULL)
+		{
+			int count = recv(_fd, msgFramer_getBuf(&_framer), msgFramer_getBufLength(&_framer), 0);
+			if (count <= 0)
+				return NULL;
+			msgFramer_incrementBufPos(&_framer, count);
+		}
+
+		return ivpMsg_parse(raw);
+	}
+
+private:
+	int _fd;
+	MsgFramer _framer = MSG_FRAMER_INITIALIZER;
+};
+
+class ShmChannel: public Channel
+{
+public:
+	ShmChannel(ShmRing *out, ShmRing *in): _out(out), _in(in) { }
+
+	bool Send(IvpMessage *msg)
+	{
+		return shmTransport_sendWait(_out, msg, 1000) == 0;
+	}
+
+	IvpMessage *Receive()
+	{
+		return shmTransport_receive(_in, 1000);
+	}
+
+private:
+	ShmRing *_out;
+	ShmRing *_in;
+};
+
+/**
+ * Compares the latency and throughput of the loopback TCP transport that plugins use today
+ * with the shared memory transport, for messages the size of a BSM and of a MAP.
+ *
+ * The latency is the round trip of a message that is echoed back by a second thread acting as
+ * ivpcore, which parses each message and serializes it again just like the core does.  The
+ * throughput is the rate at which the second thread can consume a one way stream of messages.
+ */
+class ShmBench: public Runnable
+{
+public:
+	ShmBench(): Runnable(INPUT_FILES_PARAM, "Unused")
+	{
+		AddOptions()
+			("count,n", boost::program_options::value<uint32_t>()->default_value(20000), "Number of messages for each test.")
+			("sizes", boost::program_options::value<string>()->default_value("40,1500"), "Comma separated payload sizes to test, in bytes of UPER.");
+	}
+
+	inline int Main()
+	{
+		cout << left << setw(6) << "Trans" << right << setw(8) << "Bytes" << setw(12) << "P50 us" << setw(12) << "P99 us" <<
+				setw(12) << "Max us" << setw(14) << "msg/s" << endl;
+
+		for (size_t size : sizes)
+		{
+			// The payload is binary, so it goes over the TCP transport as a hex string and over
+			// the shared memory transport as it is
+			vector<uint8_t> bytes(size);
+			for (size_t i = 0; i < bytes.size(); i++)
+				bytes[i] = (uint8_t)(i * 7);
+
+			IvpMessage *msg = ivpMsg_create("J2735", size < 500 ? "BSM" : "MAP",
+					IVP_ENCODING_ASN1_UPER, IvpMsgFlags_None, NULL);
+			ivpMsg_setPayloadBytes(msg, bytes.data(), bytes.size());
+
+			if (!RunTcp(msg) || !RunShm(msg))
+			{
+				ivpMsg_destroy(msg);
+				return -1;
+			}
+
+			ivpMsg_destroy(msg);
+		}
+
+		return 0;
+	}
+
+	inline bool ProcessOptions(const boost::program_options::variables_map &opts)
+	{
+		Runnable::ProcessOptions(opts);
+
+		count = opts["count"].as<uint32_t>();
+
+		sizes.clear();
+		stringstream ss(opts["sizes"].as<string>());
+		string item;
+		while (getline(ss, item, ','))
+		{
+			size_t size = strtoul(item.c_str(), NULL, 10);
+			if (size > 0)
+				sizes.push_back(size);
+		}
+
+		return count > 0 && !sizes.empty();
+	}
+
+private:
+	bool RunTcp(IvpMessage *msg)
+	{
+		int listener = socket(AF_INET, SOCK_STREAM, 0);
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t addrLength = sizeof(addr);
+
+		if (listener < 0 || ::bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+				listen(listener, 1) != 0 || getsockname(listener, (struct sockaddr *)&addr, &addrLength) != 0)
+		{
+			cerr << "Unable to listen on the loopback interface: " << strerror(errno) << endl;
+			if (listener >= 0)
+				close(listener);
+			return false;
+		}
+
+		int client = socket(AF_INET, SOCK_STREAM, 0);
+		if (connect(client, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+		{
+			cerr << "Unable to connect on the loopback interface: " << strerror(errno) << endl;
+			close(client);
+			close(listener);
+			return false;
+		}
+
+		int server = accept(listener, NULL, NULL);
+		close(listener);
+
+		// Plugin connections send small messages that should not wait for more data
+		int on = 1;
+		setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+		setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+		TcpChannel pluginSide(client);
+		TcpChannel coreSide(server);
+		Run("tcp", msg, pluginSide, coreSide, coreSide, pluginSide);
+		return true;
+	}
+
+	bool RunShm(IvpMessage *msg)
+	{
+		ShmTransport *transport = shmTransport_create(SHM_TRANSPORT_DEFAULT_RING_SIZE);
+		if (!transport)
+		{
+			cerr << "Unable to create the shared memory transport: " << strerror(errno) << endl;
+			return false;
+		}
+
+		ShmChannel pluginToCore(&transport->toCore, &transport->toPlugin);
+		ShmChannel coreToPlugin(&transport->toPlugin, &transport->toCore);
+		Run("shm", msg, pluginToCore, coreToPlugin, coreToPlugin, pluginToCore);
+
+		shmTransport_destroy(transport);
+		return true;
+	}
+
+	void Run(const char *name, IvpMessage *msg, Channel &pluginSend, Channel &coreReceive, Channel &coreSend, Channel &pluginReceive)
+	{
+		PercentileStatistics latency(count);
+
+		// Round trip latency, one message in flight at a time
+		thread echo([&]()
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				IvpMessage *in = coreReceive.Receive();
+				if (!in)
+					break;
+				coreSend.Send(in);
+				ivpMsg_destroy(in);
+			}
+		});
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			chrono::nanoseconds start = DeadlineTimer::Now();
+			if (!pluginSend.Send(msg))
+				break;
+
+			IvpMessage *reply = pluginReceive.Receive();
+			if (!reply)
+				break;
+
+			latency.Add((DeadlineTimer::Now() - start).count() / 1000.0);
+			ivpMsg_destroy(reply);
+		}
+
+		echo.join();
+
+		// Throughput of a one way stream
+		atomic<uint32_t> received(0);
+		chrono::nanoseconds start = DeadlineTimer::Now();
+
+		thread sink([&]()
+		{
+			while (received < count)
+			{
+				IvpMessage *in = coreReceive.Receive();
+				if (!in)
+					break;
+				ivpMsg_destroy(in);
+				received++;
+			}
+		});
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (!pluginSend.Send(msg))
+				break;
+		}
+
+		sink.join();
+		double elapsed = (DeadlineTimer::Now() - start).count() / 1000000000.0;
+
+		cout << left << setw(6) << name << right << setw(8) << msg->payloadLength << fixed << setprecision(1) <<
+				setw(12) << latency.Percentile(50) << setw(12) << latency.Percentile(99) << setw(12) << latency.Max() <<
+				setprecision(0) << setw(14) << (elapsed > 0 ? received / elapsed : 0) << endl;
+	}
+
+	uint32_t count = 20000;
+	vector<size_t> sizes;
+};
+
+} /* End namespace */
+
+int main(int argc, char *argv[])
+{
+	FILELog::ReportingLevel() = logERROR;
+
+	try
+	{
+		shmbench::ShmBench myExec;
+		return run("", argc, argv, myExec);
+	}
+	catch (exception &ex)
+	{
+		cerr << ExceptionToString(ex) << endl;
+		throw;
+	}
+}
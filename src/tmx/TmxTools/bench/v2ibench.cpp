@@ -0,0 +1,452 @@
+/*
+ * v2ibench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <tmx/tmx.h>
+#include <tmx/IvpPlugin.h>
+#include <tmx/j2735_messages/J2735MessageFactory.hpp>
+#include <BsmConverter.h>
+#include <DeadlineTimer.h>
+#include <DecodedBsmMessage.h>
+#include <FlightRecorder.h>
+#include <PercentileStatistics.h>
+#include <PluginExec.h>
+#include <UdpClient.h>
+#include <UdpServer.h>
+
+#include "../src/ToolPlugin.h"
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+namespace v2ibench
+{
+
+/**
+ * The times that a single generated message was seen at each point of the pipeline,
+ * in nanoseconds on the monotonic clock.  Zero means the message was never seen there.
+ */
+struct Sample
+{
+	int64_t sent = 0;
+	int64_t routed = 0;
+	int64_t forwarded = 0;
+};
+
+/**
+ * All the messages sent with the same payload, in the order they were sent, and how many
+ * of them have been seen at each point of the pipeline so far.
+ */
+struct Pending
+{
+	vector<size_t> indices;
+	size_t routed = 0;
+	size_t forwarded = 0;
+};
+
+static int64_t Now()
+{
+	return DeadlineTimer::Now().count();
+}
+
+/**
+ * Pushes J2735 payloads into the MessageReceiver plugin UDP port at a fixed rate and
+ * measures how long each one takes to reach the ivpcore router, and then to come out of
+ * the DSRC Message Manager plugin into a local UDP sink that stands in for the radio.
+ *
+ * For the full chain to be measured, MessageReceiver must have RouteDSRC set to true and
+ * the DSRC Message Manager must forward BSMs to the sink address, for example:
+ * 		Messages_Destination_1 = { "Messages": [ { "TmxType": "BSM", "SendType": "BSM", "PSID": "0x20" } ] }
+ * 		Destination_1 = 127.0.0.1:4589
+ */
+class V2IBench: public Runnable
+{
+public:
+	V2IBench(): Runnable(INPUT_FILES_PARAM, "Flight recorder directory to take J2735 payloads from, instead of synthetic BSMs")
+	{
+		AddOptions()
+			("target", boost::program_options::value<string>()->default_value("127.0.0.1:26789"), "Address and port of the MessageReceiver plugin.")
+			("sink", boost::program_options::value<string>()->default_value("127.0.0.1:4589"), "Address and port to receive the forwarded radio messages on.")
+			("rate,r", boost::program_options::value<double>()->default_value(1000), "Total messages per second to send.")
+			("vehicles,v", boost::program_options::value<unsigned int>()->default_value(100), "Number of simulated vehicles.")
+			("duration,d", boost::program_options::value<double>()->default_value(10), "Seconds to send for.")
+			("drain", boost::program_options::value<double>()->default_value(2), "Seconds to wait for outstanding messages after sending stops.")
+			("no-tap", "Do not register with ivpcore to time the router stage.")
+			("manifest,m", boost::program_options::value<string>()->default_value(""), "Plugin manifest used to register with ivpcore.  By default a minimal manifest is generated.");
+	}
+
+	inline int Main()
+	{
+		if (!BuildPayloads())
+			return -1;
+
+		size_t count = _payloads.size();
+		_samples.resize(count);
+		for (size_t i = 0; i < count; i++)
+			_pending[_payloads[i].second].indices.push_back(i);
+
+		cout << "Sending " << count << " messages from " << (recording.empty() ? to_string(vehicles) + " vehicles" : recording) <<
+				" at " << rate << " msg/s to " << target << endl;
+
+		IvpPlugin *plugin = NULL;
+		if (tap && !(plugin = Connect()))
+			return -1;
+
+		unique_ptr<UdpClient> client;
+		unique_ptr<UdpServer> server;
+		try
+		{
+			client.reset(new UdpClient(Host(target), Port(target)));
+			server.reset(new UdpServer(Host(sink), Port(sink)));
+		}
+		catch (exception &ex)
+		{
+			cerr << ex.what() << endl;
+			if (plugin)
+				ivp_destroy(plugin);
+			return -1;
+		}
+
+		_running = true;
+		thread sinkThread(&V2IBench::SinkLoop, this, server.get());
+
+		DeadlineTimer timer(chrono::nanoseconds((int64_t)(1000000000.0 / rate)));
+		PercentileStatistics lateness(10000);
+		int64_t start = Now();
+
+		for (size_t i = 0; i < count; i++)
+		{
+			lateness.Add(timer.WaitForNextDeadline().count() / 1000000.0);
+
+			_samples[i].sent = Now();
+			if (client->Send((void *)_payloads[i].first.data(), _payloads[i].first.size()) < 0)
+				_sendErrors++;
+		}
+
+		int64_t sendEnd = Now();
+
+		this_thread::sleep_for(chrono::milliseconds((int64_t)(drain * 1000)));
+		_running = false;
+		sinkThread.join();
+
+		if (plugin)
+			ivp_destroy(plugin);
+
+		Report(start, sendEnd, lateness, timer.get_MissedDeadlines());
+		return 0;
+	}
+
+	inline bool ProcessOptions(const boost::program_options::variables_map &opts)
+	{
+		Runnable::ProcessOptions(opts);
+
+		if (opts.count(INPUT_FILES_PARAM))
+		{
+			vector<string> files = opts[INPUT_FILES_PARAM].as< vector<string> >();
+			if (files.size())
+				recording = files[0];
+		}
+
+		target = opts["target"].as<string>();
+		sink = opts["sink"].as<string>();
+		rate = opts["rate"].as<double>();
+		vehicles = opts["vehicles"].as<unsigned int>();
+		duration = opts["duration"].as<double>();
+		drain = opts["drain"].as<double>();
+		manifest = opts["manifest"].as<string>();
+		tap = !opts.count("no-tap");
+
+		return rate > 0 && duration > 0 && vehicles > 0;
+	}
+
+	/// Called from the TMX API thread for every BSM routed by ivpcore
+	void OnRouted(IvpMessage *msg)
+	{
+		// A binary payload from the shared memory transport is compared as its hex string.  The
+		// keys are in lower case, as written by the hex codec, and a JSON peer may use either case.
+		cJSON *payload = ivpMsg_getPayload(msg);
+		if (!payload || payload->type != cJSON_String || !payload->valuestring)
+			return;
+
+		int64_t now = Now();
+
+		string hex(payload->valuestring);
+		transform(hex.begin(), hex.end(), hex.begin(), ::tolower);
+
+		lock_guard<mutex> lock(_lock);
+		auto entry = _pending.find(hex);
+		if (entry == _pending.end())
+			return;
+
+		// Credit the oldest message with this payload that has not yet been routed
+		if (entry->second.routed < entry->second.indices.size())
+			_samples[entry->second.indices[entry->second.routed++]].routed = now;
+	}
+
+private:
+	static string Host(const string &address)
+	{
+		return address.substr(0, address.rfind(':'));
+	}
+
+	static int Port(const string &address)
+	{
+		size_t colon = address.rfind(':');
+		return colon == string::npos ? 0 : atoi(address.substr(colon + 1).c_str());
+	}
+
+	/**
+	 * Build all the payloads before the run, so the cost of encoding does not limit the send rate.
+	 */
+	bool BuildPayloads()
+	{
+		size_t count = (size_t)(rate * duration);
+		_payloads.reserve(count);
+
+		if (!recording.empty())
+		{
+			vector< pair<byte_stream, string> > recorded;
+
+			FlightRecordReader reader(recording);
+			FlightRecord record;
+			while (reader.Next(record))
+			{
+				if (record.get_Type() != api::MSGSUBTYPE_J2735_STRING || record.get_Encoding() != api::ENCODING_ASN1_UPER_STRING)
+					continue;
+
+				// The payload is recorded as a JSON string
+				string hex = record.get_Payload();
+				hex.erase(remove(hex.begin(), hex.end(), '"'), hex.end());
+				transform(hex.begin(), hex.end(), hex.begin(), ::tolower);
+				recorded.push_back(make_pair(byte_stream_decode(hex), hex));
+			}
+
+			if (recorded.empty())
+			{
+				cerr << "No J2735 messages found in " << recording << endl;
+				return false;
+			}
+
+			for (size_t i = 0; i < count; i++)
+				_payloads.push_back(recorded[i % recorded.size()]);
+
+			return true;
+		}
+
+		// Spread the vehicles around a point, each one moving north a little with every message
+		double baseLat = 38.9548;
+		double baseLon = -77.1481;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			unsigned int vehicle = i % vehicles;
+			unsigned int step = i / vehicles;
+
+			DecodedBsmMessage decoded;
+			decoded.set_TemporaryId(vehicle + 1);
+			decoded.set_MsgCount(step % 128);
+			decoded.set_SecondMark((step * 100) % 60000);
+			decoded.set_Latitude(baseLat + (vehicle % 100) * 0.0001 + step * 0.0000001);
+			decoded.set_Longitude(baseLon + (vehicle / 100) * 0.0001);
+			decoded.set_IsLocationValid(true);
+			decoded.set_Elevation_m(100);
+			decoded.set_IsElevationValid(true);
+			decoded.set_Speed_mps(10);
+			decoded.set_IsSpeedValid(true);
+			decoded.set_Heading(0);
+			decoded.set_IsHeadingValid(true);
+
+			BasicSafetyMessage *bsm = (BasicSafetyMessage *)calloc(1, sizeof(BasicSafetyMessage));
+			if (!bsm)
+				return false;
+			BsmConverter::ToBasicSafetyMessage(decoded, *bsm);
+
+			// Note that this constructor assumes control of cleaning up the J2735 structure pointer
+			BsmMessage bsmMsg(bsm);
+			BsmEncodedMessage encoded;
+			encoded.initialize(bsmMsg);
+
+			byte_stream bytes = encoded.get_payload_bytes();
+			_payloads.push_back(make_pair(bytes, byte_stream_encode(bytes)));
+		}
+
+		return true;
+	}
+
+	/**
+	 * Receive the messages forwarded to the radio.  Each datagram is a text message in the
+	 * format of the USDOT Roadside Unit Specification, with the J2735 bytes on the Payload line.
+	 */
+	void SinkLoop(UdpServer *server)
+	{
+		char buf[4000];
+		while (_running)
+		{
+			int len = server->TimedReceive(buf, sizeof(buf) - 1, 100);
+			if (len <= 0)
+				continue;
+
+			int64_t now = Now();
+			buf[len] = '\0';
+
+			const char *payload = strstr(buf, "Payload=");
+			if (!payload)
+				continue;
+
+			payload += strlen("Payload=");
+			string hex(payload, strcspn(payload, "\r\n"));
+			transform(hex.begin(), hex.end(), hex.begin(), ::tolower);
+
+			lock_guard<mutex> lock(_lock);
+			auto entry = _pending.find(hex);
+			if (entry == _pending.end())
+			{
+				_unknown++;
+				continue;
+			}
+
+			if (entry->second.forwarded < entry->second.indices.size())
+				_samples[entry->second.indices[entry->second.forwarded++]].forwarded = now;
+		}
+	}
+
+	static void PrintStage(const string &name, PercentileStatistics &stats, size_t sent)
+	{
+		size_t received = stats.Size();
+		cout << left << setw(22) << name << right <<
+				" received " << setw(8) << received << "  drop " << setw(6) << fixed << setprecision(2) <<
+				(sent ? 100.0 * (sent - received) / sent : 0) << "%";
+
+		if (received > 0)
+		{
+			cout << setprecision(3) << "  p50 " << stats.Percentile(50) << " ms  p99 " << stats.Percentile(99) <<
+					" ms  p999 " << stats.Percentile(99.9) << " ms  max " << stats.Max() << " ms";
+		}
+
+		cout << endl;
+	}
+
+	void Report(int64_t start, int64_t sendEnd, PercentileStatistics &lateness, uint64_t missed)
+	{
+		size_t count = _samples.size();
+		PercentileStatistics routed(count);
+		PercentileStatistics forwarded(count);
+		PercentileStatistics endToEnd(count);
+		int64_t lastForwarded = 0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const Sample &s = _samples[i];
+			if (s.routed)
+				routed.Add((s.routed - s.sent) / 1000000.0);
+			if (s.routed && s.forwarded)
+				forwarded.Add((s.forwarded - s.routed) / 1000000.0);
+			if (s.forwarded)
+			{
+				endToEnd.Add((s.forwarded - s.sent) / 1000000.0);
+				lastForwarded = max(lastForwarded, s.forwarded);
+			}
+		}
+
+		double sendSeconds = (sendEnd - start) / 1000000000.0;
+		double forwardSeconds = (lastForwarded - start) / 1000000000.0;
+
+		cout << endl << fixed << setprecision(1);
+		cout << "Sent " << count << " messages in " << sendSeconds << " s (" << count / sendSeconds << " msg/s), " <<
+				_sendErrors << " send errors, " << missed << " missed send deadlines" << endl;
+		cout << setprecision(3) << "Send lateness p50 " << lateness.Percentile(50) << " ms  p99 " << lateness.Percentile(99) << " ms" << endl;
+		if (lastForwarded > 0)
+			cout << setprecision(1) << "Forwarded throughput " << endToEnd.Size() / forwardSeconds << " msg/s" << endl;
+		if (_unknown > 0)
+			cout << _unknown << " unrecognized messages were received by the sink" << endl;
+		cout << endl;
+
+		if (tap)
+		{
+			PrintStage("UDP -> router", routed, count);
+			PrintStage("router -> radio", forwarded, routed.Size());
+		}
+		PrintStage("UDP -> radio", endToEnd, count);
+	}
+
+	/**
+	 * Register with ivpcore as a plugin that subscribes to J2735 messages.
+	 */
+	IvpPlugin *Connect()
+	{
+		IvpPluginInformation info = IVP_PLUGIN_INFORMATION_INITIALIZER;
+		info.onMsgReceived = StaticOnMessageReceived;
+
+		_instance = this;
+		IvpPlugin *plugin = tools::ConnectTool(info, "v2ibench", "Measures the latency of the V2I Hub message pipeline", manifest);
+		if (!plugin)
+			return NULL;
+
+		IvpMsgFilter *filter = ivpSubscribe_addFilterEntry(NULL, api::MSGSUBTYPE_J2735_STRING, "*");
+		ivp_subscribe(plugin, filter);
+		ivpSubscribe_destroyFilter(filter);
+
+		return plugin;
+	}
+
+	static void StaticOnMessageReceived(IvpPlugin *plugin, IvpMessage *msg)
+	{
+		if (_instance && msg)
+			_instance->OnRouted(msg);
+	}
+
+	static V2IBench *_instance;
+
+	string recording;
+	string target;
+	string sink;
+	double rate = 1000;
+	unsigned int vehicles = 100;
+	double duration = 10;
+	double drain = 2;
+	string manifest;
+	bool tap = true;
+
+	vector< pair<byte_stream, string> > _payloads;
+	vector<Sample> _samples;
+	unordered_map<string, Pending> _pending;
+	mutex _lock;
+	atomic<bool> _running {false};
+	uint64_t _sendErrors = 0;
+	uint64_t _unknown = 0;
+};
+
+V2IBench *V2IBench::_instance = NULL;
+
+} /* End namespace */
+
+int main(int argc, char *argv[])
+{
+	FILELog::ReportingLevel() = logERROR;
+
+	try
+	{
+		v2ibench::V2IBench myExec;
+		return run("", argc, argv, myExec);
+	}
+	catch (exception &ex)
+	{
+		cerr << ExceptionToString(ex) << endl;
+		throw;
+	}
+}
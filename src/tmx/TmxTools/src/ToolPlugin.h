@@ -0,0 +1,96 @@
+/*
+ * ToolPlugin.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef TOOLPLUGIN_H_
+#define TOOLPLUGIN_H_
+
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include <tmx/tmx.h>
+#include <tmx/IvpPlugin.h>
+
+#include "version.h"
+
+namespace tmx {
+namespace tools {
+
+/**
+ * Write a minimal plugin manifest for a command line tool to a temporary file, which points at
+ * the default ivpcore address and declares no messages or configuration.
+ *
+ * @return The name of the file, which the caller must remove, or an empty string on error
+ */
+inline std::string WriteToolManifest(const std::string &name, const std::string &description)
+{
+	char tmpName[] = "/tmp/tmxtool.XXXXXX";
+	int fd = mkstemp(tmpName);
+	if (fd < 0)
+	{
+		std::cerr << "Unable to create a plugin manifest" << std::endl;
+		return std::string();
+	}
+
+	std::string json = "{\"name\":\"" + name + "\",\"description\":\"" + description + "\","
+			"\"version\":\"" CLI_VERSION "\",\"coreIpAddr\":\"" IVP_DEFAULT_IP "\",\"corePort\":" +
+			std::to_string(IVP_DEFAULT_PORT) + ",\"messageTypes\":[],\"configuration\":[]}";
+	if (write(fd, json.c_str(), json.size()) != (ssize_t)json.size())
+		std::cerr << "Unable to write the plugin manifest" << std::endl;
+	close(fd);
+
+	return tmpName;
+}
+
+/**
+ * Register a command line tool with ivpcore as a plugin, and wait up to 10 seconds for the
+ * registration to complete.  The status of the plugin is then set to running.
+ *
+ * @param info The callbacks of the plugin.  The manifest location is filled in here.
+ * @param manifest The plugin manifest to use, or an empty string to generate a minimal one
+ * @return The plugin, which the caller must destroy with ivp_destroy, or NULL on error
+ */
+inline IvpPlugin *ConnectTool(IvpPluginInformation info, const std::string &name,
+		const std::string &description, const std::string &manifest)
+{
+	std::string manifestFile = manifest;
+	if (manifestFile.empty())
+	{
+		manifestFile = WriteToolManifest(name, description);
+		if (manifestFile.empty())
+			return NULL;
+	}
+
+	info.manifestLocation = (char *)manifestFile.c_str();
+	IvpPlugin *plugin = ivp_create(info);
+
+	if (manifest.empty())
+		unlink(manifestFile.c_str());
+
+	if (!plugin)
+	{
+		std::cerr << "Unable to create the " << name << " plugin" << std::endl;
+		return NULL;
+	}
+
+	for (int i = 0; i < 100 && plugin->state != IvpPluginState_registered; i++)
+		usleep(100000);
+
+	if (plugin->state != IvpPluginState_registered)
+	{
+		std::cerr << "Unable to register with ivpcore" << std::endl;
+		ivp_destroy(plugin);
+		return NULL;
+	}
+
+	ivp_setStatus(plugin, IVP_STATUS_RUNNING);
+	return plugin;
+}
+
+}} // namespace tmx::tools
+
+#endif /* TOOLPLUGIN_H_ */
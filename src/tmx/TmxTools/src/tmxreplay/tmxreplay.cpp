@@ -0,0 +1,236 @@
+/*
+ * tmxreplay.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <time.h>
+#include <unistd.h>
+
+#include <tmx/tmx.h>
+#include <tmx/IvpPlugin.h>
+#include <DeadlineTimer.h>
+#include <FlightRecorder.h>
+#include <PercentileStatistics.h>
+#include <PluginExec.h>
+
+#include "../ToolPlugin.h"
+
+#ifndef DEFAULT_RECORDING
+#define DEFAULT_RECORDING "/var/log/tmx/recorder"
+#endif
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::utils;
+
+namespace tmxreplay
+{
+
+static void onError(IvpPlugin *plugin, IvpError err)
+{
+	PLOG(logERROR) << "TMX API error " << err.error << " (level " << err.level << ", errno " << err.sysErrNo << ")";
+}
+
+/**
+ * Streams the messages of a flight recorder log, as written by ivpcore, back into the
+ * message router.  The messages are sent with the same spacing as when they were recorded,
+ * divided by the speed factor, or as fast as possible if the speed is zero.
+ */
+class TmxReplay: public Runnable
+{
+public:
+	TmxReplay(): Runnable(INPUT_FILES_PARAM, "Recording directory")
+	{
+		AddOptions()
+			("prefix,p", boost::program_options::value<string>()->default_value("ivpcore"), "File name prefix of the log segments.")
+			("speed,s", boost::program_options::value<double>()->default_value(1.0), "Replay speed, as a multiple of the recorded rate.  Use 0 to replay as fast as possible.")
+			("from,f", boost::program_options::value<uint64_t>()->default_value(0), "Start with the first message recorded at or after this time, in milliseconds since the epoch.")
+			("to,t", boost::program_options::value<uint64_t>()->default_value(0), "Stop after the last message recorded before this time, in milliseconds since the epoch.")
+			("type", boost::program_options::value<string>()->default_value(""), "Only replay messages of this type.")
+			("subtype", boost::program_options::value<string>()->default_value(""), "Only replay messages of this subtype.")
+			("manifest,m", boost::program_options::value<string>()->default_value(""), "Plugin manifest used to register with ivpcore.  By default a minimal manifest is generated.")
+			("keep-timestamps", "Send the messages with their original timestamps instead of the current time.")
+			("route-dsrc", "Keep the DSRC routing flag of the messages, which transmits them over the radio again.")
+			("list", "Print a summary of each message instead of sending it.");
+	}
+
+	inline int Main()
+	{
+		FlightRecordReader reader(directory, prefix);
+		if (reader.get_SegmentCount() == 0)
+		{
+			cerr << "No recording found in " << directory << endl;
+			return -1;
+		}
+
+		// Everything sent is recorded again, so replaying the live recording would read back its own
+		// messages, and at a speed of zero would never reach the end
+		if (!list && FlightRecorder::IsRecording(directory, prefix))
+		{
+			cerr << directory << " is still being recorded to.  Copy the segments to another directory, " <<
+					"or turn off Enable Recording in ivpcore, before replaying them." << endl;
+			return -1;
+		}
+
+		reader.Seek(from);
+
+		IvpPlugin *plugin = NULL;
+		if (!list && !(plugin = Connect()))
+			return -1;
+
+		PercentileStatistics lateness(10000);
+		FlightRecord record;
+		uint64_t firstRecordTime = 0;
+		uint64_t count = 0;
+		chrono::nanoseconds start = DeadlineTimer::Now();
+
+		while (reader.Next(record))
+		{
+			const flightrecorder::RecordHeader *hdr = record.header;
+
+			if (to && hdr->recordTime / 1000000 >= to)
+				break;
+
+			if (!type.empty() && record.get_Type() != type)
+				continue;
+			if (!subtype.empty() && record.get_Subtype() != subtype)
+				continue;
+
+			if (list)
+			{
+				cout << hdr->recordTime / 1000000 << " " << record.get_Source() << "(" << hdr->sourceId << ") " <<
+						record.get_Type() << "/" << record.get_Subtype() << " flags=" << hdr->flags <<
+						" bytes=" << hdr->length << endl;
+				continue;
+			}
+
+			if (plugin->state != IvpPluginState_registered)
+			{
+				cerr << "Lost the connection to ivpcore after " << count << " messages" << endl;
+				break;
+			}
+
+			if (firstRecordTime == 0)
+			{
+				firstRecordTime = hdr->recordTime;
+				start = DeadlineTimer::Now();
+			}
+
+			if (speed > 0)
+			{
+				chrono::nanoseconds deadline = start + chrono::nanoseconds((int64_t)((hdr->recordTime - firstRecordTime) / speed));
+
+				struct timespec ts;
+				ts.tv_sec = deadline.count() / 1000000000;
+				ts.tv_nsec = deadline.count() % 1000000000;
+				while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+
+				lateness.Add((DeadlineTimer::Now() - deadline).count() / 1000000.0);
+			}
+
+			IvpMessage *msg = record.CreateMessage();
+			if (!msg)
+				continue;
+
+			if (!keepTimestamps)
+				msg->timestamp = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+			if (!routeDsrc)
+				msg->flags &= ~IvpMsgFlags_RouteDSRC;
+
+			ivp_broadcastMessage(plugin, msg);
+			ivpMsg_destroy(msg);
+			count++;
+		}
+
+		if (plugin)
+		{
+			double elapsed = (DeadlineTimer::Now() - start).count() / 1000000000.0;
+			cout << "Replayed " << count << " messages in " << elapsed << " s";
+			if (elapsed > 0)
+				cout << " (" << count / elapsed << " msg/s)";
+			cout << endl;
+
+			if (lateness.Size() > 0)
+			{
+				cout << "Send lateness (ms): P50=" << lateness.Percentile(50) << " P99=" << lateness.Percentile(99) <<
+						" Max=" << lateness.Max() << endl;
+			}
+
+			// Give the socket a moment to drain before disconnecting
+			sleep(1);
+			ivp_destroy(plugin);
+		}
+
+		return 0;
+	}
+
+	inline bool ProcessOptions(const boost::program_options::variables_map &opts)
+	{
+		Runnable::ProcessOptions(opts);
+
+		if (opts.count(INPUT_FILES_PARAM))
+		{
+			vector<string> files = opts[INPUT_FILES_PARAM].as< vector<string> >();
+			if (files.size())
+				directory = files[0];
+		}
+
+		prefix = opts["prefix"].as<string>();
+		speed = opts["speed"].as<double>();
+		from = opts["from"].as<uint64_t>();
+		to = opts["to"].as<uint64_t>();
+		type = opts["type"].as<string>();
+		subtype = opts["subtype"].as<string>();
+		manifest = opts["manifest"].as<string>();
+		keepTimestamps = opts.count("keep-timestamps");
+		routeDsrc = opts.count("route-dsrc");
+		list = opts.count("list");
+
+		return speed >= 0;
+	}
+
+private:
+	IvpPlugin *Connect()
+	{
+		IvpPluginInformation info = IVP_PLUGIN_INFORMATION_INITIALIZER;
+		info.onError = onError;
+
+		return tools::ConnectTool(info, "tmxreplay", "Replays recorded TMX messages", manifest);
+	}
+
+	string directory = DEFAULT_RECORDING;
+	string prefix;
+	double speed = 1.0;
+	uint64_t from = 0;
+	uint64_t to = 0;
+	string type;
+	string subtype;
+	string manifest;
+	bool keepTimestamps = false;
+	bool routeDsrc = false;
+	bool list = false;
+};
+
+} /* End namespace */
+
+int main(int argc, char *argv[])
+{
+	FILELog::ReportingLevel() = logERROR;
+
+	try
+	{
+		tmxreplay::TmxReplay myExec;
+		return run("", argc, argv, myExec);
+	}
+	catch (exception &ex)
+	{
+		cerr << ExceptionToString(ex) << endl;
+		throw;
+	}
+}
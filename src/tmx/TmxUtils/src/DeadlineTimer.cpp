@@ -0,0 +1,85 @@
+/*
+ * DeadlineTimer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "DeadlineTimer.h"
+
+#include <cerrno>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace tmx {
+namespace utils {
+
+DeadlineTimer::DeadlineTimer(nanoseconds period, nanoseconds offset) :
+	_period(period), _offset(offset), _nextDeadline(0)
+{
+}
+
+void DeadlineTimer::Reset()
+{
+	_nextDeadline = Now() + _offset;
+	_started = true;
+}
+
+nanoseconds DeadlineTimer::WaitForNextDeadline()
+{
+	if (!_started)
+		Reset();
+
+	struct timespec deadline;
+	deadline.tv_sec = duration_cast<seconds>(_nextDeadline).count();
+	deadline.tv_nsec = (_nextDeadline - seconds(deadline.tv_sec)).count();
+
+	// Restart the sleep if a signal interrupts it.  The deadline is absolute so nothing needs adjusting.
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR);
+
+	nanoseconds now = Now();
+	nanoseconds late = now - _nextDeadline;
+
+	_nextDeadline += _period;
+
+	// Skip any cycles that were missed entirely
+	if (_period > nanoseconds(0) && _nextDeadline <= now)
+	{
+		uint64_t missed = (now - _nextDeadline) / _period + 1;
+		_nextDeadline += _period * missed;
+		_missedDeadlines += missed;
+	}
+
+	return late;
+}
+
+nanoseconds DeadlineTimer::get_NextDeadline()
+{
+	return _nextDeadline;
+}
+
+nanoseconds DeadlineTimer::get_Period()
+{
+	return _period;
+}
+
+void DeadlineTimer::set_Period(nanoseconds period)
+{
+	_period = period;
+}
+
+uint64_t DeadlineTimer::get_MissedDeadlines()
+{
+	return _missedDeadlines;
+}
+
+nanoseconds DeadlineTimer::Now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return seconds(now.tv_sec) + nanoseconds(now.tv_nsec);
+}
+
+} /* namespace utils */
+} /* namespace tmx */
@@ -0,0 +1,82 @@
+/*
+ * DeadlineTimer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_DEADLINETIMER_H_
+#define SRC_DEADLINETIMER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <time.h>
+
+namespace tmx {
+namespace utils {
+
+/**
+ * Paces a periodic loop on absolute deadlines of the monotonic clock.
+ *
+ * Each deadline is computed by adding the period to the previous deadline, and the
+ * thread sleeps with clock_nanosleep(TIMER_ABSTIME) until it arrives.  Unlike sleeping
+ * for a relative amount of time, scheduling error does not accumulate from one cycle
+ * to the next.  If a deadline is missed by more than a full period, the missed cycles
+ * are skipped instead of being run back to back.
+ */
+class DeadlineTimer
+{
+public:
+	/**
+	 * @param period The interval between deadlines.
+	 * @param offset The delay from the time of the first call to WaitForNextDeadline (or Reset)
+	 * to the first deadline.  This can be used to stagger several timers with the same period.
+	 */
+	DeadlineTimer(std::chrono::nanoseconds period, std::chrono::nanoseconds offset = std::chrono::nanoseconds(0));
+
+	/**
+	 * Restart the schedule so that the next deadline is one offset from now.
+	 */
+	void Reset();
+
+	/**
+	 * Block the current thread until the next deadline.
+	 *
+	 * @return How late the thread woke up relative to the deadline.
+	 */
+	std::chrono::nanoseconds WaitForNextDeadline();
+
+	/**
+	 * @return The time of the next deadline on the monotonic clock.
+	 */
+	std::chrono::nanoseconds get_NextDeadline();
+
+	std::chrono::nanoseconds get_Period();
+
+	/**
+	 * Change the period.  The change takes effect after the next deadline.
+	 */
+	void set_Period(std::chrono::nanoseconds period);
+
+	/**
+	 * @return The number of deadlines that have been skipped because the caller fell behind.
+	 */
+	uint64_t get_MissedDeadlines();
+
+	/**
+	 * @return The current time of the monotonic clock.
+	 */
+	static std::chrono::nanoseconds Now();
+
+private:
+	std::chrono::nanoseconds _period;
+	std::chrono::nanoseconds _offset;
+	std::chrono::nanoseconds _nextDeadline;
+	bool _started = false;
+	uint64_t _missedDeadlines = 0;
+};
+
+} /* namespace utils */
+} /* namespace tmx */
+
+#endif /* SRC_DEADLINETIMER_H_ */
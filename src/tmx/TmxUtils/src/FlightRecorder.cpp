@@ -0,0 +1,707 @@
+/*
+ * FlightRecorder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "FlightRecorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <tmx/TmxException.hpp>
+#include <tmx/utils/HexCodec.h>
+
+using namespace std;
+using namespace tmx::utils::flightrecorder;
+
+namespace tmx {
+namespace utils {
+
+/// Space kept after the last record of a trimmed segment so the end marker can always be read
+static constexpr size_t EndMarkerSize = 8;
+
+static inline size_t Align8(size_t size)
+{
+	return (size + 7) & ~(size_t)7;
+}
+
+static inline uint16_t StringLength(const char *str)
+{
+	if (!str)
+		return 0;
+
+	size_t len = strlen(str);
+	return len > UINT16_MAX ? UINT16_MAX : (uint16_t)len;
+}
+
+static string SegmentFileName(const string &directory, const string &prefix, uint64_t sequence, const char *extension)
+{
+	char name[32];
+	snprintf(name, sizeof(name), ".%010llu", (unsigned long long)sequence);
+	return directory + "/" + prefix + name + extension;
+}
+
+static string IndexFileName(const string &segmentName)
+{
+	return segmentName.substr(0, segmentName.size() - strlen(SegmentExtension)) + IndexExtension;
+}
+
+static uint64_t SequenceOf(const string &segmentName)
+{
+	size_t end = segmentName.size() - strlen(SegmentExtension);
+	size_t start = segmentName.rfind('.', end - 1);
+	return strtoull(segmentName.substr(start + 1, end - start - 1).c_str(), NULL, 10);
+}
+
+static uint64_t NowNanos()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static string LockFileName(const string &directory, const string &prefix)
+{
+	return directory + "/" + prefix + LockExtension;
+}
+
+static void AppendJsonString(string &out, const char *str)
+{
+	out.push_back('"');
+
+	for (const char *ptr = str; ptr && *ptr; ptr++)
+	{
+		unsigned char c = (unsigned char)*ptr;
+		switch (c)
+		{
+		case '\\': out.append("\\\\"); break;
+		case '"': out.append("\\\""); break;
+		case '\b': out.append("\\b"); break;
+		case '\f': out.append("\\f"); break;
+		case '\n': out.append("\\n"); break;
+		case '\r': out.append("\\r"); break;
+		case '\t': out.append("\\t"); break;
+		default:
+			if (c < 32)
+			{
+				char buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", c);
+				out.append(buf);
+			}
+			else
+			{
+				out.push_back(*ptr);
+			}
+			break;
+		}
+	}
+
+	out.push_back('"');
+}
+
+static void AppendJsonNumber(string &out, const cJSON *item)
+{
+	char buf[64];
+	double d = item->valuedouble;
+
+	if (fabs(((double)item->valueint) - d) <= DBL_EPSILON && d <= INT_MAX && d >= INT_MIN)
+		snprintf(buf, sizeof(buf), "%lld", (long long)item->valueint);
+	else if (fabs(floor(d) - d) <= DBL_EPSILON && fabs(d) < 1.0e60)
+		snprintf(buf, sizeof(buf), "%.0f", d);
+	else if (fabs(d) < 1.0e-6 || fabs(d) > 1.0e9)
+		snprintf(buf, sizeof(buf), "%e", d);
+	else
+		snprintf(buf, sizeof(buf), "%f", d);
+
+	out.append(buf);
+}
+
+/**
+ * Append the JSON text of the item to the string, exactly as cJSON_PrintUnformatted writes it.
+ * cJSON allocates a new string for every value in the tree, where this only grows the one buffer.
+ */
+static void AppendJson(string &out, const cJSON *item)
+{
+	switch (item->type & 255)
+	{
+	case cJSON_False:
+		out.append("false");
+		break;
+	case cJSON_True:
+		out.append("true");
+		break;
+	case cJSON_Number:
+		AppendJsonNumber(out, item);
+		break;
+	case cJSON_String:
+		AppendJsonString(out, item->valuestring);
+		break;
+	case cJSON_Array:
+		out.push_back('[');
+		for (const cJSON *child = item->child; child; child = child->next)
+		{
+			if (child != item->child)
+				out.push_back(',');
+			AppendJson(out, child);
+		}
+		out.push_back(']');
+		break;
+	case cJSON_Object:
+		out.push_back('{');
+		for (const cJSON *child = item->child; child; child = child->next)
+		{
+			if (child != item->child)
+				out.push_back(',');
+			AppendJsonString(out, child->string);
+			out.push_back(':');
+			AppendJson(out, child);
+		}
+		out.push_back('}');
+		break;
+	default:
+		out.append("null");
+		break;
+	}
+}
+
+FlightRecorder::FlightRecorder(string directory, string prefix, size_t segmentSize, uint64_t diskQuota, uint64_t indexInterval):
+	_directory(directory), _prefix(prefix), _segmentSize(segmentSize), _diskQuota(diskQuota), _indexInterval(indexInterval)
+{
+	if (mkdir(_directory.c_str(), 0755) != 0 && errno != EEXIST)
+		throw tmx::TmxException("Unable to create flight recorder directory " + _directory + ": " + strerror(errno));
+
+	_lockFd = open(LockFileName(_directory, _prefix).c_str(), O_RDWR | O_CREAT, 0644);
+	if (_lockFd < 0)
+		throw tmx::TmxException("Unable to create flight recorder lock in " + _directory + ": " + strerror(errno));
+
+	if (flock(_lockFd, LOCK_EX | LOCK_NB) != 0)
+	{
+		close(_lockFd);
+		throw tmx::TmxException("The flight recorder directory " + _directory + " is already being recorded to");
+	}
+
+	// Continue numbering after any segments left by a previous run
+	vector<string> segments = ListSegments(_directory, _prefix);
+	if (!segments.empty())
+		_sequence = SequenceOf(segments.back()) + 1;
+}
+
+FlightRecorder::~FlightRecorder()
+{
+	Close();
+
+	// Closing the file releases the lock
+	close(_lockFd);
+}
+
+bool FlightRecorder::IsRecording(const string &directory, const string &prefix)
+{
+	int fd = open(LockFileName(directory, prefix).c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	bool recording = flock(fd, LOCK_SH | LOCK_NB) != 0 && errno == EWOULDBLOCK;
+	close(fd);
+	return recording;
+}
+
+vector<string> FlightRecorder::ListSegments(const string &directory, const string &prefix)
+{
+	vector<string> segments;
+
+	DIR *dir = opendir(directory.c_str());
+	if (!dir)
+		return segments;
+
+	string start = prefix + ".";
+	size_t extLen = strlen(SegmentExtension);
+
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		string name(entry->d_name);
+		if (name.size() > start.size() + extLen &&
+				name.compare(0, start.size(), start) == 0 &&
+				name.compare(name.size() - extLen, extLen, SegmentExtension) == 0)
+			segments.push_back(directory + "/" + name);
+	}
+
+	closedir(dir);
+
+	// The sequence numbers are zero padded, so name order is also creation order
+	sort(segments.begin(), segments.end());
+	return segments;
+}
+
+bool FlightRecorder::Record(const IvpMessage *msg)
+{
+	if (!msg)
+		return false;
+
+	uint64_t recordTime = NowNanos();
+
+	lock_guard<mutex> lock(_lock);
+
+	_payload.clear();
+	if (msg->payloadBytes)
+	{
+		// A binary payload is recorded as the JSON string of its hex digits, as it is sent to JSON peers
+		_payload.resize(2 * msg->payloadLength + 2);
+		_payload[0] = '"';
+		hexCodec_encode(msg->payloadBytes, msg->payloadLength, &_payload[1]);
+		_payload[_payload.size() - 1] = '"';
+	}
+	else if (msg->payload)
+	{
+		AppendJson(_payload, msg->payload);
+	}
+
+	RecordHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.flags = msg->flags;
+	hdr.timestamp = msg->timestamp;
+	hdr.recordTime = recordTime;
+	hdr.sourceId = msg->sourceId;
+	hdr.dsrcChannel = msg->dsrcMetadata ? msg->dsrcMetadata->channel : NoDsrcChannel;
+	hdr.dsrcPsid = msg->dsrcMetadata ? msg->dsrcMetadata->psid : 0;
+	hdr.typeLength = StringLength(msg->type);
+	hdr.subtypeLength = StringLength(msg->subtype);
+	hdr.sourceLength = StringLength(msg->source);
+	hdr.encodingLength = StringLength(msg->encoding);
+	hdr.payloadLength = _payload.size();
+
+	size_t length = Align8(sizeof(RecordHeader) + hdr.typeLength + hdr.subtypeLength +
+			hdr.sourceLength + hdr.encodingLength + hdr.payloadLength);
+
+	if (length + sizeof(SegmentHeader) + EndMarkerSize > _segmentSize)
+	{
+		_droppedCount++;
+		return false;
+	}
+
+	if (_segment && _offset + length + EndMarkerSize > _mappedSize)
+		CloseSegment();
+
+	if (!_segment && !OpenSegment(recordTime))
+	{
+		_droppedCount++;
+		return false;
+	}
+
+	char *rec = _segment + _offset;
+	char *ptr = rec + sizeof(RecordHeader);
+	memcpy(ptr, msg->type, hdr.typeLength);
+	ptr += hdr.typeLength;
+	memcpy(ptr, msg->subtype, hdr.subtypeLength);
+	ptr += hdr.subtypeLength;
+	memcpy(ptr, msg->source, hdr.sourceLength);
+	ptr += hdr.sourceLength;
+	memcpy(ptr, msg->encoding, hdr.encodingLength);
+	ptr += hdr.encodingLength;
+	memcpy(ptr, _payload.data(), hdr.payloadLength);
+
+	// Publish the length last so a concurrent reader never sees a partial record
+	memcpy(rec, &hdr, sizeof(RecordHeader));
+	__atomic_store_n(&((RecordHeader *)rec)->length, (uint32_t)length, __ATOMIC_RELEASE);
+
+	uint64_t recordMs = recordTime / 1000000;
+	if (_lastIndexTime == 0 || recordMs >= _lastIndexTime + _indexInterval)
+		AddIndexEntry(recordMs, _offset);
+
+	_offset += length;
+	_recordCount++;
+	_bytesWritten += length;
+	return true;
+}
+
+void FlightRecorder::Close()
+{
+	lock_guard<mutex> lock(_lock);
+	CloseSegment();
+}
+
+bool FlightRecorder::OpenSegment(uint64_t timestamp)
+{
+	_segmentName = SegmentFileName(_directory, _prefix, _sequence, SegmentExtension);
+
+	_segmentFd = open(_segmentName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (_segmentFd < 0)
+		return false;
+
+	if (ftruncate(_segmentFd, _segmentSize) != 0)
+	{
+		close(_segmentFd);
+		_segmentFd = -1;
+		unlink(_segmentName.c_str());
+		return false;
+	}
+
+	void *map = mmap(NULL, _segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, _segmentFd, 0);
+	if (map == MAP_FAILED)
+	{
+		close(_segmentFd);
+		_segmentFd = -1;
+		unlink(_segmentName.c_str());
+		return false;
+	}
+
+	_indexFd = open(IndexFileName(_segmentName).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+
+	_segment = (char *)map;
+	_mappedSize = _segmentSize;
+	_lastIndexTime = 0;
+	_sequence++;
+
+	SegmentHeader *hdr = (SegmentHeader *)_segment;
+	hdr->magic = SegmentMagic;
+	hdr->version = FormatVersion;
+	hdr->headerSize = sizeof(SegmentHeader);
+	hdr->createdTime = timestamp;
+	_offset = sizeof(SegmentHeader);
+
+	EnforceQuota();
+	return true;
+}
+
+void FlightRecorder::CloseSegment()
+{
+	if (!_segment)
+		return;
+
+	// Give back the unused part of the segment.  The end marker after the last record
+	// is kept inside the file so a reader that still has the segment mapped can see it.
+	munmap(_segment, _mappedSize);
+	if (ftruncate(_segmentFd, _offset + EndMarkerSize) != 0)
+	{
+		// The segment keeps its full size, which only wastes disk space
+	}
+
+	close(_segmentFd);
+	if (_indexFd >= 0)
+		close(_indexFd);
+
+	_segment = NULL;
+	_segmentFd = -1;
+	_indexFd = -1;
+	_mappedSize = 0;
+	_offset = 0;
+}
+
+void FlightRecorder::EnforceQuota()
+{
+	if (_diskQuota == 0)
+		return;
+
+	vector<string> segments = ListSegments(_directory, _prefix);
+	vector<uint64_t> sizes;
+	uint64_t total = 0;
+
+	for (size_t i = 0; i < segments.size(); i++)
+	{
+		struct stat st;
+		uint64_t size = 0;
+		if (stat(segments[i].c_str(), &st) == 0)
+			size = st.st_size;
+		if (stat(IndexFileName(segments[i]).c_str(), &st) == 0)
+			size += st.st_size;
+
+		sizes.push_back(size);
+		total += size;
+	}
+
+	// Never delete the segment currently being written, which is the newest one
+	for (size_t i = 0; total > _diskQuota && i + 1 < segments.size(); i++)
+	{
+		if (segments[i] == _segmentName)
+			break;
+
+		unlink(segments[i].c_str());
+		unlink(IndexFileName(segments[i]).c_str());
+		total -= sizes[i];
+	}
+}
+
+void FlightRecorder::AddIndexEntry(uint64_t timestamp, uint64_t offset)
+{
+	_lastIndexTime = timestamp;
+
+	if (_indexFd < 0)
+		return;
+
+	IndexEntry entry;
+	entry.timestamp = timestamp;
+	entry.offset = offset;
+	if (write(_indexFd, &entry, sizeof(entry)) != sizeof(entry))
+	{
+		// A short index only makes seeking slower, the records are still complete
+	}
+}
+
+string FlightRecorder::get_Directory()
+{
+	return _directory;
+}
+
+void FlightRecorder::set_SegmentSize(size_t segmentSize)
+{
+	lock_guard<mutex> lock(_lock);
+	_segmentSize = segmentSize;
+}
+
+void FlightRecorder::set_DiskQuota(uint64_t diskQuota)
+{
+	lock_guard<mutex> lock(_lock);
+	_diskQuota = diskQuota;
+	EnforceQuota();
+}
+
+void FlightRecorder::set_IndexInterval(uint64_t indexInterval)
+{
+	lock_guard<mutex> lock(_lock);
+	_indexInterval = indexInterval;
+}
+
+uint64_t FlightRecorder::get_RecordCount()
+{
+	lock_guard<mutex> lock(_lock);
+	return _recordCount;
+}
+
+uint64_t FlightRecorder::get_DroppedCount()
+{
+	lock_guard<mutex> lock(_lock);
+	return _droppedCount;
+}
+
+uint64_t FlightRecorder::get_BytesWritten()
+{
+	lock_guard<mutex> lock(_lock);
+	return _bytesWritten;
+}
+
+string FlightRecord::get_Type() const
+{
+	return header ? string(type, header->typeLength) : string();
+}
+
+string FlightRecord::get_Subtype() const
+{
+	return header ? string(subtype, header->subtypeLength) : string();
+}
+
+string FlightRecord::get_Source() const
+{
+	return header ? string(source, header->sourceLength) : string();
+}
+
+string FlightRecord::get_Encoding() const
+{
+	return header ? string(encoding, header->encodingLength) : string();
+}
+
+string FlightRecord::get_Payload() const
+{
+	return header ? string(payload, header->payloadLength) : string();
+}
+
+IvpMessage *FlightRecord::CreateMessage() const
+{
+	if (!header)
+		return NULL;
+
+	cJSON *json = NULL;
+	if (header->payloadLength > 0)
+		json = cJSON_Parse(get_Payload().c_str());
+
+	string type = get_Type();
+	string subtype = get_Subtype();
+	string encoding = get_Encoding();
+
+	IvpMessage *msg = ivpMsg_create(header->typeLength ? type.c_str() : NULL,
+			header->subtypeLength ? subtype.c_str() : NULL,
+			header->encodingLength ? encoding.c_str() : NULL,
+			header->flags, json);
+
+	if (json)
+		cJSON_Delete(json);
+
+	if (msg)
+	{
+		msg->timestamp = header->timestamp;
+		msg->sourceId = header->sourceId;
+		if (header->sourceLength)
+			msg->source = strdup(get_Source().c_str());
+		if (header->dsrcChannel != NoDsrcChannel)
+			ivpMsg_addDsrcMetadata(msg, header->dsrcChannel, header->dsrcPsid);
+	}
+
+	return msg;
+}
+
+FlightRecordReader::FlightRecordReader(string directory, string prefix):
+	_directory(directory), _segments(FlightRecorder::ListSegments(directory, prefix))
+{
+	OpenSegment(0);
+}
+
+FlightRecordReader::~FlightRecordReader()
+{
+	CloseSegment();
+}
+
+size_t FlightRecordReader::get_SegmentCount()
+{
+	return _segments.size();
+}
+
+bool FlightRecordReader::OpenSegment(size_t index)
+{
+	CloseSegment();
+
+	for (_current = index; _current < _segments.size(); _current++)
+	{
+		int fd = open(_segments[_current].c_str(), O_RDONLY);
+		if (fd < 0)
+			continue;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SegmentHeader) + EndMarkerSize)
+		{
+			close(fd);
+			continue;
+		}
+
+		void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (map == MAP_FAILED)
+			continue;
+
+		const SegmentHeader *hdr = (const SegmentHeader *)map;
+		if (hdr->magic != SegmentMagic || hdr->version != FormatVersion)
+		{
+			munmap(map, st.st_size);
+			continue;
+		}
+
+		_segment = (const char *)map;
+		_mappedSize = st.st_size;
+		_offset = hdr->headerSize;
+		return true;
+	}
+
+	return false;
+}
+
+void FlightRecordReader::CloseSegment()
+{
+	if (_segment)
+		munmap((void *)_segment, _mappedSize);
+
+	_segment = NULL;
+	_mappedSize = 0;
+	_offset = 0;
+}
+
+vector<IndexEntry> FlightRecordReader::ReadIndex(size_t index)
+{
+	vector<IndexEntry> entries;
+
+	FILE *f = fopen(IndexFileName(_segments[index]).c_str(), "rb");
+	if (!f)
+		return entries;
+
+	IndexEntry entry;
+	while (fread(&entry, sizeof(entry), 1, f) == 1)
+		entries.push_back(entry);
+
+	fclose(f);
+	return entries;
+}
+
+void FlightRecordReader::Seek(uint64_t timestamp)
+{
+	// Find the last segment whose first record is no later than the requested time
+	size_t segment = 0;
+	vector<IndexEntry> index;
+	for (size_t i = 0; i < _segments.size(); i++)
+	{
+		vector<IndexEntry> entries = ReadIndex(i);
+		if (entries.empty() || entries.front().timestamp > timestamp)
+			break;
+
+		segment = i;
+		index.swap(entries);
+	}
+
+	if (!OpenSegment(segment))
+		return;
+
+	// Jump to the last index entry before the requested time
+	auto entry = upper_bound(index.begin(), index.end(), timestamp,
+			[](uint64_t t, const IndexEntry &e) { return t < e.timestamp; });
+	if (entry != index.begin())
+	{
+		--entry;
+		if (entry->offset < _mappedSize)
+			_offset = entry->offset;
+	}
+
+	// Then scan forward to the first record at or after the requested time
+	FlightRecord record;
+	while (Next(record))
+	{
+		if (record.header->recordTime / 1000000 >= timestamp)
+		{
+			// Back up so the next read returns this record
+			_offset -= record.header->length;
+			return;
+		}
+	}
+}
+
+bool FlightRecordReader::Next(FlightRecord &record)
+{
+	while (_segment)
+	{
+		if (_offset + sizeof(RecordHeader) <= _mappedSize)
+		{
+			const RecordHeader *hdr = (const RecordHeader *)(_segment + _offset);
+			uint32_t length = __atomic_load_n(&hdr->length, __ATOMIC_ACQUIRE);
+
+			if (length >= sizeof(RecordHeader) && _offset + length <= _mappedSize)
+			{
+				record.header = hdr;
+				record.type = (const char *)(hdr + 1);
+				record.subtype = record.type + hdr->typeLength;
+				record.source = record.subtype + hdr->subtypeLength;
+				record.encoding = record.source + hdr->sourceLength;
+				record.payload = record.encoding + hdr->encodingLength;
+
+				_offset += length;
+				return true;
+			}
+		}
+
+		// End of this segment
+		OpenSegment(_current + 1);
+	}
+
+	record = FlightRecord();
+	return false;
+}
+
+} /* namespace utils */
+} /* namespace tmx */
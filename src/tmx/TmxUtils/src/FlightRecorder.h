@@ -0,0 +1,242 @@
+/*
+ * FlightRecorder.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_FLIGHTRECORDER_H_
+#define SRC_FLIGHTRECORDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <tmx/IvpMessage.h>
+
+namespace tmx {
+namespace utils {
+
+/**
+ * The on-disk layout of a flight recorder log.
+ *
+ * A recording is a directory of segment files named <prefix>.<sequence>.rec, each with a
+ * companion <prefix>.<sequence>.idx sparse time index.  A segment starts with a SegmentHeader
+ * followed by records packed back to back on 8 byte boundaries.  Every record starts with a
+ * RecordHeader, followed by the type, subtype, source and encoding strings (not null terminated)
+ * and the JSON text of the message payload.  A record length of zero marks the end of the data.
+ *
+ * The index file is a plain array of IndexEntry.  An entry is written for the first record of
+ * each segment and then at most once per index interval, so a reader can binary search for a
+ * time and then scan forward a short distance.
+ *
+ * While a recorder is writing to the directory, it holds an exclusive lock on the file
+ * <prefix>.lock, so a tool can tell a live recording from a finished one.
+ */
+namespace flightrecorder {
+
+static constexpr uint64_t SegmentMagic = 0x3130434552584D54ULL; // "TMXREC01"
+static constexpr uint32_t FormatVersion = 1;
+static constexpr const char *SegmentExtension = ".rec";
+static constexpr const char *IndexExtension = ".idx";
+static constexpr const char *LockExtension = ".lock";
+
+struct SegmentHeader
+{
+	uint64_t magic;
+	uint32_t version;
+	uint32_t headerSize;
+	uint64_t createdTime;
+	uint64_t reserved;
+};
+
+struct RecordHeader
+{
+	/// Total size of the record in bytes, including this header and the padding
+	uint32_t length;
+	/// Bit-or'ed IvpMsgFlags of the message
+	uint32_t flags;
+	/// Timestamp of the message, in milliseconds since the epoch
+	uint64_t timestamp;
+	/// Time the message was recorded, in nanoseconds since the epoch
+	uint64_t recordTime;
+	uint32_t sourceId;
+	int32_t dsrcChannel;
+	int32_t dsrcPsid;
+	uint16_t typeLength;
+	uint16_t subtypeLength;
+	uint16_t sourceLength;
+	uint16_t encodingLength;
+	uint32_t payloadLength;
+};
+
+struct IndexEntry
+{
+	uint64_t timestamp;
+	uint64_t offset;
+};
+
+/// DSRC channel value stored when the message has no DSRC metadata
+static constexpr int32_t NoDsrcChannel = -1;
+
+} /* namespace flightrecorder */
+
+/**
+ * Appends messages to a segmented, memory-mapped flight recorder log.
+ *
+ * Each segment is created at its full size and mapped into memory, so appending a message is
+ * a bounded copy with no system call.  When a segment fills up it is trimmed to the used size
+ * and a new one is started.  The oldest segments are deleted whenever the total size of the
+ * recording goes over the disk quota.  Only one recorder at a time may write to the same
+ * directory and prefix.  All methods are thread safe.
+ */
+class FlightRecorder
+{
+public:
+	/**
+	 * @param directory The directory to write segments to.  It is created if it does not exist.
+	 * @param prefix The file name prefix for all segments.
+	 * @param segmentSize The size of each segment file, in bytes.
+	 * @param diskQuota The maximum total size of all segments, in bytes.  Zero means no limit.
+	 * @param indexInterval The minimum time between index entries, in milliseconds.
+	 * @throws TmxException if the directory can not be created or is already being recorded to
+	 */
+	FlightRecorder(std::string directory, std::string prefix = "ivpcore",
+			size_t segmentSize = 64 * 1024 * 1024, uint64_t diskQuota = 512ULL * 1024 * 1024,
+			uint64_t indexInterval = 1000);
+	virtual ~FlightRecorder();
+
+	/**
+	 * Append a message to the log.
+	 *
+	 * @return False if the message could not be recorded, for instance if it is larger than
+	 * a segment or the segment could not be created.
+	 */
+	bool Record(const IvpMessage *msg);
+
+	/**
+	 * Trim and close the current segment.  The next call to Record starts a new segment.
+	 */
+	void Close();
+
+	std::string get_Directory();
+
+	void set_SegmentSize(size_t segmentSize);
+	void set_DiskQuota(uint64_t diskQuota);
+	void set_IndexInterval(uint64_t indexInterval);
+
+	uint64_t get_RecordCount();
+	uint64_t get_DroppedCount();
+	uint64_t get_BytesWritten();
+
+	/**
+	 * @return The names of all segments of the recording in the directory, oldest first.
+	 */
+	static std::vector<std::string> ListSegments(const std::string &directory, const std::string &prefix = "ivpcore");
+
+	/**
+	 * @return True if a recorder, in this or another process, is currently writing to the directory.
+	 */
+	static bool IsRecording(const std::string &directory, const std::string &prefix = "ivpcore");
+
+private:
+	bool OpenSegment(uint64_t timestamp);
+	void CloseSegment();
+	void EnforceQuota();
+	void AddIndexEntry(uint64_t timestamp, uint64_t offset);
+
+	std::mutex _lock;
+	std::string _directory;
+	std::string _prefix;
+	size_t _segmentSize;
+	uint64_t _diskQuota;
+	uint64_t _indexInterval;
+
+	int _lockFd = -1;
+	uint64_t _sequence = 0;
+	std::string _segmentName;
+	int _segmentFd = -1;
+	int _indexFd = -1;
+	char *_segment = NULL;
+	size_t _mappedSize = 0;
+	size_t _offset = 0;
+	uint64_t _lastIndexTime = 0;
+
+	uint64_t _recordCount = 0;
+	uint64_t _droppedCount = 0;
+	uint64_t _bytesWritten = 0;
+
+	// The JSON text of the message being recorded, kept between records so its memory is reused
+	std::string _payload;
+};
+
+/**
+ * A single message read back from a flight recorder log.  The string members point into the
+ * mapped segment and are only valid until the reader moves to the next record.
+ */
+struct FlightRecord
+{
+	const flightrecorder::RecordHeader *header = NULL;
+	const char *type = NULL;
+	const char *subtype = NULL;
+	const char *source = NULL;
+	const char *encoding = NULL;
+	const char *payload = NULL;
+
+	std::string get_Type() const;
+	std::string get_Subtype() const;
+	std::string get_Source() const;
+	std::string get_Encoding() const;
+	std::string get_Payload() const;
+
+	/**
+	 * Build a new IvpMessage from this record.  The caller must destroy it with ivpMsg_destroy.
+	 */
+	IvpMessage *CreateMessage() const;
+};
+
+/**
+ * Reads the segments of a flight recorder log in order.  Segments are mapped read only, so
+ * a log can be read while ivpcore is still writing to it.
+ */
+class FlightRecordReader
+{
+public:
+	FlightRecordReader(std::string directory, std::string prefix = "ivpcore");
+	virtual ~FlightRecordReader();
+
+	/**
+	 * Position the reader on the first record with a timestamp at or after the given time, using
+	 * the sparse index to skip whole segments and most of the segment the record is in.
+	 *
+	 * @param timestamp Time in milliseconds since the epoch.  Zero starts from the oldest record.
+	 */
+	void Seek(uint64_t timestamp);
+
+	/**
+	 * Read the next record.
+	 *
+	 * @return False at the end of the recording.
+	 */
+	bool Next(FlightRecord &record);
+
+	size_t get_SegmentCount();
+
+private:
+	bool OpenSegment(size_t index);
+	void CloseSegment();
+	std::vector<flightrecorder::IndexEntry> ReadIndex(size_t index);
+
+	std::string _directory;
+	std::vector<std::string> _segments;
+	size_t _current = 0;
+	const char *_segment = NULL;
+	size_t _mappedSize = 0;
+	size_t _offset = 0;
+};
+
+} /* namespace utils */
+} /* namespace tmx */
+
+#endif /* SRC_FLIGHTRECORDER_H_ */
@@ -7,10 +7,14 @@
 
 #include "ITISPhrase.h"
 
+#include <algorithm>
+#include <stdlib.h>
+
 namespace tmx {
 namespace utils {
 
-map<int, string> ITISPhrase::_codes =
+// Sorted by code, for the binary search in Find()
+static constexpr ITISPhrase::Entry _codes[] =
 {
 		{1,"Traffic Conditions"},
 		{2,"Accidents & Incidents"},
@@ -1305,5 +1309,41 @@ map<int, string> ITISPhrase::_codes =
 		{10562,"guide poles"}
 };
 
+static constexpr size_t _count = sizeof(_codes) / sizeof(_codes[0]);
+
+static constexpr bool IsSorted(const ITISPhrase::Entry *entries, size_t count)
+{
+	for (size_t i = 1; i < count; i++)
+		if (entries[i - 1].code >= entries[i].code)
+			return false;
+	return true;
+}
+
+static_assert(IsSorted(_codes, _count), "The ITIS codes must be sorted and unique");
+
+phrase_view ITISPhrase::Find(int code)
+{
+	const Entry *end = _codes + _count;
+	const Entry *found = std::lower_bound(_codes, end, code,
+			[](const Entry &entry, int code) { return entry.code < code; });
+
+	if (found == end || found->code != code)
+		return phrase_view();
+
+	return phrase_view(found->phrase, found->length);
+}
+
+phrase_view ITISPhrase::Find(const string &code)
+{
+	const char *str = code.c_str();
+	char *end = NULL;
+	long i = strtol(str, &end, 10);
+
+	if (end == str)
+		return phrase_view();
+
+	return Find((int)i);
+}
+
 }
 } // namespace tmx::utils
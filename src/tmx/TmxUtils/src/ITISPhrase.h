@@ -8,48 +8,66 @@
 #ifndef SRC_ITISPHRASE_H_
 #define SRC_ITISPHRASE_H_
 
-#include <map>
+#include <cstddef>
 #include <string>
 #include <iostream>
-#include <sstream>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#else
+#include <boost/utility/string_ref.hpp>
+#endif
 
 using namespace std;
 
 namespace tmx {
 namespace utils {
 
-
+/// A view of a phrase in the ITIS code table, which is valid for the life of the program
+#if __cplusplus >= 201703L
+typedef std::string_view phrase_view;
+#else
+typedef boost::string_ref phrase_view;
+#endif
 
 class ITISPhrase
 {
-private:
+public:
+	/// One code in the table, with the length of its phrase worked out at compile time
+	struct Entry
+	{
+		int code;
+		const char *phrase;
+		size_t length;
 
-	static map<int, string> _codes;
+		template <size_t N>
+		constexpr Entry(int code, const char (&phrase)[N]): code(code), phrase(phrase), length(N - 1) { }
+	};
 
-public:
+	/**
+	 * Find the phrase for an ITIS code, without copying it.
+	 *
+	 * @return The phrase, or an empty view if the code is unknown
+	 */
+	static phrase_view Find(int code);
+
+	/**
+	 * Find the phrase for an ITIS code given as a decimal string.
+	 *
+	 * @return The phrase, or an empty view if the code is unknown or not a number
+	 */
+	static phrase_view Find(const string &code);
 
 	static string GetPhrase(int code)
 	{
-		if (_codes.find(code) != _codes.end())
-			return _codes[code];
-		else
-			return "";
+		phrase_view phrase = Find(code);
+		return string(phrase.data(), phrase.size());
 	}
 
 	static string GetPhrase(string code)
 	{
-		int i;
-		istringstream iss(code);
-		iss >> i;
-		if (!iss.fail())
-		{
-			if (_codes.find(i) != _codes.end())
-				return _codes[i];
-			else
-				return "";
-		}
-		else
-			return "";
+		phrase_view phrase = Find(code);
+		return string(phrase.data(), phrase.size());
 	}
 };
 
@@ -0,0 +1,108 @@
+/*
+ * MessageDispatcher.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "MessageDispatcher.h"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+namespace tmx {
+namespace utils {
+
+namespace {
+
+// The same hash as MessageId, in a loop for the received messages
+inline message_id RuntimeMessageId(const char *type, const char *subtype)
+{
+	uint64_t hash = dispatch_detail::FnvBasis;
+	for (const char *s = type; *s; s++)
+		hash = dispatch_detail::fnv_step(hash, (unsigned char)*s);
+
+	hash = dispatch_detail::fnv_step(hash, 0xff);
+
+	for (const char *s = subtype; *s; s++)
+		hash = dispatch_detail::fnv_step(hash, (unsigned char)*s);
+
+	return hash;
+}
+
+} // namespace
+
+void MessageDispatcher::Register(const string &type, const string &subtype, handler *h)
+{
+	Register(RuntimeMessageId(type.c_str(), subtype.c_str()), type, subtype, h);
+}
+
+void MessageDispatcher::Register(message_id id, const string &type, const string &subtype, handler *h)
+{
+	auto range = _handlers.equal_range(id);
+	for (auto i = range.first; i != range.second; i++)
+	{
+		if (i->second.type == type && i->second.subtype == subtype)
+		{
+			i->second.h = h;
+			return;
+		}
+	}
+
+	_handlers.emplace(id, Entry { type, subtype, h });
+}
+
+MessageDispatcher::handler *MessageDispatcher::Find(const char *type, const char *subtype) const
+{
+	if (!type) type = "";
+	if (!subtype) subtype = "";
+
+	return Find(RuntimeMessageId(type, subtype), type, subtype);
+}
+
+MessageDispatcher::handler *MessageDispatcher::Find(message_id id, const char *type, const char *subtype) const
+{
+	if (!type) type = "";
+	if (!subtype) subtype = "";
+
+	auto range = _handlers.equal_range(id);
+	for (auto i = range.first; i != range.second; i++)
+	{
+		if (strcmp(i->second.type.c_str(), type) == 0 && strcmp(i->second.subtype.c_str(), subtype) == 0)
+			return i->second.h;
+	}
+
+	return NULL;
+}
+
+bool MessageDispatcher::Dispatch(IvpMessage *msg)
+{
+	if (!msg)
+		return false;
+
+	handler *h = Find(msg->type, msg->subtype);
+	if (!h)
+		return false;
+
+	h->dispatch(MessageView(msg));
+	return true;
+}
+
+bool MessageDispatcher::Dispatch(tmx::routeable_message &routeableMsg)
+{
+	handler *h = Find(routeableMsg.get_type().c_str(), routeableMsg.get_subtype().c_str());
+	if (!h)
+		return false;
+
+	h->invokeHandler(routeableMsg);
+	return true;
+}
+
+size_t MessageDispatcher::Count() const
+{
+	return _handlers.size();
+}
+
+}} // namespace tmx::utils
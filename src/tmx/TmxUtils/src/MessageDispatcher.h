@@ -0,0 +1,150 @@
+/*
+ * MessageDispatcher.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_MESSAGEDISPATCHER_H_
+#define SRC_MESSAGEDISPATCHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <tmx/IvpMessage.h>
+#include <tmx/messages/routeable_message.hpp>
+
+#include "MessageView.h"
+
+namespace tmx {
+namespace utils {
+
+/// The interned ID of a message type and subtype
+typedef uint64_t message_id;
+
+namespace dispatch_detail {
+
+// 64-bit FNV-1a, written recursively so it can be evaluated at compile time
+static constexpr uint64_t FnvBasis = 0xcbf29ce484222325ULL;
+static constexpr uint64_t FnvPrime = 0x100000001b3ULL;
+
+constexpr uint64_t fnv_step(uint64_t hash, unsigned char c)
+{
+	return (hash ^ c) * FnvPrime;
+}
+
+constexpr uint64_t fnv_str(uint64_t hash, const char *s)
+{
+	return *s ? fnv_str(fnv_step(hash, (unsigned char)*s), s + 1) : hash;
+}
+
+} // namespace dispatch_detail
+
+/**
+ * @return The ID of a message type and subtype.  NULL is the same as empty.  There is a separator
+ * between the two, so "ab","c" differs from "a","bc".
+ */
+constexpr message_id MessageId(const char *type, const char *subtype)
+{
+	return dispatch_detail::fnv_str(dispatch_detail::fnv_step(
+			dispatch_detail::fnv_str(dispatch_detail::FnvBasis, type ? type : ""), 0xff), subtype ? subtype : "");
+}
+
+/**
+ * The ID of a message class, computed at compile time from its MessageType and MessageSubType.
+ */
+template <typename MsgType>
+struct message_id_of
+{
+	static constexpr message_id value = MessageId(MsgType::MessageType, MsgType::MessageSubType);
+};
+
+template <typename MsgType>
+constexpr message_id message_id_of<MsgType>::value;
+
+/**
+ * Finds the handler registered for the type and subtype of each message a plugin receives.
+ *
+ * The handlers are kept in a hash table keyed by the message ID, so a lookup does not construct
+ * any strings or do any ordered comparisons, and the IDs of handlers for a message class are
+ * computed at compile time.  When dispatching an IvpMessage, the handler gets a view of it, and a
+ * routeable message and typed payload are only built by handlers that take them.  Messages without
+ * a handler cost one hash and lookup.
+ *
+ * Handlers are registered before messages are received, and are not owned by the dispatcher.
+ */
+class MessageDispatcher
+{
+public:
+	/// The handler for one type of message
+	struct handler
+	{
+		virtual ~handler() {}
+
+		virtual std::string get_messageType() = 0;
+		virtual void invokeHandler(tmx::routeable_message &routeableMsg) = 0;
+
+		/**
+		 * Handle a received message.  By default, this builds the routeable message for invokeHandler.
+		 */
+		virtual void dispatch(const MessageView &view)
+		{
+			tmx::routeable_message routeableMsg(view.get_message());
+			invokeHandler(routeableMsg);
+		}
+	};
+
+	/**
+	 * Register the handler for a message type and subtype, replacing any earlier handler.
+	 */
+	void Register(const std::string &type, const std::string &subtype, handler *h);
+
+	/**
+	 * Register the handler for a message type and subtype with an ID already computed, such as
+	 * message_id_of<MsgType>::value.
+	 */
+	void Register(message_id id, const std::string &type, const std::string &subtype, handler *h);
+
+	/**
+	 * @return The handler for the message type and subtype, or NULL if there is none.
+	 */
+	handler *Find(const char *type, const char *subtype) const;
+
+	/**
+	 * @return The handler for the message ID, type and subtype, or NULL if there is none.
+	 */
+	handler *Find(message_id id, const char *type, const char *subtype) const;
+
+	/**
+	 * Invoke the handler of the message with a view of it.  Exceptions thrown by the handler are passed on.
+	 *
+	 * @return True if a handler was invoked.
+	 */
+	bool Dispatch(IvpMessage *msg);
+
+	/**
+	 * @see Dispatch(IvpMessage *)
+	 */
+	bool Dispatch(tmx::routeable_message &routeableMsg);
+
+	/**
+	 * @return The number of handlers registered.
+	 */
+	std::size_t Count() const;
+
+private:
+	struct Entry
+	{
+		std::string type;
+		std::string subtype;
+		handler *h;
+	};
+
+	std::unordered_multimap<message_id, Entry> _handlers;
+};
+
+}} // namespace tmx::utils
+
+#endif /* SRC_MESSAGEDISPATCHER_H_ */
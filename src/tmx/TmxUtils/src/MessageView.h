@@ -0,0 +1,109 @@
+/*
+ * MessageView.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_MESSAGEVIEW_H_
+#define SRC_MESSAGEVIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <tmx/IvpMessage.h>
+#include <tmx/messages/byte_stream.hpp>
+#include <tmx/utils/HexCodec.h>
+
+namespace tmx {
+namespace utils {
+
+/**
+ * A read only view of a received message, for handlers that only need the header or the raw
+ * payload.  Nothing is copied, so the view is only valid for the duration of the handler call.
+ */
+class MessageView
+{
+public:
+	explicit MessageView(const IvpMessage *msg): _msg(msg) {}
+
+	/// @return The underlying message
+	inline const IvpMessage *get_message() const { return _msg; }
+
+	inline const char *get_type() const { return str(_msg->type); }
+	inline const char *get_subtype() const { return str(_msg->subtype); }
+	inline const char *get_source() const { return str(_msg->source); }
+	inline const char *get_encoding() const { return str(_msg->encoding); }
+	inline unsigned int get_sourceId() const { return _msg->sourceId; }
+	inline uint64_t get_timestamp() const { return _msg->timestamp; }
+	inline IvpMsgFlags get_flags() const { return _msg->flags; }
+
+	/**
+	 * @return The JSON payload of the message, or NULL if there is none.  A binary payload is
+	 * converted to its hex string the first time.
+	 */
+	inline const cJSON *get_payload() const { return ivpMsg_getPayload(const_cast<IvpMessage *>(_msg)); }
+
+	/**
+	 * @return The payload if it is a string, such as the hex bytes of an encoded J2735 message, or NULL
+	 */
+	inline const char *get_payload_str() const
+	{
+		const cJSON *payload = get_payload();
+		if (payload && payload->type == cJSON_String)
+			return payload->valuestring;
+		return NULL;
+	}
+
+	/**
+	 * @param length The number of bytes
+	 * @return The binary payload of the message, without any copy, or NULL if it is not binary
+	 */
+	inline const tmx::byte_t *get_payload_data(size_t &length) const
+	{
+		length = _msg->payloadLength;
+		return _msg->payloadBytes;
+	}
+
+	/**
+	 * Copy the binary payload, or decode the hex string payload, into the bytes, replacing the
+	 * contents.  The capacity of the byte stream is kept, so a handler can reuse one for every message.
+	 *
+	 * @return False if the payload is not binary or a string of hex digits
+	 */
+	bool get_payload_bytes(tmx::byte_stream &bytes) const
+	{
+		bytes.clear();
+
+		if (_msg->payloadBytes)
+		{
+			bytes.assign(_msg->payloadBytes, _msg->payloadBytes + _msg->payloadLength);
+			return true;
+		}
+
+		if (!_msg->payload || _msg->payload->type != cJSON_String || !_msg->payload->valuestring)
+			return false;
+
+		const char *hex = _msg->payload->valuestring;
+		size_t length = strlen(hex);
+		bytes.resize((length + 1) / 2);
+
+		if (hexCodec_decode(hex, length, bytes.data()) < 0)
+		{
+			bytes.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+private:
+	static inline const char *str(const char *s) { return s ? s : ""; }
+
+	const IvpMessage *_msg;
+};
+
+}} // namespace tmx::utils
+
+#endif /* SRC_MESSAGEVIEW_H_ */
@@ -0,0 +1,573 @@
+/*
+ * NtcipClient.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+#include "NtcipClient.h"
+#include "PluginLog.h"
+
+using namespace std;
+
+namespace tmx {
+namespace utils {
+
+struct NtcipClient::Request
+{
+	int command;
+	vector<string> oids;
+	vector<Variable> variables;
+	Callback callback;
+	chrono::steady_clock::time_point start;
+	// Set when the request failed as part of a combined PDU and has to be sent on its own
+	bool alone = false;
+
+	size_t Count() const { return command == SNMP_MSG_GET ? oids.size() : variables.size(); }
+};
+
+// One PDU sent to a device and waiting for the answer
+struct NtcipClient::Pending
+{
+	NtcipClient *client;
+	Device *device;
+	vector<Request *> requests;
+};
+
+struct NtcipClient::Device
+{
+	DeviceId id;
+	void *session;
+	DeviceOptions options;
+	string peer;
+	deque<Request *> queue;
+	unordered_set<Pending *> outstanding;
+};
+
+NtcipClient::Variable::Variable(const string &oid, long value):
+	oid(oid), asnType(ASN_INTEGER), integer(value)
+{
+}
+
+NtcipClient::Variable::Variable(const string &oid, char type, const string &value):
+	oid(oid), textType(type), value(value)
+{
+}
+
+NtcipClient::Variable::Variable(const string &oid, u_char asnType, const void *value, size_t length):
+	oid(oid), asnType(asnType), value((const char *)value, length)
+{
+}
+
+NtcipClient &NtcipClient::Shared()
+{
+	static NtcipClient client;
+	client.Start();
+	return client;
+}
+
+NtcipClient::NtcipClient()
+{
+	_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_wakeFd < 0)
+		throw NtcipClientError(string("Unable to create the event loop: ") + strerror(errno));
+}
+
+NtcipClient::~NtcipClient()
+{
+	Stop();
+	close(_wakeFd);
+}
+
+void NtcipClient::Start()
+{
+	static once_flag initialized;
+	call_once(initialized, []() { init_snmp("tmx"); });
+
+	lock_guard<mutex> lock(_mutex);
+	if (!_thread)
+	{
+		_active = true;
+		ThreadWorker::Start();
+	}
+}
+
+void NtcipClient::Stop()
+{
+	_active = false;
+	Wake();
+	ThreadWorker::Stop();
+}
+
+NtcipClient::DeviceId NtcipClient::OpenDevice(const string &address, int port, const DeviceOptions &options)
+{
+	string peer = address + ":" + to_string(port);
+
+	netsnmp_session session;
+	snmp_sess_init(&session);
+	session.peername = (char *)peer.c_str();
+	session.version = options.version;
+	session.community = (u_char *)options.community.c_str();
+	session.community_len = options.community.size();
+	session.timeout = (long)options.timeoutMs * 1000;
+	session.retries = options.retries;
+
+	// The session keeps its own copies of the peer name and community
+	void *handle = snmp_sess_open(&session);
+	if (!handle)
+		throw NtcipClientError("Unable to open an SNMP session to " + peer);
+
+	Device *device = new Device();
+	device->session = handle;
+	device->options = options;
+	device->peer = peer;
+	if (device->options.maxOutstanding == 0)
+		device->options.maxOutstanding = 1;
+
+	{
+		lock_guard<mutex> lock(_mutex);
+		device->id = _nextDeviceId++;
+		_devices[device->id] = device;
+	}
+
+	return device->id;
+}
+
+void NtcipClient::CloseDevice(DeviceId device)
+{
+	{
+		lock_guard<mutex> lock(_mutex);
+		_closing.push_back(device);
+	}
+
+	Wake();
+}
+
+void NtcipClient::Get(DeviceId device, const vector<string> &oids, Callback callback)
+{
+	Request *request = new Request();
+	request->command = SNMP_MSG_GET;
+	request->oids = oids;
+	request->callback = callback;
+	Enqueue(device, request);
+}
+
+void NtcipClient::Set(DeviceId device, const vector<Variable> &variables, Callback callback)
+{
+	Request *request = new Request();
+	request->command = SNMP_MSG_SET;
+	request->variables = variables;
+	request->callback = callback;
+	Enqueue(device, request);
+}
+
+future<NtcipClient::Response> NtcipClient::Get(DeviceId device, const vector<string> &oids)
+{
+	shared_ptr<promise<Response> > result = make_shared<promise<Response> >();
+	Get(device, oids, [result](const Response &response) { result->set_value(response); });
+	return result->get_future();
+}
+
+future<NtcipClient::Response> NtcipClient::Set(DeviceId device, const vector<Variable> &variables)
+{
+	shared_ptr<promise<Response> > result = make_shared<promise<Response> >();
+	Set(device, variables, [result](const Response &response) { result->set_value(response); });
+	return result->get_future();
+}
+
+size_t NtcipClient::get_MaxVariablesPerPdu() const
+{
+	return _maxVariablesPerPdu;
+}
+
+void NtcipClient::set_MaxVariablesPerPdu(size_t maxVariables)
+{
+	_maxVariablesPerPdu = maxVariables > 0 ? maxVariables : 1;
+}
+
+void NtcipClient::Enqueue(DeviceId device, Request *request)
+{
+	request->start = chrono::steady_clock::now();
+
+	if (request->Count() == 0)
+	{
+		Fail(request, Error);
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(_mutex);
+		if (_active)
+		{
+			_incoming.push_back(make_pair(device, request));
+			request = NULL;
+		}
+	}
+
+	if (request)
+		Fail(request, Closed);
+	else
+		Wake();
+}
+
+void NtcipClient::Wake()
+{
+	uint64_t one = 1;
+	if (write(_wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+		PLOG(logERROR) << "Unable to wake the NTCIP event loop: " << strerror(errno);
+}
+
+void NtcipClient::DoWork()
+{
+	vector<pair<DeviceId, Request *> > incoming;
+	vector<DeviceId> closing;
+	vector<Device *> devices;
+
+	while (_active)
+	{
+		{
+			lock_guard<mutex> lock(_mutex);
+			incoming.swap(_incoming);
+			closing.swap(_closing);
+
+			devices.clear();
+			for (auto &entry : _devices)
+				devices.push_back(entry.second);
+		}
+
+		for (auto &entry : incoming)
+		{
+			auto device = find_if(devices.begin(), devices.end(), [&](Device *d) { return d->id == entry.first; });
+			if (device == devices.end())
+				Fail(entry.second, Closed);
+			else
+				(*device)->queue.push_back(entry.second);
+		}
+		incoming.clear();
+
+		for (DeviceId id : closing)
+		{
+			auto device = find_if(devices.begin(), devices.end(), [&](Device *d) { return d->id == id; });
+			if (device == devices.end())
+				continue;
+
+			{
+				lock_guard<mutex> lock(_mutex);
+				_devices.erase(id);
+			}
+
+			Close(*device);
+			devices.erase(device);
+		}
+		closing.clear();
+
+		// Send what each device has room for, then wait for an answer, a timeout, or more work
+		int numfds = _wakeFd + 1;
+		fd_set fdset;
+		FD_ZERO(&fdset);
+		FD_SET(_wakeFd, &fdset);
+
+		struct timeval wait;
+		bool haveWait = false;
+
+		for (Device *device : devices)
+		{
+			while (device->outstanding.size() < device->options.maxOutstanding && !device->queue.empty())
+				SendNext(device);
+
+			int block = 1;
+			struct timeval timeout = { 0, 0 };
+			snmp_sess_select_info(device->session, &numfds, &fdset, &timeout, &block);
+			if (!block && (!haveWait || timercmp(&timeout, &wait, <)))
+			{
+				wait = timeout;
+				haveWait = true;
+			}
+		}
+
+		int ready = select(numfds, &fdset, NULL, NULL, haveWait ? &wait : NULL);
+		if (ready < 0)
+		{
+			if (errno != EINTR)
+				PLOG(logERROR) << "NTCIP event loop select failed: " << strerror(errno);
+			continue;
+		}
+
+		if (FD_ISSET(_wakeFd, &fdset))
+		{
+			uint64_t count;
+			while (read(_wakeFd, &count, sizeof(count)) > 0) { }
+		}
+
+		for (Device *device : devices)
+		{
+			if (ready > 0)
+				snmp_sess_read(device->session, &fdset);
+			snmp_sess_timeout(device->session);
+		}
+	}
+
+	{
+		lock_guard<mutex> lock(_mutex);
+		incoming.swap(_incoming);
+		_closing.clear();
+
+		devices.clear();
+		for (auto &entry : _devices)
+			devices.push_back(entry.second);
+		_devices.clear();
+	}
+
+	for (auto &entry : incoming)
+		Fail(entry.second, Closed);
+
+	for (Device *device : devices)
+		Close(device);
+}
+
+void NtcipClient::SendNext(Device *device)
+{
+	Pending *pending = new Pending();
+	pending->client = this;
+	pending->device = device;
+
+	Request *first = device->queue.front();
+	device->queue.pop_front();
+	pending->requests.push_back(first);
+
+	// Combine the GETs waiting behind this one into the same PDU, keeping them in order
+	if (first->command == SNMP_MSG_GET && !first->alone)
+	{
+		size_t count = first->Count();
+		while (!device->queue.empty())
+		{
+			Request *next = device->queue.front();
+			if (next->command != SNMP_MSG_GET || next->alone || count + next->Count() > _maxVariablesPerPdu)
+				break;
+
+			pending->requests.push_back(next);
+			count += next->Count();
+			device->queue.pop_front();
+		}
+	}
+
+	netsnmp_pdu *pdu = snmp_pdu_create(first->command);
+
+	for (auto it = pending->requests.begin(); it != pending->requests.end(); )
+	{
+		Request *request = *it;
+		bool ok = true;
+
+		for (size_t i = 0; ok && i < request->Count(); i++)
+		{
+			oid name[MAX_OID_LEN];
+			size_t nameLength = MAX_OID_LEN;
+			const string &text = (request->command == SNMP_MSG_GET ? request->oids[i] : request->variables[i].oid);
+
+			if (!snmp_parse_oid(text.c_str(), name, &nameLength))
+			{
+				PLOG(logERROR) << "Invalid OID " << text << " for " << device->peer;
+				ok = false;
+			}
+			else if (request->command == SNMP_MSG_GET)
+			{
+				snmp_add_null_var(pdu, name, nameLength);
+			}
+			else
+			{
+				const Variable &variable = request->variables[i];
+				if (variable.textType)
+					ok = snmp_add_var(pdu, name, nameLength, variable.textType, variable.value.c_str()) == 0;
+				else if (variable.value.empty() && variable.asnType == ASN_INTEGER)
+					ok = snmp_pdu_add_variable(pdu, name, nameLength, ASN_INTEGER, &variable.integer, sizeof(variable.integer)) != NULL;
+				else
+					ok = snmp_pdu_add_variable(pdu, name, nameLength, variable.asnType, variable.value.data(), variable.value.size()) != NULL;
+
+				if (!ok)
+					PLOG(logERROR) << "Invalid value for " << text << " on " << device->peer;
+			}
+		}
+
+		if (ok)
+		{
+			it++;
+			continue;
+		}
+
+		// A bad request cannot be part of a PDU, so start again without it
+		it = pending->requests.erase(it);
+		Fail(request, Error);
+
+		snmp_free_pdu(pdu);
+		pdu = snmp_pdu_create(first->command);
+		it = pending->requests.begin();
+		if (it != pending->requests.end())
+			first = *it;
+	}
+
+	if (pending->requests.empty())
+	{
+		snmp_free_pdu(pdu);
+		delete pending;
+		return;
+	}
+
+	if (!snmp_sess_async_send(device->session, pdu, &NtcipClient::OnResponse, pending))
+	{
+		int libError, snmpError;
+		char *message = NULL;
+		snmp_sess_error(device->session, &libError, &snmpError, &message);
+		PLOG(logERROR) << "Unable to send SNMP request to " << device->peer << ": " << (message ? message : "");
+		free(message);
+
+		snmp_free_pdu(pdu);
+		for (Request *request : pending->requests)
+			Fail(request, Error);
+		delete pending;
+		return;
+	}
+
+	device->outstanding.insert(pending);
+}
+
+int NtcipClient::OnResponse(int operation, netsnmp_session *session, int reqid, netsnmp_pdu *pdu, void *magic)
+{
+	Pending *pending = (Pending *)magic;
+	pending->client->Complete(pending, operation, pdu);
+	return 1;
+}
+
+void NtcipClient::Complete(Pending *pending, int operation, netsnmp_pdu *pdu)
+{
+	Device *device = pending->device;
+	if (device->outstanding.erase(pending) == 0)
+		return;
+
+	if (operation != NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE || pdu == NULL)
+	{
+		if (operation == NETSNMP_CALLBACK_OP_TIMED_OUT)
+			PLOG(logDEBUG) << "Timeout waiting for " << device->peer;
+
+		for (Request *request : pending->requests)
+			Fail(request, operation == NETSNMP_CALLBACK_OP_TIMED_OUT ? Timeout : Error);
+		delete pending;
+		return;
+	}
+
+	// An error in a combined PDU may belong to any of the requests, so try each on its own
+	if (pdu->errstat != SNMP_ERR_NOERROR && pending->requests.size() > 1)
+	{
+		for (auto it = pending->requests.rbegin(); it != pending->requests.rend(); it++)
+		{
+			(*it)->alone = true;
+			device->queue.push_front(*it);
+		}
+
+		delete pending;
+		return;
+	}
+
+	netsnmp_variable_list *vars = pdu->variables;
+
+	for (Request *request : pending->requests)
+	{
+		Response response;
+		response.status = Success;
+		response.errorStatus = pdu->errstat;
+		response.errorIndex = pdu->errindex;
+
+		size_t count = request->Count();
+		response.values.reserve(count);
+
+		for (size_t i = 0; i < count && vars; i++, vars = vars->next_variable)
+		{
+			Value value;
+			value.type = vars->type;
+			value.integer = 0;
+
+			for (size_t n = 0; n < vars->name_length; n++)
+			{
+				if (n > 0)
+					value.oid.push_back('.');
+				value.oid.append(to_string(vars->name[n]));
+			}
+
+			switch (vars->type)
+			{
+			case ASN_INTEGER:
+			case ASN_COUNTER:
+			case ASN_GAUGE:
+			case ASN_TIMETICKS:
+			case ASN_UINTEGER:
+				if (vars->val.integer)
+					value.integer = *vars->val.integer;
+				break;
+			case ASN_NULL:
+				break;
+			default:
+				if (vars->val.string && vars->val_len > 0)
+					value.string.assign((const char *)vars->val.string, vars->val_len);
+				break;
+			}
+
+			response.values.push_back(value);
+		}
+
+		Finish(request, response);
+	}
+
+	delete pending;
+}
+
+void NtcipClient::Close(Device *device)
+{
+	snmp_sess_close(device->session);
+
+	// Closing the session may already have completed some of these as timed out
+	for (Pending *pending : device->outstanding)
+	{
+		for (Request *request : pending->requests)
+			Fail(request, Closed);
+		delete pending;
+	}
+
+	for (Request *request : device->queue)
+		Fail(request, Closed);
+
+	delete device;
+}
+
+void NtcipClient::Finish(Request *request, Response &response)
+{
+	response.latencyMicroseconds = chrono::duration_cast<chrono::microseconds>(
+			chrono::steady_clock::now() - request->start).count();
+
+	try
+	{
+		if (request->callback)
+			request->callback(response);
+	}
+	catch (exception &ex)
+	{
+		PLOG(logERROR) << "NTCIP callback failed: " << ex.what();
+	}
+
+	delete request;
+}
+
+void NtcipClient::Fail(Request *request, Status status)
+{
+	Response response;
+	response.status = status;
+	Finish(request, response);
+}
+
+}} // namespace tmx::utils
@@ -0,0 +1,196 @@
+/*
+ * NtcipClient.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_NTCIPCLIENT_H_
+#define SRC_NTCIPCLIENT_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <tmx/TmxException.hpp>
+
+#include "ThreadWorker.h"
+
+namespace tmx {
+namespace utils {
+
+class NtcipClientError : public tmx::TmxException
+{
+public:
+	NtcipClientError(const std::string &w) : tmx::TmxException(w) {}
+};
+
+/**
+ * An SNMP client for NTCIP devices, such as signal controllers and message signs, that keeps one
+ * session open to each device and sends every request asynchronously from a single event loop.
+ *
+ * Each request is a GET or SET of any number of OIDs, carried in one PDU.  While a device already
+ * has its limit of requests outstanding, further GETs queue up and are sent together in one PDU,
+ * up to the limit of variables per PDU.  Timeouts and retries are handled by net-snmp for each
+ * device from the options it was opened with.  If a device rejects a GET that was combined from
+ * several requests, each request is sent again on its own so one bad OID does not fail the others.
+ *
+ * The results are delivered either to a callback, which runs on the event loop thread and must
+ * not block, or through a future.  All of the methods are thread safe.
+ */
+class NtcipClient: public ThreadWorker
+{
+public:
+	typedef int DeviceId;
+
+	enum Status
+	{
+		/// The device answered, although it may have reported an error in the response
+		Success,
+		/// The device did not answer within the timeout and retries
+		Timeout,
+		/// The request could not be built or sent
+		Error,
+		/// The device was closed, or was never opened, before the request completed
+		Closed
+	};
+
+	struct DeviceOptions
+	{
+		DeviceOptions() {}
+
+		std::string community = "public";
+		long version = SNMP_VERSION_1;
+		/// The time to wait for each try of a request
+		unsigned int timeoutMs = 1000;
+		/// The number of times to send a request again after a timeout
+		int retries = 2;
+		/// The most PDUs that may be waiting for an answer from the device at once
+		unsigned int maxOutstanding = 4;
+	};
+
+	/**
+	 * A variable returned by the device.
+	 */
+	struct Value
+	{
+		/// The OID in numeric dotted form
+		std::string oid;
+		u_char type;
+		/// The value of integer, counter, gauge and time tick variables
+		long integer;
+		/// The raw bytes of octet string and other variables
+		std::string string;
+	};
+
+	struct Response
+	{
+		Status status = Error;
+		/// The SNMP error status and index reported by the device, relative to this request
+		long errorStatus = SNMP_ERR_NOERROR;
+		long errorIndex = 0;
+		std::vector<Value> values;
+		/// The time from when the request was made until it completed
+		uint64_t latencyMicroseconds = 0;
+
+		/**
+		 * @return True if the device answered without an error.
+		 */
+		bool Ok() const { return status == Success && errorStatus == SNMP_ERR_NOERROR; }
+	};
+
+	/**
+	 * A variable to SET on a device.
+	 */
+	struct Variable
+	{
+		/// An INTEGER variable
+		Variable(const std::string &oid, long value);
+		/// A variable converted from text by net-snmp, where the type is one of the characters of
+		/// snmp_add_var, such as 'i' for INTEGER, 's' for a string or 'x' for hex bytes
+		Variable(const std::string &oid, char type, const std::string &value);
+		/// A variable of the given ASN type encoded from the raw value
+		Variable(const std::string &oid, u_char asnType, const void *value, size_t length);
+
+		std::string oid;
+		char textType = 0;
+		u_char asnType = ASN_INTEGER;
+		long integer = 0;
+		std::string value;
+	};
+
+	typedef std::function<void(const Response &)> Callback;
+
+	/**
+	 * @return The client shared by the whole process, which is started on first use.
+	 */
+	static NtcipClient &Shared();
+
+	NtcipClient();
+	virtual ~NtcipClient();
+
+	void Start();
+	void Stop();
+
+	/**
+	 * Open a session to a device.  No packets are sent until the first request.
+	 *
+	 * @return The ID to use for requests to the device.
+	 * @throws NtcipClientError If the session could not be opened.
+	 */
+	DeviceId OpenDevice(const std::string &address, int port, const DeviceOptions &options = DeviceOptions());
+
+	/**
+	 * Close the session to a device.  Any requests still waiting complete with a status of Closed.
+	 */
+	void CloseDevice(DeviceId device);
+
+	void Get(DeviceId device, const std::vector<std::string> &oids, Callback callback);
+	void Set(DeviceId device, const std::vector<Variable> &variables, Callback callback);
+
+	std::future<Response> Get(DeviceId device, const std::vector<std::string> &oids);
+	std::future<Response> Set(DeviceId device, const std::vector<Variable> &variables);
+
+	size_t get_MaxVariablesPerPdu() const;
+	void set_MaxVariablesPerPdu(size_t maxVariables);
+
+protected:
+	void DoWork();
+
+private:
+	struct Request;
+	struct Pending;
+	struct Device;
+
+	void Enqueue(DeviceId device, Request *request);
+	void Wake();
+	void SendNext(Device *device);
+	void Close(Device *device);
+	void Complete(Pending *pending, int operation, netsnmp_pdu *pdu);
+	void Finish(Request *request, Response &response);
+	void Fail(Request *request, Status status);
+
+	static int OnResponse(int operation, netsnmp_session *session, int reqid, netsnmp_pdu *pdu, void *magic);
+
+	std::mutex _mutex;
+	std::map<DeviceId, Device *> _devices;
+	std::vector<std::pair<DeviceId, Request *> > _incoming;
+	std::vector<DeviceId> _closing;
+	DeviceId _nextDeviceId = 1;
+
+	std::atomic<size_t> _maxVariablesPerPdu {32};
+
+	int _wakeFd = -1;
+};
+
+}} // namespace tmx::utils
+
+#endif /* SRC_NTCIPCLIENT_H_ */
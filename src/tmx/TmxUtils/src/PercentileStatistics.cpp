@@ -0,0 +1,101 @@
+/*
+ * PercentileStatistics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "PercentileStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace tmx {
+namespace utils {
+
+PercentileStatistics::PercentileStatistics(size_t capacity) :
+	_samples(capacity > 0 ? capacity : 1)
+{
+	_sorted.reserve(_samples.size());
+}
+
+void PercentileStatistics::Add(double sample)
+{
+	_samples[_next] = sample;
+	_next = (_next + 1) % _samples.size();
+
+	if (_size < _samples.size())
+		_size++;
+
+	_count++;
+}
+
+void PercentileStatistics::Clear()
+{
+	_next = 0;
+	_size = 0;
+	_count = 0;
+}
+
+double PercentileStatistics::Percentile(double percentile) const
+{
+	if (_size == 0)
+		return 0;
+
+	if (percentile < 0)
+		percentile = 0;
+	if (percentile > 100)
+		percentile = 100;
+
+	_sorted.assign(_samples.begin(), _samples.begin() + _size);
+
+	// Nearest rank
+	size_t rank = (size_t)ceil(percentile / 100.0 * _size);
+	size_t index = rank > 0 ? rank - 1 : 0;
+
+	nth_element(_sorted.begin(), _sorted.begin() + index, _sorted.end());
+	return _sorted[index];
+}
+
+size_t PercentileStatistics::Size() const
+{
+	return _size;
+}
+
+uint64_t PercentileStatistics::Count() const
+{
+	return _count;
+}
+
+double PercentileStatistics::Min() const
+{
+	if (_size == 0)
+		return 0;
+
+	return *min_element(_samples.begin(), _samples.begin() + _size);
+}
+
+double PercentileStatistics::Max() const
+{
+	if (_size == 0)
+		return 0;
+
+	return *max_element(_samples.begin(), _samples.begin() + _size);
+}
+
+double PercentileStatistics::Mean() const
+{
+	if (_size == 0)
+		return 0;
+
+	double sum = 0;
+	for (size_t i = 0; i < _size; i++)
+		sum += _samples[i];
+
+	return sum / _size;
+}
+
+} /* namespace utils */
+} /* namespace tmx */
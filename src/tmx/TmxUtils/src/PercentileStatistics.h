@@ -0,0 +1,76 @@
+/*
+ * PercentileStatistics.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_PERCENTILESTATISTICS_H_
+#define SRC_PERCENTILESTATISTICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tmx {
+namespace utils {
+
+/**
+ * Keeps a window of the most recent samples of a measurement, such as a latency or a
+ * scheduling error, and computes percentiles over that window.
+ *
+ * Samples are stored in a fixed size ring buffer that is allocated up front, so adding a
+ * sample never allocates.  This class is not thread safe.
+ */
+class PercentileStatistics
+{
+public:
+	/**
+	 * @param capacity The number of most recent samples kept in the window.
+	 */
+	PercentileStatistics(size_t capacity = 1000);
+
+	/**
+	 * Add a sample to the window, replacing the oldest sample if the window is full.
+	 */
+	void Add(double sample);
+
+	/**
+	 * Remove all samples.
+	 */
+	void Clear();
+
+	/**
+	 * @param percentile The percentile to compute, from 0 to 100.
+	 * @return The value at the given percentile of the samples in the window, or 0 if there are no samples.
+	 */
+	double Percentile(double percentile) const;
+
+	/**
+	 * @return The number of samples in the window.
+	 */
+	size_t Size() const;
+
+	/**
+	 * @return The total number of samples added since construction or the last Clear.
+	 */
+	uint64_t Count() const;
+
+	double Min() const;
+	double Max() const;
+	double Mean() const;
+
+private:
+	std::vector<double> _samples;
+	size_t _next = 0;
+	size_t _size = 0;
+	uint64_t _count = 0;
+
+	// Scratch space used to sort the samples when computing a percentile
+	mutable std::vector<double> _sorted;
+};
+
+} /* namespace utils */
+} /* namespace tmx */
+
+#endif /* SRC_PERCENTILESTATISTICS_H_ */
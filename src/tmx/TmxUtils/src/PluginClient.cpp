@@ -276,14 +276,13 @@ void PluginClient::OnMessageReceived(IvpMessage *msg)
 	static unsigned int count = 1;
 	count++;
 
-	routeable_message routeableMsg(msg);
-
-	PLOG(logDEBUG1) << "Received Message. Type: " << routeableMsg.get_type() <<
-			", Subtype: " << routeableMsg.get_subtype() <<
-			", Source: " << routeableMsg.get_source() <<
+	PLOG(logDEBUG1) << "Received Message. Type: " << (msg->type ? msg->type : "") <<
+			", Subtype: " << (msg->subtype ? msg->subtype : "") <<
+			", Source: " << (msg->source ? msg->source : "") <<
 			", Count: " << count;
 
-	invoke_handler(routeableMsg.get_type(), routeableMsg.get_subtype(), routeableMsg);
+	// The routeable message is only built if there is a handler for this type
+	invoke_handler(msg);
 }
 
 // static wrapper for OnStateChange.
@@ -367,8 +366,7 @@ bool PluginClient::invoke_handler(string messageType, string messageSubType,
 {
 	try
 	{
-		handler_allocator *allocator =
-				_msgHandlers[pair<string, string>(messageType, messageSubType)];
+		handler_allocator *allocator = _msgHandlers.Find(messageType.c_str(), messageSubType.c_str());
 		if (allocator)
 			allocator->invokeHandler(routeableMsg);
 		else
@@ -383,6 +381,19 @@ bool PluginClient::invoke_handler(string messageType, string messageSubType,
 	return true;
 }
 
+bool PluginClient::invoke_handler(IvpMessage *msg)
+{
+	try
+	{
+		return _msgHandlers.Dispatch(msg);
+	}
+	catch (exception &ex)
+	{
+		HandleException(ex, false);
+		return false;
+	}
+}
+
 void PluginClient::handleMessage(message &msg, routeable_message &src)
 {
 	throw PluginException(this->_name + " received unhandled message of Type=" +
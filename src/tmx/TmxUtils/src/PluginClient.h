@@ -25,6 +25,7 @@
 #include <tmx/IvpPlugin.h>
 
 #include "Clock.h"
+#include "MessageDispatcher.h"
 #include "PluginExec.h"
 #include "PluginLog.h"
 #include "PluginException.h"
@@ -86,24 +87,43 @@ public:
 	template <typename MsgType, class HandlerType>
 	void AddMessageFilter(HandlerType *plugin, void (HandlerType::*handler)(MsgType &, tmx::routeable_message &) = 0)
 	{
-		typedef MsgType msg_type;
+		add_message_filter<MsgType>();
 
-		AddMessageFilter(MsgType::MessageType, MsgType::MessageSubType);
-
-		std::string typeName(MsgType::MessageType);
-		std::string subTypeName(MsgType::MessageSubType);
+		if (handler)
+			this->register_handler<MsgType>(plugin, handler);
+		else
+			this->register_handler<MsgType>(plugin, &HandlerType::handleMessage);
+	}
 
-		static msg_type msgType;
+	/// Register a handler that takes the payload by const reference.  The payload is built once
+	/// for the handler, directly from the received string when it is one (e.g. encoded J2735).
+	template <typename MsgType, class HandlerType>
+	void AddMessageFilter(HandlerType *plugin, void (HandlerType::*handler)(const MsgType &, tmx::routeable_message &))
+	{
+		add_message_filter<MsgType>();
+		this->register_handler<MsgType>(plugin, handler);
+	}
 
-		PLOG(logINFO) << "Registering message type " <<
-				battelle::attributes::type_id_name<msg_type>() <<
-				" for receiving message Type=" << typeName <<
-				", SubType=" << subTypeName;
+	/// Register a handler that takes a view of the received message, for high rate messages such
+	/// as the BSM that are forwarded or inspected without building the routeable message or payload.
+	/// The message type must be given, e.g. AddMessageFilter<BsmMessage>(this, &MyPlugin::HandleBsm).
+	template <typename MsgType, class HandlerType>
+	void AddMessageFilter(HandlerType *plugin, void (HandlerType::*handler)(const MessageView &))
+	{
+		add_message_filter<MsgType>();
+		this->register_handler<MsgType>(plugin, handler);
+	}
 
-		if (handler)
-			this->register_handler(plugin, typeName, subTypeName, handler);
-		else
-			this->register_handler(plugin, typeName, subTypeName, &HandlerType::handleMessage);
+	/// Register a passthrough handler, for plugins that forward the encoded message as is.  The
+	/// handler gets a view of the header and the raw payload bytes, without any message being built.
+	/// The bytes are decoded from the hex payload into a buffer that is reused for every message,
+	/// so they are only valid for the duration of the call.
+	/// The message type must be given, e.g. AddMessageFilter<BsmMessage>(this, &MyPlugin::ForwardBsm).
+	template <typename MsgType, class HandlerType>
+	void AddMessageFilter(HandlerType *plugin, void (HandlerType::*handler)(const MessageView &, const tmx::byte_stream &))
+	{
+		add_message_filter<MsgType>();
+		this->register_handler<MsgType>(plugin, handler);
 	}
 
 	/// Broadcast a message to TMX core and optionally route it out the DSRC radio.
@@ -152,6 +172,20 @@ public:
 		ivpMsg_destroy(const_cast<IvpMessage *>(copy));
 	}
 
+	/// Broadcast a message frame prebuilt with ivp_createMsgFrame, stamped with the current time.
+	/// Only the timestamp in the frame changes, so the message is not serialized again.
+	/// @param frame The frame to send
+	void BroadcastFrame(IvpMsgFrame *frame)
+	{
+		if (!frame)
+			return;
+
+		ivp_broadcastMsgFrame(_plugin, frame, tmx::routeable_message::get_millisecondsSinceEpoch());
+
+		if (!IsMessageOfType<tmx::messages::KeepAliveMessage>(frame->msg))
+			this->_keepAlive->touch();
+	}
+
 	/// Function for determining if a IvpMessage received from the core is a specific type.
 	/// Validates the type category and subtype category.
 	/// @param message The message to compare against the message type specified.
@@ -382,12 +416,24 @@ private:
 	std::map<std::string, std::string> _statusMap;
 
 	// Code for message handler registration and invoking
-	struct handler_allocator {
-		virtual ~handler_allocator() {}
+	typedef MessageDispatcher::handler handler_allocator;
 
-		virtual std::string get_messageType() = 0;
-		virtual void invokeHandler(tmx::routeable_message &routeableMsg) = 0;
-	};
+	template <typename MsgType>
+	void add_message_filter()
+	{
+		AddMessageFilter(MsgType::MessageType, MsgType::MessageSubType);
+
+		PLOG(logINFO) << "Registering message type " <<
+				battelle::attributes::type_id_name<MsgType>() <<
+				" for receiving message Type=" << MsgType::MessageType <<
+				", SubType=" << MsgType::MessageSubType;
+	}
+
+	// The message under the routeable message, without the copy that the non-const get_message makes
+	static inline const IvpMessage *const_msg(const tmx::routeable_message &routeableMsg)
+	{
+		return routeableMsg.get_message();
+	}
 
 	template <typename MsgType, class PluginType, class HandlerType>
 	struct handler_allocator_impl: public handler_allocator {
@@ -415,20 +461,196 @@ private:
 		void (HandlerType::*fn)(MsgType &, tmx::routeable_message &);
 	};
 
-	// Map for message handlers
-	std::map<std::pair<std::string, std::string>, handler_allocator *> _msgHandlers;
+	template <typename MsgType, class PluginType, class HandlerType>
+	struct handler_const_impl: public handler_allocator {
+		handler_const_impl(PluginType *plugin,
+				void (HandlerType::*handler)(const MsgType &, tmx::routeable_message &)):
+					instance(plugin), fn(handler) {}
+
+		std::string get_messageType()
+		{
+			return battelle::attributes::type_id_name<MsgType>();
+		}
+
+		void invokeHandler(tmx::routeable_message &routeableMsg)
+		{
+			MsgType msg;
+
+			const IvpMessage *ivpMsg = const_msg(routeableMsg);
+			size_t length = 0;
+			if (ivpMsg && MessageView(ivpMsg).get_payload_data(length))
+			{
+				// A binary payload is decoded from the bytes, without asking for the hex string of it
+				if (!from_bytes(msg, MessageView(ivpMsg), 0))
+					msg = routeableMsg.template get_payload<MsgType>();
+
+				(instance->*fn)(msg, routeableMsg);
+				return;
+			}
+
+			// A string payload is the contents as is, as long as it has nothing that the routeable
+			// message would escape when converting it
+			const char *payload = ivpMsg ? MessageView(ivpMsg).get_payload_str() : NULL;
+			if (payload && !has_escapes(payload))
+			{
+				if (*payload)
+					msg.set_contents(std::string(payload));
+			}
+			else
+			{
+				msg = routeableMsg.template get_payload<MsgType>();
+			}
+
+			(instance->*fn)(msg, routeableMsg);
+		}
+	private:
+		// An encoded J2735 message is decoded straight from the payload bytes
+		template <typename T>
+		static auto from_bytes(T &msg, const MessageView &view, int) -> decltype(T::get_descriptor(), bool())
+		{
+			// Each receiving thread keeps its own buffer, which only grows
+			static thread_local tmx::byte_stream bytes;
+			if (!view.get_payload_bytes(bytes))
+				return false;
+
+			tmx::messages::TmxJ2735EncodedMessage<T> encMsg;
+			encMsg.set_data(bytes);
+			if (*view.get_encoding())
+				encMsg.set_encoding(view.get_encoding());
+
+			msg = encMsg.template get_payload<T>();
+			return true;
+		}
+
+		// Any other type is only read from its string form
+		template <typename T>
+		static bool from_bytes(T &, const MessageView &, long)
+		{
+			return false;
+		}
+
+		static bool has_escapes(const char *s)
+		{
+			for (; *s; s++)
+			{
+				if ((unsigned char)*s < 0x20 || *s == '"' || *s == '\\')
+					return true;
+			}
+			return false;
+		}
+
+		PluginType *instance;
+		void (HandlerType::*fn)(const MsgType &, tmx::routeable_message &);
+	};
+
+	template <typename MsgType, class PluginType, class HandlerType>
+	struct handler_view_impl: public handler_allocator {
+		handler_view_impl(PluginType *plugin, void (HandlerType::*handler)(const MessageView &)):
+			instance(plugin), fn(handler) {}
+
+		std::string get_messageType()
+		{
+			return battelle::attributes::type_id_name<MsgType>();
+		}
+
+		void invokeHandler(tmx::routeable_message &routeableMsg)
+		{
+			(instance->*fn)(MessageView(const_msg(routeableMsg)));
+		}
+
+		void dispatch(const MessageView &view)
+		{
+			(instance->*fn)(view);
+		}
+	private:
+		PluginType *instance;
+		void (HandlerType::*fn)(const MessageView &);
+	};
 
 	template <typename MsgType, class PluginType, class HandlerType>
-	void register_handler(PluginType *plugin, std::string messageType, std::string messageSubType,
-			void (HandlerType::*handler)(MsgType &, tmx::routeable_message &))
+	struct handler_passthrough_impl: public handler_allocator {
+		handler_passthrough_impl(PluginType *plugin,
+				void (HandlerType::*handler)(const MessageView &, const tmx::byte_stream &)):
+					instance(plugin), fn(handler) {}
+
+		std::string get_messageType()
+		{
+			return battelle::attributes::type_id_name<MsgType>();
+		}
+
+		void invokeHandler(tmx::routeable_message &routeableMsg)
+		{
+			const IvpMessage *ivpMsg = const_msg(routeableMsg);
+			if (!ivpMsg)
+				throw PluginException("Missing message for " + get_messageType());
+
+			dispatch(MessageView(ivpMsg));
+		}
+
+		void dispatch(const MessageView &view)
+		{
+			// Each receiving thread keeps its own buffer, which only grows
+			static thread_local tmx::byte_stream bytes;
+
+			if (!view.get_payload_bytes(bytes))
+				throw PluginException("Payload of " + get_messageType() + " is not encoded bytes");
+
+			(instance->*fn)(view, bytes);
+		}
+	private:
+		PluginType *instance;
+		void (HandlerType::*fn)(const MessageView &, const tmx::byte_stream &);
+	};
+
+	// Hash table of the message handlers by the message ID of the type and subtype
+	MessageDispatcher _msgHandlers;
+
+	// The handler is registered under the ID of the filtered message type, which is computed at
+	// compile time.  The payload type of the handler is deduced separately.
+	template <typename FilterType>
+	void register_handler(handler_allocator *allocator)
+	{
+		_msgHandlers.Register(message_id_of<FilterType>::value, FilterType::MessageType, FilterType::MessageSubType, allocator);
+	}
+
+	template <typename FilterType, typename MsgType, class PluginType, class HandlerType>
+	void register_handler(PluginType *plugin, void (HandlerType::*handler)(MsgType &, tmx::routeable_message &))
 	{
 		static handler_allocator_impl<MsgType, PluginType, HandlerType> *allocator =
 				new handler_allocator_impl<MsgType, PluginType, HandlerType>(plugin, handler);
 
-		_msgHandlers[std::pair<std::string, std::string>(messageType, messageSubType)] = allocator;
+		register_handler<FilterType>(allocator);
+	}
+
+	template <typename FilterType, typename MsgType, class PluginType, class HandlerType>
+	void register_handler(PluginType *plugin, void (HandlerType::*handler)(const MsgType &, tmx::routeable_message &))
+	{
+		static handler_const_impl<MsgType, PluginType, HandlerType> *allocator =
+				new handler_const_impl<MsgType, PluginType, HandlerType>(plugin, handler);
+
+		register_handler<FilterType>(allocator);
+	}
+
+	template <typename FilterType, class PluginType, class HandlerType>
+	void register_handler(PluginType *plugin, void (HandlerType::*handler)(const MessageView &))
+	{
+		static handler_view_impl<FilterType, PluginType, HandlerType> *allocator =
+				new handler_view_impl<FilterType, PluginType, HandlerType>(plugin, handler);
+
+		register_handler<FilterType>(allocator);
+	}
+
+	template <typename FilterType, class PluginType, class HandlerType>
+	void register_handler(PluginType *plugin, void (HandlerType::*handler)(const MessageView &, const tmx::byte_stream &))
+	{
+		static handler_passthrough_impl<FilterType, PluginType, HandlerType> *allocator =
+				new handler_passthrough_impl<FilterType, PluginType, HandlerType>(plugin, handler);
+
+		register_handler<FilterType>(allocator);
 	}
 
 	bool invoke_handler(std::string, std::string, tmx::routeable_message &);
+	bool invoke_handler(IvpMessage *);
 };
 
 template<>
@@ -213,6 +213,24 @@ public:
 		return tId;
 	}
 
+	/**
+	 * Assign a group and id to a specific thread, instead of one picked by the assignment strategy.
+	 * The assignment is removed the same way, with unassign().
+	 *
+	 * @param group The group identifier
+	 * @param id The unique identifier in the group
+	 * @param threadId The thread to assign to
+	 * @return The thread id, or -1 if there is no such thread
+	 */
+	int assign(group_type group, id_type id, int threadId) {
+		if (threadId < 0 || threadId >= (int)_threads.size())
+			return -1;
+
+		assignments[group][id].count++;
+		assignments[group][id].threadId = threadId;
+		return threadId;
+	}
+
 	/**
 	 * Remove a thread assignment for a specific group and id, assuming no more tasks
 	 * exists for that thread to finish.  If this is never called, then the thread
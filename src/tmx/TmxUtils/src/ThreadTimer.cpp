@@ -24,121 +24,187 @@ ThreadTimer::ThreadTimer(std::chrono::milliseconds precision) :
 
 ThreadTimer::~ThreadTimer()
 {
+	Stop();
+}
+
+void ThreadTimer::Start()
+{
+	{
+		lock_guard<mutex> lock(_lock);
+		_stopRequested = false;
+	}
+
+	ThreadWorker::Start();
+}
+
+void ThreadTimer::Stop()
+{
+	{
+		lock_guard<mutex> lock(_lock);
+		_stopRequested = true;
+	}
+
+	_wakeup.notify_all();
+
+	ThreadWorker::Stop();
 }
 
 uint ThreadTimer::AddPeriodicTick(const std::function<void(void)> &periodicTick,
 		std::chrono::milliseconds frequency, std::chrono::milliseconds startDelay)
 {
-	lock_guard<mutex> lock(_lock);
+	uint id;
 
-	PeriodicTickData tick;
-	tick.PeriodicTick = periodicTick;
-	tick.Frequency = frequency;
-	tick.StartDelay = startDelay;
+	{
+		lock_guard<mutex> lock(_lock);
+
+		PeriodicTickData tick;
+		tick.PeriodicTick = periodicTick;
+		tick.Frequency = frequency;
+		tick.StartDelay = startDelay;
+
+		_periodicTicks.push_back(tick);
+
+		id = _periodicTicks.size() - 1;
+
+		// Ticks added before the thread starts are scheduled relative to the start time in DoWork.
+		if (!_started)
+			return id;
+
+		steady_clock::time_point startTime = steady_clock::now() + startDelay;
+		_periodicTicks[id].LastTickTime = startTime - frequency;
+		if (frequency > milliseconds(0))
+			Schedule(id, startTime);
+	}
 
-	_periodicTicks.push_back(tick);
+	_wakeup.notify_all();
 
-	return _periodicTicks.size() - 1;
+	return id;
 }
 
 void ThreadTimer::ChangeFrequency(uint id, std::chrono::milliseconds frequency)
 {
-	lock_guard<mutex> lock(_lock);
-
-	if (id >= _periodicTicks.size())
 	{
-		PLOG(logERROR) << "ChangeFrequency: Invalid ID.";
-		throw tmx::TmxException("ChangeFrequency: Invalid ID");
+		lock_guard<mutex> lock(_lock);
+
+		if (id >= _periodicTicks.size())
+		{
+			PLOG(logERROR) << "ChangeFrequency: Invalid ID.";
+			throw tmx::TmxException("ChangeFrequency: Invalid ID");
+		}
+
+		PeriodicTickData &tick = _periodicTicks[id];
+		tick.Frequency = frequency;
+
+		if (!_started)
+			return;
+
+		if (frequency > milliseconds(0))
+			Schedule(id, tick.LastTickTime + frequency);
+		else
+			tick.Generation++;
 	}
 
-	_periodicTicks[id].Frequency = frequency;
+	_wakeup.notify_all();
 }
 
 void ThreadTimer::TriggerNow(uint id)
 {
-	lock_guard<mutex> lock(_lock);
-
-	if (id >= _periodicTicks.size())
 	{
-		PLOG(logERROR) << "ChangeFrequency: Invalid ID.";
-		throw tmx::TmxException("ChangeFrequency: Invalid ID");
+		lock_guard<mutex> lock(_lock);
+
+		if (id >= _periodicTicks.size())
+		{
+			PLOG(logERROR) << "ChangeFrequency: Invalid ID.";
+			throw tmx::TmxException("ChangeFrequency: Invalid ID");
+		}
+
+		PeriodicTickData &tick = _periodicTicks[id];
+		tick.LastTickTime = steady_clock::now() - tick.Frequency;
+
+		if (!_started || tick.Frequency <= milliseconds(0))
+			return;
+
+		Schedule(id, steady_clock::now());
 	}
-	_periodicTicks[id].LastTickTime = steady_clock::now() - _periodicTicks[id].Frequency;
-
-//	if (!_stopThread)
-//	{
-//		for (uint index = 0; true; index++)
-//		{
-//			// Get a copy of the data for the current function to call.
-//			// A copy is obtained so that the lock is not held while the PeriodicTick function is called.
-//			PeriodicTickData tick;
-//			{
-//				lock_guard<mutex> lock(_lock);
-//
-//				if (index >= _periodicTicks.size())
-//					break;
-//
-//				tick = _periodicTicks[index];
-//			}
-//
-//			// Call the function.
-//			tick.PeriodicTick();
-//		}
-//	}
+
+	_wakeup.notify_all();
+}
+
+void ThreadTimer::Schedule(uint id, std::chrono::steady_clock::time_point deadline)
+{
+	PeriodicTickData &tick = _periodicTicks[id];
+	tick.NextTickTime = deadline;
+	tick.Generation++;
+
+	PeriodicTickDeadline entry;
+	entry.Deadline = deadline;
+	entry.Id = id;
+	entry.Generation = tick.Generation;
+	_deadlines.push(entry);
 }
 
 void ThreadTimer::DoWork()
 {
+	unique_lock<mutex> lock(_lock);
+
 	steady_clock::time_point startTime = steady_clock::now();
 
-	{
-		lock_guard<mutex> lock(_lock);
+	_started = true;
+	_deadlines = priority_queue<PeriodicTickDeadline>();
 
-		for (PeriodicTickData &tick: _periodicTicks)
-		{
-			tick.LastTickTime = startTime - tick.Frequency + tick.StartDelay;
-		}
+	for (uint id = 0; id < _periodicTicks.size(); id++)
+	{
+		PeriodicTickData &tick = _periodicTicks[id];
+		tick.LastTickTime = startTime - tick.Frequency + tick.StartDelay;
+		if (tick.Frequency > milliseconds(0))
+			Schedule(id, startTime + tick.StartDelay);
 	}
 
-	while (IsRunning())
+	while (!_stopRequested)
 	{
-		for (uint index = 0; true; index++)
+		if (_deadlines.empty())
 		{
-			// Get a copy of the data for the current function to call.
-			// A copy is obtained so that the lock is not held while the PeriodicTick function is called.
-			PeriodicTickData tick;
-			{
-				lock_guard<mutex> lock(_lock);
-
-				if (index >= _periodicTicks.size())
-					break;
+			_wakeup.wait(lock);
+			continue;
+		}
 
-				tick = _periodicTicks[index];
-			}
+		PeriodicTickDeadline next = _deadlines.top();
+		PeriodicTickData &tick = _periodicTicks[next.Id];
 
-			// Call the function if the frequency has arrived.
+		// Discard deadlines that were replaced by a later call to ChangeFrequency or TriggerNow.
+		if (next.Generation != tick.Generation)
+		{
+			_deadlines.pop();
+			continue;
+		}
 
-			steady_clock::time_point now = steady_clock::now();
+		steady_clock::time_point now = steady_clock::now();
+		if (now < next.Deadline)
+		{
+			_wakeup.wait_until(lock, next.Deadline);
+			continue;
+		}
 
-			milliseconds period = duration_cast<milliseconds> (now - tick.LastTickTime);
+		_deadlines.pop();
 
-			if (tick.Frequency > milliseconds(0) && period >= tick.Frequency)
-			{
-				// Call the function.
-				tick.PeriodicTick();
+		// The following deadline is computed from this deadline instead of the current time so that
+		// the calls do not drift.  If the tick is running behind, the missed periods are skipped.
+		steady_clock::time_point following = next.Deadline + tick.Frequency;
+		if (following <= now)
+			following += tick.Frequency * ((now - following) / tick.Frequency + 1);
 
-				// Update the last time the function was called.
-				// Assume that elements are never removed from the _periodicTicks vector and that
-				// they are never rearranged (i.e. index still refers to the same element).
-				{
-					lock_guard<mutex> lock(_lock);
-					_periodicTicks[index].LastTickTime = now;
-				}
-			}
-		}
+		tick.LastTickTime = now;
+		Schedule(next.Id, following);
 
-		std::this_thread::sleep_for(_precision);
+		// Call the function without holding the lock.
+		// The reference remains valid since elements are never removed from the _periodicTicks deque,
+		// and the function itself is never modified after it is added.
+		lock.unlock();
+		tick.PeriodicTick();
+		lock.lock();
 	}
+
+	_started = false;
 }
 
 } /* namespace utils */
@@ -9,8 +9,11 @@
 #define SRC_THREADTIMER_H_
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <mutex>
+#include <queue>
 #include <vector>
 
 #include "ThreadWorker.h"
@@ -24,6 +27,27 @@ struct PeriodicTickData
 	std::chrono::milliseconds Frequency;
 	std::chrono::milliseconds StartDelay;
 	std::chrono::steady_clock::time_point LastTickTime;
+	std::chrono::steady_clock::time_point NextTickTime;
+
+	// Incremented each time the tick is rescheduled, which invalidates any older
+	// deadline entries for this tick that are still in the scheduler queue.
+	uint Generation = 0;
+};
+
+/**
+ * An entry in the deadline queue of the timer.
+ */
+struct PeriodicTickDeadline
+{
+	std::chrono::steady_clock::time_point Deadline;
+	uint Id;
+	uint Generation;
+
+	// Ordered so that the earliest deadline is at the top of a std::priority_queue.
+	bool operator<(const PeriodicTickDeadline &other) const
+	{
+		return Deadline > other.Deadline;
+	}
 };
 
 class ThreadTimer : public ThreadWorker
@@ -32,7 +56,11 @@ public:
 	/**
 	 * Construct a new timer that runs in a separate thread.
 	 *
-	 * @param precision The amount of time the thread will sleep between checks to call periodic tick functions.
+	 * The thread keeps a queue of deadlines ordered by time and sleeps until the earliest one
+	 * is due, so it does not wake up unless a tick function needs to be called.
+	 *
+	 * @param precision Retained for compatibility.  Deadlines are no longer polled, so this value
+	 * is not used to pace the thread.
 	 */
 	ThreadTimer(std::chrono::milliseconds precision = std::chrono::milliseconds(100));
 	virtual ~ThreadTimer();
@@ -42,7 +70,8 @@ public:
 	 *
 	 * If more than 1 periodic tick functions are added, then the execution of 1 function
 	 * may affect the timing of when the other function is called, since a single thread
-	 * is used to call each function.
+	 * is used to call each function.  Deadlines are computed from the previous deadline,
+	 * not from the time the function returned, so a late call does not cause drift.
 	 *
 	 * @param periodicTick The function to call.
 	 * @param frequency The interval that the function is called.
@@ -66,17 +95,37 @@ public:
 	*/
 	void TriggerNow(uint id);
 
+	/**
+	 * Start the timer thread.
+	 */
+	void Start();
+
+	/**
+	 * Stop the timer thread, waking it if it is waiting on a deadline.
+	 */
+	void Stop();
+
 private:
 	// Override of DoWork from BackgroundWorker.
 	void DoWork();
 
+	// Push a new deadline for the tick.  The lock must be held by the caller.
+	void Schedule(uint id, std::chrono::steady_clock::time_point deadline);
+
 	std::mutex _lock;
+	std::condition_variable _wakeup;
 	std::chrono::milliseconds _precision;
+	bool _started = false;
+	bool _stopRequested = false;
 
-	// Note that the internal code assumes that elements are never removed from this vector!
+	// Note that the internal code assumes that elements are never removed from this container!
 	// If a RemovePeriodicTick is ever written, a flag should just be added to PeriodicTickData
 	// to show that it is no longer in use.  The index of each element must never change.
-	std::vector<PeriodicTickData> _periodicTicks;
+	// A deque is used so that references to existing elements remain valid when a new tick
+	// is added, which allows the tick function to be called without copying it.
+	std::deque<PeriodicTickData> _periodicTicks;
+
+	std::priority_queue<PeriodicTickDeadline> _deadlines;
 };
 
 class ThreadTimerClient
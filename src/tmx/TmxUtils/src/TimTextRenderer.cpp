@@ -0,0 +1,182 @@
+/*
+ * TimTextRenderer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "TimTextRenderer.h"
+#include "ITISPhrase.h"
+
+#include <cstring>
+
+#if SAEJ2735_SPEC < 63
+#define TIM_CONTENT(X) content_PR_##X
+#else
+#define TIM_CONTENT(X) TravelerDataFrame__content_PR_##X
+#endif
+
+namespace tmx {
+namespace utils {
+
+// Every item choice in the TIM content has the same layout as ITIScodesAndText
+static constexpr int ITEM_NOTHING = ITIScodesAndText__Memberitem_PR_NOTHING;
+static constexpr int ITEM_ITIS = ITIScodesAndText__Memberitem_PR_itis;
+static constexpr int ITEM_TEXT = ITIScodesAndText__Memberitem_PR_text;
+
+/**
+ * Call the function with each item of the data frame content.
+ */
+template <typename Frame, typename Function>
+static void ForEachItem(const Frame &frame, Function function)
+{
+	switch (frame.content.present)
+	{
+	case TIM_CONTENT(advisory):
+		for (int i = 0; i < frame.content.choice.advisory.list.count; i++)
+			function(frame.content.choice.advisory.list.array[i]);
+		break;
+	case TIM_CONTENT(workZone):
+		for (int i = 0; i < frame.content.choice.workZone.list.count; i++)
+			function(frame.content.choice.workZone.list.array[i]);
+		break;
+	case TIM_CONTENT(genericSign):
+		for (int i = 0; i < frame.content.choice.genericSign.list.count; i++)
+			function(frame.content.choice.genericSign.list.array[i]);
+		break;
+	case TIM_CONTENT(speedLimit):
+		for (int i = 0; i < frame.content.choice.speedLimit.list.count; i++)
+			function(frame.content.choice.speedLimit.list.array[i]);
+		break;
+	case TIM_CONTENT(exitService):
+		for (int i = 0; i < frame.content.choice.exitService.list.count; i++)
+			function(frame.content.choice.exitService.list.array[i]);
+		break;
+	default:
+		break;
+	}
+}
+
+TimTextRenderer::TimTextRenderer(size_t maxEntries): _maxEntries(maxEntries)
+{
+}
+
+void TimTextRenderer::BuildKey(const TravelerInformation &tim, std::string &key)
+{
+	key.clear();
+
+	// Each data frame is written as its content type and the number of its items, followed by
+	// each item as its choice and value.  A missing frame has a content type of -1.  A text value is
+	// written after its length, so no two different contents can have the same key.
+	for (int i = 0; i < tim.dataFrames.list.count; i++)
+	{
+		int present = -1;
+		if (tim.dataFrames.list.array[i])
+			present = tim.dataFrames.list.array[i]->content.present;
+
+		key.append((const char *)&present, sizeof(present));
+		if (!tim.dataFrames.list.array[i])
+			continue;
+
+		// The number of items is filled in once they have been counted
+		size_t countOffset = key.size();
+		int count = 0;
+		key.append((const char *)&count, sizeof(count));
+
+		ForEachItem(*tim.dataFrames.list.array[i], [&key, &count](const auto *member)
+		{
+			count++;
+
+			// A missing item is shown just like an item with no choice
+			if (!member)
+			{
+				key.push_back((char)ITEM_NOTHING);
+				return;
+			}
+
+			key.push_back((char)member->item.present);
+			if (member->item.present == ITEM_ITIS)
+			{
+				long code = member->item.choice.itis;
+				key.append((const char *)&code, sizeof(code));
+			}
+			else if (member->item.present == ITEM_TEXT)
+			{
+				int size = member->item.choice.text.size;
+				key.append((const char *)&size, sizeof(size));
+				key.append((const char *)member->item.choice.text.buf, size);
+			}
+		});
+
+		memcpy(&key[countOffset], &count, sizeof(count));
+	}
+}
+
+void TimTextRenderer::Render(const TravelerInformation &tim, std::string &text)
+{
+	text.clear();
+
+	for (int i = 0; i < tim.dataFrames.list.count; i++)
+	{
+		if (!tim.dataFrames.list.array[i])
+			continue;
+
+		if (i > 0)
+			text.push_back('\n');
+
+		bool first = true;
+		ForEachItem(*tim.dataFrames.list.array[i], [&text, &first](const auto *member)
+		{
+			if (!member)
+				return;
+
+			if (member->item.present == ITEM_ITIS)
+			{
+				if (!first)
+					text.push_back(' ');
+
+				phrase_view phrase = ITISPhrase::Find((int)member->item.choice.itis);
+				if (phrase.empty())
+					text.append(std::to_string(member->item.choice.itis));
+				else
+					text.append(phrase.data(), phrase.size());
+			}
+			else if (member->item.present == ITEM_TEXT)
+			{
+				if (!first)
+					text.push_back(' ');
+
+				text.append((const char *)member->item.choice.text.buf, member->item.choice.text.size);
+			}
+			else
+			{
+				return;
+			}
+
+			first = false;
+		});
+	}
+}
+
+const std::string &TimTextRenderer::Render(const TravelerInformation &tim)
+{
+	BuildKey(tim, _key);
+
+	auto found = _cache.find(_key);
+	if (found != _cache.end())
+	{
+		_hits++;
+		return found->second;
+	}
+
+	_misses++;
+
+	if (_cache.size() >= _maxEntries)
+		_cache.clear();
+
+	std::string &text = _cache[_key];
+	Render(tim, text);
+	return text;
+}
+
+}} // namespace tmx::utils
@@ -0,0 +1,66 @@
+/*
+ * TimTextRenderer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_TIMTEXTRENDERER_H_
+#define SRC_TIMTEXTRENDERER_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <tmx/j2735_messages/TravelerInformationMessage.hpp>
+
+namespace tmx {
+namespace utils {
+
+/**
+ * Renders the display text of a TIM, for a message sign or a log.  Each data frame becomes one
+ * line, with the phrase of each ITIS code and each text item separated by spaces.  An ITIS code
+ * not in the table is shown as its number.
+ *
+ * A sign is updated with the same TIM content over and over, so the rendered text is cached by the
+ * content of the data frames.  A TIM that only differs in its count or timestamp is rendered from
+ * the cache, with no ITIS lookups and no string assembly.
+ *
+ * The renderer is not thread safe, so each thread needs its own.
+ */
+class TimTextRenderer
+{
+public:
+	/**
+	 * @param maxEntries The number of different contents to cache before starting over
+	 */
+	TimTextRenderer(size_t maxEntries = 256);
+
+	/**
+	 * Render the text of the TIM, from the cache if the same content was rendered before.
+	 *
+	 * @return The text, which is valid until the next call
+	 */
+	const std::string &Render(const TravelerInformation &tim);
+
+	/**
+	 * Render the text of the TIM, without the cache.
+	 */
+	static void Render(const TravelerInformation &tim, std::string &text);
+
+	uint64_t Hits() const { return _hits; }
+	uint64_t Misses() const { return _misses; }
+
+private:
+	static void BuildKey(const TravelerInformation &tim, std::string &key);
+
+	size_t _maxEntries;
+	std::string _key;
+	std::unordered_map<std::string, std::string> _cache;
+	uint64_t _hits = 0;
+	uint64_t _misses = 0;
+};
+
+}} // namespace tmx::utils
+
+#endif /* SRC_TIMTEXTRENDERER_H_ */
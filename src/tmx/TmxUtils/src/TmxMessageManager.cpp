@@ -75,8 +75,8 @@ private:
 
 std::mutex _threadLock;
 
-// This static factory initializes the map data for future use
-static tmx::messages::J2735MessageFactory factory;
+// The factory shared by all the threads, which also initializes the map data for future use
+static tmx::messages::J2735MessageFactory &factory = tmx::messages::J2735MessageFactory::get_instance();
 
 bool IsByteHexEncoded(const std::string &encoding)
 {
@@ -151,16 +151,13 @@ void RxThread::doWork(MessageStruct &msg) {
 		if (bytes.size()) {
 			if (IsByteHexEncoded(enc)) {
 				if (enc != messages::api::ENCODING_BYTEARRAY_STRING) {
-					// New factory needed to avoid race conditions
-					tmx::messages::J2735MessageFactory myFactory;
-
 					FILE_LOG(logDEBUG4) << this->Id() << ": Decoding from bytes " << bytes;
 
 					// Bytes are encoded.  First try to convert to a J2735 message
-					routeableMsg.reset(myFactory.NewMessage(bytes));
+					routeableMsg.reset(factory.NewMessage(bytes));
 
 					if (!routeableMsg)
-						FILE_LOG(logDEBUG4) << this->Id() << ": Not a J2735 message: " << myFactory.get_event();
+						FILE_LOG(logDEBUG4) << this->Id() << ": Not a J2735 message: " << factory.get_event();
 				}
 
 				if (!routeableMsg) {
@@ -431,6 +428,41 @@ void TmxMessageManager::IncomingMessage(const tmx::byte_t *bytes, size_t size, c
 	}
 }
 
+bool TmxMessageManager::IncomingMessageToThread(size_t threadId, const tmx::byte_t *bytes, size_t size, const char *encoding, byte_t groupId, byte_t uniqId, uint64_t timestamp) {
+	if (!bytes || threadId >= workerThreads.size())
+		return false;
+
+	RxThread *thread = dynamic_cast<RxThread *>(workerThreads[threadId]);
+	if (!thread)
+		return false;
+
+	MessageStruct in;
+	in.groupId = groupId;
+	in.uniqId = uniqId;
+	in.timestamp = timestamp;
+	in.encoding = (encoding == NULL ? NULL : strdup(encoding));
+	in.mgr = this;
+
+	in.msgLen = size;
+	in.msgBytes = (tmx::byte_t *) calloc(in.msgLen, sizeof(tmx::byte_t));
+	if (in.msgBytes)
+		memcpy(in.msgBytes, bytes, in.msgLen);
+
+	// The worker still cleans up the assignment after the message, so keep the count right
+	threadAssign.assign(groupId, uniqId, threadId);
+
+	if (!thread->push(in)) {
+		PLOG(logDEBUG3) << "Message lost when push to thread " << threadId << " failed";
+
+		threadAssign.unassign(groupId, uniqId);
+		if (in.encoding) free(in.encoding);
+		if (in.msgBytes) free(in.msgBytes);
+		return false;
+	}
+
+	return true;
+}
+
 void TmxMessageManager::IncomingMessage(const tmx::byte_stream &bytes, const char *encoding, tmx::byte_t groupId, tmx::byte_t uniqId, uint64_t timestamp) {
 	this->IncomingMessage(bytes.data(), bytes.size(), encoding, groupId, uniqId, timestamp);
 }
@@ -137,6 +137,25 @@ public:
 	 */
 	void IncomingMessage(const tmx::routeable_message &msg, tmx::byte_t groupId = 0, tmx::byte_t uniqId = 0, uint64_t timestamp = 0);
 
+	/**
+	 * Handle an incoming message as a byte stream on a specific worker thread, instead of one picked by the
+	 * assignment strategy.  This lets each of several receiver threads keep its own worker thread.  Note that
+	 * each worker thread takes its incoming messages from a single producer, so a receiver thread that uses
+	 * this function must be the only thread that sends incoming messages to that worker thread.
+	 *
+	 * @param threadId - The worker thread, from 0 to NumThreads() - 1
+	 * @param bytes - The bytes of the message.  These could be encoded or decoded bytes.
+	 * @param size - The number of bytes passed in.
+	 * @param encoding - The encoding of the bytes, or null for a non-encoded string
+	 * @param groupId - A one-byte group identifier for the source
+	 * @param uniqId - A one-byte unique identifier for the source in the group
+	 * @param timestamp - The timestamp of the message, or 0 for none
+	 * @returns True if the message was queued, or false if the worker thread does not exist or its queue is full
+	 */
+	bool IncomingMessageToThread(size_t threadId, const tmx::byte_t *bytes, size_t size,
+								 const char *encoding = tmx::messages::api::ENCODING_ASN1_UPER_STRING,
+								 tmx::byte_t groupId = 0, tmx::byte_t uniqId = 0, uint64_t timestamp = 0);
+
 	/**
 	 * Handle an outgoing message by broadcasting to the TMX core.  If immediate is set, then the broadcast is pushed out
 	 * within the current thread.  If not, then the output message is queued.
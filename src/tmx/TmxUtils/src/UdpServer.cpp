@@ -45,10 +45,16 @@ namespace utils {
  * and port combination cannot be resolved or if the socket cannot be
  * opened.
  *
+ * With reusePort set, the socket is bound with SO_REUSEPORT, so several
+ * servers, each with its own socket, can receive on the same address and
+ * port.  The kernel then spreads the datagrams over the sockets by the
+ * address and port they come from.
+ *
  * \param[in] address  The address we receive on.
  * \param[in] port  The port we receive from.
+ * \param[in] reusePort  True to share the port with other servers.
  */
-UdpServer::UdpServer(const std::string& address, int port)
+UdpServer::UdpServer(const std::string& address, int port, bool reusePort)
     : _port(port)
     , _address(address)
 {
@@ -75,6 +81,14 @@ UdpServer::UdpServer(const std::string& address, int port)
 		throw UdpServerRuntimeError(("could not create UDP socket for: \"" + address + ":" + decimalPort + "\"").c_str());
 	}
 
+	int on = 1;
+	if (reusePort && setsockopt(_socket, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0)
+	{
+		freeaddrinfo(_addrInfo);
+		close(_socket);
+		throw UdpServerRuntimeError(("could not share UDP port for: \"" + address + ":" + decimalPort + "\"").c_str());
+	}
+
 	r = bind(_socket, _addrInfo->ai_addr, _addrInfo->ai_addrlen);
 	if (r != 0)
 	{
@@ -26,7 +26,7 @@ public:
 class UdpServer
 {
 public:
-	UdpServer(const std::string& address, int port);
+	UdpServer(const std::string& address, int port, bool reusePort = false);
 	~UdpServer();
 
 	int GetSocket() const;
@@ -0,0 +1,367 @@
+/*
+ * VehicleStateTable.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_VEHICLESTATETABLE_H_
+#define SRC_VEHICLESTATETABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tmx {
+namespace utils {
+
+/**
+ * Keeps the latest state of each vehicle heard from, keyed by its temporary ID, and forgets
+ * vehicles that have not been updated within a timeout.
+ *
+ * Vehicles are stored in a hash map and are also linked into a hashed timer wheel by the time
+ * they expire, so expiring old vehicles only visits the slots of the wheel that have come due
+ * instead of every vehicle.  Each vehicle may also be placed in a zone, such as a TIM region,
+ * and marked as counted, for instance because it is speeding.  The number of counted vehicles
+ * in each zone is kept up to date on every change, so finding the first zone with a counted
+ * vehicle does not depend on the number of vehicles.
+ *
+ * Times are in milliseconds and are supplied by the caller.  This class is not thread safe.
+ */
+template <typename State, typename KeyType = int32_t>
+class VehicleStateTable
+{
+public:
+	struct Entry
+	{
+		KeyType id;
+		State state;
+		/// The zone of the vehicle.  Zero or less means it is not in a zone.
+		int zone;
+		/// True if the vehicle counts towards the aggregate of its zone.
+		bool counted;
+		uint64_t lastUpdateTime;
+	};
+
+	/**
+	 * @param timeout The time after the last update that a vehicle expires.
+	 * @param resolution The length of time covered by each slot of the timer wheel.
+	 */
+	VehicleStateTable(uint64_t timeout = 1000, uint64_t resolution = 100);
+
+	/**
+	 * @return The vehicle with the given ID, or NULL if there is none.
+	 */
+	Entry *Find(KeyType id);
+
+	/**
+	 * Add a vehicle or update the existing one, and restart its timeout.
+	 */
+	Entry &Update(KeyType id, const State &state, int zone, bool counted, uint64_t now);
+
+	/**
+	 * @return False if there was no vehicle with the given ID.
+	 */
+	bool Remove(KeyType id);
+
+	/**
+	 * Remove all vehicles whose timeout has passed.
+	 *
+	 * @return The number of vehicles removed.
+	 */
+	size_t Expire(uint64_t now);
+
+	void Clear();
+
+	/**
+	 * Recompute whether every vehicle is counted, for instance after a speed limit changes.
+	 *
+	 * @param isCounted A function that takes a const Entry & and returns a bool.
+	 */
+	template <typename Predicate>
+	void Recount(Predicate isCounted);
+
+	/**
+	 * Call a function with a const Entry & for each vehicle, in no particular order.
+	 */
+	template <typename Function>
+	void ForEach(Function function) const;
+
+	/**
+	 * @return The lowest zone number that has at least one counted vehicle, or 0 if there is none.
+	 */
+	int get_FirstCountedZone() const;
+
+	/**
+	 * @return The number of counted vehicles in the zone.
+	 */
+	size_t get_CountedInZone(int zone) const;
+
+	size_t Size() const;
+
+	uint64_t get_Timeout() const;
+
+	/**
+	 * Change the timeout.  Every vehicle is moved to the slot of its new expiration time.
+	 */
+	void set_Timeout(uint64_t timeout);
+
+private:
+	struct Node
+	{
+		Entry entry;
+		Node *prev;
+		Node *next;
+	};
+
+	void Link(Node *node);
+	void Unlink(Node *node);
+	void AddToZone(const Entry &entry);
+	void RemoveFromZone(const Entry &entry);
+
+	uint64_t _timeout;
+	uint64_t _resolution;
+
+	std::unordered_map<KeyType, Node> _vehicles;
+
+	// Slot i holds the vehicles that expire during ticks where tick % slots == i
+	std::vector<Node *> _wheel;
+	uint64_t _lastTick = 0;
+
+	// The number of counted vehicles in each zone, and a bit set of the zones with any
+	std::vector<uint32_t> _zoneCounts;
+	std::vector<uint64_t> _zoneBits;
+};
+
+template <typename State, typename KeyType>
+VehicleStateTable<State, KeyType>::VehicleStateTable(uint64_t timeout, uint64_t resolution):
+	_timeout(timeout), _resolution(resolution > 0 ? resolution : 1)
+{
+	_wheel.assign(_timeout / _resolution + 2, NULL);
+}
+
+template <typename State, typename KeyType>
+typename VehicleStateTable<State, KeyType>::Entry *VehicleStateTable<State, KeyType>::Find(KeyType id)
+{
+	typename std::unordered_map<KeyType, Node>::iterator it = _vehicles.find(id);
+	if (it == _vehicles.end())
+		return NULL;
+
+	return &(it->second.entry);
+}
+
+template <typename State, typename KeyType>
+typename VehicleStateTable<State, KeyType>::Entry &VehicleStateTable<State, KeyType>::Update(
+		KeyType id, const State &state, int zone, bool counted, uint64_t now)
+{
+	typename std::unordered_map<KeyType, Node>::iterator it = _vehicles.find(id);
+	Node *node;
+
+	if (it == _vehicles.end())
+	{
+		node = &(_vehicles[id]);
+		node->entry.id = id;
+	}
+	else
+	{
+		node = &(it->second);
+		RemoveFromZone(node->entry);
+		Unlink(node);
+	}
+
+	node->entry.state = state;
+	node->entry.zone = zone;
+	node->entry.counted = counted;
+	node->entry.lastUpdateTime = now;
+
+	AddToZone(node->entry);
+	Link(node);
+
+	return node->entry;
+}
+
+template <typename State, typename KeyType>
+bool VehicleStateTable<State, KeyType>::Remove(KeyType id)
+{
+	typename std::unordered_map<KeyType, Node>::iterator it = _vehicles.find(id);
+	if (it == _vehicles.end())
+		return false;
+
+	RemoveFromZone(it->second.entry);
+	Unlink(&(it->second));
+	_vehicles.erase(it);
+	return true;
+}
+
+template <typename State, typename KeyType>
+size_t VehicleStateTable<State, KeyType>::Expire(uint64_t now)
+{
+	size_t removed = 0;
+	uint64_t tick = now / _resolution;
+
+	// Visit each slot that has come due since the last call, at most once around the wheel.
+	// The slot of the current tick is visited again next time, since more of it may be due then.
+	uint64_t first = _lastTick;
+	if (first == 0 || tick - first >= _wheel.size())
+		first = tick >= _wheel.size() ? tick - _wheel.size() + 1 : 0;
+
+	for (uint64_t t = first; t <= tick; t++)
+	{
+		Node *node = _wheel[t % _wheel.size()];
+		while (node != NULL)
+		{
+			Node *next = node->next;
+
+			// A slot also holds vehicles due on later turns of the wheel, which stay
+			if (node->entry.lastUpdateTime + _timeout <= now)
+			{
+				Remove(node->entry.id);
+				removed++;
+			}
+
+			node = next;
+		}
+	}
+
+	_lastTick = tick;
+	return removed;
+}
+
+template <typename State, typename KeyType>
+void VehicleStateTable<State, KeyType>::Clear()
+{
+	_vehicles.clear();
+	_wheel.assign(_wheel.size(), NULL);
+	_zoneCounts.clear();
+	_zoneBits.clear();
+}
+
+template <typename State, typename KeyType>
+template <typename Predicate>
+void VehicleStateTable<State, KeyType>::Recount(Predicate isCounted)
+{
+	_zoneCounts.assign(_zoneCounts.size(), 0);
+	_zoneBits.assign(_zoneBits.size(), 0);
+
+	for (typename std::unordered_map<KeyType, Node>::iterator it = _vehicles.begin(); it != _vehicles.end(); it++)
+	{
+		it->second.entry.counted = isCounted((const Entry &)it->second.entry);
+		AddToZone(it->second.entry);
+	}
+}
+
+template <typename State, typename KeyType>
+template <typename Function>
+void VehicleStateTable<State, KeyType>::ForEach(Function function) const
+{
+	for (typename std::unordered_map<KeyType, Node>::const_iterator it = _vehicles.begin(); it != _vehicles.end(); it++)
+		function(it->second.entry);
+}
+
+template <typename State, typename KeyType>
+int VehicleStateTable<State, KeyType>::get_FirstCountedZone() const
+{
+	for (size_t word = 0; word < _zoneBits.size(); word++)
+	{
+		if (_zoneBits[word])
+			return word * 64 + __builtin_ctzll(_zoneBits[word]);
+	}
+
+	return 0;
+}
+
+template <typename State, typename KeyType>
+size_t VehicleStateTable<State, KeyType>::get_CountedInZone(int zone) const
+{
+	if (zone <= 0 || (size_t)zone >= _zoneCounts.size())
+		return 0;
+
+	return _zoneCounts[zone];
+}
+
+template <typename State, typename KeyType>
+size_t VehicleStateTable<State, KeyType>::Size() const
+{
+	return _vehicles.size();
+}
+
+template <typename State, typename KeyType>
+uint64_t VehicleStateTable<State, KeyType>::get_Timeout() const
+{
+	return _timeout;
+}
+
+template <typename State, typename KeyType>
+void VehicleStateTable<State, KeyType>::set_Timeout(uint64_t timeout)
+{
+	if (timeout == _timeout)
+		return;
+
+	_timeout = timeout;
+	_wheel.assign(_timeout / _resolution + 2, NULL);
+
+	// Some vehicles may already be past their new expiration time, so the next
+	// call to Expire has to look all the way around the wheel
+	_lastTick = 0;
+
+	for (typename std::unordered_map<KeyType, Node>::iterator it = _vehicles.begin(); it != _vehicles.end(); it++)
+		Link(&(it->second));
+}
+
+template <typename State, typename KeyType>
+void VehicleStateTable<State, KeyType>::Link(Node *node)
+{
+	Node *&head = _wheel[((node->entry.lastUpdateTime + _timeout) / _resolution) % _wheel.size()];
+
+	node->prev = NULL;
+	node->next = head;
+	if (head != NULL)
+		head->prev = node;
+	head = node;
+}
+
+template <typename State, typename KeyType>
+void VehicleStateTable<State, KeyType>::Unlink(Node *node)
+{
+	if (node->prev != NULL)
+		node->prev->next = node->next;
+	else
+		_wheel[((node->entry.lastUpdateTime + _timeout) / _resolution) % _wheel.size()] = node->next;
+
+	if (node->next != NULL)
+		node->next->prev = node->prev;
+
+	node->prev = NULL;
+	node->next = NULL;
+}
+
+template <typename State, typename KeyType>
+void VehicleStateTable<State, KeyType>::AddToZone(const Entry &entry)
+{
+	if (!entry.counted || entry.zone <= 0)
+		return;
+
+	if ((size_t)entry.zone >= _zoneCounts.size())
+	{
+		_zoneCounts.resize(entry.zone + 1, 0);
+		_zoneBits.resize(entry.zone / 64 + 1, 0);
+	}
+
+	if (_zoneCounts[entry.zone]++ == 0)
+		_zoneBits[entry.zone / 64] |= 1ULL << (entry.zone % 64);
+}
+
+template <typename State, typename KeyType>
+void VehicleStateTable<State, KeyType>::RemoveFromZone(const Entry &entry)
+{
+	if (!entry.counted || entry.zone <= 0 || (size_t)entry.zone >= _zoneCounts.size())
+		return;
+
+	if (--_zoneCounts[entry.zone] == 0)
+		_zoneBits[entry.zone / 64] &= ~(1ULL << (entry.zone % 64));
+}
+
+}} // namespace tmx::utils
+
+#endif /* SRC_VEHICLESTATETABLE_H_ */
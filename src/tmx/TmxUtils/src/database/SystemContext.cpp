@@ -46,7 +46,7 @@ SystemContext::SystemContext()
 	FILE_LOG(logDEBUG) << "Constructing static SystemContext";
 
 	// Start a thread that will periodically flush latency entries to the DB.
-	static ThreadTimer updateTimer(milliseconds(100)); // this is precision in ms. Should be a small value to allow frequency setting to be high.
+	static ThreadTimer updateTimer;
 
 	SystemContextThread * dbT = new SystemContextThread(updateTimer);
 	{
@@ -0,0 +1,225 @@
+/*
+ * CswZoneBench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ *
+ * Measures the per-BSM zone lookup of the curve speed warning plugin against a generated
+ * multi-zone curve TIM, comparing the compiled TimZoneIndex with the original walk of the TIM
+ * in VehicleLocate::FindRegion.
+ *
+ * Usage: CswZoneBench [vehicles] [seconds] [zones]
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <PercentileStatistics.h>
+
+#include "../src/TimZoneIndex.h"
+#include "../src/VehicleLocate.h"
+
+using namespace std;
+
+#define CURVE_LATITUDE 42.2891
+#define CURVE_LONGITUDE -83.7193
+#define CURVE_RADIUS_M 150.0
+#define NODE_SPACING_DEG 4.0
+#define ZONE_ARC_DEG 40.0
+#define LANE_WIDTH_CM 400
+#define BSM_RATE_HZ 10
+
+// The same conversion VehicleLocate::GetPointArray uses to turn offsets into degrees
+#define DSRC_EQUATORIAL_RADIUS_M 6378137.0
+#define DEGREES_PER_METER (180.0 / (M_PI * DSRC_EQUATORIAL_RADIUS_M))
+
+static WGS84Point ToPoint(double east_m, double north_m)
+{
+	WGS84Point point;
+	point.Latitude = CURVE_LATITUDE + north_m * DEGREES_PER_METER;
+	point.Longitude = CURVE_LONGITUDE + east_m * DEGREES_PER_METER / cos(CURVE_LATITUDE * M_PI / 180.0);
+	return point;
+}
+
+// Build a TIM with one data frame whose regions follow consecutive arcs of a circular curve
+static void BuildCurveTim(TravelerInformation *tim, int zones)
+{
+	memset(tim, 0, sizeof(TravelerInformation));
+
+	TiDataFrame *frame = (TiDataFrame *)calloc(1, sizeof(TiDataFrame));
+
+	for (int z = 0; z < zones; z++)
+	{
+		GeographicalPath *geoPath = (GeographicalPath *)calloc(1, sizeof(GeographicalPath));
+		geoPath->description = (GeographicalPath::GeographicalPath__description *)
+				calloc(1, sizeof(GeographicalPath::GeographicalPath__description));
+		geoPath->description->present = GeographicalPath__description_PR_path;
+		geoPath->description->choice.path.offset.present = OffsetSystem__offset_PR_xy;
+		geoPath->description->choice.path.offset.choice.xy.present = NodeListXY_PR_nodes;
+
+		geoPath->laneWidth = (LaneWidth_t *)malloc(sizeof(LaneWidth_t));
+		*geoPath->laneWidth = LANE_WIDTH_CM;
+
+		double startAngle = z * ZONE_ARC_DEG * M_PI / 180.0;
+		WGS84Point anchorPoint = ToPoint(CURVE_RADIUS_M * cos(startAngle), CURVE_RADIUS_M * sin(startAngle));
+
+		geoPath->anchor = (Position3D *)calloc(1, sizeof(Position3D));
+		geoPath->anchor->lat = (long)(anchorPoint.Latitude * 10000000.0);
+		geoPath->anchor->Long = (long)(anchorPoint.Longitude * 10000000.0);
+
+		double lastX = CURVE_RADIUS_M * cos(startAngle);
+		double lastY = CURVE_RADIUS_M * sin(startAngle);
+		for (double a = 0; a <= ZONE_ARC_DEG + 0.001; a += NODE_SPACING_DEG)
+		{
+			double angle = startAngle + a * M_PI / 180.0;
+			double x = CURVE_RADIUS_M * cos(angle);
+			double y = CURVE_RADIUS_M * sin(angle);
+
+			NodeXY *node = (NodeXY *)calloc(1, sizeof(NodeXY));
+			node->delta.present = NodeOffsetPointXY_PR_node_XY6;
+			node->delta.choice.node_XY6.x = lround((x - lastX) * 100);
+			node->delta.choice.node_XY6.y = lround((y - lastY) * 100);
+			ASN_SEQUENCE_ADD(&geoPath->description->choice.path.offset.choice.xy.choice.nodes.list, node);
+
+			lastX = x;
+			lastY = y;
+		}
+
+		ASN_SEQUENCE_ADD(&frame->regions.list, geoPath);
+	}
+
+	ASN_SEQUENCE_ADD(&tim->dataFrames.list, frame);
+}
+
+struct Vehicle
+{
+	double angle;
+	double offset_m;
+	double direction;
+	bool onCurve;
+	double east_m;
+	double north_m;
+};
+
+int main(int argc, char *argv[])
+{
+	int vehicles = argc > 1 ? atoi(argv[1]) : 500;
+	int seconds = argc > 2 ? atoi(argv[2]) : 60;
+	int zones = argc > 3 ? atoi(argv[3]) : 6;
+	if (vehicles <= 0 || seconds <= 0 || zones <= 0 || zones * ZONE_ARC_DEG > 360)
+	{
+		cerr << "Usage: " << argv[0] << " [vehicles] [seconds] [zones <= " << (int)(360 / ZONE_ARC_DEG) << "]" << endl;
+		return 1;
+	}
+
+	TravelerInformation tim;
+	BuildCurveTim(&tim, zones);
+
+	auto buildStart = chrono::steady_clock::now();
+	TimZoneIndex index;
+	index.Build(&tim);
+	double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - buildStart).count();
+
+	cout << "Curve TIM: " << zones << " zones, " << index.get_SegmentCount() << " segments, " <<
+			index.get_CellCount() << " cells, compiled in " << fixed << setprecision(3) << buildMs << " ms" << endl;
+
+	// Most vehicles drive along the curve in either direction, some are on nearby roads
+	mt19937 random(42);
+	uniform_real_distribution<double> unit(0, 1);
+	vector<Vehicle> fleet(vehicles);
+	for (Vehicle &v : fleet)
+	{
+		v.onCurve = unit(random) < 0.8;
+		v.angle = unit(random) * zones * ZONE_ARC_DEG * M_PI / 180.0;
+		v.offset_m = (unit(random) - 0.5) * 8;
+		v.direction = unit(random) < 0.5 ? 1 : -1;
+		v.east_m = (unit(random) - 0.5) * 1000;
+		v.north_m = (unit(random) - 0.5) * 1000;
+	}
+
+	double speed_mps = 15;
+	double step_s = 1.0 / BSM_RATE_HZ;
+	uint64_t lookups = (uint64_t)vehicles * seconds * BSM_RATE_HZ;
+
+	vector<WGS84Point> points;
+	vector<double> headings;
+	points.reserve(lookups);
+	headings.reserve(lookups);
+
+	for (int t = 0; t < seconds * BSM_RATE_HZ; t++)
+	{
+		for (Vehicle &v : fleet)
+		{
+			double heading;
+			if (v.onCurve)
+			{
+				v.angle += v.direction * speed_mps * step_s / CURVE_RADIUS_M;
+				double r = CURVE_RADIUS_M + v.offset_m;
+				points.push_back(ToPoint(r * cos(v.angle), r * sin(v.angle)));
+
+				// Tangent of the curve in the direction of travel, as a compass bearing
+				heading = atan2(-sin(v.angle) * v.direction, cos(v.angle) * v.direction) * 180.0 / M_PI;
+			}
+			else
+			{
+				v.north_m += speed_mps * step_s * v.direction;
+				points.push_back(ToPoint(v.east_m, v.north_m));
+				heading = v.direction > 0 ? 0 : 180;
+			}
+
+			if (heading < 0)
+				heading += 360;
+			headings.push_back((uint16_t)heading);
+		}
+	}
+
+	PercentileStatistics indexLatency(lookups);
+	PercentileStatistics walkLatency(lookups);
+	vector<int> indexZones(lookups);
+	uint64_t mismatches = 0;
+	uint64_t inZone = 0;
+
+	auto start = chrono::steady_clock::now();
+	for (uint64_t i = 0; i < lookups; i++)
+	{
+		auto t0 = chrono::steady_clock::now();
+		indexZones[i] = index.FindZone(points[i], headings[i]);
+		indexLatency.Add(chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count());
+	}
+	double indexSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	start = chrono::steady_clock::now();
+	for (uint64_t i = 0; i < lookups; i++)
+	{
+		auto t0 = chrono::steady_clock::now();
+		int zone = VehicleLocate::FindRegion(&tim, points[i], headings[i]);
+		walkLatency.Add(chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count());
+
+		if (zone != indexZones[i])
+			mismatches++;
+		if (zone > 0)
+			inZone++;
+	}
+	double walkSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << lookups << " BSMs from " << vehicles << " vehicles at " << BSM_RATE_HZ << " Hz (" <<
+			vehicles * BSM_RATE_HZ << " BSM/s), " << inZone << " in a zone" << endl;
+	cout << left << setw(8) << "Lookup" << right << setw(12) << "P50 us" << setw(12) << "P99 us" <<
+			setw(12) << "Max us" << setw(14) << "BSM/s" << endl;
+	cout << left << setw(8) << "index" << right << setprecision(2) << setw(12) << indexLatency.Percentile(50) <<
+			setw(12) << indexLatency.Percentile(99) << setw(12) << indexLatency.Max() <<
+			setprecision(0) << setw(14) << lookups / indexSeconds << endl;
+	cout << left << setw(8) << "walk" << right << setprecision(2) << setw(12) << walkLatency.Percentile(50) <<
+			setw(12) << walkLatency.Percentile(99) << setw(12) << walkLatency.Max() <<
+			setprecision(0) << setw(14) << lookups / walkSeconds << endl;
+	cout << "Zone mismatches between the index and the walk: " << mismatches << endl;
+
+	ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_TravelerInformation, &tim);
+	return 0;
+}
@@ -63,7 +63,11 @@ PLOG(logDEBUG)<<"HandleBasicSafetyMessage";
 	float speed_mph;
 	int32_t vehicleId;
 
-	if (VehicleLocate::ProcessBsmMessage(*bsm, &_tim, &regionNumber, &speed_mph, &vehicleId))
+	pthread_mutex_lock(&_timMutex);
+	bool isProcessed = VehicleLocate::ProcessBsmMessage(*bsm, _zones, &regionNumber, &speed_mph, &vehicleId);
+	pthread_mutex_unlock(&_timMutex);
+
+	if (isProcessed)
 	{
 		// Store the ID in a map, where the vehicle ID is the key, and the value is the speed
 		// and zone/region where the vehicle is currently at.
@@ -114,6 +118,7 @@ void CswPlugin::OnStateChange(IvpPluginState state) {
 bool CswPlugin::LoadTim(TravelerInformation *tim, const char *mapFile)
 {
 	memset(tim, 0, sizeof(TravelerInformation));
+	_zones.Clear();
 
 	// J2735 packet header.
 
@@ -137,6 +142,11 @@ bool CswPlugin::LoadTim(TravelerInformation *tim, const char *mapFile)
 
 	std::cout << "TIM was created." << std::endl;
 
+	if (!_zones.Build(tim))
+		PLOG(logWARNING) << "The curve file " << mapFile << " has no usable regions";
+
+	PluginUtil::SetStatus<unsigned int>(_plugin, "Zone Segments", _zones.get_SegmentCount());
+
 	_speedLimit = curveParser.SpeedLimit;
 
 	PluginUtil::SetStatus<unsigned int>(_plugin, "Speed Limit", _speedLimit);
@@ -163,19 +173,17 @@ void CswPlugin::UpdateVehicleInZone(int32_t vehicleId, int zoneId, float speed_m
 	// If msgId is 0, the vehicle is removed from the map.
 	// If msgId is not 0, the vehicle is either added or updated in the map.
 
-	std::map<int32_t, ZoneInfo>::iterator it = _vehicleInZone.find(vehicleId);
-	if (it == _vehicleInZone.end())
+	ZoneInfo zoneInfo;
+	zoneInfo.Speed_mph = speed_mph;
+	bool isSpeeding = speed_mph > _countedSpeedLimit;
+
+	VehicleStateTable<ZoneInfo, int32_t>::Entry *entry = _vehicleInZone.Find(vehicleId);
+	if (entry == NULL)
 	{
 		if (zoneId != 0)
 		{
 			PLOG(logDEBUG) << "Adding   Vehicle ID: " << vehicleId << ", zone: " << zoneId << ", speed: " << speed_mph;
-
-			ZoneInfo zoneInfo;
-			zoneInfo.ZoneId = zoneId;
-			zoneInfo.Speed_mph = speed_mph;
-			zoneInfo.LastUpdateTime = now;
-
-			_vehicleInZone.insert(std::pair<int32_t, ZoneInfo>(vehicleId, zoneInfo));
+			_vehicleInZone.Update(vehicleId, zoneInfo, zoneId, isSpeeding, now);
 		}
 	}
 	else
@@ -184,20 +192,16 @@ void CswPlugin::UpdateVehicleInZone(int32_t vehicleId, int zoneId, float speed_m
 		uint64_t snapInterval = _snapInterval;
 		pthread_mutex_unlock(&_settingsMutex);
 
-		if (zoneId == 0 && (now - it->second.LastUpdateTime) < snapInterval)
+		if (zoneId == 0 && (now - entry->lastUpdateTime) < snapInterval)
 		{
 			PLOG(logDEBUG) << "Removing Vehicle ID: " << vehicleId << ", zone: " << zoneId << ", speed: " << speed_mph;
-			_vehicleInZone.erase(vehicleId);
+			_vehicleInZone.Remove(vehicleId);
 		}
 		else
 		{
-			if (it->second.ZoneId != zoneId || it->second.Speed_mph != speed_mph)
-			{
+			if (entry->zone != zoneId || entry->state.Speed_mph != speed_mph)
 				PLOG(logDEBUG) << "Updating Vehicle ID: " << vehicleId << ", zone: " << zoneId << ", speed: " << speed_mph;
-				it->second.ZoneId = zoneId;
-				it->second.Speed_mph = speed_mph;
-			}
-			it->second.LastUpdateTime = now;
+			_vehicleInZone.Update(vehicleId, zoneInfo, zoneId, isSpeeding, now);
 		}
 	}
 }
@@ -211,21 +215,9 @@ void CswPlugin::RemoveOldVehicles()
 	uint64_t vehicleTimeout = _vehicleTimeout;
 	pthread_mutex_unlock(&_settingsMutex);
 
-	std::map<int32_t, ZoneInfo>::iterator it = _vehicleInZone.begin();
-
-	while (it != _vehicleInZone.end())
-	{
-	    if (now - it->second.LastUpdateTime > vehicleTimeout)
-	    {
-	    	std::map<int32_t, ZoneInfo>::iterator toErase = it;
-	       it++;
-	       _vehicleInZone.erase(toErase);
-	    }
-	    else
-	    {
-	       it++;
-	    }
-	}
+	// Vehicles expire once the timeout has fully passed
+	_vehicleInZone.set_Timeout(vehicleTimeout + 1);
+	_vehicleInZone.Expire(now);
 }
 
 // Get the zone id with the highest priority of all vehicles that are speeding.
@@ -234,17 +226,19 @@ int CswPlugin::GetHighestPriorityZoneId(unsigned int speedLimit_mph)
 	// Remove any old vehicles that have timed out.
 	RemoveOldVehicles();
 
-	// The lower the zone id, the higher the priority.
-
-	int id = 9999;
-
-	for (auto& kv : _vehicleInZone)
+	// Vehicles are counted against the speed limit as they are updated, so they
+	// only need to be counted again when the speed limit changes.
+	if (speedLimit_mph != _countedSpeedLimit)
 	{
-		if (kv.second.ZoneId != 0 && id > kv.second.ZoneId && kv.second.Speed_mph > speedLimit_mph)
-			id = kv.second.ZoneId;
+		_countedSpeedLimit = speedLimit_mph;
+		_vehicleInZone.Recount([speedLimit_mph](const VehicleStateTable<ZoneInfo, int32_t>::Entry &entry)
+		{
+			return entry.state.Speed_mph > speedLimit_mph;
+		});
 	}
 
-	return id == 9999 ? 0 : id;
+	// The lower the zone id, the higher the priority.
+	return _vehicleInZone.get_FirstCountedZone();
 }
 
 void CswPlugin::SetStatusForVehiclesInZones()
@@ -253,15 +247,15 @@ void CswPlugin::SetStatusForVehiclesInZones()
 	ss.precision(1);
 
 	bool first = true;
-	for (auto& kv : _vehicleInZone)
+	_vehicleInZone.ForEach([&](const VehicleStateTable<ZoneInfo, int32_t>::Entry &entry)
 	{
 		if (first)
 			first = false;
 		else
 			ss << ", ";
 
-		ss << "[ID: " << kv.first << ", Zone: " << kv.second.ZoneId << ", Speed: " << fixed << kv.second.Speed_mph << "]";
-	}
+		ss << "[ID: " << entry.id << ", Zone: " << entry.zone << ", Speed: " << fixed << entry.state.Speed_mph << "]";
+	});
 
 	if (first)
 		ss << "None";
@@ -332,6 +326,13 @@ int CswPlugin::Main() {
 				TimMessage timMsg;
 				timMsg.set_j2735_data(&_tim);
 
+				const string &timText = _timRenderer.Render(_tim);
+				if (timText != _timText)
+				{
+					_timText = timText;
+					SetStatus<string>("TIM Text", _timText);
+				}
+
 				PLOG(logDEBUG)<<"Send TIM 2";
 
 				PLOG(logDEBUG)<<timMsg;
@@ -23,6 +23,8 @@
 #include <tmx/IvpPlugin.h>
 #include <tmx/messages/IvpJ2735.h>
 #include <GeoVector.h>
+#include <VehicleStateTable.h>
+#include <TimTextRenderer.h>
 
 
 
@@ -37,6 +39,8 @@
 #include <tmx/j2735_messages/BasicSafetyMessage.hpp>
 #include <tmx/messages/auto_message.hpp>
 
+#include "TimZoneIndex.h"
+
 using boost::property_tree::ptree;
 
 using namespace std;
@@ -54,16 +58,8 @@ using namespace tmx::messages;
 
 struct ZoneInfo
 {
-	// ID of the zone the vehicle is in.  0 indicates no zone.
-	int ZoneId;
-
 	// The current speed of the vehicle in MPH.
 	float Speed_mph;
-
-	// The time the ZoneId was last updated.
-	// Note that if a 0 is received for ZoneId, this time will not be set unless
-	// it has been longer than a configurable duration.
-	uint64_t LastUpdateTime;
 };
 
 namespace CswPlugin {
@@ -97,8 +93,13 @@ protected:
 
 private:
 
-	// For each vehicle ID, store what zone they are in.
-	map<int32_t, ZoneInfo> _vehicleInZone;
+	// For each vehicle ID, store what zone they are in.  Vehicles over the speed limit are counted
+	// in their zone.  The time of an entry is when its zone was last updated.  Note that if a 0 is
+	// received for the zone, this time will not be set unless it has been longer than a configurable duration.
+	VehicleStateTable<ZoneInfo, int32_t> _vehicleInZone;
+
+	// The speed limit that vehicles in _vehicleInZone were counted against.
+	unsigned int _countedSpeedLimit = 0;
 
 	pthread_mutex_t _settingsMutex = PTHREAD_MUTEX_INITIALIZER;
 	pthread_mutex_t _timMutex = PTHREAD_MUTEX_INITIALIZER;
@@ -109,11 +110,19 @@ private:
 
 	TravelerInformation _tim;
 
+	// The regions of _tim compiled for the zone lookup of every BSM.  Guarded by _timMutex.
+	TimZoneIndex _zones;
+
+	// The sign text of _tim, rendered from the cache each time the TIM is sent while its content
+	// is unchanged.  Only used by the main thread.
+	TimTextRenderer _timRenderer;
+	string _timText;
+
 	mutex _mapFileLock;
 	string _mapFile;
 	atomic<bool> _isMapFileNew{false};
 	bool _isTimLoaded = false;
-	unsigned int _speedLimit = 0;
+	atomic<unsigned int> _speedLimit{0};
 	int _lastMsgIdSent = -1;
 
 	
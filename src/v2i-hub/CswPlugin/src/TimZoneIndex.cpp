@@ -0,0 +1,232 @@
+/*
+ * TimZoneIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+#include "Conversions.h"
+#include "TimZoneIndex.h"
+#include "VehicleLocate.h"
+
+// The same earth radius used by Conversions::DistanceMeters
+#define EARTH_RADIUS_M 6371000.0
+#define METERS_PER_DEGREE (EARTH_RADIUS_M * M_PI / 180.0)
+
+// Smallest grid cell, and the most cells the grid may have before the cells are made larger
+#define MIN_CELL_SIZE_M 25.0
+#define MAX_CELLS 65536
+
+TimZoneIndex::TimZoneIndex()
+{
+}
+
+void TimZoneIndex::Clear()
+{
+	_segments.clear();
+	_cellStart.clear();
+	_cellSegments.clear();
+	_columns = 0;
+	_rows = 0;
+}
+
+inline void TimZoneIndex::Project(double latitude, double longitude, double &x, double &y) const
+{
+	x = (longitude - _originLongitude) * _metersPerDegreeLongitude;
+	y = (latitude - _originLatitude) * METERS_PER_DEGREE;
+}
+
+bool TimZoneIndex::Build(TravelerInformation *tim)
+{
+	Clear();
+
+	if (tim == NULL)
+		return false;
+
+	bool haveOrigin = false;
+
+	for (int f = 0; f < tim->dataFrames.list.count; f++)
+	{
+		TiDataFrame *frame = tim->dataFrames.list.array[f];
+
+		for (int r = 0; r < frame->regions.list.count; r++)
+		{
+			GeographicalPath *geoPath = frame->regions.list.array[r];
+			if (geoPath->anchor == NULL || geoPath->laneWidth == NULL || geoPath->description == NULL)
+				continue;
+
+			NodeSetXY *nodes = &geoPath->description->choice.path.offset.choice.xy.choice.nodes;
+			int nodesLength = nodes->list.count;
+			if (nodesLength < 2)
+				continue;
+
+			WGS84Point *points = VehicleLocate::GetPointArray(nodes, nodesLength, geoPath->anchor);
+			if (points == NULL)
+				continue;
+
+			if (!haveOrigin)
+			{
+				_originLatitude = points[0].Latitude;
+				_originLongitude = points[0].Longitude;
+				_metersPerDegreeLongitude = METERS_PER_DEGREE * cos(_originLatitude * M_PI / 180.0);
+				haveOrigin = true;
+			}
+
+			for (int i = 1; i < nodesLength; i++)
+			{
+				Segment segment;
+				double endX, endY;
+				Project(points[i-1].Latitude, points[i-1].Longitude, segment.x, segment.y);
+				Project(points[i].Latitude, points[i].Longitude, endX, endY);
+
+				segment.length = hypot(endX - segment.x, endY - segment.y);
+				if (segment.length <= 0)
+					continue;
+
+				segment.dx = (endX - segment.x) / segment.length;
+				segment.dy = (endY - segment.y) / segment.length;
+				segment.halfWidth = *(geoPath->laneWidth) / 200.0;
+				segment.bearing = Conversions::GetBearingDegrees(points[i], points[i-1]);
+				segment.order = ((uint32_t)f << 16) | (uint32_t)r;
+				segment.zoneId = r + 1;
+
+				_segments.push_back(segment);
+			}
+
+			free(points);
+		}
+	}
+
+	if (_segments.empty())
+		return false;
+
+	// Every segment covers its bounding box grown by half a lane width.  A vehicle that
+	// matches a segment is always inside that box.
+	double minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+	for (const Segment &segment : _segments)
+	{
+		double endX = segment.x + segment.dx * segment.length;
+		double endY = segment.y + segment.dy * segment.length;
+		minX = std::min(minX, std::min(segment.x, endX) - segment.halfWidth);
+		minY = std::min(minY, std::min(segment.y, endY) - segment.halfWidth);
+		maxX = std::max(maxX, std::max(segment.x, endX) + segment.halfWidth);
+		maxY = std::max(maxY, std::max(segment.y, endY) + segment.halfWidth);
+	}
+
+	_minX = minX;
+	_minY = minY;
+	_cellSize = std::max(MIN_CELL_SIZE_M, sqrt((maxX - minX) * (maxY - minY) / MAX_CELLS));
+	_columns = (int)((maxX - minX) / _cellSize) + 1;
+	_rows = (int)((maxY - minY) / _cellSize) + 1;
+	while ((size_t)_columns * _rows > MAX_CELLS)
+	{
+		_cellSize *= 1.5;
+		_columns = (int)((maxX - minX) / _cellSize) + 1;
+		_rows = (int)((maxY - minY) / _cellSize) + 1;
+	}
+
+	// Count the segments in each cell, then fill them in, so each cell is a contiguous range
+	_cellStart.assign((size_t)_columns * _rows + 1, 0);
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		std::vector<uint32_t> fill;
+		if (pass == 1)
+		{
+			for (size_t c = 1; c < _cellStart.size(); c++)
+				_cellStart[c] += _cellStart[c - 1];
+			_cellSegments.resize(_cellStart.back());
+			fill.assign(_cellStart.begin(), _cellStart.end() - 1);
+		}
+
+		for (uint32_t s = 0; s < _segments.size(); s++)
+		{
+			const Segment &segment = _segments[s];
+			double endX = segment.x + segment.dx * segment.length;
+			double endY = segment.y + segment.dy * segment.length;
+
+			int col0 = (int)((std::min(segment.x, endX) - segment.halfWidth - _minX) / _cellSize);
+			int col1 = (int)((std::max(segment.x, endX) + segment.halfWidth - _minX) / _cellSize);
+			int row0 = (int)((std::min(segment.y, endY) - segment.halfWidth - _minY) / _cellSize);
+			int row1 = (int)((std::max(segment.y, endY) + segment.halfWidth - _minY) / _cellSize);
+
+			for (int row = std::max(row0, 0); row <= std::min(row1, _rows - 1); row++)
+			{
+				for (int col = std::max(col0, 0); col <= std::min(col1, _columns - 1); col++)
+				{
+					size_t cell = (size_t)row * _columns + col;
+					if (pass == 0)
+						_cellStart[cell + 1]++;
+					else
+						_cellSegments[fill[cell]++] = s;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+int TimZoneIndex::FindZone(const WGS84Point &point, double heading) const
+{
+	if (_segments.empty())
+		return -1;
+
+	double x, y;
+	Project(point.Latitude, point.Longitude, x, y);
+
+	double colPos = (x - _minX) / _cellSize;
+	double rowPos = (y - _minY) / _cellSize;
+	if (colPos < 0 || rowPos < 0 || colPos >= _columns || rowPos >= _rows)
+		return -1;
+
+	size_t cell = (size_t)rowPos * _columns + (size_t)colPos;
+
+	uint32_t bestOrder = UINT32_MAX;
+	int zoneId = -1;
+
+	for (uint32_t i = _cellStart[cell]; i < _cellStart[cell + 1]; i++)
+	{
+		const Segment &segment = _segments[_cellSegments[i]];
+		if (segment.order >= bestOrder)
+			continue;
+
+		// Skip if the two headings are not within +-90 degrees of each other.
+		double headingDiff = fabs(heading - segment.bearing);
+		if (headingDiff > 90 && headingDiff < 270)
+			continue;
+
+		double px = x - segment.x;
+		double py = y - segment.y;
+		double endPx = px - segment.dx * segment.length;
+		double endPy = py - segment.dy * segment.length;
+		double lengthSq = segment.length * segment.length;
+
+		// The vehicle must be closer to both ends than the ends are to each other
+		if (px * px + py * py >= lengthSq || endPx * endPx + endPy * endPy >= lengthSq)
+			continue;
+
+		double perpendicular = fabs(px * segment.dy - py * segment.dx);
+		if (perpendicular < segment.halfWidth)
+		{
+			bestOrder = segment.order;
+			zoneId = segment.zoneId;
+		}
+	}
+
+	return zoneId;
+}
+
+size_t TimZoneIndex::get_SegmentCount() const
+{
+	return _segments.size();
+}
+
+size_t TimZoneIndex::get_CellCount() const
+{
+	return (size_t)_columns * _rows;
+}
@@ -0,0 +1,94 @@
+/*
+ * TimZoneIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef TIMZONEINDEX_H_
+#define TIMZONEINDEX_H_
+
+#include <stdint.h>
+#include <vector>
+#include <WGS84Point.h>
+
+#include "DsrcBuilder.h"
+
+using namespace tmx::utils;
+
+/**
+ * The regions of a curve speed warning TIM compiled into a form that can be searched quickly
+ * for every BSM.
+ *
+ * Each region is a path of lane segments.  When the TIM is loaded, every segment is projected
+ * once onto a flat plane around the first anchor, in meters, with its bearing and half width
+ * precomputed.  The segments are then bucketed into a uniform grid, so a lookup only looks at
+ * the few segments in the cell the vehicle is in and never allocates.
+ *
+ * A lookup gives the same answer as VehicleLocate::FindRegion, which walks the TIM itself:
+ * the vehicle must be heading within 90 degrees of the segment, closer to both of its ends
+ * than their distance apart, and within half a lane width of it.  When several regions match,
+ * the first one in the TIM wins.
+ */
+class TimZoneIndex
+{
+public:
+	TimZoneIndex();
+
+	/**
+	 * Compile the regions of a TIM, replacing any that were compiled before.
+	 *
+	 * @return False if the TIM has no regions that can be used.
+	 */
+	bool Build(TravelerInformation *tim);
+
+	void Clear();
+
+	/**
+	 * @param point The location of the vehicle.
+	 * @param heading The heading of the vehicle, in degrees.
+	 * @return The number of the region the vehicle is in, starting at 1, or -1 if none.
+	 */
+	int FindZone(const WGS84Point &point, double heading) const;
+
+	size_t get_SegmentCount() const;
+	size_t get_CellCount() const;
+
+private:
+	struct Segment
+	{
+		// Start of the segment, in meters east and north of the origin
+		double x;
+		double y;
+		// Unit vector from the start to the end of the segment
+		double dx;
+		double dy;
+		double length;
+		double halfWidth;
+		// The bearing between the end points, as VehicleLocate::IsInPointList computes it
+		double bearing;
+		// Position of the region in the TIM, frame first, which decides between overlapping regions
+		uint32_t order;
+		int zoneId;
+	};
+
+	inline void Project(double latitude, double longitude, double &x, double &y) const;
+
+	double _originLatitude = 0;
+	double _originLongitude = 0;
+	double _metersPerDegreeLongitude = 0;
+
+	double _minX = 0;
+	double _minY = 0;
+	double _cellSize = 0;
+	int _columns = 0;
+	int _rows = 0;
+
+	std::vector<Segment> _segments;
+
+	// The segments overlapping each cell, as offsets into _cellSegments
+	std::vector<uint32_t> _cellStart;
+	std::vector<uint32_t> _cellSegments;
+};
+
+#endif /* TIMZONEINDEX_H_ */
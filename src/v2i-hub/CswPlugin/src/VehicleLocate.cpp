@@ -28,21 +28,16 @@ WGS84Point* VehicleLocate::GetPointArray(NodeSetXY *nodeSet, int nodesLength, Po
 	double xOffset;
 	double yOffset;
 
-	std::cout << "baseLatitude: " << baseLatitude <<" , baseLongitude"<<baseLongitude<<std::endl;
-
 	for (int i = 0; i < nodesLength; i++)
 	{
 		xOffset = nodeSet->list.array[i]->delta.choice.node_XY6.x;
 		yOffset = nodeSet->list.array[i]->delta.choice.node_XY6.y;
 
-		std::cout << "xOffset " << xOffset << ", yOffset " << yOffset << std::endl;
 		totalXOffset += xOffset;
 		totalYOffset += yOffset;
 
 		points[i].Latitude = baseLatitude + (totalYOffset / DSRC_EQUATORIAL_RADIUS_CM) *(180/PI);
 		points[i].Longitude = baseLongitude + (totalXOffset / DSRC_EQUATORIAL_RADIUS_CM) *(180/PI)/cos(baseLatitude * PI/180);
-
-		std::cout << "points[i].Latitude " << points[i].Latitude << ", points[i].Longitude " << points[i].Longitude << std::endl;
 	}
 
 	return points;
@@ -75,10 +70,11 @@ int VehicleLocate::FindRegion(TiDataFrame *frame, WGS84Point point, uint16_t hea
 
 		WGS84Point* points = GetPointArray(nodes, nodesLength, nodesAnchor);
 
-		if (IsInPointList(points, nodesLength, point, heading, laneWidth/100.0))
-			return i + 1;
-
+		bool found = IsInPointList(points, nodesLength, point, heading, laneWidth/100.0);
 		free(points);
+
+		if (found)
+			return i + 1;
 	}
 
 	return -1;
@@ -91,8 +87,6 @@ bool VehicleLocate::IsInPointList(WGS84Point* points, int pointsLength, WGS84Poi
 	{
 		double pointsHeading = Conversions::GetBearingDegrees(points[i], points[i-1]);
 
-		std::cout << "CSW IsInPointList - Vehicle Heading: " << heading << ", Points Heading: " << pointsHeading << std::endl;
-
 		// Continue if the two headings are not within +-90 degrees of each other.
 		double headingDiff = abs(heading - pointsHeading);
 		if (headingDiff > 90 && headingDiff < 270)
@@ -102,10 +96,6 @@ bool VehicleLocate::IsInPointList(WGS84Point* points, int pointsLength, WGS84Poi
 		double dist1 = Conversions::DistanceMeters(points[i], point);
 		double dist2 = Conversions::DistanceMeters(points[i-1], point);
 
-		std::cout<<"CSW IsInPointList - point: " << point.Latitude <<", " <<point.Longitude<<std::endl;
-
-		std::cout << "CSW IsInPointList - laneDist_m: " << laneDist_m << ", dist1: " << dist1 << ", dist2: " << dist2 << std::endl;
-
 		if ((laneDist_m > dist1) && (laneDist_m > dist2))
 		{
 			double s = (.5) * (laneDist_m + dist1 + dist2);
@@ -113,8 +103,6 @@ bool VehicleLocate::IsInPointList(WGS84Point* points, int pointsLength, WGS84Poi
 
 			double dist_perp = 2 * (area / laneDist_m);
 
-			std::cout << "CSW IsInPointList - laneWidth: " << laneWidth << ", dist_perp: " << dist_perp << std::endl;
-
 			if (laneWidth / 2 > dist_perp)
 			{
 				return true;
@@ -151,7 +139,7 @@ void VehicleLocate::GetUInt32(unsigned char *buf, uint32_t *value)
 // - speed_mph: The current speed of the vehicle.
 // - vehicleId: The ID of the vehicle.
 // Returns true on success; false if the BSM is invalid or other error occurs.
-bool VehicleLocate::ProcessBsmMessage(BasicSafetyMessage_t &bsm, TravelerInformation *tim, int* regionNumber, float* speed_mph, int32_t *vehicleId)
+bool VehicleLocate::ProcessBsmMessage(BasicSafetyMessage_t &bsm, const TimZoneIndex &zones, int* regionNumber, float* speed_mph, int32_t *vehicleId)
 {
 	bool isSuccess = false;
 	//asn_fprint(stdout, &asn_DEF_BasicSafetyMessage, bsm);
@@ -159,8 +147,6 @@ bool VehicleLocate::ProcessBsmMessage(BasicSafetyMessage_t &bsm, TravelerInforma
 	int32_t latitude = bsm.coreData.lat;
 	int32_t longitude = bsm.coreData.Long;
 
-std::cout<<"ProgessBsmMessage - lat: "<<latitude<<" ,"<<" lon: "<<longitude<<std::endl;
-
 	uint16_t rawSpeed = bsm.coreData.speed;
 	uint16_t rawHeading = bsm.coreData.heading;
 	GetInt32((unsigned char *)bsm.coreData.id.buf, vehicleId);
@@ -181,7 +167,7 @@ std::cout<<"ProgessBsmMessage - lat: "<<latitude<<" ,"<<" lon: "<<longitude<<std
 
 		//std::cout << "Vehicle Lat/Long/Heading/Speed: " << vehiclePoint.Latitude << ", " << vehiclePoint.Longitude << ", " << heading << ", " << speed << std::endl;
 
-		*regionNumber = FindRegion(tim, vehiclePoint, heading);
+		*regionNumber = zones.FindZone(vehiclePoint, heading);
 
 		if (*regionNumber < 0)
 			*regionNumber = 0;
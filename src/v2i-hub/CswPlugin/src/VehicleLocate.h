@@ -12,6 +12,7 @@
 #include <NodeSetXY.h>
 //#include <asn_j2735_r63/BasicSafetyMessageVerbose.h>
 #include "DsrcBuilder.h"
+#include "TimZoneIndex.h"
 #include <WGS84Point.h>
 
 using namespace tmx::utils;
@@ -29,7 +30,7 @@ public:
 	static void GetUInt16(unsigned char *buf, uint16_t *value);
 	static void GetInt32(unsigned char *buf, int32_t *value);
 	static void GetUInt32(unsigned char *buf, uint32_t *value);
-	static bool ProcessBsmMessage(BasicSafetyMessage_t &bsm, TravelerInformation *tim, int* regionNumber, float* speed_mph, int32_t *vehicleId);
+	static bool ProcessBsmMessage(BasicSafetyMessage_t &bsm, const TimZoneIndex &zones, int* regionNumber, float* speed_mph, int32_t *vehicleId);
 };
 
 #endif /* VEHICLELOCATE_H_ */
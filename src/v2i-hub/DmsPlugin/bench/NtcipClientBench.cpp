@@ -0,0 +1,454 @@
+/*
+ * NtcipClientBench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ *
+ * Measures NTCIP request latency and throughput against a local SNMPv1 agent that stands in for
+ * a signal controller or message sign, comparing the old pattern of opening a session for every
+ * OID and waiting on snmp_synch_response with the shared NtcipClient, both one request at a time
+ * and with many requests in flight.
+ *
+ * The agent answers GET and SET for any OID, remembers the values set, and can add a fixed
+ * network delay and drop a share of the requests to exercise the timeouts and retries.
+ *
+ * Usage: NtcipClientBench [requests] [oids per request] [delay us] [drop percent]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <NtcipClient.h>
+#include <PercentileStatistics.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+// The phase status group OIDs that SignalControllerNTCIP::PhaseRead asks for
+#define BASE_OID "1.3.6.1.4.1.1206.4.2.1.1.4.1.4."
+
+/**
+ * A minimal SNMPv1 agent on a loopback UDP port.
+ */
+class StandInAgent
+{
+public:
+	StandInAgent(int delayUs, int dropPercent): _delayUs(delayUs), _dropPercent(dropPercent)
+	{
+		_fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t length = sizeof(addr);
+
+		if (_fd < 0 || ::bind(_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+				getsockname(_fd, (struct sockaddr *)&addr, &length) != 0)
+		{
+			cerr << "Unable to bind the stand-in agent: " << strerror(errno) << endl;
+			exit(1);
+		}
+
+		_port = ntohs(addr.sin_port);
+		_thread = thread(&StandInAgent::Run, this);
+	}
+
+	~StandInAgent()
+	{
+		_active = false;
+		_thread.join();
+		close(_fd);
+	}
+
+	int get_Port() const { return _port; }
+	uint64_t get_Packets() const { return _packets; }
+	uint64_t get_Dropped() const { return _dropped; }
+
+private:
+	struct Reply
+	{
+		chrono::steady_clock::time_point due;
+		struct sockaddr_in to;
+		string data;
+	};
+
+	// Read the tag and length of a BER item, returning the offset of its contents
+	static bool ReadHeader(const string &in, size_t &pos, uint8_t &tag, size_t &length)
+	{
+		if (pos + 2 > in.size())
+			return false;
+
+		tag = in[pos++];
+		length = (uint8_t)in[pos++];
+		if (length & 0x80)
+		{
+			size_t bytes = length & 0x7F;
+			if (bytes > 4 || pos + bytes > in.size())
+				return false;
+
+			length = 0;
+			while (bytes--)
+				length = (length << 8) | (uint8_t)in[pos++];
+		}
+
+		return pos + length <= in.size();
+	}
+
+	static void WriteHeader(string &out, uint8_t tag, size_t length)
+	{
+		out.push_back(tag);
+		if (length < 0x80)
+		{
+			out.push_back(length);
+		}
+		else if (length < 0x100)
+		{
+			out.push_back(0x81);
+			out.push_back(length);
+		}
+		else
+		{
+			out.push_back(0x82);
+			out.push_back(length >> 8);
+			out.push_back(length & 0xFF);
+		}
+	}
+
+	static string Item(uint8_t tag, const string &contents)
+	{
+		string out;
+		WriteHeader(out, tag, contents.size());
+		return out + contents;
+	}
+
+	static string Integer(long value)
+	{
+		string contents;
+		for (int shift = 24; shift > 0; shift -= 8)
+		{
+			// Leave off leading bytes that only repeat the sign
+			int8_t byte = value >> shift;
+			int8_t next = value >> (shift - 8);
+			if (!contents.empty() || !((byte == 0 && next >= 0) || (byte == -1 && next < 0)))
+				contents.push_back(byte);
+		}
+		contents.push_back(value & 0xFF);
+		return Item(ASN_INTEGER, contents);
+	}
+
+	// Answer a GET or SET message, or return an empty string if it cannot be parsed
+	string Answer(const string &in)
+	{
+		size_t pos = 0, length;
+		uint8_t tag;
+
+		if (!ReadHeader(in, pos, tag, length) || tag != 0x30)
+			return "";
+
+		size_t versionStart = pos;
+		if (!ReadHeader(in, pos, tag, length) || tag != ASN_INTEGER)
+			return "";
+		pos += length;
+		if (!ReadHeader(in, pos, tag, length) || tag != ASN_OCTET_STR)
+			return "";
+		pos += length;
+		string header = in.substr(versionStart, pos - versionStart);
+
+		uint8_t command;
+		if (!ReadHeader(in, pos, command, length) || (command != SNMP_MSG_GET && command != SNMP_MSG_SET))
+			return "";
+
+		// Request ID, error status and error index
+		size_t idStart = pos;
+		if (!ReadHeader(in, pos, tag, length))
+			return "";
+		pos += length;
+		string requestId = in.substr(idStart, pos - idStart);
+		for (int i = 0; i < 2; i++)
+		{
+			if (!ReadHeader(in, pos, tag, length))
+				return "";
+			pos += length;
+		}
+
+		if (!ReadHeader(in, pos, tag, length) || tag != 0x30)
+			return "";
+
+		string varbinds;
+		size_t end = pos + length;
+		while (pos < end)
+		{
+			size_t bindEnd;
+			if (!ReadHeader(in, pos, tag, length) || tag != 0x30)
+				return "";
+			bindEnd = pos + length;
+
+			size_t nameStart = pos;
+			if (!ReadHeader(in, pos, tag, length) || tag != ASN_OBJECT_ID)
+				return "";
+			pos += length;
+			string name = in.substr(nameStart, pos - nameStart);
+			string value = in.substr(pos, bindEnd - pos);
+			pos = bindEnd;
+
+			if (command == SNMP_MSG_SET)
+			{
+				_values[name] = value;
+			}
+			else
+			{
+				map<string, string>::iterator stored = _values.find(name);
+				value = (stored != _values.end() ? stored->second : Integer((uint8_t)name.back()));
+			}
+
+			varbinds.append(Item(0x30, name + value));
+		}
+
+		string pdu = requestId + Integer(SNMP_ERR_NOERROR) + Integer(0) + Item(0x30, varbinds);
+		return Item(0x30, header + Item(SNMP_MSG_RESPONSE, pdu));
+	}
+
+	void Run()
+	{
+		mt19937 random(7);
+		uniform_int_distribution<int> percent(0, 99);
+		deque<Reply> replies;
+		char buffer[65536];
+
+		while (_active)
+		{
+			int timeout = 50;
+			if (!replies.empty())
+			{
+				timeout = chrono::duration_cast<chrono::milliseconds>(replies.front().due - chrono::steady_clock::now()).count();
+				if (timeout < 0)
+					timeout = 0;
+			}
+
+			struct pollfd pfd = { _fd, POLLIN, 0 };
+			if (poll(&pfd, 1, timeout) > 0)
+			{
+				Reply reply;
+				socklen_t length = sizeof(reply.to);
+				ssize_t count = recvfrom(_fd, buffer, sizeof(buffer), 0, (struct sockaddr *)&reply.to, &length);
+				if (count > 0)
+				{
+					_packets++;
+					if (percent(random) < _dropPercent)
+					{
+						_dropped++;
+					}
+					else
+					{
+						reply.data = Answer(string(buffer, count));
+						reply.due = chrono::steady_clock::now() + chrono::microseconds(_delayUs);
+						if (!reply.data.empty())
+							replies.push_back(reply);
+					}
+				}
+			}
+
+			// The delay is the same for every reply, so they come due in order
+			chrono::steady_clock::time_point now = chrono::steady_clock::now();
+			while (!replies.empty() && replies.front().due <= now)
+			{
+				Reply &reply = replies.front();
+				sendto(_fd, reply.data.data(), reply.data.size(), 0, (struct sockaddr *)&reply.to, sizeof(reply.to));
+				replies.pop_front();
+			}
+		}
+	}
+
+	int _fd;
+	int _port;
+	int _delayUs;
+	int _dropPercent;
+	map<string, string> _values;
+	atomic<bool> _active {true};
+	atomic<uint64_t> _packets {0};
+	atomic<uint64_t> _dropped {0};
+	thread _thread;
+};
+
+struct Results
+{
+	Results(size_t requests): latency(requests) { }
+
+	PercentileStatistics latency;
+	uint64_t failed = 0;
+	double seconds = 0;
+};
+
+static void Print(const char *name, Results &results, int requests, int oids)
+{
+	cout << left << setw(10) << name << right << fixed << setprecision(1) <<
+			setw(12) << results.latency.Percentile(50) << setw(12) << results.latency.Percentile(99) <<
+			setw(12) << results.latency.Max() << setprecision(0) <<
+			setw(12) << requests / results.seconds << setw(12) << (double)requests * oids / results.seconds <<
+			setw(8) << results.failed << endl;
+}
+
+// The old pattern of SignalControllerNTCIP: a new session and a blocking request for each OID
+static void RunOpenClose(int port, const vector<vector<string> > &requests, Results &results)
+{
+	string peer = "127.0.0.1:" + to_string(port);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (const vector<string> &oids : requests)
+	{
+		chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+		bool ok = true;
+
+		for (const string &text : oids)
+		{
+			netsnmp_session session, *ss;
+			snmp_sess_init(&session);
+			session.peername = (char *)peer.c_str();
+			session.version = SNMP_VERSION_1;
+			session.community = (u_char *)"public";
+			session.community_len = strlen("public");
+
+			ss = snmp_open(&session);
+			if (!ss)
+			{
+				ok = false;
+				continue;
+			}
+
+			oid name[MAX_OID_LEN];
+			size_t nameLength = MAX_OID_LEN;
+			snmp_parse_oid(text.c_str(), name, &nameLength);
+
+			netsnmp_pdu *pdu = snmp_pdu_create(SNMP_MSG_GET);
+			snmp_add_null_var(pdu, name, nameLength);
+
+			netsnmp_pdu *response = NULL;
+			int status = snmp_synch_response(ss, pdu, &response);
+			if (status != STAT_SUCCESS || response == NULL || response->errstat != SNMP_ERR_NOERROR)
+				ok = false;
+			if (response)
+				snmp_free_pdu(response);
+
+			snmp_close(ss);
+		}
+
+		results.latency.Add(chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count());
+		if (!ok)
+			results.failed++;
+	}
+
+	results.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// One request at a time on the shared client, with all the OIDs of a request in one PDU
+static void RunSession(NtcipClient &client, NtcipClient::DeviceId device, const vector<vector<string> > &requests, Results &results)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (const vector<string> &oids : requests)
+	{
+		NtcipClient::Response response = client.Get(device, oids).get();
+		results.latency.Add(response.latencyMicroseconds);
+		if (!response.Ok() || response.values.size() != oids.size())
+			results.failed++;
+	}
+
+	results.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Every request made at once, so the client keeps several PDUs in flight and combines the rest
+static void RunAsync(NtcipClient &client, NtcipClient::DeviceId device, const vector<vector<string> > &requests, Results &results)
+{
+	mutex lock;
+	promise<void> done;
+	size_t remaining = requests.size();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (const vector<string> &oids : requests)
+	{
+		size_t expected = oids.size();
+		client.Get(device, oids, [&, expected](const NtcipClient::Response &response)
+		{
+			lock_guard<mutex> guard(lock);
+			results.latency.Add(response.latencyMicroseconds);
+			if (!response.Ok() || response.values.size() != expected)
+				results.failed++;
+			if (--remaining == 0)
+				done.set_value();
+		});
+	}
+
+	done.get_future().wait();
+	results.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+	int requests = argc > 1 ? atoi(argv[1]) : 2000;
+	int oids = argc > 2 ? atoi(argv[2]) : 8;
+	int delayUs = argc > 3 ? atoi(argv[3]) : 500;
+	int dropPercent = argc > 4 ? atoi(argv[4]) : 0;
+	if (requests <= 0 || oids <= 0 || delayUs < 0 || dropPercent < 0 || dropPercent >= 100)
+	{
+		cerr << "Usage: " << argv[0] << " [requests] [oids per request] [delay us] [drop percent]" << endl;
+		return 1;
+	}
+
+	NtcipClient &client = NtcipClient::Shared();
+	StandInAgent agent(delayUs, dropPercent);
+
+	vector<vector<string> > work(requests);
+	for (int r = 0; r < requests; r++)
+	{
+		for (int i = 0; i < oids; i++)
+			work[r].push_back(BASE_OID + to_string((r + i) % 16 + 1));
+	}
+
+	NtcipClient::DeviceOptions options;
+	options.timeoutMs = 200;
+	options.retries = 2;
+	NtcipClient::DeviceId device = client.OpenDevice("127.0.0.1", agent.get_Port(), options);
+
+	cout << requests << " GET requests of " << oids << " OIDs, " << delayUs << " us agent delay, " <<
+			dropPercent << "% dropped" << endl;
+	cout << left << setw(10) << "Mode" << right << setw(12) << "P50 us" << setw(12) << "P99 us" <<
+			setw(12) << "Max us" << setw(12) << "req/s" << setw(12) << "OID/s" << setw(8) << "Failed" << endl;
+
+	// The old pattern is slow, so it only runs a share of the requests
+	vector<vector<string> > openCloseWork(work.begin(), work.begin() + max(1, requests / 10));
+	Results openClose(openCloseWork.size());
+	RunOpenClose(agent.get_Port(), openCloseWork, openClose);
+	Print("open/close", openClose, openCloseWork.size(), oids);
+
+	Results session(requests);
+	RunSession(client, device, work, session);
+	Print("session", session, requests, oids);
+
+	Results async(requests);
+	RunAsync(client, device, work, async);
+	Print("async", async, requests, oids);
+
+	cout << "Packets received by the agent: " << agent.get_Packets() << ", dropped: " << agent.get_Dropped() << endl;
+
+	client.CloseDevice(device);
+	client.Stop();
+	return 0;
+}
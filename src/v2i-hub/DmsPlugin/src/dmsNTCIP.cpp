@@ -1,5 +1,7 @@
 #include "dmsNTCIP.h"
 
+using namespace tmx::utils;
+
 const char* DMS_MSG_MEMORYTYPE_CURR =		"1.3.6.1.4.1.1206.4.2.3.5.8.1.1";
 const char* DMS_MSG_NUMBER_CURR =			"1.3.6.1.4.1.1206.4.2.3.5.8.1.2";
 const char* DMS_MSG_MULTISTRING_CURR =		"1.3.6.1.4.1.1206.4.2.3.5.8.1.3";
@@ -8,29 +10,14 @@ const char* DMS_MSG_CRC_CURR =				"1.3.6.1.4.1.1206.4.2.3.5.8.1.5";
 const char* DMS_MSG_RUNTIMEPRIORITY_CURR =	"1.3.6.1.4.1.1206.4.2.3.5.8.1.8";
 const char* DMS_MSG_STATUS_CURR =			"1.3.6.1.4.1.1206.4.2.3.5.8.1.9";
 
-char* concat(char *s1, char *s2)
-{
-    size_t len1 = strlen(s1);
-    size_t len2 = strlen(s2);
-    char *result = (char *) malloc(len1+len2+1);
-
-    strcpy(result, s1);
-    strcat(result, s2);
-    //memcpy(result, s1, len1);
-    //memcpy(result+len1, s2, len2+1);//+1 to copy the null-terminator
-    return result;
-}
-char* concat(const char *s1, const char *s2)
-{
-	return concat((char*)s1, (char*)s2);
-}
-char* concat(const char *s1, char *s2)
+std::string concat(const char *s1, const char *s2)
 {
-	return concat((char*)s1, s2);
+	return std::string(s1) + s2;
 }
 
 void SignalControllerNTCIP::setConfigs(std::string snmpIP, char* snmpPort)
 {
+	closeDevices();
 	INTip = strdup(snmpIP.c_str());
 	INTport = strdup(snmpPort);
 	//printf("NTCIP Configuration Set %s:%s\n", INTip, INTport);
@@ -38,6 +25,7 @@ void SignalControllerNTCIP::setConfigs(std::string snmpIP, char* snmpPort)
 
 void SignalControllerNTCIP::setConfigs(std::string snmpIP, int snmpPort)
 {
+	closeDevices();
 	INTip = strdup(snmpIP.c_str());
 
 	char port[6];
@@ -47,81 +35,124 @@ void SignalControllerNTCIP::setConfigs(std::string snmpIP, int snmpPort)
 }
 
 /**
- * Send SMNP messages from the supplied pdu
+ * Return the session to the controller for the community on the shared NTCIP client, opening it on first use
+ */
+NtcipClient::DeviceId SignalControllerNTCIP::getDevice(const char *community)
+{
+	std::map<std::string, NtcipClient::DeviceId>::iterator it = _devices.find(community);
+	if (it != _devices.end())
+		return it->second;
+
+	if (!INTip || !INTport)
+		return 0;
+
+	NtcipClient::DeviceOptions options;
+	options.community = community;
+	options.version = SNMP_VERSION_1;
+
+	NtcipClient::DeviceId device;
+	try
+	{
+		device = NtcipClient::Shared().OpenDevice(INTip, atoi(INTport), options);
+	}
+	catch (exception &ex)
+	{
+		fprintf(stderr, "%s\n", ex.what());
+		return 0;
+	}
+
+	_devices[community] = device;
+	return device;
+}
+
+void SignalControllerNTCIP::closeDevices()
+{
+	for (std::map<std::string, NtcipClient::DeviceId>::iterator it = _devices.begin(); it != _devices.end(); it++)
+		NtcipClient::Shared().CloseDevice(it->second);
+	_devices.clear();
+}
+
+/**
+ * Send SMNP messages from the supplied pdu on the session to the controller for the community.
+ * The supplied pdu is freed.  The response is returned in a pdu that the caller must free, or
+ * NULL if there was no response.
  */
 
 netsnmp_pdu* SignalControllerNTCIP::getSNMP(netsnmp_pdu *pdu, const char *community)
 {
-	netsnmp_session session, *ss;
-	netsnmp_pdu *response;
-	int status;
+	netsnmp_variable_list *vars;
+	std::vector<std::string> oids;
+	std::vector<NtcipClient::Variable> variables;
 
 	printf("getSNMP Function - \tIP:   %s   Port:   %s   Community: %s\n", INTip, INTport, community);
-	//printf("getSNMP %s %s\n", INTip, INTport);
-	snmp_sess_init(&session); //Initialize a "session" that defines who we're going to talk to
-	/* set up defaults */
-	char ipwithport[64];
-	strcpy(ipwithport, INTip);
-	strcat(ipwithport, ":");
-	strcat(ipwithport, INTport);
-	//printf("SNMP IP %s\n", ipwithport);
-
-	session.peername = strdup(ipwithport);
-	session.version = SNMP_VERSION_1; //for ASC intersection  /* set the SNMP version number */
-	/* set the SNMPv1 community name used for authentication */
-	//session.community = (u_char *) "Public";
-	session.community = (u_char *) community;
-	session.community_len = strlen((const char *) session.community);
-
-	SOCK_STARTUP;
-	ss = snmp_open(&session); /* establish the session */
-
-	if (!ss) {
-		// Could not open session
-		snmp_sess_perror("ASC", &session);
-		SOCK_CLEANUP;
-		return NULL;
+
+	int command = pdu->command;
+	for (vars = pdu->variables; vars; vars = vars->next_variable)
+	{
+		std::string name;
+		for (size_t i = 0; i < vars->name_length; i++)
+		{
+			if (i > 0)
+				name.push_back('.');
+			name.append(std::to_string(vars->name[i]));
+		}
+
+		if (command == SNMP_MSG_SET)
+			variables.push_back(NtcipClient::Variable(name, vars->type, vars->val.string, vars->val_len));
+		else
+			oids.push_back(name);
 	}
+	snmp_free_pdu(pdu);
 
-	/*
-	 * Send the messages and get responses
-	 */
-	status = snmp_synch_response(ss, pdu, &response);
+	NtcipClient::DeviceId device = getDevice(community);
+	if (!device)
+		return NULL;
+
+	NtcipClient::Response response = (command == SNMP_MSG_SET ?
+			NtcipClient::Shared().Set(device, variables) : NtcipClient::Shared().Get(device, oids)).get();
 
 	/*
 	 * Check response for errors.
 	 */
-	if (!response)
+	if (response.status != NtcipClient::Success)
 	{
 		printf("SignalControllerNTCIP::getSNMP Response is null\n");
-		snmp_sess_perror("ASC", &session);
-		SOCK_CLEANUP;
+		if (response.status == NtcipClient::Timeout)
+			fprintf(stderr, "Timeout: No response from %s:%s.\n", INTip, INTport);
+		else
+			fprintf(stderr, "Error %s:%s.\n", INTip, INTport);
 		return NULL;
 	}
 
-	if (status != STAT_SUCCESS && response->errstat != SNMP_ERR_NOERROR) {
-//	if (status != STAT_SUCCESS) { // && response->errstat != SNMP_ERR_NOERROR) {
-		printf("SignalControllerNTCIP::getSNMP Status not successful\n");
-		if (status == STAT_SUCCESS)
-		{
-			fprintf(stderr, "Error in packet\nReason: %s\n", snmp_errstring(response->errstat));
-		}
-		else if (status == STAT_TIMEOUT)
-		{
-			fprintf(stderr, "Timeout: No response from %s.\n", session.peername);
-		}
-		else
+	netsnmp_pdu *results = snmp_pdu_create(SNMP_MSG_RESPONSE);
+	results->errstat = response.errorStatus;
+	results->errindex = response.errorIndex;
+
+	for (size_t i = 0; i < response.values.size(); i++)
+	{
+		const NtcipClient::Value &value = response.values[i];
+
+		oid anOID[MAX_OID_LEN];
+		size_t anOID_len = MAX_OID_LEN;
+		if (!snmp_parse_oid(value.oid.c_str(), anOID, &anOID_len))
+			continue;
+
+		switch (value.type)
 		{
-			fprintf(stderr, "Error %s.\n", session.peername);
-			snmp_sess_perror("SendSNMP", ss);
+		case ASN_INTEGER:
+		case ASN_COUNTER:
+		case ASN_GAUGE:
+		case ASN_TIMETICKS:
+		case ASN_UINTEGER:
+			snmp_pdu_add_variable(results, anOID, anOID_len, value.type, &value.integer, sizeof(value.integer));
+			break;
+		default:
+			snmp_pdu_add_variable(results, anOID, anOID_len, value.type, value.string.data(), value.string.size());
+			break;
 		}
-		return NULL;
 	}
 
-	snmp_close(ss);
-	SOCK_CLEANUP;
-
-	return response;
+	return results;
 }
 
 netsnmp_pdu*  SignalControllerNTCIP::singleGetSNMP(const char* getOID, const char* community)
@@ -153,7 +184,7 @@ int  SignalControllerNTCIP::getSingleINT(const char* getOID, const char *communi
 {
     netsnmp_pdu *response;
     netsnmp_variable_list *vars;
-    int *returnInt;
+    int returnInt = -1;
 
 	//printf("getSingleINT Function -\tOID: %s \t Community: %s\n", getOID, community);
     response = singleGetSNMP(getOID, community);
@@ -162,7 +193,8 @@ int  SignalControllerNTCIP::getSingleINT(const char* getOID, const char *communi
         for(vars = response->variables; vars; vars = vars->next_variable)
         {
         	// Should only be one integer variable
-        	returnInt = (int *) vars->val.integer;
+        	if (vars->val.integer)
+        		returnInt = (int) *vars->val.integer;
         }
     }
     else
@@ -175,77 +207,50 @@ int  SignalControllerNTCIP::getSingleINT(const char* getOID, const char *communi
     {
     	snmp_free_pdu(response);
     }
-    return *returnInt;
+    return returnInt;
 
 }
 
-char * SignalControllerNTCIP::getSingleString(const char* getOID, const char *community)
+std::string SignalControllerNTCIP::getSingleString(const char* getOID, const char *community)
 {
     netsnmp_pdu *response;
     netsnmp_variable_list *vars;
-    char *returnInt;
-    //int *NumVars;
+    std::string returnString;
 
     //printf("getSingleString\n");
     response = singleGetSNMP(getOID, community);
     if (response)
     {
 		printf("getSingleString Function -\tOID: %s \t Community: %s\t", getOID, community);
-    	//------SUCCESS: Print the result variables
-	    int *out = new int[MAX_ITEMS];
-	    int i =0;
 	    for(vars = response->variables; vars; vars = vars->next_variable)
 	        print_variable(vars->name, vars->name_length, vars);
 
 	    for(vars = response->variables; vars; vars = vars->next_variable)
 	    {
-			//case ASN_INTEGER:
-			//case ASN_COUNTER:
-			//case ASN_GAUGE:
-			//case ASN_TIMETICKS:
-			//case ASN_PRIV_IMPLIED_OBJECT_ID:
-			//case ASN_OBJECT_ID:
-			//case ASN_PRIV_IMPLIED_OCTET_STR:
-			//case ASN_OPAQUE:
-			//case ASN_OCTET_STR:
-			//	var->name_length = var->val_len + 1;
-			//	var->name = (oid *) malloc(sizeof(oid) * (var->name_length));
 	        if (vars->type == ASN_OCTET_STR)
 	        {
 	            printf("ASN-OCTET-String Variable: \n");
-	            char *sp = (char *)malloc(1 + vars->val_len);
-	            memcpy(sp, vars->val.string, vars->val_len);
-	            sp[vars->val_len] = '\0';
-	            //printf("value #%d is a string: %s\n", *NumVars++, sp);
-	            printf("%s\n", sp);
-	            free(sp);
+	            returnString.assign((const char *)vars->val.string, vars->val_len);
+	            printf("%s\n", returnString.c_str());
 	        }
 	        else if (vars->type == ASN_INTEGER)
 	        {
 	            printf("ASN-INTEGER Variable: \n");
-	            int *aa;
-	            aa =(int *)vars->val.integer;
-	            out[i++] = * aa;
-	            printf("value #%d is NOT a string! Ack!\n", *returnInt++);
+	            printf("value is NOT a string! Ack!\n");
 	        }
 	    }
-       for(vars = response->variables; vars; vars = vars->next_variable)
-        {
-        	//NumChars = vars->val_len;
-        	returnInt = (char *) vars->val.bitstring;
-        }
     }
     else
     {
     	// No response
-        return NULL;
+        return returnString;
     }
 
     if (response)
     {
     	snmp_free_pdu(response);
     }
-    return returnInt;
+    return returnString;
 }
 
 int  SignalControllerNTCIP::getOctetString(const char* getOID,  const char *community)
@@ -319,7 +324,6 @@ int  SignalControllerNTCIP::getMaxOverlaps()
 int  SignalControllerNTCIP::CurTimingPlanRead()
 {
     // USING the standard oid : ONLY read timing plan 1.
-    netsnmp_session session, *ss;
     netsnmp_pdu *pdu;
     netsnmp_pdu *response;
 
@@ -327,35 +331,9 @@ int  SignalControllerNTCIP::CurTimingPlanRead()
     size_t anOID_len;
 
     netsnmp_variable_list *vars;
-    int status;
     //int count=1;
     //int currentTimePlan; // return value
 
-    snmp_sess_init( &session );  //Initialize a "session" that defines who we're going to talk to
-    /* set up defaults */
-    //char *ip = m_rampmeterip.GetBuffer(m_rampmeterip.GetLength());
-    //char *port = m_rampmeterport.GetBuffer(m_rampmeterport.GetLength());
-   char ipwithport[64];
-       strcpy(ipwithport,INTip);
-       strcat(ipwithport,":");
-       strcat(ipwithport,INTport);
-    session.peername = strdup(ipwithport);
-    //session.version = SNMP_VERSION_2c; //for ASC intersection  /* set the SNMP version number */
-    session.version = SNMP_VERSION_1;    //for ASC/3 software  /* set the SNMP version number */
-    /* set the SNMPv1 community name used for authentication */
-    session.community = (u_char *)"public";
-    session.community_len = strlen((const char *)session.community);
-
-    SOCK_STARTUP;
-    ss = snmp_open(&session);                     /* establish the session */
-
-    if (!ss)
-    {
-        snmp_sess_perror("RSU", &session);
-        SOCK_CLEANUP;
-        exit(1);
-    }
-
     /*
     * Create the PDU for the data for our request.
     *   1) We're going to GET the system.sysDescr.0 node.
@@ -382,14 +360,14 @@ int  SignalControllerNTCIP::CurTimingPlanRead()
 
 
     /*
-    * Send the Request out.
+    * Send the Request out on the shared session.
     */
-    status = snmp_synch_response(ss, pdu, &response);
+    response = getSNMP(pdu, "public");
 
     /*
     * Process the response.
     */
-    if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR)
+    if (response && response->errstat == SNMP_ERR_NOERROR)
     {
         /*
         * SUCCESS: Print the result variables
@@ -424,28 +402,17 @@ int  SignalControllerNTCIP::CurTimingPlanRead()
         CurTimingPlan=out[0];
 
     }
-    else
+    else if (response)
     {
-        if (status == STAT_SUCCESS)
-            fprintf(stderr, "Error in packet\nReason: %s\n",
-            snmp_errstring(response->errstat));
-        else if (status == STAT_TIMEOUT)
-            fprintf(stderr, "Timeout: No response from %s.\n",
-            session.peername);
-        else
-            snmp_sess_perror("signalControllerSNMP", ss);
-
+        fprintf(stderr, "Error in packet\nReason: %s\n",
+        snmp_errstring(response->errstat));
     }
 
     /*
-    * Clean up:    *  1) free the response.   *  2) close the session.
+    * Clean up:    *  1) free the response.
     */
     if (response)        snmp_free_pdu(response);
 
-    snmp_close(ss);
-
-    SOCK_CLEANUP;
-
     return CurTimingPlan;
 
 }
@@ -465,7 +432,6 @@ void SignalControllerNTCIP::PhaseControl(int phase_control, int Total,char YES)
     char tmp_log[64];
     char tmp_int[16];
     //char buffer[16];
-    netsnmp_session session, *ss;
     netsnmp_pdu *pdu;
     netsnmp_pdu *response;
 	int verbose=0;
@@ -475,7 +441,6 @@ void SignalControllerNTCIP::PhaseControl(int phase_control, int Total,char YES)
     size_t anOID_len;
 
     netsnmp_variable_list *vars;
-    int status;
     int count=1;
     int  failures = 0;
 
@@ -488,35 +453,6 @@ void SignalControllerNTCIP::PhaseControl(int phase_control, int Total,char YES)
 
     cout<<"  "<<tmp_int<<"  "<<YES<<endl;
 
-    /*
-    * Initialize a "session" that defines who we're going to talk to
-    */
-    snmp_sess_init( &session );                   /* set up defaults */
-
-    char ipwithport[64];
-    strcpy(ipwithport,INTip);
-    strcat(ipwithport,":");
-    strcat(ipwithport,INTport);
-    session.peername = strdup(ipwithport);
-
-    /* set the SNMP version number */
-    //session.version = SNMP_VERSION_2c;
-    session.version = SNMP_VERSION_1;
-
-    /* set the SNMPv1 community name used for authentication */
-    session.community = (u_char *)"public";
-    session.community_len = strlen((const char *)session.community);
-
-    SOCK_STARTUP;
-    ss = snmp_open(&session);                     /* establish the session */
-
-    if (!ss)
-        {
-        snmp_sess_perror("RSU", &session);
-        SOCK_CLEANUP;
-        exit(1);
-        }
-
     /*
     * Create the PDU for the data for our request.
     *   1) We're going to SET the system.sysDescr.0 node.
@@ -590,20 +526,19 @@ void SignalControllerNTCIP::PhaseControl(int phase_control, int Total,char YES)
 
     if (failures)
         {
-        snmp_close(ss);
         SOCK_CLEANUP;
         exit(1);
         }
 
     /*
-    * Send the Request out.
+    * Send the Request out on the shared session.
     */
-    status = snmp_synch_response(ss, pdu, &response);
+    response = getSNMP(pdu, "public");
 
     /*
     * Process the response.
     */
-    if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR)
+    if (response && response->errstat == SNMP_ERR_NOERROR)
         {
         //------SUCCESS: Print the result variables
           int *out = new int[MAX_ITEMS];
@@ -631,30 +566,20 @@ void SignalControllerNTCIP::PhaseControl(int phase_control, int Total,char YES)
                 }
             }
         }
-    else
+    else if (response)
         {
         // FAILURE: print what went wrong!
-        if (status == STAT_SUCCESS)
-            fprintf(stderr, "Error in packet\nReason: %s\n",
-            snmp_errstring(response->errstat));
-        else if (status == STAT_TIMEOUT)
-            fprintf(stderr, "Timeout: No response from %s.\n",
-            session.peername);
-        else
-            snmp_sess_perror("signalControllerSNMP", ss);
+        fprintf(stderr, "Error in packet\nReason: %s\n",
+        snmp_errstring(response->errstat));
         }
-    //------Clean up:1) free the response. 2) close the session.
+    //------Clean up:1) free the response.
     if (response)
         snmp_free_pdu(response);
-    snmp_close(ss);
-
-    SOCK_CLEANUP;
 
     }
 
 void SignalControllerNTCIP::PhaseRead()
     {
-    netsnmp_session session, *ss;
 	    netsnmp_pdu *pdu;
 	    netsnmp_pdu *response;
 
@@ -662,34 +587,8 @@ void SignalControllerNTCIP::PhaseRead()
 	    size_t anOID_len;
 
 	    netsnmp_variable_list *vars;
-	    int status;
 	    int count=1;
 
-	    snmp_sess_init( &session );  //Initialize a "session" that defines who we're going to talk to
-	    /* set up defaults */
-	    //char *ip = m_rampmeterip.GetBuffer(m_rampmeterip.GetLength());
-	    //char *port = m_rampmeterport.GetBuffer(m_rampmeterport.GetLength());
-	    char ipwithport[64];
-		    strcpy(ipwithport,INTip);
-		    strcat(ipwithport,":");
-		    strcat(ipwithport,INTport);
-	    session.peername = strdup(ipwithport);
-	    //session.version = SNMP_VERSION_2c; //for ASC intersection  /* set the SNMP version number */
-	    session.version = SNMP_VERSION_1; //for ASC intersection  /* set the SNMP version number */
-	    /* set the SNMPv1 community name used for authentication */
-	    session.community = (u_char *)"public";
-	    session.community_len = strlen((const char *)session.community);
-
-	    SOCK_STARTUP;
-	    ss = snmp_open(&session);                     /* establish the session */
-
-	    if (!ss)
-	    {
-	        snmp_sess_perror("ASC", &session);
-	        SOCK_CLEANUP;
-	        exit(1);
-	    }
-
 	    /*
 	    * Create the PDU for the data for our request.
 	    *   1) We're going to GET the system.sysDescr.0 node.
@@ -718,14 +617,14 @@ void SignalControllerNTCIP::PhaseRead()
 
 
 	    /*
-	    * Send the Request out.
+	    * Send the Request out on the shared session.
 	    */
-	    status = snmp_synch_response(ss, pdu, &response);
+	    response = getSNMP(pdu, "public");
 
 	    /*
 	    * Process the response.
 	    */
-	    if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR)
+	    if (response && response->errstat == SNMP_ERR_NOERROR)
 	    {
 	        /*
 	        * SUCCESS: Print the result variables
@@ -765,25 +664,15 @@ void SignalControllerNTCIP::PhaseRead()
 	            //if(out[i]==3)       PhaseDisabled[i]=1;  // Phase i is not enabled.
 //	        }
 	    }
-	    else
+	    else if (response)
 	    {
-	        if (status == STAT_SUCCESS)
-	            fprintf(stderr, "Error in packet\nReason: %s\n",
-	            snmp_errstring(response->errstat));
-	        else if (status == STAT_TIMEOUT)
-	            fprintf(stderr, "Timeout: No response from %s.\n",
-	            session.peername);
-	        else
-	            snmp_sess_perror("signalControllerSNMP", ss);
-
+	        fprintf(stderr, "Error in packet\nReason: %s\n",
+	        snmp_errstring(response->errstat));
 	    }
 	    /*
-	    * Clean up:    *  1) free the response.   *  2) close the session.
+	    * Clean up:    *  1) free the response.
 	    */
 	    if (response)        snmp_free_pdu(response);
-
-	    snmp_close(ss);
-	    SOCK_CLEANUP;
     }
 
  // Spat push Control
@@ -803,7 +692,6 @@ void SignalControllerNTCIP::DisableSpaTPush()
 void SignalControllerNTCIP::sendSpatPush(int command)
 {
 	// USING the standard oid : Set the Spat Push value
-	netsnmp_session session, *ss;
 	netsnmp_pdu *pdu;
 	netsnmp_pdu *response;
 
@@ -811,29 +699,6 @@ void SignalControllerNTCIP::sendSpatPush(int command)
 	size_t anOID_len;
 
 	//netsnmp_variable_list *vars;
-	int status;
-
-	snmp_sess_init(&session); //Initialize a "session" that defines who we're going to talk to
-	/* set up defaults */
-	char ipwithport[64];
-	strcpy(ipwithport, INTip);
-	strcat(ipwithport, ":");
-	strcat(ipwithport, INTport);
-	session.peername = strdup(ipwithport);
-	session.version = SNMP_VERSION_1;
-	/* set the SNMPv1 community name used for authentication */
-	session.community = (u_char *) "public";
-	session.community_len = strlen((const char *) session.community);
-
-	SOCK_STARTUP;
-	ss = snmp_open(&session); /* establish the session */
-
-	if (!ss) {
-		snmp_sess_perror("ASC", &session);
-		SOCK_CLEANUP;
-		// TODO: add failure
-		return;
-	}
 
 	/*
 	 * Create the PDU for the data for our request.
@@ -847,20 +712,20 @@ void SignalControllerNTCIP::sendSpatPush(int command)
 	{
 		printf("Error parse failed\n");
 		snmp_perror(ENABLE_SPAT);
-		SOCK_CLEANUP;
+		snmp_free_pdu(pdu);
 		return;
 	}
 	snmp_add_var(pdu, anOID, anOID_len, 'i', "6");
 
 	/*
-	 * Send the Request out.
+	 * Send the Request out on the shared session.
 	 */
-	status = snmp_synch_response(ss, pdu, &response);
+	response = getSNMP(pdu, "public");
 
 	/*
 	 * Process the response.
 	 */
-	if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR) {
+	if (response && response->errstat == SNMP_ERR_NOERROR) {
 		/*
 		 * SUCCESS: Print the result variables
 		 */
@@ -890,28 +755,22 @@ void SignalControllerNTCIP::sendSpatPush(int command)
 		CurTimingPlan = out[0];
 		*/
 
-	} else {
-		if (status == STAT_SUCCESS)
-			fprintf(stderr, "Error in packet\nReason: %s\n",
-					snmp_errstring(response->errstat));
-		else if (status == STAT_TIMEOUT)
-			fprintf(stderr, "Timeout: No response from %s.\n",
-					session.peername);
-		else
-			snmp_sess_perror("signalControllerSNMP", ss);
-
+	} else if (response) {
+		fprintf(stderr, "Error in packet\nReason: %s\n",
+				snmp_errstring(response->errstat));
 	}
 
 	/*
-	 * Clean up:    *  1) free the response.   *  2) close the session.
+	 * Clean up:    *  1) free the response.
 	 */
 	if (response)
 		snmp_free_pdu(response);
+}
+
+
+
 
-	snmp_close(ss);
 
-	SOCK_CLEANUP;
-}
 
 
 
@@ -987,7 +846,7 @@ int  SignalControllerNTCIP::getDMSMsgNumber()
 	//printf("\ngetDMSMsgNumber Function\n");
 	return getSingleINT(DMS_MSG_NUMBER, "public");
 }
-char *  SignalControllerNTCIP::getDMSMsgMultiString()
+std::string SignalControllerNTCIP::getDMSMsgMultiString()
 {
 	//printf("\ngetDMSMsgMultiString Function\n");
 	return getSingleString(DMS_MSG_MULTISTRING, "public");
@@ -1010,43 +869,43 @@ int  SignalControllerNTCIP::getDMSMsgRunTimePriority()
 int  SignalControllerNTCIP::getDMSMsgStatus(const char *MsgID)
 {
 	//printf("\ngetDMSMsgStatus Function\n");
-	return getSingleINT(concat(DMS_MSG_STATUS, MsgID), "public");
+	return getSingleINT(concat(DMS_MSG_STATUS, MsgID).c_str(), "public");
 }
 
 int  SignalControllerNTCIP::getDMSMsgMemoryTypeCurr(const char *msgID)
 {
 	//printf("\ngetDMSMsgMemoryType_Curr Function\n");
-	return getSingleINT(concat(DMS_MSG_MEMORYTYPE_CURR, msgID), "public");
+	return getSingleINT(concat(DMS_MSG_MEMORYTYPE_CURR, msgID).c_str(), "public");
 }
 int  SignalControllerNTCIP::getDMSMsgNumberCurr(const char *msgID)
 {
 	//printf("\ngetDMSMsgNumber_Curr Function\n");
-	return getSingleINT(concat(DMS_MSG_NUMBER_CURR, msgID), "public");
+	return getSingleINT(concat(DMS_MSG_NUMBER_CURR, msgID).c_str(), "public");
 }
-char *  SignalControllerNTCIP::getDMSMsgMultiStringCurr(const char *msgID)
+std::string SignalControllerNTCIP::getDMSMsgMultiStringCurr(const char *msgID)
 {
 	//printf("\ngetDMSMsgMultiString_Curr Function\n");
-	return getSingleString(concat(DMS_MSG_MULTISTRING_CURR, msgID), "public");
+	return getSingleString(concat(DMS_MSG_MULTISTRING_CURR, msgID).c_str(), "public");
 }
 int  SignalControllerNTCIP::getDMSMsgOwnerCurr(const char *msgID)
 {
 	//printf("\ngetDMSMsgOwner_Curr Function\n");
-	return getSingleINT(concat(DMS_MSG_OWNER_CURR, msgID), "public");
+	return getSingleINT(concat(DMS_MSG_OWNER_CURR, msgID).c_str(), "public");
 }
 int  SignalControllerNTCIP::getDMSMsgCRCCurr(const char *msgID)
 {
 	//printf("\ngetDMSMsgCRC_Curr Function\n");
-	return getSingleINT(concat(DMS_MSG_CRC_CURR, msgID), "public");
+	return getSingleINT(concat(DMS_MSG_CRC_CURR, msgID).c_str(), "public");
 }
 int  SignalControllerNTCIP::getDMSMsgRunTimePriorityCurr(const char *msgID)
 {
 	//printf("\ngetDMSMsgRunTimePriority_Curr Function\n");
-	return getSingleINT(concat(DMS_MSG_RUNTIMEPRIORITY_CURR, msgID), "public");
+	return getSingleINT(concat(DMS_MSG_RUNTIMEPRIORITY_CURR, msgID).c_str(), "public");
 }
 int  SignalControllerNTCIP::getDMSMsgStatusCurr(const char *msgID)
 {
 	//printf("\ngetDMSMsgStatus_Curr Function\n");
-	return getSingleINT(concat(DMS_MSG_STATUS_CURR, msgID), "public");
+	return getSingleINT(concat(DMS_MSG_STATUS_CURR, msgID).c_str(), "public");
 }
 
 
@@ -1061,14 +920,14 @@ int  SignalControllerNTCIP::getDMSMsgDisplayTimeRemaining()
 	return getSingleINT(DMS_MSG_DISPLAY_TIME_REMAINING, "public");
 }
 //int  SignalControllerNTCIP::getDMSMsgTableSource()
-char *  SignalControllerNTCIP::getDMSMsgTableSource()
+std::string SignalControllerNTCIP::getDMSMsgTableSource()
 {
 	printf("\ngetDMSMsgTableSource Function\n");
 	//return getSingleINT(DMS_MSG_TABLE_SOURCE, "public");
 	return getSingleString(DMS_MSG_TABLE_SOURCE, "public");
 }
 //int  SignalControllerNTCIP::getDMSMsgRequesterID()
-char *  SignalControllerNTCIP::getDMSMsgRequesterID()
+std::string SignalControllerNTCIP::getDMSMsgRequesterID()
 {
 	printf("\ngetDMSMsgRequesterID Function\n");
 	//return getSingleINT(DMS_MSG_REQUESTER_ID, "public");
@@ -1099,27 +958,37 @@ int  SignalControllerNTCIP::getDMSMsgMultiSyntaxError()
 void  SignalControllerNTCIP::setDMSControlMode(const char *Value)
 {
 	//printf("\n setDMSControlMode Function\n");
-	setSNMP(DMS_CONTROL_MODE, "public", Value);
+	netsnmp_pdu *response = setSNMP(DMS_CONTROL_MODE, "public", Value);
+	if (response)
+		snmp_free_pdu(response);
 }
 void SignalControllerNTCIP::setDMSMsgStatus(const char *Value, const char * MsgID)
 {
 	//printf("\n setDMSMsgStatus Function\n");
-	setSNMP(concat(DMS_MSG_STATUS, MsgID), "public", Value);
+	netsnmp_pdu *response = setSNMP(concat(DMS_MSG_STATUS, MsgID).c_str(), "public", Value);
+	if (response)
+		snmp_free_pdu(response);
 }
 void SignalControllerNTCIP::setDMSMsgMultiString(const char *Msg, const char *MsgID)
 {
 	//printf("\n setDMSMsgMultiString Function\n");
-	setSNMPText(concat(DMS_MSG_MULTISTRING, MsgID), "public", Msg);
+	netsnmp_pdu *response = setSNMPText(concat(DMS_MSG_MULTISTRING, MsgID).c_str(), "public", Msg);
+	if (response)
+		snmp_free_pdu(response);
 }
 void SignalControllerNTCIP::setDMSMsgOwner(const char *Owner, const char *MsgID)
 {
 	//printf("\n setDMSMsgOwner Function\n");
-	setSNMPText(concat(DMS_MSG_OWNER, MsgID), "public", Owner);
+	netsnmp_pdu *response = setSNMPText(concat(DMS_MSG_OWNER, MsgID).c_str(), "public", Owner);
+	if (response)
+		snmp_free_pdu(response);
 }
 
 void SignalControllerNTCIP::setDMSMsgRunTimePriority(const char *Priority, const char *MsgID)
 {
-	setSNMP(concat(DMS_MSG_RUNTIMEPRIORITY, MsgID), "public", Priority);
+	netsnmp_pdu *response = setSNMP(concat(DMS_MSG_RUNTIMEPRIORITY, MsgID).c_str(), "public", Priority);
+	if (response)
+		snmp_free_pdu(response);
 	//printf("\n setDMSMsgRunTimePriority Function\n");
 }
 
@@ -1139,45 +1008,14 @@ bool SignalControllerNTCIP::setDMSMsgActivate(const char *ActivationString)
 
 netsnmp_pdu*  SignalControllerNTCIP::setSNMPTCP(const char* setOID, const char *community, const char *Value)
 {
-	netsnmp_session session, *ss;
 	netsnmp_pdu *pdu;
 	netsnmp_pdu *response;
 
 	oid anOID[MAX_OID_LEN];
 	size_t anOID_len;
 
-	//netsnmp_variable_list *vars;
-	int status;
-
-	snmp_sess_init(&session); //Initialize a "session" that defines who we're going to talk to
-	/* set up defaults */
-	char ipwithport[64];
-	strcpy(ipwithport, "tcp:");
-	strcpy(ipwithport, INTip);
-	strcat(ipwithport, ":");
-	strcat(ipwithport, INTport);
-	session.peername = strdup(ipwithport);
-	session.version = SNMP_VERSION_1;
-
-	/* set the SNMPv1 community name used for authentication */
-	//session.community = (u_char *) "public";
-	session.community = (u_char *)community;
-	session.community_len = strlen((const char *) session.community);
-
-	SOCK_STARTUP;
-	ss = snmp_open(&session); /* establish the session */
-
-	if (!ss)
-	{
-		snmp_sess_perror("ASC", &session);
-		SOCK_CLEANUP;
-		// TODO: add failure
-		return response;
-	}
-
 	/*
 	 * Create the PDU for the data for our request.
-	 *   1) We're going to GET the system.sysDescr.0 node.
 	 */
 	pdu = snmp_pdu_create(SNMP_MSG_SET);
 	anOID_len = MAX_OID_LEN;
@@ -1187,114 +1025,36 @@ netsnmp_pdu*  SignalControllerNTCIP::setSNMPTCP(const char* setOID, const char *
 	{
 		printf("Error parse OID failed\n");
 		snmp_perror(ENABLE_SPAT);
-		SOCK_CLEANUP;
-		return response;
+		snmp_free_pdu(pdu);
+		return NULL;
 	}
 	//snmp_add_var(pdu, anOID, anOID_len, 'i', "6");
 	snmp_add_var(pdu, anOID, anOID_len, 'i', Value);
 
 	/*
-	 * Send the Request out.
+	 * Send the Request out on the shared session.
 	 */
-	status = snmp_synch_response(ss, pdu, &response);
+	response = getSNMP(pdu, community);
 
 	/*
 	 * Process the response.
 	 */
-	if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR)
-	{
-		/*
-		 * SUCCESS: Print the result variables
-		 */
-		//int *out = new int[MAX_ITEMS];
-		//int i = 0;
-//		for (vars = response->variables; vars; vars = vars->next_variable)
-//			print_variable(vars->name, vars->name_length, vars);
-/*
-		// manipuate the information ourselves
-		for (vars = response->variables; vars; vars = vars->next_variable) {
-			if (vars->type == ASN_OCTET_STR) {
-				char *sp = (char *) malloc(1 + vars->val_len);
-				memcpy(sp, vars->val.string, vars->val_len);
-				sp[vars->val_len] = '\0';
-				//printf("value #%d is a string: %s\n", count++, sp);
-				free(sp);
-			} else {
-
-				int *aa;
-				aa = (int *) vars->val.integer;
-				out[i++] = *aa;
-				//printf("value #%d is NOT a string! Ack!. Value = %d \n", count++,*aa);
-			}l
-		}
-
-		// ----------get the current timing plan----------------//
-		CurTimingPlan = out[0];
-		*/
-	}
-	else
-	{
-		if (status == STAT_SUCCESS)
-			fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
-		else if (status == STAT_TIMEOUT)
-			fprintf(stderr, "Timeout: No response from %s.\n",session.peername);
-		else
-			snmp_sess_perror("signalControllerSNMP", ss);
-	}
-
-	/*
-	 * Clean up:    *  1) free the response.   *  2) close the session.
-	 */
-	if (response)
-		snmp_free_pdu(response);
-
-	snmp_close(ss);
-
-	SOCK_CLEANUP;
+	if (response && response->errstat != SNMP_ERR_NOERROR)
+		fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
 
 	return response;
 }
 
 netsnmp_pdu*  SignalControllerNTCIP::setSNMP(const char* setOID, const char *community, const char *Value)
 {
-	netsnmp_session session, *ss;
 	netsnmp_pdu *pdu;
 	netsnmp_pdu *response;
 
 	oid anOID[MAX_OID_LEN];
 	size_t anOID_len;
 
-	//netsnmp_variable_list *vars;
-	int status;
-
-	snmp_sess_init(&session); //Initialize a "session" that defines who we're going to talk to
-	/* set up defaults */
-	char ipwithport[64];
-	strcpy(ipwithport, INTip);
-	strcat(ipwithport, ":");
-	strcat(ipwithport, INTport);
-	session.peername = strdup(ipwithport);
-	session.version = SNMP_VERSION_1;
-
-	/* set the SNMPv1 community name used for authentication */
-	//session.community = (u_char *) "public";
-	session.community = (u_char *)community;
-	session.community_len = strlen((const char *) session.community);
-
-	SOCK_STARTUP;
-	ss = snmp_open(&session); /* establish the session */
-
-	if (!ss)
-	{
-		snmp_sess_perror("ASC", &session);
-		SOCK_CLEANUP;
-		// TODO: add failure
-		return response;
-	}
-
 	/*
 	 * Create the PDU for the data for our request.
-	 *   1) We're going to GET the system.sysDescr.0 node.
 	 */
 	pdu = snmp_pdu_create(SNMP_MSG_SET);
 	anOID_len = MAX_OID_LEN;
@@ -1304,77 +1064,28 @@ netsnmp_pdu*  SignalControllerNTCIP::setSNMP(const char* setOID, const char *com
 	{
 		printf("Error parse OID failed\n");
 		snmp_perror(ENABLE_SPAT);
-		SOCK_CLEANUP;
-		return response;
+		snmp_free_pdu(pdu);
+		return NULL;
 	}
 	//snmp_add_var(pdu, anOID, anOID_len, 'i', "6");
 	snmp_add_var(pdu, anOID, anOID_len, 'i', Value);
 
 	/*
-	 * Send the Request out.
+	 * Send the Request out on the shared session.
 	 */
-	status = snmp_synch_response(ss, pdu, &response);
+	response = getSNMP(pdu, community);
 
 	/*
 	 * Process the response.
 	 */
-	if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR)
-	{
-		/*
-		 * SUCCESS: Print the result variables
-		 */
-		//int *out = new int[MAX_ITEMS];
-		//int i = 0;
-//		for (vars = response->variables; vars; vars = vars->next_variable)
-//			print_variable(vars->name, vars->name_length, vars);
-/*
-		// manipuate the information ourselves
-		for (vars = response->variables; vars; vars = vars->next_variable) {
-			if (vars->type == ASN_OCTET_STR) {
-				char *sp = (char *) malloc(1 + vars->val_len);
-				memcpy(sp, vars->val.string, vars->val_len);
-				sp[vars->val_len] = '\0';
-				//printf("value #%d is a string: %s\n", count++, sp);
-				free(sp);
-			} else {
-
-				int *aa;
-				aa = (int *) vars->val.integer;
-				out[i++] = *aa;
-				//printf("value #%d is NOT a string! Ack!. Value = %d \n", count++,*aa);
-			}l
-		}
-
-		// ----------get the current timing plan----------------//
-		CurTimingPlan = out[0];
-		*/
-	}
-	else
-	{
-		if (status == STAT_SUCCESS)
-			fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
-		else if (status == STAT_TIMEOUT)
-			fprintf(stderr, "Timeout: No response from %s.\n",session.peername);
-		else
-			snmp_sess_perror("signalControllerSNMP", ss);
-	}
-
-	/*
-	 * Clean up:    *  1) free the response.   *  2) close the session.
-	 */
-	if (response)
-		snmp_free_pdu(response);
-
-	snmp_close(ss);
-
-	SOCK_CLEANUP;
+	if (response && response->errstat != SNMP_ERR_NOERROR)
+		fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
 
 	return response;
 }
 
 netsnmp_pdu*  SignalControllerNTCIP::setSNMPInt(const char* setOID, const char *community, const char *Value)
 {
-	netsnmp_session session, *ss;
 	netsnmp_pdu *pdu;
 	netsnmp_pdu *response;
 
@@ -1382,36 +1093,9 @@ netsnmp_pdu*  SignalControllerNTCIP::setSNMPInt(const char* setOID, const char *
 	size_t anOID_len;
 
 	netsnmp_variable_list *vars;
-	int status;
-
-	snmp_sess_init(&session); //Initialize a "session" that defines who we're going to talk to
-	/* set up defaults */
-	char ipwithport[64];
-	strcpy(ipwithport, INTip);
-	strcat(ipwithport, ":");
-	strcat(ipwithport, INTport);
-	session.peername = strdup(ipwithport);
-	session.version = SNMP_VERSION_1;
-
-	/* set the SNMPv1 community name used for authentication */
-	//session.community = (u_char *) "public";
-	session.community = (u_char *)community;
-	session.community_len = strlen((const char *) session.community);
-
-	SOCK_STARTUP;
-	ss = snmp_open(&session); /* establish the session */
-
-	if (!ss)
-	{
-		snmp_sess_perror("ASC", &session);
-		SOCK_CLEANUP;
-		// TODO: add failure
-		return response;
-	}
 
 	/*
 	 * Create the PDU for the data for our request.
-	 *   1) We're going to GET the system.sysDescr.0 node.
 	 */
 	pdu = snmp_pdu_create(SNMP_MSG_SET);
 	anOID_len = MAX_OID_LEN;
@@ -1423,29 +1107,27 @@ netsnmp_pdu*  SignalControllerNTCIP::setSNMPInt(const char* setOID, const char *
 		//Check with greg if we need to set the variable in the next commented line
 		//based on the object we are trying to set its value
 		//snmp_perror(ENABLE_SPAT);
-		SOCK_CLEANUP;
-		return response;
+		snmp_free_pdu(pdu);
+		return NULL;
 	}
 	//snmp_add_var(pdu, anOID, anOID_len, 'i', "6");
 	snmp_add_var(pdu, anOID, anOID_len, 'i', Value);
 
 	/*
-	 * Send the Request out.
+	 * Send the Request out on the shared session.
 	 */
-	status = snmp_synch_response(ss, pdu, &response);
+	response = getSNMP(pdu, community);
 
 	/*
 	 * Process the response.
 	 */
 
-	if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR)
+	if (response && response->errstat == SNMP_ERR_NOERROR)
 	{
 		printf("SetSNMPInt Function - OID: %s   \nCommunity: %s   \nValue: %s", setOID, community, Value);
 		/*
 		 * SUCCESS: Print the result variables
 		 */
-		int *out = new int[MAX_ITEMS];
-		int i = 0;
 		int count = 0;
 
 		for (vars = response->variables; vars; vars = vars->next_variable)
@@ -1464,89 +1146,30 @@ netsnmp_pdu*  SignalControllerNTCIP::setSNMPInt(const char* setOID, const char *
 			}
 			else if (vars->type == ASN_INTEGER)
 			{
-				int *aa;
-				aa = (int *) vars->val.integer;
-				out[i++] = *aa;
-				//printf("value #%d is NOT a string! Ack!. Value = %d \n", count++,*aa);
+				// ----------get the current timing plan----------------//
+				CurTimingPlan = (int) *vars->val.integer;
+				break;
 			}
 		}
-
-		// ----------get the current timing plan----------------//
-		CurTimingPlan = out[0];
-
 	}
-	else
+	else if (response)
 	{
-		if (status == STAT_SUCCESS)
-			fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
-		else if (status == STAT_TIMEOUT)
-			fprintf(stderr, "Timeout: No response from %s.\n",session.peername);
-		else
-			snmp_sess_perror("signalControllerSNMP", ss);
+		fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
 	}
 
-	/*
-	 * Clean up:    *  1) free the response.   *  2) close the session.
-	 */
-	if (response)
-		snmp_free_pdu(response);
-
-	snmp_close(ss);
-
-	SOCK_CLEANUP;
-
 	return response;
 }
 
 netsnmp_pdu*  SignalControllerNTCIP::setSNMPText(const char* getOID, const char *community, const char *Value)
 {
-	netsnmp_session session, *ss;
 	netsnmp_pdu *pdu;
 	netsnmp_pdu *response;
 
 	oid anOID[MAX_OID_LEN];
 	size_t anOID_len;
 
-	//netsnmp_variable_list *vars;
-	int status;
-
-	snmp_sess_init(&session); //Initialize a "session" that defines who we're going to talk to
-
-	/* set up defaults */
-	char ipwithport[64];
-
-	//Original code to add ip address and port to the peername
-	//strcpy(ipwithport, INTip);
-	//strcat(ipwithport, ":");
-	//strcat(ipwithport, INTport);
-
-	//Modified code for adding ip address and port by adding the transport as tcp
-	//strcpy(ipwithport, "tcp:");
-	strcpy(ipwithport, INTip);
-	strcat(ipwithport, ":");
-	strcat(ipwithport, INTport);
-	session.peername = strdup(ipwithport);
-	session.version = SNMP_VERSION_1;
-
-	/* set the SNMPv1 community name used for authentication */
-	//session.community = (u_char *) "public";
-	session.community = (u_char *)community;
-	session.community_len = strlen((const char *) session.community);
-
-	SOCK_STARTUP;
-	ss = snmp_open(&session); /* establish the session */
-
-	if (!ss)
-	{
-		snmp_sess_perror("ASC", &session);
-		SOCK_CLEANUP;
-		// TODO: add failure
-		return response;
-	}
-
 	/*
 	 * Create the PDU for the data for our request.
-	 *   1) We're going to GET the system.sysDescr.0 node.
 	 */
 	pdu = snmp_pdu_create(SNMP_MSG_SET);
 	anOID_len = MAX_OID_LEN;
@@ -1556,70 +1179,22 @@ netsnmp_pdu*  SignalControllerNTCIP::setSNMPText(const char* getOID, const char
 	{
 		printf("Error parse failed\n");
 		snmp_perror(ENABLE_SPAT);
-		SOCK_CLEANUP;
-		return response;
+		snmp_free_pdu(pdu);
+		return NULL;
 	}
 	//snmp_add_var(pdu, anOID, anOID_len, 'i', "6");
 	snmp_add_var(pdu, anOID, anOID_len, 's', Value);
 
 	/*
-	 * Send the Request out.
+	 * Send the Request out on the shared session.
 	 */
-	status = snmp_synch_response(ss, pdu, &response);
+	response = getSNMP(pdu, community);
 
 	/*
 	 * Process the response.
 	 */
-	if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR)
-	{
-		/*
-		 * SUCCESS: Print the result variables
-		 */
-		//int *out = new int[MAX_ITEMS];
-		//int i = 0;
-//		for (vars = response->variables; vars; vars = vars->next_variable)
-//			print_variable(vars->name, vars->name_length, vars);
-/*
-		// manipuate the information ourselves
-		for (vars = response->variables; vars; vars = vars->next_variable) {
-			if (vars->type == ASN_OCTET_STR) {
-				char *sp = (char *) malloc(1 + vars->val_len);
-				memcpy(sp, vars->val.string, vars->val_len);
-				sp[vars->val_len] = '\0';
-				//printf("value #%d is a string: %s\n", count++, sp);
-				free(sp);
-			} else {
-
-				int *aa;
-				aa = (int *) vars->val.integer;
-				out[i++] = *aa;
-				//printf("value #%d is NOT a string! Ack!. Value = %d \n", count++,*aa);
-			}l
-		}
-
-		// ----------get the current timing plan----------------//
-		CurTimingPlan = out[0];
-		*/
-	}
-	else
-	{
-		if (status == STAT_SUCCESS)
-			fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
-		else if (status == STAT_TIMEOUT)
-			fprintf(stderr, "Timeout: No response from %s.\n",session.peername);
-		else
-			snmp_sess_perror("signalControllerSNMP", ss);
-	}
-
-	/*
-	 * Clean up:    *  1) free the response.   *  2) close the session.
-	 */
-	if (response)
-		snmp_free_pdu(response);
-
-	snmp_close(ss);
-
-	SOCK_CLEANUP;
+	if (response && response->errstat != SNMP_ERR_NOERROR)
+		fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
 
 	return response;
 }
@@ -1628,53 +1203,16 @@ netsnmp_pdu*  SignalControllerNTCIP::setSNMPText(const char* getOID, const char
 bool SignalControllerNTCIP::setSNMPActivateMsg(const char* getOID, const char *community, const char * ActivationString)
 {
 	bool isSuccess = false;
-	netsnmp_session session, *ss;
 	netsnmp_pdu *pdu;
 	netsnmp_pdu *response;
 
 	oid anOID[MAX_OID_LEN];
 	size_t anOID_len;
-	//int j = 0;
 
 	netsnmp_variable_list *vars;
-	int status;
-
-	snmp_sess_init(&session); //Initialize a "session" that defines who we're going to talk to
-
-	/* set up defaults */
-	char ipwithport[64];
-
-	//Original code to add ip address and port to the peername
-	//strcpy(ipwithport, INTip);
-	//strcat(ipwithport, ":");
-	//strcat(ipwithport, INTport);
-
-	//Modified code for adding ip address and port by adding the transport as tcp
-	//strcpy(ipwithport, "tcp:");
-	strcpy(ipwithport, INTip);
-	strcat(ipwithport, ":");
-	strcat(ipwithport, INTport);
-	session.peername = strdup(ipwithport);
-	session.version = SNMP_VERSION_1;
-
-	/* set the SNMPv1 community name used for authentication */
-	//session.community = (u_char *) "public";
-	session.community = (u_char *)community;
-	session.community_len = strlen((const char *) session.community);
-
-	SOCK_STARTUP;
-	ss = snmp_open(&session); /* establish the session */
-
-	if (!ss)
-	{
-		snmp_sess_perror("ASC", &session);
-		SOCK_CLEANUP;
-		return false;
-	}
 
 	/*
 	 * Create the PDU for the data for our request.
-	 *   1) We're going to GET the system.sysDescr.0 node.
 	 */
 	pdu = snmp_pdu_create(SNMP_MSG_SET);
 	anOID_len = MAX_OID_LEN;
@@ -1684,78 +1222,40 @@ bool SignalControllerNTCIP::setSNMPActivateMsg(const char* getOID, const char *c
 	{
 		printf("Error parse failed\n");
 		snmp_perror(ENABLE_SPAT);
-		SOCK_CLEANUP;
+		snmp_free_pdu(pdu);
 		return false;
 	}
-	//snmp_add_var(pdu, anOID, anOID_len, 'i', "6");
 	//char* SignActivationInfo="FFFFFF030001057B12345678";
 
 	//snmp_add_var(pdu, anOID, anOID_len, 'x', "FFFFFF030001057B12345678");
 	snmp_add_var(pdu, anOID, anOID_len, 'x', ActivationString);
 
 	//snmp_add_var(pdu, anOID, anOID_len, 'x', "FF FF FF 03 00 01 53 54 12 34 56 78");
-	status = snmp_synch_response(ss, pdu, &response);
+	response = getSNMP(pdu, community);
 
 	/*
 	 * Process the response.
 	 */
-	if (status == STAT_SUCCESS && response->errstat == SNMP_ERR_NOERROR)
+	if (response && response->errstat == SNMP_ERR_NOERROR)
 	{
 		isSuccess = true;
 
 		/*
 		 * SUCCESS: Print the result variables
 		 */
-		int *out = new int[MAX_ITEMS];
-		int i = 0;
 		for (vars = response->variables; vars; vars = vars->next_variable)
 			print_variable(vars->name, vars->name_length, vars);
-
-		// manipuate the information ourselves
-		for (vars = response->variables; vars; vars = vars->next_variable)
-		{
-			if (vars->type == ASN_OCTET_STR)
-			{
-				char *sp = (char *) malloc(1 + vars->val_len);
-				memcpy(sp, vars->val.string, vars->val_len);
-				sp[vars->val_len] = '\0';
-				//printf("value #%d is a string: %s\n", count++, sp);
-				free(sp);
-				//j++;
-			}
-			else
-			{
-
-				int *aa;
-				aa = (int *) vars->val.integer;
-				out[i++] = *aa;
-				//printf("value #%d is NOT a string! Ack!. Value = %d \n", count++,*aa);
-			}
-		}
-
-		// ----------get the current timing plan----------------//
-		//CurTimingPlan = out[0];
-
 	}
-	else
+	else if (response)
 	{
-		if (status == STAT_SUCCESS)
-			fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
-		else if (status == STAT_TIMEOUT)
-			fprintf(stderr, "Timeout: No response from %s.\n",session.peername);
-		else
-			snmp_sess_perror("signalControllerSNMP", ss);
+		fprintf(stderr, "Error in packet\nReason: %s\n",snmp_errstring(response->errstat));
 	}
 
 	/*
-	 * Clean up:    *  1) free the response.   *  2) close the session.
+	 * Clean up:    *  1) free the response.
 	 */
 	if (response)
 		snmp_free_pdu(response);
 
-	snmp_close(ss);
-
-	SOCK_CLEANUP;
-
 	return isSuccess;
 }
@@ -17,8 +17,12 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 
+#include <map>
+#include <vector>
+
 #include <net-snmp/net-snmp-config.h>
 #include <net-snmp/net-snmp-includes.h>
+#include <NtcipClient.h>
 
 using namespace std;
 
@@ -708,14 +712,14 @@ public:
 
 	int  getDMSMsgMemoryType();
     int  getDMSMsgNumber();
-	char *  getDMSMsgMultiString();
+	std::string getDMSMsgMultiString();
 	int  getDMSMsgOwner();
 	int  getDMSMsgCRC();
 	int  getDMSMsgRunTimePriority();
 	int  getDMSMsgStatus(const char *msgID);
 
 	int  getDMSMsgMemoryTypeCurr(const char *msgID);
-	char *  getDMSMsgMultiStringCurr(const char *msgID);
+	std::string getDMSMsgMultiStringCurr(const char *msgID);
     int  getDMSMsgNumberCurr(const char *msgID);
 	int  getDMSMsgOwnerCurr(const char *msgID);
 	int  getDMSMsgCRCCurr(const char *msgID);
@@ -727,8 +731,8 @@ public:
 	int  getDMSMsgDisplayTimeRemaining();
 	//int  getDMSMsgTableSource();
 	//int  getDMSMsgRequesterID();
-	char *  getDMSMsgTableSource();
-	char *  getDMSMsgRequesterID();
+	std::string getDMSMsgTableSource();
+	std::string getDMSMsgRequesterID();
 	int  getDMSMsgSourceMode();
 	int  getDMSMsgActivateError();
 	int  getDMSMsgActivateErrorCode();
@@ -749,9 +753,14 @@ public:
 	int  getDMSMsgPriority();
 
 private:
-	char* INTip;
-	char* INTport;
+	char* INTip = NULL;
+	char* INTport = NULL;
+
+	// Sessions to the controller on the shared NTCIP client, by community
+	std::map<std::string, tmx::utils::NtcipClient::DeviceId> _devices;
 
+	tmx::utils::NtcipClient::DeviceId getDevice(const char *community);
+	void closeDevices();
 
 	void sendSpatPush(int command);
 	netsnmp_pdu* getSNMP(netsnmp_pdu *pdu, const char *community);
@@ -759,7 +768,7 @@ private:
 
 	netsnmp_pdu* singleGetSNMP(const char* getOID, const char *community);
 	int  getSingleINT(const char* getOID, const char *community);
-	char * getSingleString(const char* getOID, const char *community);
+	std::string getSingleString(const char* getOID, const char *community);
 	int  getOctetString(const char* getOID, const char *community);
 
 	netsnmp_pdu* setSNMPTCP(const char* getOID, const char *community, const char *Value);
@@ -17,6 +17,7 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include "UdpClient.h"
+#include <tmx/utils/HexCodec.h>
 
 
 using namespace boost::property_tree;
@@ -287,9 +288,20 @@ void DsrcMessageManagerPlugin::SendMessageToRadio(IvpMessage *msg)
 		SetStatus<int>(msg->subtype, msgCount);
 	}
 
-	// Convert the payload to upper case.
-	for (int i = 0; i < (int)(strlen(msg->payload->valuestring)); i++)
-		msg->payload->valuestring[i] = toupper(msg->payload->valuestring[i]);
+	// The payload is forwarded as a hex string in upper case.  It is converted once into a buffer
+	// that is reused for every message, instead of building a typed message.
+	if (msg->payloadBytes)
+	{
+		_payload.resize(2 * msg->payloadLength);
+		hexCodec_encode(msg->payloadBytes, msg->payloadLength, &_payload[0]);
+	}
+	else
+	{
+		_payload.assign((msg->payload && msg->payload->type == cJSON_String) ? msg->payload->valuestring : "");
+	}
+
+	for (size_t i = 0; i < _payload.size(); i++)
+		_payload[i] = toupper((unsigned char)_payload[i]);
 
 
 	//loop through all MessageConfig and send to each with the proper TmxType
@@ -302,19 +314,21 @@ void DsrcMessageManagerPlugin::SendMessageToRadio(IvpMessage *msg)
 			// Format the message using the protocol defined in the
 			// USDOT ROadside Unit Specifications Document v 4.0 Appendix C.
 
-			stringstream os;
+			// The message is built in a buffer that is reused, so it only allocates when it grows.
+			string &message = _message;
+			message.clear();
 
-			os << "Version=0.7" << "\n";
-			os << "Type=" << _messageConfigMap[configIndex].SendType << "\n" << "PSID=" << _messageConfigMap[configIndex].Psid << "\n";
+			message.append("Version=0.7").append("\n");
+			message.append("Type=").append(_messageConfigMap[configIndex].SendType).append("\n");
+			message.append("PSID=").append(_messageConfigMap[configIndex].Psid).append("\n");
+			message.append("Priority=7").append("\n").append("TxMode=CONT").append("\n").append("TxChannel=");
 			if (_messageConfigMap[configIndex].Channel.empty())
-				os << "Priority=7" << "\n" << "TxMode=CONT" << "\n" << "TxChannel=" << msg->dsrcMetadata->channel << "\n";
+				message.append(::to_string(msg->dsrcMetadata->channel)).append("\n");
 			else
-				os << "Priority=7" << "\n" << "TxMode=CONT" << "\n" << "TxChannel=" << _messageConfigMap[configIndex].Channel << "\n";
-			os << "TxInterval=0" << "\n" << "DeliveryStart=\n" << "DeliveryStop=\n";
-			os << "Signature= "<< _signature << "\n" << "Encryption=False\n";
-			os << "Payload=" << msg->payload->valuestring << "\n";
-
-			string message = os.str();
+				message.append(_messageConfigMap[configIndex].Channel).append("\n");
+			message.append("TxInterval=0").append("\n").append("DeliveryStart=\n").append("DeliveryStop=\n");
+			message.append("Signature= ").append(_signature).append("\n").append("Encryption=False\n");
+			message.append("Payload=").append(_payload).append("\n");
 
 			// Send the message using the configured UDP client.
 
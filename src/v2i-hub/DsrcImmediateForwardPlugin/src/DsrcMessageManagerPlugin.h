@@ -56,6 +56,10 @@ private:
 	std::map<std::string, int> _messageCountMap;
 	std::string _signature;
 
+	// Buffers for the message sent to the radio, which are reused for every message.
+	std::string _payload;
+	std::string _message;
+
 	// Thread safe bool set to true the first time the configuration has been read.
 	std::atomic<bool> _configRead;
 
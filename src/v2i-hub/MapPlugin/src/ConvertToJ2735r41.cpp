@@ -1,3 +1,4 @@
+#include <atomic>
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -15,7 +16,8 @@
 
 namespace MapPlugin {
 
-volatile int gMapMessageCount = 0;
+// Map files are compiled on several threads at once
+std::atomic<unsigned int> gMapMessageCount(0);
 
 tmx::byte_stream encBytes;
 
@@ -26,6 +28,10 @@ ConvertToJ2735r41::ConvertToJ2735r41() {
 	derEncodedByteCount = 0;
 }
 
+int ConvertToJ2735r41::NextMessageRevision() {
+	return gMapMessageCount++ % 128;
+}
+
 ConvertToJ2735r41::~ConvertToJ2735r41() {
 
 }
@@ -440,9 +446,7 @@ int ConvertToJ2735r41::convertMap(map *mapMessage) {
 
 	encodedByteCount = 0;
 	// Counter for message that is issued
-	MapJ2735->msgIssueRevision = gMapMessageCount++;
-	if (gMapMessageCount > 127)
-		gMapMessageCount = 0;
+	MapJ2735->msgIssueRevision = NextMessageRevision();
 
 	if (mapMessage->mapType == roadway) {
 		convertRoadwayMap(MapJ2735, mapMessage);
@@ -22,6 +22,12 @@ public:
 	unsigned char encoded[4000];
 
 	int convertMap(map *mapMessage);
+
+	/**
+	 * @return The next issue revision for a converted MAP, which counts from 0 to 127 and
+	 * is shared by all of the converters.
+	 */
+	static int NextMessageRevision();
 	bool decodePerMapData(MapData* map, char* messageBuf, int bytes);
 private:
 	void addLaneType(GenericLane *lane, BIT_STRING_t *choice, LaneTypeAttributes_PR laneType, uint16_t attributes);
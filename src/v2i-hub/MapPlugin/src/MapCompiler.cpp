@@ -0,0 +1,381 @@
+/*
+ * MapCompiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "MapCompiler.h"
+
+#include <atomic>
+#include <dirent.h>
+#include <errno.h>
+#include <set>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utime.h>
+
+#include <tmx/tmx.h>
+#include <tmx/j2735_messages/J2735MessageFactory.hpp>
+#include <PluginLog.h>
+
+#include "XmlMapParser.h"
+#include "ConvertToJ2735r41.h"
+#include "inputs/isd/ISDToJ2735r41.h"
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+namespace MapPlugin {
+
+// Changes whenever the output of the compiler changes, so older cache entries are not used
+#define MAP_COMPILER_VERSION "2"
+
+// The age of a cache entry that is not in use before it is removed, in seconds
+#define MAP_COMPILER_CACHE_EXPIRE (7 * 24 * 60 * 60)
+
+// Each XmlMapParser initializes and terminates Xerces, which is not thread safe
+static mutex xercesLock;
+
+static void DestroyParser(XmlMapParser *parser)
+{
+	lock_guard<mutex> lock(xercesLock);
+	delete parser;
+}
+
+static XmlMapParser *CreateParser()
+{
+	lock_guard<mutex> lock(xercesLock);
+	return new XmlMapParser();
+}
+
+// Give an encoded MAP the next issue revision, as if it had just been converted
+static string NextRevision(const string &bytes)
+{
+	MapDataEncodedMessage encMap;
+	encMap.set_data(byte_stream_decode(bytes));
+
+	MapDataMessage mapMsg = encMap.get_payload<MapDataMessage>();
+	std::shared_ptr<MapDataMessage::message_type> data = mapMsg.get_j2735_data();
+	data->msgIssueRevision = ConvertToJ2735r41::NextMessageRevision();
+
+	MapDataMessage revised(data);
+	MapDataEncodedMessage revisedEnc;
+	revisedEnc.encode_j2735_message(revised);
+	return revisedEnc.get_payload_str();
+}
+
+static bool MakeDirectories(const string &path)
+{
+	for (size_t pos = 1; pos != string::npos; pos++)
+	{
+		pos = path.find('/', pos);
+		string dir = path.substr(0, pos);
+		if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+			return false;
+
+		if (pos == string::npos)
+			break;
+	}
+
+	return true;
+}
+
+MapCompiler::MapCompiler(string cacheDirectory): _cacheDirectory(cacheDirectory)
+{
+}
+
+string MapCompiler::get_CacheDirectory() const
+{
+	return _cacheDirectory;
+}
+
+void MapCompiler::set_CacheDirectory(string cacheDirectory)
+{
+	_cacheDirectory = cacheDirectory;
+}
+
+string MapCompiler::InputTypeOf(const string &filePath)
+{
+	if (filePath.size() >= 5 && filePath.substr(filePath.size() - 5) == ".json")
+		return "ISD";
+	else if (filePath.size() >= 4 && filePath.substr(filePath.size() - 4) == ".txt")
+		return "TXT";
+	else
+		return "XML";
+}
+
+size_t MapCompiler::Compile(vector<Job> &jobs, unsigned int threads)
+{
+	if (jobs.empty())
+		return 0;
+
+	if (threads == 0)
+		threads = std::max(1u, thread::hardware_concurrency());
+	if (threads > jobs.size())
+		threads = jobs.size();
+
+	if (!_cacheDirectory.empty() && !MakeDirectories(_cacheDirectory))
+	{
+		PLOG(logWARNING) << "Unable to create map cache directory " << _cacheDirectory << ": " << strerror(errno);
+	}
+
+	// Each worker takes the next job that has not been started
+	atomic<size_t> next {0};
+	auto work = [this, &jobs, &next]()
+	{
+		for (size_t i = next++; i < jobs.size(); i = next++)
+			CompileJob(jobs[i]);
+	};
+
+	vector<thread> workers;
+	for (unsigned int i = 1; i < threads; i++)
+		workers.emplace_back(work);
+
+	work();
+
+	for (thread &worker : workers)
+		worker.join();
+
+	if (!_cacheDirectory.empty())
+		PruneCache(jobs);
+
+	size_t failed = 0;
+	for (Job &job : jobs)
+	{
+		if (job.bytes.empty())
+			failed++;
+	}
+
+	return failed;
+}
+
+void MapCompiler::CompileJob(Job &job)
+{
+	try
+	{
+		string inputType = job.inputType.empty() ? InputTypeOf(job.filePath) : job.inputType;
+
+		string &cachePath = job.cachePath;
+		if (!_cacheDirectory.empty())
+		{
+			ifstream in(job.filePath, ios::binary);
+			stringstream contents;
+			contents << in.rdbuf();
+
+			struct stat st;
+			if (in && stat(job.filePath.c_str(), &st) == 0)
+				cachePath = CachePath(contents.str(), st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec, inputType);
+		}
+
+		if (!cachePath.empty())
+		{
+			ifstream cached(cachePath);
+			if (cached && getline(cached, job.bytes) && !job.bytes.empty())
+			{
+				// The second line says whether the revision came from the counter
+				string revised;
+				if (getline(cached, revised) && revised == "revised")
+					job.bytes = NextRevision(job.bytes);
+
+				job.fromCache = true;
+				PLOG(logDEBUG) << job.filePath << " loaded from " << cachePath;
+
+				// Keep the entry from expiring while it is in use
+				utime(cachePath.c_str(), NULL);
+				return;
+			}
+		}
+
+		bool revised = false;
+		job.bytes = CompileFile(job.filePath, inputType, &revised);
+
+		if (!cachePath.empty())
+		{
+			// Write the entry under a temporary name first, so a partial entry is never read
+			string tempPath = cachePath + ".tmp" + to_string(::getpid()) + "_" +
+					to_string(hash<thread::id>()(this_thread::get_id()));
+			{
+				ofstream out(tempPath, ios::trunc);
+				out << job.bytes << endl;
+				if (revised)
+					out << "revised" << endl;
+			}
+
+			if (rename(tempPath.c_str(), cachePath.c_str()) != 0)
+			{
+				PLOG(logWARNING) << "Unable to write map cache " << cachePath << ": " << strerror(errno);
+				unlink(tempPath.c_str());
+			}
+		}
+	}
+	catch (exception &ex)
+	{
+		job.bytes.clear();
+		job.error = ex.what();
+	}
+}
+
+void MapCompiler::PruneCache(const vector<Job> &jobs)
+{
+	set<string> used;
+	for (const Job &job : jobs)
+		used.insert(job.cachePath);
+
+	DIR *dir = opendir(_cacheDirectory.c_str());
+	if (dir == NULL)
+		return;
+
+	time_t now = time(NULL);
+	while (struct dirent *entry = readdir(dir))
+	{
+		string name(entry->d_name);
+		if (name.size() < 4 || name.substr(name.size() - 4) != ".map")
+			continue;
+
+		string path = _cacheDirectory + "/" + name;
+		struct stat st;
+		if (used.count(path) || stat(path.c_str(), &st) != 0 || now - st.st_mtime < MAP_COMPILER_CACHE_EXPIRE)
+			continue;
+
+		PLOG(logDEBUG) << "Removing unused map cache entry " << path;
+		unlink(path.c_str());
+	}
+
+	closedir(dir);
+}
+
+string MapCompiler::CachePath(const string &contents, long long mtime, const string &inputType) const
+{
+	// 64-bit FNV-1a over everything that determines the output
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	auto add = [&hash](const string &s)
+	{
+		for (unsigned char c : s)
+		{
+			hash ^= c;
+			hash *= 0x100000001b3ULL;
+		}
+		hash ^= 0xff;
+		hash *= 0x100000001b3ULL;
+	};
+
+	add(MAP_COMPILER_VERSION);
+	add(to_string(SAEJ2735_SPEC));
+	add(inputType);
+	add(contents);
+
+	ostringstream path;
+	path << _cacheDirectory << "/" << hex << setw(16) << setfill('0') << hash << "-" << dec << mtime << ".map";
+	return path.str();
+}
+
+string MapCompiler::CompileFile(const string &filePath, string inputType, bool *revised)
+{
+	string fn = filePath;
+	string bytes;
+
+	if (revised)
+		*revised = false;
+
+	if (inputType.empty())
+		inputType = InputTypeOf(fn);
+
+	if (inputType == "ISD")
+	{
+		ISDToJ2735r41 converter(fn);
+		MapDataMessage msg = converter.to_message();
+		MapDataEncodedMessage encMap;
+		encMap.initialize(msg);
+
+		bytes = encMap.get_payload_str();
+
+		PLOG(logINFO) << fn << " ISD file encoded as " << bytes;
+	}
+	else if (inputType == "TXT")
+	{
+		ifstream in(fn);
+		string line;
+
+		if (!std::getline(in, line))
+			throw runtime_error("Unable to read " + fn);
+
+		byte_stream encoded = byte_stream_decode(line);
+
+		PLOG(logINFO) << fn << " MAP encoded bytes are " << encoded;
+		MapDataEncodedMessage encMap;
+		encMap.set_data(encoded);
+
+		MapDataMessage mapMsg = encMap.get_payload<MapDataMessage>();
+		PLOG(logDEBUG) << "Map is " << mapMsg;
+		bytes = encMap.get_payload_str();
+		PLOG(logINFO) << fn << " J2735 message bytes encoded as " << bytes;
+	}
+	else if (inputType == "XML")
+	{
+		tmx::message_container_type container;
+		container.load<XML>(fn);
+
+		if (container.get_storage().get_tree().begin()->first == "MapData")
+		{
+			MapDataMessage mapMsg;
+			mapMsg.set_contents(container.get_storage().get_tree());
+
+			PLOG(logDEBUG) << "Encoding " << mapMsg;
+			MapDataEncodedMessage mapEnc;
+			mapEnc.encode_j2735_message(mapMsg);
+			bytes = mapEnc.get_payload_str();
+
+			PLOG(logINFO) << fn << " XML file encoded as " << bytes;
+		}
+		else
+		{
+			ConvertToJ2735r41 mapConverter;
+			unique_ptr<XmlMapParser, void (*)(XmlMapParser *)> mapParser(CreateParser(), &DestroyParser);
+			map theMap;
+
+			if (!mapParser->ReadGidFile(fn, &theMap))
+				throw runtime_error("Unable to read GID file " + fn);
+
+			mapConverter.convertMap(&theMap);
+
+			PLOG(logDEBUG) << "Encoded Bytes:" << mapConverter.encodedByteCount;
+
+			if (mapConverter.encodedByteCount <= 0)
+				throw runtime_error("Unable to encode GID file " + fn);
+
+			byte_stream encoded(mapConverter.encodedByteCount);
+			memcpy(encoded.data(), mapConverter.encoded, mapConverter.encodedByteCount);
+
+			J2735MessageFactory factory;
+			unique_ptr<TmxJ2735EncodedMessageBase> mapEnc(factory.NewMessage(encoded));
+			if (!mapEnc)
+				throw runtime_error("Unable to decode the MAP from GID file " + fn + ": " + factory.get_event().what());
+
+			bytes = mapEnc->get_payload_str();
+			if (revised)
+				*revised = true;
+
+			PLOG(logINFO) << fn << " input file encoded as " << bytes;
+		}
+	}
+	else
+	{
+		throw runtime_error("Unknown input type " + inputType + " for " + fn);
+	}
+
+	return bytes;
+}
+
+} /* namespace MapPlugin */
@@ -0,0 +1,86 @@
+/*
+ * MapCompiler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef MAPCOMPILER_H_
+#define MAPCOMPILER_H_
+
+#include <string>
+#include <vector>
+
+namespace MapPlugin {
+
+/**
+ * Compiles map files (ISD JSON, MAP or GID XML, or a text file of encoded bytes) into the
+ * hex string of the UPER encoded J2735 MAP.
+ *
+ * Several files are compiled at once, each on its own worker thread.  The results are kept in
+ * a cache directory, keyed by a hash of the contents of the file and its modification time, so
+ * a file that has not changed is not parsed or encoded again on a restart or a reload of the
+ * configuration.  A GID file gets the next issue revision each time it is compiled, so a GID file
+ * that is taken from the cache is given a new revision.
+ */
+class MapCompiler
+{
+public:
+	struct Job
+	{
+		std::string filePath;
+		/// ISD, XML or TXT, or empty to go by the file extension.  This is left as given.
+		std::string inputType;
+
+		/// The hex string of the encoded MAP, or empty if the file could not be compiled
+		std::string bytes;
+		std::string error;
+		bool fromCache = false;
+		/// The cache entry for the file, or empty if the cache is not used
+		std::string cachePath;
+	};
+
+	/**
+	 * @param cacheDirectory The directory for compiled files, which is created if needed.
+	 * An empty directory turns off the cache.
+	 */
+	MapCompiler(std::string cacheDirectory = "");
+
+	std::string get_CacheDirectory() const;
+	void set_CacheDirectory(std::string cacheDirectory);
+
+	/**
+	 * Compile all of the jobs, filling in the bytes or the error of each one.  Cache entries
+	 * that were not used by any of the jobs and have not been used for a week are removed.
+	 *
+	 * @param threads The most files to compile at once, or 0 for one per CPU.
+	 * @return The number of jobs that failed.
+	 */
+	size_t Compile(std::vector<Job> &jobs, unsigned int threads = 0);
+
+	/**
+	 * Compile a single file, without the cache.
+	 *
+	 * @param revised If given, set to true if the issue revision of the MAP was taken from the
+	 * revision counter instead of from the file
+	 * @return The hex string of the encoded MAP.
+	 * @throws std::exception If the file could not be read or encoded.
+	 */
+	static std::string CompileFile(const std::string &filePath, std::string inputType, bool *revised = NULL);
+
+	/**
+	 * @return The input type of a file by its extension.
+	 */
+	static std::string InputTypeOf(const std::string &filePath);
+
+private:
+	void CompileJob(Job &job);
+	void PruneCache(const std::vector<Job> &jobs);
+	std::string CachePath(const std::string &contents, long long mtime, const std::string &inputType) const;
+
+	std::string _cacheDirectory;
+};
+
+} /* namespace MapPlugin */
+
+#endif /* MAPCOMPILER_H_ */
@@ -1,9 +1,11 @@
 
 #include <atomic>
+#include <chrono>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <sstream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -18,11 +20,10 @@
 #include <tmx/messages/IvpSignalControllerStatus.h>
 #include <tmx/messages/IvpJ2735.h>
 #include <tmx/j2735_messages/J2735MessageFactory.hpp>
-#include "XmlMapParser.h"
-#include "ConvertToJ2735r41.h"
-#include "inputs/isd/ISDToJ2735r41.h"
+#include "MapCompiler.h"
 
 #define USE_STD_CHRONO
+#include <DeadlineTimer.h>
 #include <FrequencyThrottle.h>
 #include <PluginClient.h>
 
@@ -47,6 +48,7 @@ public:
 	virtual ~MapFile() {}
 
 	std_attribute(this->msg, int, Action, -1, );
+	std_attribute(this->msg, int, IntersectionId, 0, );
 	std_attribute(this->msg, std::string, FilePath, "", );
 	std_attribute(this->msg, std::string, InputType, "", );
 	std_attribute(this->msg, std::string, Bytes, "", );
@@ -68,6 +70,16 @@ public:
 
 volatile int gMessageCount = 0;
 
+/**
+ * The MAP of one intersection for its active action, serialized once and then only
+ * re-stamped for each transmission.
+ */
+struct MapFrame {
+	int intersectionId;
+	int action;
+	std::unique_ptr<IvpMsgFrame, void (*)(IvpMsgFrame *)> frame {nullptr, &ivp_destroyMsgFrame};
+};
+
 class MapPlugin: public PluginClient {
 public:
 	MapPlugin(string name);
@@ -82,19 +94,26 @@ protected:
 	void OnMessageReceived(IvpMessage *msg);
 	void OnStateChange(IvpPluginState state);
 private:
-	std::atomic<int> _mapAction {-1};
 	std::atomic<bool> _isMapFileNew {false};
+	std::atomic<bool> _isFrameStale {false};
 	std::atomic<bool> _cohdaR63 {false};
+	std::atomic<int> _frequency {1000};
 
-	std::map<int, MapFile> _mapFiles;
+	// The map files of each intersection by action, and the active action of each intersection
+	std::map<int, std::map<int, MapFile> > _mapFiles;
+	std::map<int, int> _mapActions;
+	std::string _cacheDirectory;
 	std::mutex data_lock;
 
+	// Only used by the main thread
+	MapCompiler _compiler;
+
 	J2735MessageFactory factory;
 
-	FrequencyThrottle<int> throttle;
 	FrequencyThrottle<int> errThrottle;
 
 	bool LoadMapFiles();
+	bool BuildFrames(std::vector<MapFrame> &frames);
 	void DebugPrintMapFiles();
 };
 
@@ -112,7 +131,10 @@ MapPlugin::~MapPlugin() {
 void MapPlugin::UpdateConfigSettings() {
 	int gFrequency;
 	GetConfigValue("Frequency", gFrequency);
-	throttle.set_Frequency(chrono::milliseconds(gFrequency));
+	if (gFrequency > 0)
+		_frequency = gFrequency;
+
+	GetConfigValue<string>("Cache_Directory", _cacheDirectory, &data_lock);
 
 	message_tree_type rawMapFiles;
 	GetConfigValue("MAP_Files", rawMapFiles);
@@ -133,24 +155,37 @@ void MapPlugin::UpdateConfigSettings() {
 				if (mapFile.get_Action() < 0)
 					continue;
 
-				_mapFiles[mapFile.get_Action()] = mapFile;
+				_mapFiles[mapFile.get_IntersectionId()][mapFile.get_Action()] = mapFile;
 				_isMapFileNew = true;
 			}
 
-			// Check to see if the active map was lost
-			if (!_mapFiles.count(_mapAction))
+			// Forget the intersections that are no longer configured
+			for (auto it = _mapActions.begin(); it != _mapActions.end(); )
 			{
-				if (_mapAction > 0)
-				{
-					PLOG(logINFO) << "New configuration does not contain a map for active action " <<
-							_mapAction << ". Using default action.";
-				}
-				_mapAction = -1;
+				if (_mapFiles.count(it->first))
+					it++;
+				else
+					it = _mapActions.erase(it);
 			}
 
-			if (_mapFiles.size() > 0 && _mapAction < 0)
-				_mapAction = _mapFiles.begin()->first;
+			for (auto &intersection : _mapFiles)
+			{
+				int &action = _mapActions.emplace(intersection.first, -1).first->second;
+
+				// Check to see if the active map was lost
+				if (!intersection.second.count(action))
+				{
+					if (action > 0)
+					{
+						PLOG(logINFO) << "New configuration does not contain a map for active action " <<
+								action << ". Using default action.";
+					}
+					action = -1;
+				}
 
+				if (action < 0)
+					action = intersection.second.begin()->first;
+			}
 		}
 		catch (exception &ex)
 		{
@@ -168,7 +203,7 @@ void MapPlugin::OnConfigChanged(const char *key, const char *value) {
 	if (_plugin->state == IvpPluginState_registered)
 	{
 		// Check for special case Cohda R63 messages
-		if (strcmp("Cohda R63", key))
+		if (strcmp("Cohda R63", key) == 0)
 		{
 			string strValue(value);
 
@@ -183,6 +218,8 @@ void MapPlugin::OnConfigChanged(const char *key, const char *value) {
 			{
 				_cohdaR63 = false;
 			}
+
+			_isFrameStale = true;
 		}
 		else
 		{
@@ -207,20 +244,27 @@ void MapPlugin::OnMessageReceived(IvpMessage *msg) {
 			&& (msg->payload->type == cJSON_String)) {
 		int action = ivpSigCont_getIvpSignalControllerAction(msg);
 
-		if (action != _mapAction)
+		// The action applies to every intersection with a map for it
+		lock_guard<mutex> lock(data_lock);
+		bool found = false;
+		for (auto &intersection : _mapFiles)
 		{
-			// Ignore if there is no map for this action
-			lock_guard<mutex> lock(data_lock);
-			if (_mapFiles.count(action) <= 0)
+			if (intersection.second.count(action) <= 0)
+				continue;
+
+			found = true;
+			int &active = _mapActions[intersection.first];
+			if (active != action)
 			{
-				if (errThrottle.Monitor(action))
-				{
-					PLOG(logERROR) << "Missing map for Action " << action;
-				}
-				return;
+				active = action;
+				_isFrameStale = true;
 			}
+		}
 
-			_isMapFileNew = _mapAction.exchange(action) != action;
+		// Ignore if there is no map for this action
+		if (!found && errThrottle.Monitor(action))
+		{
+			PLOG(logERROR) << "Missing map for Action " << action;
 		}
 	}
 }
@@ -230,203 +274,203 @@ int MapPlugin::Main() {
 
 	bool mapFilesOk = false;
 
-	std::unique_ptr<MapDataEncodedMessage> msg;
-	int activeAction = -1;
+	std::vector<MapFrame> frames;
+	size_t slot = 0;
+
+	// Each intersection is sent in its own slot of the period, so the MAPs are spread out
+	// over the period instead of sent in one burst.  The deadlines are absolute, so the
+	// time taken to send does not accumulate as error.
+	chrono::nanoseconds period(0);
+	DeadlineTimer transmitTimer { chrono::milliseconds(_frequency.load()) };
 
 	while (_plugin->state != IvpPluginState_error) {
 		if (_isMapFileNew) {
-			msg.reset();
-			activeAction = -1;
+			_isMapFileNew = false;
+			_isFrameStale = false;
 
 			mapFilesOk = LoadMapFiles();
-			_isMapFileNew = false;
+			frames.clear();
+			if (mapFilesOk)
+				BuildFrames(frames);
+			slot = 0;
+		}
+		else if (_isFrameStale) {
+			// Only the action or the options changed, so the maps are already encoded
+			_isFrameStale = false;
+
+			frames.clear();
+			if (mapFilesOk)
+				BuildFrames(frames);
+			slot = 0;
 		}
 
-		int temp = _mapAction;
-		if (temp < 0)
+		if (frames.empty())
 		{
-			// No action set yet, so just wait
+			// No maps to send yet, so just wait
 			sleep(1);
 			continue;
 		}
 
-		// Action has changed, so retrieve the correct map
-		if (temp != activeAction)
+		chrono::nanoseconds slotPeriod = chrono::nanoseconds(chrono::milliseconds(_frequency)) / frames.size();
+		if (slotPeriod != period)
 		{
-			lock_guard<mutex> lock(data_lock);
-			string byteStr = _mapFiles[temp].get_Bytes();
-			if (!byteStr.empty())
-			{
-				msg.reset(dynamic_cast<MapDataEncodedMessage *>(factory.NewMessage(api::MSGSUBTYPE_MAPDATA_STRING)));
-				if (!msg)
-				{	if (errThrottle.Monitor(temp))
-					{
-						PLOG(logERROR) << "Unable to create map from bytes " << byteStr << ": " << factory.get_event();
-					}
-					sleep(1);
-					continue;
-				}
+			period = slotPeriod;
+			transmitTimer.set_Period(period);
+			transmitTimer.Reset();
+		}
+
+		transmitTimer.WaitForNextDeadline();
+
+		// Time to send a new message, which only needs a new timestamp
+		if (slot >= frames.size())
+			slot = 0;
+		BroadcastFrame(frames[slot].frame.get());
+		slot++;
+	}
+
+	return (EXIT_SUCCESS);
+}
 
-				string enc = msg->get_encoding();
-				msg->refresh_timestamp();
-				msg->set_payload(byteStr);
-				msg->set_encoding(enc);
-				msg->set_flags(IvpMsgFlags_RouteDSRC);
-				msg->addDsrcMetadata(172, 0x8002);
+bool MapPlugin::BuildFrames(std::vector<MapFrame> &frames)
+{
+	lock_guard<mutex> lock(data_lock);
 
-				activeAction = temp;
-				PLOG(logINFO) << "Map for action " << activeAction << " will be sent";
+	for (auto &intersection : _mapFiles)
+	{
+		int action = _mapActions[intersection.first];
+		auto mapFile = intersection.second.find(action);
+		if (mapFile == intersection.second.end())
+			continue;
+
+		string byteStr = mapFile->second.get_Bytes();
+		if (byteStr.empty())
+			continue;
+
+		std::unique_ptr<MapDataEncodedMessage> msg(dynamic_cast<MapDataEncodedMessage *>(factory.NewMessage(api::MSGSUBTYPE_MAPDATA_STRING)));
+		if (!msg)
+		{	if (errThrottle.Monitor(action))
+			{
+				PLOG(logERROR) << "Unable to create map from bytes " << byteStr << ": " << factory.get_event();
 			}
+			continue;
 		}
 
-		if (mapFilesOk && throttle.Monitor(0))
+		string enc = msg->get_encoding();
+		msg->refresh_timestamp();
+		msg->set_payload(byteStr);
+		msg->set_encoding(enc);
+		msg->set_flags(IvpMsgFlags_RouteDSRC);
+		msg->addDsrcMetadata(172, 0x8002);
+
+		if (_cohdaR63)
 		{
-			// Time to send a new message
-			routeable_message *rMsg = dynamic_cast<routeable_message *>(msg.get());
-			if (_cohdaR63)
-			{
-				auto bytes = rMsg->get_payload_bytes();
-				rMsg->set_payload_bytes(bytes); // TODO: Translate to R63 bytes
-			}
+			auto bytes = msg->get_payload_bytes();
+			msg->set_payload_bytes(bytes); // TODO: Translate to R63 bytes
+		}
 
-			if (rMsg) {
-				rMsg->refresh_timestamp();
-				BroadcastMessage(*rMsg);
-			}
+		IvpMessage *ivpMsg = msg->get_message();
+		MapFrame frame;
+		frame.intersectionId = intersection.first;
+		frame.action = action;
+		frame.frame.reset(ivp_createMsgFrame(ivpMsg));
+		ivpMsg_destroy(ivpMsg);
+
+		if (!frame.frame)
+		{
+			PLOG(logERROR) << "Unable to build the frame for the map of action " << action;
+			continue;
 		}
 
-		// Wake up a few times before next cycle, in case there is something to do
-		usleep(1000 * throttle.get_Frequency().count() / 5);
+		PLOG(logINFO) << "Map for intersection " << frame.intersectionId << " action " << frame.action << " will be sent";
+		frames.push_back(std::move(frame));
 	}
 
-	return (EXIT_SUCCESS);
+	return !frames.empty();
 }
 
 bool MapPlugin::LoadMapFiles()
 {
-	if (_mapFiles.empty())
-		return false;
+	vector<MapCompiler::Job> jobs;
 
-	lock_guard<mutex> lock(data_lock);
-	for (auto &mapPair : _mapFiles)
 	{
-		MapFile &mapFile = mapPair.second;
-		if (mapFile.get_Bytes() == "")
+		lock_guard<mutex> lock(data_lock);
+		if (_mapFiles.empty())
+			return false;
+
+		_compiler.set_CacheDirectory(_cacheDirectory);
+
+		// Compile each file that has not been encoded yet, once even if several actions use it
+		set<pair<string, string> > files;
+		for (auto &intersection : _mapFiles)
 		{
-			// Fill in the bytes for each map file
-			string inType = mapFile.get_InputType();
-			if (inType.empty())
+			for (auto &mapPair : intersection.second)
 			{
-				try
+				MapFile &mapFile = mapPair.second;
+				if (mapFile.get_Bytes() == "" &&
+					files.emplace(mapFile.get_FilePath(), mapFile.get_InputType()).second)
 				{
-					string fn = mapFile.get_FilePath();
-
-					if (fn.substr(fn.size() - 5) == ".json")
-						inType = "ISD";
-					else if (fn.substr(fn.size() - 4) == ".txt")
-						inType = "TXT";
-					else
-						inType = "XML";
-
-					if (inType == "ISD")
-					{
-						ISDToJ2735r41 converter(fn);
-																MapDataMessage msg = converter.to_message();
-						MapDataEncodedMessage encMap;
-						encMap.initialize(msg);
-
-						mapFile.set_Bytes(encMap.get_payload_str());
+					MapCompiler::Job job;
+					job.filePath = mapFile.get_FilePath();
+					job.inputType = mapFile.get_InputType();
+					jobs.push_back(job);
+				}
+			}
+		}
+	}
 
+	if (jobs.empty())
+		return true;
 
-						PLOG(logINFO) << fn << " ISD file encoded as " << mapFile.get_Bytes();
-					}
-					else if (inType == "TXT")
-					{
-						ifstream in(fn);
-						string line;
+	// The files are parsed and encoded in parallel without holding the lock
+	auto start = chrono::steady_clock::now();
+	size_t failed = _compiler.Compile(jobs);
+	auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
 
-						std::getline(in, line);
-						byte_stream bytes = byte_stream_decode(line);
+	size_t fromCache = 0;
+	for (auto &job : jobs)
+	{
+		if (job.fromCache)
+			fromCache++;
+		if (!job.error.empty())
+			PLOG(logERROR) << "Unable to convert " << job.filePath << ": " << job.error;
+	}
 
-						PLOG(logINFO) << fn << " MAP encoded bytes are " << bytes;
-						MapDataEncodedMessage encMap;
-						encMap.set_data(bytes);
+	PLOG(logINFO) << "Compiled " << jobs.size() << " map files in " << elapsed.count() << " ms, "
+			<< fromCache << " from the cache";
 
-						MapDataMessage mapMsg = encMap.get_payload<MapDataMessage>();
-						PLOG(logDEBUG) << "Map is " << mapMsg;
-						mapFile.set_Bytes(encMap.get_payload_str());
-						PLOG(logINFO) << fn << " J2735 message bytes encoded as " << mapFile.get_Bytes();
-					}
+	lock_guard<mutex> lock(data_lock);
+	for (auto &intersection : _mapFiles)
+	{
+		for (auto &mapPair : intersection.second)
+		{
+			MapFile &mapFile = mapPair.second;
+			if (mapFile.get_Bytes() != "")
+				continue;
 
-					else if (inType == "XML")
-					{
-						tmx::message_container_type container;
-						container.load<XML>(fn);
-
-						if (container.get_storage().get_tree().begin()->first == "MapData")
-						{
-							MapDataMessage mapMsg;
-							mapMsg.set_contents(container.get_storage().get_tree());
-
-							PLOG(logDEBUG) << "Encoding " << mapMsg;
-							MapDataEncodedMessage mapEnc;
-							mapEnc.encode_j2735_message(mapMsg);
-							mapFile.set_Bytes(mapEnc.get_payload_str());
-
-							PLOG(logINFO) << fn << " XML file encoded as " << mapFile.get_Bytes();
-						}
-						else
-						{
-							ConvertToJ2735r41 mapConverter;
-							XmlMapParser mapParser;
-							map theMap;
-
-							if (mapParser.ReadGidFile(fn, &theMap))
-							{
-								mapConverter.convertMap(&theMap);
-
-								PLOG(logDEBUG) << "Encoded Bytes:" << mapConverter.encodedByteCount;
-
-								if (mapConverter.encodedByteCount > 0)
-								{
-									byte_stream bytes(mapConverter.encodedByteCount);
-									memcpy(bytes.data(), mapConverter.encoded, mapConverter.encodedByteCount);
-
-									auto *mapEnc = factory.NewMessage(bytes);
-									if (!mapEnc)
-										return false;
-
-									mapFile.set_Bytes(mapEnc->get_payload_str());
-
-									PLOG(logINFO) << fn << " input file encoded as " << mapEnc->get_payload_str();
-								}
-								else
-								{
-									return false;
-								}
-							}
-						}
-					}
-				}
-				catch (exception &ex)
+			for (auto &job : jobs)
+			{
+				if (job.filePath == mapFile.get_FilePath() && job.inputType == mapFile.get_InputType() &&
+					!job.bytes.empty())
 				{
-					PLOG(logERROR) << "Unable to convert " << mapFile.get_FilePath() << ": " << ex.what();
-					return false;
+					mapFile.set_Bytes(job.bytes);
+					break;
 				}
 			}
 		}
 	}
 
-	return true;
+	return failed == 0;
 }
 
 void MapPlugin::DebugPrintMapFiles() {
-	PLOG(logDEBUG) << _mapFiles.size()
-			<< " map files specified by configuration settings:";
+	PLOG(logDEBUG) << "Map files for " << _mapFiles.size()
+			<< " intersections specified by configuration settings:";
 
-	for (auto iter = _mapFiles.begin(); iter != _mapFiles.end(); iter++) {
-		int key = iter->first;
-		PLOG(logDEBUG) << "-- Action " << key << " file is " << iter->second.get_FilePath();
+	for (auto &intersection : _mapFiles) {
+		for (auto iter = intersection.second.begin(); iter != intersection.second.end(); iter++) {
+			int key = iter->first;
+			PLOG(logDEBUG) << "-- Intersection " << intersection.first << " action " << key << " file is " << iter->second.get_FilePath();
+		}
 	}
 }
 
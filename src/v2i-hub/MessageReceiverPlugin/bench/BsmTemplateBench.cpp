@@ -0,0 +1,144 @@
+/*
+ * BsmTemplateBench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ *
+ * Measures how many abbreviated BSMs per second are turned into encoded BSMs, the way
+ * MessageReceiverPlugin did it with DecodedBsmMessage, BsmConverter and the ASN.1 encoder, and
+ * with the BsmTemplateEncoder, for a simulation of many vehicles.  Every BSM from the template
+ * encoder is checked to be the same as the one from the full encoder.
+ *
+ * Usage: BsmTemplateBench [vehicles] [updates per vehicle]
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdlib.h>
+#include <vector>
+
+#include <tmx/j2735_messages/J2735MessageFactory.hpp>
+#include <BsmConverter.h>
+#include <DecodedBsmMessage.h>
+
+#include "../src/BsmTemplateEncoder.h"
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+using namespace MessageReceiver;
+
+// The values of an abbreviated BSM packet, as they are sent
+struct AbbreviatedBsm
+{
+	uint32_t vehicleId;
+	uint32_t heading;
+	uint32_t speed;
+	uint32_t latitude;
+	uint32_t longitude;
+	uint32_t elevation;
+};
+
+// The same conversions as MessageReceiverPlugin
+static void Convert(const AbbreviatedBsm &abbr, double &heading, double &speed, double &latitude,
+		double &longitude, double &elevation)
+{
+	heading = (float)(abbr.heading / 1000000.0);
+	speed = (double)(abbr.speed / 1000.0);
+	latitude = (double)(abbr.latitude / 1000000.0 - 180);
+	longitude = (double)(abbr.longitude / 1000000.0 - 180);
+	elevation = (float)(abbr.elevation / 1000.0 - 500);
+}
+
+static byte_stream FullEncode(const AbbreviatedBsm &abbr)
+{
+	double heading, speed, latitude, longitude, elevation;
+	Convert(abbr, heading, speed, latitude, longitude, elevation);
+
+	DecodedBsmMessage decodedBsm;
+	decodedBsm.set_TemporaryId(abbr.vehicleId);
+	decodedBsm.set_Heading(heading);
+	decodedBsm.set_IsHeadingValid(true);
+	decodedBsm.set_Speed_mps(speed);
+	decodedBsm.set_IsSpeedValid(true);
+	decodedBsm.set_Latitude(latitude);
+	decodedBsm.set_Longitude(longitude);
+	decodedBsm.set_IsLocationValid(true);
+	decodedBsm.set_Elevation_m(elevation);
+	decodedBsm.set_IsElevationValid(true);
+
+	BasicSafetyMessage *bsm = (BasicSafetyMessage *)calloc(1, sizeof(BasicSafetyMessage));
+	BsmConverter::ToBasicSafetyMessage(decodedBsm, *bsm);
+
+	// Note that this constructor assumes control of cleaning up the J2735 structure pointer
+	BsmMessage bsmMsg(bsm);
+	BsmEncodedMessage encodedBsm;
+	encodedBsm.initialize(bsmMsg);
+	return encodedBsm.get_payload_bytes();
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t vehicles = argc > 1 ? strtoul(argv[1], NULL, 0) : 2000;
+	uint32_t updates = argc > 2 ? strtoul(argv[2], NULL, 0) : 10;
+
+	// Vehicles driving around one area, each one moving a little with every update
+	mt19937 random(1);
+	uniform_int_distribution<uint32_t> offset(0, 20000);
+	vector<AbbreviatedBsm> packets;
+
+	for (uint32_t u = 0; u < updates; u++)
+	{
+		for (uint32_t v = 0; v < vehicles; v++)
+		{
+			AbbreviatedBsm abbr;
+			abbr.vehicleId = 1000 + v;
+			abbr.heading = random() % 360000000;
+			abbr.speed = random() % 40000;
+			abbr.latitude = (uint32_t)((38.95 + 180) * 1000000) + offset(random);
+			abbr.longitude = (uint32_t)((-77.15 + 180) * 1000000) + offset(random);
+			abbr.elevation = (uint32_t)((100 + 500) * 1000) + random() % 10000;
+			packets.push_back(abbr);
+		}
+	}
+
+	BsmTemplateEncoder encoder;
+	byte_stream bytes;
+	uint64_t mismatches = 0;
+	uint64_t fallbacks = 0;
+	double heading, speed, latitude, longitude, elevation;
+
+	auto start = chrono::steady_clock::now();
+	for (const AbbreviatedBsm &abbr : packets)
+		bytes = FullEncode(abbr);
+	double fullSec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	start = chrono::steady_clock::now();
+	for (const AbbreviatedBsm &abbr : packets)
+	{
+		Convert(abbr, heading, speed, latitude, longitude, elevation);
+		if (!encoder.Encode(abbr.vehicleId, heading, speed, latitude, longitude, elevation, bytes))
+			fallbacks++;
+	}
+	double templateSec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	// Check every BSM against the full encoder
+	for (const AbbreviatedBsm &abbr : packets)
+	{
+		Convert(abbr, heading, speed, latitude, longitude, elevation);
+		if (encoder.Encode(abbr.vehicleId, heading, speed, latitude, longitude, elevation, bytes) &&
+			bytes != FullEncode(abbr))
+			mismatches++;
+	}
+
+	cout << packets.size() << " BSMs from " << vehicles << " vehicles" << endl;
+	cout << left << setw(10) << "Encoder" << right << setw(14) << "BSM/s" << endl;
+	cout << left << setw(10) << "full" << right << fixed << setprecision(0) << setw(14) << packets.size() / fullSec << endl;
+	cout << left << setw(10) << "template" << right << setw(14) << packets.size() / templateSec << endl;
+	cout << mismatches << " mismatches, " << fallbacks << " encoded in full" << endl;
+
+	return mismatches == 0 && fallbacks == 0 ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/*
+ * IngestShardBench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ *
+ * Measures how many datagrams per second the UdpIngest receives and decodes with a growing number
+ * of shards.  Several blaster threads send encoded BSMs to the local port, each one from many
+ * sockets so that the kernel spreads them over the shards.  Each shard decodes every BSM, as the
+ * worker threads of the plugin would.  The datagrams the shards can not keep up with are lost in
+ * the socket buffers, so only the handled datagrams are counted.
+ *
+ * Usage: IngestShardBench [max shards] [seconds per run] [blaster threads] [port]
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <tmx/j2735_messages/J2735MessageFactory.hpp>
+#include <BsmConverter.h>
+#include <DecodedBsmMessage.h>
+
+#include "../src/UdpIngest.h"
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+using namespace MessageReceiver;
+
+// Sockets for each blaster thread
+#define SOURCES 16
+
+static byte_stream EncodeBsm()
+{
+	DecodedBsmMessage decodedBsm;
+	decodedBsm.set_TemporaryId(1234);
+	decodedBsm.set_Latitude(38.9548123);
+	decodedBsm.set_Longitude(-77.1481456);
+	decodedBsm.set_IsLocationValid(true);
+	decodedBsm.set_Speed_mps(12.34);
+	decodedBsm.set_IsSpeedValid(true);
+	decodedBsm.set_Heading(234.5);
+	decodedBsm.set_IsHeadingValid(true);
+
+	BasicSafetyMessage *bsm = (BasicSafetyMessage *)calloc(1, sizeof(BasicSafetyMessage));
+	BsmConverter::ToBasicSafetyMessage(decodedBsm, *bsm);
+
+	// Note that this constructor assumes control of cleaning up the J2735 structure pointer
+	BsmMessage bsmMsg(bsm);
+	BsmEncodedMessage encodedBsm;
+	encodedBsm.initialize(bsmMsg);
+	return encodedBsm.get_payload_bytes();
+}
+
+static void Blast(int port, const byte_stream &bytes, atomic<bool> &running)
+{
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	vector<int> sockets;
+	for (int i = 0; i < SOURCES; i++)
+	{
+		int s = socket(AF_INET, SOCK_DGRAM, 0);
+		if (s >= 0)
+			sockets.push_back(s);
+	}
+
+	for (size_t i = 0; running; i++)
+		sendto(sockets[i % sockets.size()], bytes.data(), bytes.size(), 0, (sockaddr *)&addr, sizeof(addr));
+
+	for (int s : sockets)
+		close(s);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t maxShards = argc > 1 ? strtoul(argv[1], NULL, 0) : thread::hardware_concurrency();
+	int seconds = argc > 2 ? atoi(argv[2]) : 3;
+	int blasters = argc > 3 ? atoi(argv[3]) : 2;
+	int port = argc > 4 ? atoi(argv[4]) : 26790;
+
+	byte_stream bsm = EncodeBsm();
+	cout << "Sending " << bsm.size() << " byte BSMs from " << blasters << " threads with "
+		 << SOURCES << " sockets each to port " << port << endl;
+	cout << left << setw(8) << "Shards" << right << setw(14) << "Received/s" << setw(14) << "Decoded/s"
+		 << setw(10) << "Errors" << endl;
+
+	for (size_t shards = 1; shards <= (maxShards ? maxShards : 1); shards *= 2)
+	{
+		atomic<uint64_t> decoded {0};
+		atomic<uint64_t> errors {0};
+
+		UdpIngest ingest;
+		ingest.Start("127.0.0.1", vector<int> { port }, shards,
+				[&](size_t shard, const byte_t *bytes, size_t size, uint64_t timestamp) {
+			try
+			{
+				MessageFrame *frame = TmxJ2735EncodedMessage<MessageFrameMessage>::decode_j2735_message<
+						codec::uper<MessageFrameMessage> >(byte_stream(bytes, bytes + size));
+				ASN_STRUCT_FREE(asn_DEF_MessageFrame, frame);
+				decoded.fetch_add(1, memory_order_relaxed);
+				return true;
+			}
+			catch (exception &)
+			{
+				errors.fetch_add(1, memory_order_relaxed);
+				return false;
+			}
+		});
+
+		atomic<bool> running {true};
+		vector<thread> threads;
+		for (int i = 0; i < blasters; i++)
+			threads.emplace_back(Blast, port, cref(bsm), ref(running));
+
+		// Skip the start up, then count the datagrams received in the run
+		this_thread::sleep_for(chrono::milliseconds(200));
+		uint64_t startReceived = 0;
+		for (size_t i = 0; i < ingest.NumShards(); i++)
+			startReceived += ingest.GetStatistics(i).datagrams;
+		uint64_t startDecoded = decoded;
+
+		auto start = chrono::steady_clock::now();
+		this_thread::sleep_for(chrono::seconds(seconds));
+		double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		uint64_t received = 0;
+		for (size_t i = 0; i < ingest.NumShards(); i++)
+			received += ingest.GetStatistics(i).datagrams;
+		uint64_t handled = decoded;
+
+		running = false;
+		for (thread &t : threads)
+			t.join();
+		ingest.Stop();
+
+		cout << left << setw(8) << shards << right << fixed << setprecision(0)
+			 << setw(14) << (received - startReceived) / sec << setw(14) << (handled - startDecoded) / sec
+			 << setw(10) << errors << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,230 @@
+/*
+ * BsmTemplateEncoder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "BsmTemplateEncoder.h"
+
+#include <string.h>
+
+#include <tmx/j2735_messages/J2735MessageFactory.hpp>
+#include <BsmConverter.h>
+#include <DecodedBsmMessage.h>
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+// Start over if there are more vehicles than this
+#define MAX_TEMPLATES 65536
+
+namespace MessageReceiver {
+
+/*
+ * The UPER layout of a message frame holding a BSM with only the core data:
+ *
+ *   extension bit (1), messageId (15), length of the BSM in bytes (8)
+ *   BSM: extension bit (1), partII present (1), regional present (1), coreData...
+ *
+ * Each core data field is a constrained integer, encoded as its offset from the lower bound.
+ */
+struct BitField
+{
+	uint32_t pos;
+	uint32_t bits;
+	int64_t min;
+};
+
+static constexpr size_t FRAME_LENGTH = 40;
+static constexpr size_t BSM_LENGTH = 37;
+
+static constexpr BitField ID_FIELD			{  34, 32, 0 };
+static constexpr BitField LAT_FIELD			{  82, 31, -900000000 };
+static constexpr BitField LONG_FIELD		{ 113, 32, -1799999999 };
+static constexpr BitField ELEV_FIELD		{ 145, 16, -4096 };
+static constexpr BitField SPEED_FIELD		{ 196, 13, 0 };
+static constexpr BitField HEADING_FIELD		{ 209, 15, 0 };
+
+static void WriteBits(uint8_t *data, const BitField &field, int64_t value)
+{
+	uint64_t bits = (uint64_t)(value - field.min);
+
+	for (uint32_t i = 0; i < field.bits; i++)
+	{
+		uint32_t pos = field.pos + i;
+		uint8_t mask = 0x80 >> (pos % 8);
+
+		if (bits & (1ULL << (field.bits - 1 - i)))
+			data[pos / 8] |= mask;
+		else
+			data[pos / 8] &= ~mask;
+	}
+}
+
+static int64_t ReadBits(const uint8_t *data, const BitField &field)
+{
+	uint64_t bits = 0;
+
+	for (uint32_t i = 0; i < field.bits; i++)
+	{
+		uint32_t pos = field.pos + i;
+		bits = (bits << 1) | ((data[pos / 8] >> (7 - pos % 8)) & 0x01);
+	}
+
+	return (int64_t)bits + field.min;
+}
+
+// The same conversion as BsmConverter, or false if the value is outside the range of the field
+static bool Convert(double value, double scale, double low, double high, int64_t &out)
+{
+	double scaled = value * scale;
+
+	// The conversion truncates towards zero
+	if (!(scaled > low - 1.0 && scaled < high + 1.0))
+		return false;
+
+	out = (int64_t)scaled;
+	return true;
+}
+
+BsmTemplateEncoder::BsmTemplateEncoder()
+{
+}
+
+bool BsmTemplateEncoder::Initialize()
+{
+#if SAEJ2735_SPEC < 63
+	return false;
+#else
+	// Encode one BSM the usual way, with values that show up if a field is misplaced
+	DecodedBsmMessage decoded;
+	decoded.set_TemporaryId(0x12345678);
+	decoded.set_Latitude(38.9548123);
+	decoded.set_IsLocationValid(true);
+	decoded.set_Longitude(-77.1481456);
+	decoded.set_Elevation_m(123.4);
+	decoded.set_IsElevationValid(true);
+	decoded.set_Speed_mps(12.34);
+	decoded.set_IsSpeedValid(true);
+	decoded.set_Heading(234.5);
+	decoded.set_IsHeadingValid(true);
+
+	BasicSafetyMessage *bsm = (BasicSafetyMessage *)calloc(1, sizeof(BasicSafetyMessage));
+	if (!bsm)
+		return false;
+
+	BsmConverter::ToBasicSafetyMessage(decoded, *bsm);
+
+	try
+	{
+		// Note that this constructor assumes control of cleaning up the J2735 structure pointer
+		BsmMessage bsmMsg(bsm);
+		BsmEncodedMessage encoded;
+		encoded.initialize(bsmMsg);
+		_base.bytes = encoded.get_payload_bytes();
+	}
+	catch (exception &ex)
+	{
+		PLOG(logWARNING) << "Unable to encode the BSM template: " << ex.what();
+		return false;
+	}
+
+	CoreData &data = _base.last;
+	if (!Convert(decoded.get_Latitude(), 10000000.0, -900000000, 900000001, data.lat) ||
+		!Convert(decoded.get_Longitude(), 10000000.0, -1799999999, 1800000001, data.lon) ||
+		!Convert(decoded.get_Elevation_m(), 10.0, -4096, 32767, data.elev) ||
+		!Convert(decoded.get_Speed_mps(), 50.0, 0, 8191, data.speed) ||
+		!Convert(decoded.get_Heading(), 80.0, 0, 28800, data.heading))
+		return false;
+
+	// The ID is copied into the octet string as it is in memory
+	uint32_t id = decoded.get_TemporaryId();
+	uint8_t idBytes[4];
+	memcpy(idBytes, &id, sizeof(id));
+	int64_t idBits = ((int64_t)idBytes[0] << 24) | (idBytes[1] << 16) | (idBytes[2] << 8) | idBytes[3];
+
+	const uint8_t *bytes = _base.bytes.data();
+	if (_base.bytes.size() != FRAME_LENGTH || bytes[2] != BSM_LENGTH ||
+		ReadBits(bytes, ID_FIELD) != idBits ||
+		ReadBits(bytes, LAT_FIELD) != data.lat ||
+		ReadBits(bytes, LONG_FIELD) != data.lon ||
+		ReadBits(bytes, ELEV_FIELD) != data.elev ||
+		ReadBits(bytes, SPEED_FIELD) != data.speed ||
+		ReadBits(bytes, HEADING_FIELD) != data.heading)
+	{
+		PLOG(logWARNING) << "The BSM layout is not as expected.  Abbreviated BSMs are encoded in full.";
+		return false;
+	}
+
+	return true;
+#endif
+}
+
+void BsmTemplateEncoder::Patch(byte_stream &bytes, const CoreData &data, const CoreData *last)
+{
+	uint8_t *ptr = bytes.data();
+
+	if (!last || data.lat != last->lat)
+		WriteBits(ptr, LAT_FIELD, data.lat);
+	if (!last || data.lon != last->lon)
+		WriteBits(ptr, LONG_FIELD, data.lon);
+	if (!last || data.elev != last->elev)
+		WriteBits(ptr, ELEV_FIELD, data.elev);
+	if (!last || data.speed != last->speed)
+		WriteBits(ptr, SPEED_FIELD, data.speed);
+	if (!last || data.heading != last->heading)
+		WriteBits(ptr, HEADING_FIELD, data.heading);
+}
+
+bool BsmTemplateEncoder::Encode(uint32_t temporaryId, double heading, double speed_mps, double latitude,
+		double longitude, double elevation_m, byte_stream &bytes)
+{
+	if (!_initialized)
+	{
+		_valid = Initialize();
+		_initialized = true;
+	}
+
+	if (!_valid)
+		return false;
+
+	CoreData data;
+	if (!Convert(latitude, 10000000.0, -900000000, 900000001, data.lat) ||
+		!Convert(longitude, 10000000.0, -1799999999, 1800000001, data.lon) ||
+		!Convert(elevation_m, 10.0, -4096, 32767, data.elev) ||
+		!Convert(speed_mps, 50.0, 0, 8191, data.speed) ||
+		!Convert(heading, 80.0, 0, 28800, data.heading))
+		return false;
+
+	auto found = _templates.find(temporaryId);
+	if (found == _templates.end())
+	{
+		if (_templates.size() >= MAX_TEMPLATES)
+			_templates.clear();
+
+		// A new vehicle starts from the base template, with its own ID
+		found = _templates.emplace(temporaryId, _base).first;
+
+		uint8_t idBytes[4];
+		memcpy(idBytes, &temporaryId, sizeof(temporaryId));
+		WriteBits(found->second.bytes.data(), ID_FIELD,
+				((int64_t)idBytes[0] << 24) | (idBytes[1] << 16) | (idBytes[2] << 8) | idBytes[3]);
+
+		Patch(found->second.bytes, data, NULL);
+	}
+	else
+	{
+		Patch(found->second.bytes, data, &found->second.last);
+	}
+
+	found->second.last = data;
+
+	bytes.assign(found->second.bytes.begin(), found->second.bytes.end());
+	return true;
+}
+
+} /* namespace MessageReceiver */
@@ -0,0 +1,76 @@
+/*
+ * BsmTemplateEncoder.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_BSMTEMPLATEENCODER_H_
+#define SRC_BSMTEMPLATEENCODER_H_
+
+#include <cstdint>
+#include <unordered_map>
+
+#include <tmx/messages/byte_stream.hpp>
+
+namespace MessageReceiver {
+
+/**
+ * A fast encoder for the BSMs built from abbreviated BSM packets.
+ *
+ * Those BSMs only carry the core data, so their UPER encoding in a message frame always has the
+ * same length, and each field of the core data is always at the same bit position.  Instead of
+ * filling in a new BasicSafetyMessage structure and running the ASN.1 encoder for every packet,
+ * the encoder keeps the encoded bytes of the last BSM for each temporary ID, and only writes the
+ * bits of the fields that changed.  The bytes are the same as the full encoder would produce.
+ *
+ * The field positions are checked against the ASN.1 encoder the first time.  If they do not match,
+ * for example with another J2735 specification, Encode() always returns false, and the BSM must
+ * be encoded the usual way.
+ *
+ * The encoder is not thread safe, so each thread needs its own.
+ */
+class BsmTemplateEncoder
+{
+public:
+	BsmTemplateEncoder();
+
+	/**
+	 * Encode a BSM frame with the values converted from an abbreviated BSM, in the same units
+	 * as DecodedBsmMessage.
+	 *
+	 * @param bytes The bytes to encode to, which are reused from the last call
+	 * @return False if the BSM could not be encoded this way, i.e. a value is out of range
+	 */
+	bool Encode(uint32_t temporaryId, double heading, double speed_mps, double latitude, double longitude,
+			double elevation_m, tmx::byte_stream &bytes);
+
+private:
+	// The core data fields that change, in J2735 units
+	struct CoreData
+	{
+		int64_t lat;
+		int64_t lon;
+		int64_t elev;
+		int64_t speed;
+		int64_t heading;
+	};
+
+	struct Template
+	{
+		CoreData last;
+		tmx::byte_stream bytes;
+	};
+
+	bool Initialize();
+	void Patch(tmx::byte_stream &bytes, const CoreData &data, const CoreData *last);
+
+	bool _initialized = false;
+	bool _valid = false;
+	Template _base;
+	std::unordered_map<uint32_t, Template> _templates;
+};
+
+} /* namespace MessageReceiver */
+
+#endif /* SRC_BSMTEMPLATEENCODER_H_ */
@@ -18,6 +18,10 @@
 #include <LocationMessage.h>
 #include <VehicleBasicMessage.h>
 
+#include <boost/algorithm/string.hpp>
+
+#include "BsmTemplateEncoder.h"
+
 #define ABBR_BSM 1000
 #define ABBR_SRM 2000
 #define ABBR_VBM 3000
@@ -39,7 +43,6 @@ FrequencyThrottle<int> errThrottle;
 FrequencyThrottle<int> statThrottle;
 
 static std::atomic<uint64_t> totalBytes {0};
-static std::map<std::string, std::atomic<uint32_t> > totalCount;
 
 MessageReceiverPlugin::MessageReceiverPlugin(std::string name): TmxMessageManager(name)
 {
@@ -63,6 +66,35 @@ TmxJ2735EncodedMessage<T> *encode(TmxJ2735EncodedMessage<T> &encMsg, T *msg) {
 	return &encMsg;
 }
 
+template <typename T>
+TmxJ2735EncodedMessage<T> *encode(TmxJ2735EncodedMessage<T> &encMsg, const byte_stream &bytes) {
+	encMsg.clear();
+
+	// The bytes are already encoded, so only the header is needed
+	encMsg.routeable_message::initialize(std::string(T::MessageType), std::string(T::MessageSubType));
+	encMsg.set_encoding(TmxJ2735EncodedMessage<T>::DefaultCodec);
+	encMsg.set_data(bytes);
+	return &encMsg;
+}
+
+// Support different encodings, by the first byte
+static const char *DetectEncoding(const byte_t *bytes, size_t size)
+{
+	if (size == 0)
+		return NULL;
+
+	switch (bytes[0]) {
+	case 0x00:
+		return api::ENCODING_ASN1_UPER_STRING;
+	case 0x30:
+		return api::ENCODING_ASN1_BER_STRING;
+	case '{':
+		return api::ENCODING_JSON_STRING;
+	default:
+		return api::ENCODING_BYTEARRAY_STRING;
+	}
+}
+
 BsmMessage *DecodeBsm(uint32_t vehicleId, uint32_t heading, uint32_t speed, uint32_t latitude,
 			   uint32_t longitude, uint32_t elevation, DecodedBsmMessage &decodedBsm)
 {
@@ -159,6 +191,10 @@ void MessageReceiverPlugin::OnMessageReceived(const routeable_message &msg)
 {
 	routeable_message copy { msg };
 
+	// The BSM templates of the vehicles seen by this thread
+	static thread_local BsmTemplateEncoder bsmEncoder;
+	static thread_local byte_stream bsmBytes;
+
 	DecodedBsmMessage decodedBsm;
 	BsmEncodedMessage encodedBsm;
 	SrmEncodedMessage encodedSrm;
@@ -215,33 +251,45 @@ void MessageReceiverPlugin::OnMessageReceived(const routeable_message &msg)
 
 								//extract data
 								//vehicleId(4), heading*M(4), speed*K(4), (latitude+180)*M(4), (longitude+180)*M(4), elevation (4)
-								BsmMessage *bsm = DecodeBsm(ntohl(*((uint32_t*)&(bytes.data()[8]))),
-										ntohl(*((uint32_t*)&(bytes.data()[12]))),
-										ntohl(*((uint32_t*)&(bytes.data()[16]))),
-										ntohl(*((uint32_t*)&(bytes.data()[20]))),
-										ntohl(*((uint32_t*)&(bytes.data()[24]))),
-										ntohl(*((uint32_t*)&(bytes.data()[28]))),
-										decodedBsm);
+								uint32_t vehicleId = ntohl(*((uint32_t*)&(bytes.data()[8])));
+								uint32_t heading = ntohl(*((uint32_t*)&(bytes.data()[12])));
+								uint32_t speed = ntohl(*((uint32_t*)&(bytes.data()[16])));
+								uint32_t latitude = ntohl(*((uint32_t*)&(bytes.data()[20])));
+								uint32_t longitude = ntohl(*((uint32_t*)&(bytes.data()[24])));
+								uint32_t elevation = ntohl(*((uint32_t*)&(bytes.data()[28])));
+
+								// The same conversions as DecodeBsm
+								double headingDeg = (float)(heading / 1000000.0);
+								double speedMps = (double)(speed / 1000.0);
+								double latitudeDeg = (double)(latitude / 1000000.0 - 180);
+								double longitudeDeg = (double)(longitude / 1000000.0 - 180);
+								double elevationM = (float)(elevation / 1000.0 - 500);
 
 								if (simLoc) {
-									LocationMessage loc(::to_string(decodedBsm.get_TemporaryId()),
+									LocationMessage loc(::to_string(vehicleId),
 													    location::SignalQualityTypes::SimulationMode,
 														"", ::to_string(copy.get_timestamp()),
-														decodedBsm.get_Latitude(), decodedBsm.get_Longitude(),
+														latitudeDeg, longitudeDeg,
 														location::FixTypes::ThreeD, 0, 0.0,
-														decodedBsm.get_Speed_mps(), decodedBsm.get_Heading());
-									loc.set_Altitude(decodedBsm.get_Elevation_m());
+														speedMps, headingDeg);
+									loc.set_Altitude(elevationM);
 
 									routeable_message rMsg;
 									rMsg.initialize(loc);
 
-									this->IncomingMessage(rMsg, 0, 0, copy.get_timestamp());
+									// Route it from here, instead of queuing it to come back through this function
+									RouteMessage(rMsg, copy.get_timestamp());
 								}
 
-								sendMsg = encode(encodedBsm, bsm);
-								if (sendMsg) sendMsg->addDsrcMetadata(172, 0x20);
-
 								if (!simBSM) return;
+
+								// Patch the last BSM from this vehicle, or build it from scratch
+								if (bsmEncoder.Encode(vehicleId, headingDeg, speedMps, latitudeDeg, longitudeDeg, elevationM, bsmBytes))
+									sendMsg = encode(encodedBsm, bsmBytes);
+								else
+									sendMsg = encode(encodedBsm, DecodeBsm(vehicleId, heading, speed, latitude, longitude, elevation, decodedBsm));
+
+								if (sendMsg) sendMsg->addDsrcMetadata(172, 0x20);
 							}
 							break;
 						case ABBR_SRM:
@@ -297,31 +345,34 @@ void MessageReceiverPlugin::OnMessageReceived(const routeable_message &msg)
 		}
 	}
 
-	// Make sure the timestamp matches the incoming source message
+	RouteMessage(*sendMsg, copy.get_timestamp());
+}
 
-	sendMsg->set_timestamp(copy.get_timestamp());
+void MessageReceiverPlugin::RouteMessage(routeable_message &msg, uint64_t timestamp)
+{
+	routeable_message *sendMsg = &msg;
 
-	// Keep a count of each type of message received
-	string name(sendMsg->get_subtype());
-	if (!IsJ2735Message(*sendMsg))
-	{
-		// If not a J2735 message, save the type also
-		name.insert(0, "/");
-		name.insert(0, sendMsg->get_type());
-	}
+	// Make sure the timestamp matches the incoming source message
+	sendMsg->set_timestamp(timestamp);
 
-	if (!totalCount.count(name))
-		totalCount[name] = 1;
-	else
-		totalCount[name]++;
+	// Keep a count of each type of message received
+	const IvpMessage *ivpMsg = static_cast<const routeable_message *>(sendMsg)->get_message();
+	message_id id = MessageId(ivpMsg->type, ivpMsg->subtype);
 
-	// Check to see if forward is disabled for this type
 	bool fwd = true;
-	GetConfigValue(name, fwd);
+	MessageTypeTable::Entry *entry = messageTypes.Find(id);
+	if (!entry)
+		entry = AddMessageType(id, *sendMsg, fwd);
+
+	if (entry)
+	{
+		entry->count.fetch_add(1, std::memory_order_relaxed);
+		fwd = entry->forward.load(std::memory_order_relaxed);
+	}
 
 	if (fwd)
 	{
-		PLOG(logDEBUG) << "Routing " << name << " message.";
+		PLOG(logDEBUG) << "Routing " << (entry ? entry->name : sendMsg->get_subtype()) << " message.";
 
 		if (routeDsrc)
 			sendMsg->set_flags(IvpMsgFlags_RouteDSRC);
@@ -332,6 +383,29 @@ void MessageReceiverPlugin::OnMessageReceived(const routeable_message &msg)
 	}
 }
 
+MessageTypeTable::Entry *MessageReceiverPlugin::AddMessageType(message_id id, routeable_message &msg, bool &fwd)
+{
+	string name(msg.get_subtype());
+	if (!IsJ2735Message(msg))
+	{
+		// If not a J2735 message, save the type also
+		name.insert(0, "/");
+		name.insert(0, msg.get_type());
+	}
+
+	// Check to see if forward is disabled for this type.  Any later change comes in OnConfigChanged.
+	GetConfigValue(name, fwd);
+
+	// A type that is not tracked is only added once, so this is only logged once for each type
+	MessageTypeTable::Entry *entry = messageTypes.Add(id, name, fwd);
+	if (entry && !entry->tracked)
+		PLOG(logWARNING) << "Too many message types to keep track of " << name << " messages.";
+	else if (!entry && !messageTypesFull.exchange(true))
+		PLOG(logWARNING) << "Too many message types to hold the forward policy of " << name << " and later types.";
+
+	return entry;
+}
+
 void MessageReceiverPlugin::UpdateConfigSettings()
 {
 	// Atomic flags
@@ -345,6 +419,8 @@ void MessageReceiverPlugin::UpdateConfigSettings()
 
 	GetConfigValue("IP", ip);
 	GetConfigValue("Port", port);
+	GetConfigValue("AdditionalPorts", additionalPorts);
+	GetConfigValue("IngestShards", ingestShards);
 
 	cfgChanged = true;
 }
@@ -354,6 +430,12 @@ void MessageReceiverPlugin::OnConfigChanged(const char *key, const char *value)
 	TmxMessageManager::OnConfigChanged(key, value);
 	if (_plugin->state == IvpPluginState_registered)
 		UpdateConfigSettings();
+
+	// The key may be the forward policy of a message type
+	MessageTypeTable::Entry *entry = key ? messageTypes.FindByName(key) : NULL;
+	bool fwd = true;
+	if (entry && GetConfigValue(key, fwd))
+		entry->forward = fwd;
 }
 
 void MessageReceiverPlugin::OnStateChange(IvpPluginState state)
@@ -366,6 +448,56 @@ void MessageReceiverPlugin::OnStateChange(IvpPluginState state)
 	}
 }
 
+void MessageReceiverPlugin::StartIngest()
+{
+	vector<int> ports;
+	if (port > 0)
+		ports.push_back(port);
+
+	vector<string> extra;
+	boost::split(extra, additionalPorts, boost::is_any_of(","));
+	for (string &p : extra)
+	{
+		boost::trim(p);
+		if (!p.empty() && atoi(p.c_str()) > 0)
+			ports.push_back(atoi(p.c_str()));
+	}
+
+	// Each shard keeps its own worker thread, so there can not be more shards than workers
+	size_t shards = std::min((size_t)ingestShards, NumThreads());
+	if (shards < ingestShards)
+		PLOG(logWARNING) << "Only " << shards << " of " << ingestShards << " ingest shards used, one for each worker thread";
+
+	if (ports.empty() || shards == 0)
+	{
+		ingest.Stop();
+	}
+	else
+	{
+		PLOG(logDEBUG) << "Creating " << shards << " UDP ingest shards on ip " << ip << " for " << ports.size() << " ports";
+
+		ingest.Start(ip, ports, shards, [this](size_t shard, const byte_t *bytes, size_t size, uint64_t timestamp) {
+			totalBytes += size;
+			return this->IncomingMessageToThread(shard, bytes, size, DetectEncoding(bytes, size), 0, 0, timestamp);
+		});
+	}
+
+	ingestIp = ip;
+	ingestPort = port;
+	ingestAdditionalPorts = additionalPorts;
+	ingestShardsStarted = ingestShards;
+}
+
+void MessageReceiverPlugin::StopIngest()
+{
+	ingest.Stop();
+
+	ingestIp.clear();
+	ingestPort = 0;
+	ingestAdditionalPorts.clear();
+	ingestShardsStarted = 0;
+}
+
 int MessageReceiverPlugin::Main()
 {
 	PLOG(logINFO) << "Starting plugin.";
@@ -379,16 +511,42 @@ int MessageReceiverPlugin::Main()
 		if (cfgChanged) {
 			lock_guard<mutex> lock(syncLock);
 
-			if (port > 0 && (
-					!server || (server->GetAddress() != ip || server->GetPort() != port)))
+			try
+			{
+				if (ingestShards > 0)
+				{
+					// The shards receive on the port instead.  Restarting them closes the sockets and
+					// drops whatever is queued, so only do it when the ingest settings change.
+					server.reset();
+					if (ip != ingestIp || port != ingestPort || additionalPorts != ingestAdditionalPorts
+							|| ingestShards != ingestShardsStarted)
+						StartIngest();
+				}
+				else
+				{
+					StopIngest();
+
+					if (port > 0 && (
+							!server || (server->GetAddress() != ip || server->GetPort() != port)))
+					{
+						PLOG(logDEBUG) << "Creating UDPServer ip " << ip << " port " << port;
+						server.reset(new UdpServer(ip, port));
+					}
+				}
+			}
+			catch (exception &ex)
 			{
-				PLOG(logDEBUG) << "Creating UDPServer ip " << ip << " port " << port;
-				server.reset(new UdpServer(ip, port));
+				this->HandleException(ex, false);
 			}
 
 			cfgChanged = false;
 		}
 
+		if (ingest.NumShards() > 0)
+		{
+			this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+
 		try
 		{
 			int len = server ? server->Receive((char *)incoming.data(), incoming.size()) : 0;
@@ -400,27 +558,7 @@ int MessageReceiverPlugin::Main()
 
 				totalBytes += len;
 
-				// Support different encodings
-				string enc;
-				if (incoming.size() > 0)
-				{
-					switch (incoming[0]) {
-					case 0x00:
-						enc = api::ENCODING_ASN1_UPER_STRING;
-						break;
-					case 0x30:
-						enc = api::ENCODING_ASN1_BER_STRING;
-						break;
-					case '{':
-						enc = api::ENCODING_JSON_STRING;
-						break;
-					default:
-						enc = api::ENCODING_BYTEARRAY_STRING;
-						break;
-					}
-				}
-
-				this->IncomingMessage(incoming.data(), len, enc.empty() ? NULL : enc.c_str(), 0, 0, time);
+				this->IncomingMessage(incoming.data(), len, DetectEncoding(incoming.data(), len), 0, 0, time);
 			}
 			else if (len < 0)
 			{
@@ -442,22 +580,23 @@ int MessageReceiverPlugin::Main()
 
 			SetStatus("Total KBytes Received", b / 1024.0);
 
-			for (auto iter = totalCount.begin(); iter != totalCount.end(); iter++) {
-				string param("Avg ");
-				param += iter->first;
-				param += " Message Interval (ms)";
-
-				uint32_t c = totalCount[iter->first];
-				SetStatus(param.c_str(), c == 0 ? 0 : 1.0 * msCount / c);
-
-				param = "Total ";
-				param += iter->first;
-				param += " Messages Received";
-				SetStatus(param.c_str(), c);
+			for (size_t i = 0; i < ingest.NumShards(); i++)
+			{
+				const UdpIngest::Statistics &stats = ingest.GetStatistics(i);
+				string shard = "Shard " + to_string(i);
+				SetStatus((shard + " Messages Received").c_str(), stats.datagrams.load());
+				SetStatus((shard + " Messages Dropped").c_str(), stats.dropped.load());
 			}
+
+			messageTypes.ForEach([this, msCount](MessageTypeTable::Entry &entry) {
+				uint64_t c = entry.count.load(std::memory_order_relaxed);
+				SetStatus(entry.intervalStatus.c_str(), c == 0 ? 0 : 1.0 * msCount / c);
+				SetStatus(entry.totalStatus.c_str(), c);
+			});
 		}
 	}
 
+	StopIngest();
 	return 0;
 }
 
@@ -18,6 +18,9 @@
 #include <memory>
 #include <tmx/j2735_messages/BasicSafetyMessage.hpp>
 
+#include "MessageTypeTable.h"
+#include "UdpIngest.h"
+
 #define UDP "UDP"
 
 namespace MessageReceiver {
@@ -31,6 +34,10 @@ public:
 	void OnMessageReceived(const tmx::routeable_message &msg);
 protected:
 	void UpdateConfigSettings();
+	void RouteMessage(tmx::routeable_message &msg, uint64_t timestamp);
+	MessageTypeTable::Entry *AddMessageType(tmx::utils::message_id id, tmx::routeable_message &msg, bool &fwd);
+	void StartIngest();
+	void StopIngest();
 
 	// Virtual method overrides.
 	void OnConfigChanged(const char *key, const char *value);
@@ -39,6 +46,14 @@ private:
 	std::atomic<bool> cfgChanged { false };
 	std::string ip;
 	unsigned short port = 0;
+	std::string additionalPorts;
+	unsigned int ingestShards = 0;
+
+	// The settings the ingest shards are running with, so they are only restarted when one changes
+	std::string ingestIp;
+	unsigned short ingestPort = 0;
+	std::string ingestAdditionalPorts;
+	unsigned int ingestShardsStarted = 0;
 
 	std::atomic<bool> routeDsrc { false };
 	std::atomic<bool> simBSM { true };
@@ -46,6 +61,10 @@ private:
 	std::atomic<bool> simLoc { true };
 	std::atomic<bool> simVBM { true };
 
+	MessageTypeTable messageTypes;
+	std::atomic<bool> messageTypesFull { false };
+	UdpIngest ingest;
+
 };
 
 } /* namespace MessageReceiver */
@@ -0,0 +1,86 @@
+/*
+ * MessageTypeTable.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "MessageTypeTable.h"
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace MessageReceiver {
+
+constexpr size_t MessageTypeTable::Capacity;
+constexpr size_t MessageTypeTable::MaxTypes;
+constexpr size_t MessageTypeTable::MaxEntries;
+
+MessageTypeTable::Entry *MessageTypeTable::Find(message_id id)
+{
+	// An ID of 0 marks an empty slot
+	if (id == 0)
+		id = 1;
+
+	for (size_t i = 0; i < Capacity; i++)
+	{
+		Entry &entry = _entries[(id + i) % Capacity];
+		message_id entryId = entry.id.load(std::memory_order_acquire);
+
+		if (entryId == id)
+			return &entry;
+		if (entryId == 0)
+			return NULL;
+	}
+
+	return NULL;
+}
+
+MessageTypeTable::Entry *MessageTypeTable::Add(message_id id, const string &name, bool forward)
+{
+	if (id == 0)
+		id = 1;
+
+	lock_guard<mutex> lock(_lock);
+
+	Entry *found = Find(id);
+	if (found)
+		return found;
+
+	if (_size >= MaxEntries)
+		return NULL;
+
+	for (size_t i = 0; i < Capacity; i++)
+	{
+		Entry &entry = _entries[(id + i) % Capacity];
+		if (entry.id.load(std::memory_order_relaxed) != 0)
+			continue;
+
+		entry.name = name;
+		entry.intervalStatus = "Avg " + name + " Message Interval (ms)";
+		entry.totalStatus = "Total " + name + " Messages Received";
+		entry.forward = forward;
+		entry.tracked = (_size < MaxTypes);
+
+		// The entry is only found once it is filled in
+		entry.id.store(id, std::memory_order_release);
+		_size++;
+		return &entry;
+	}
+
+	return NULL;
+}
+
+MessageTypeTable::Entry *MessageTypeTable::FindByName(const string &name)
+{
+	for (size_t i = 0; i < Capacity; i++)
+	{
+		Entry &entry = _entries[i];
+		if (entry.id.load(std::memory_order_acquire) != 0 && entry.name == name)
+			return &entry;
+	}
+
+	return NULL;
+}
+
+} /* namespace MessageReceiver */
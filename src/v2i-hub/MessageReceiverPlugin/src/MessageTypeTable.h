@@ -0,0 +1,92 @@
+/*
+ * MessageTypeTable.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_MESSAGETYPETABLE_H_
+#define SRC_MESSAGETYPETABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <MessageDispatcher.h>
+
+namespace MessageReceiver {
+
+/**
+ * The forward policy and counters of each type of message received, by the interned ID of its
+ * type and subtype.
+ *
+ * A type is added the first time it is received, with its name and forward policy.  After that,
+ * finding the type, checking its policy and counting the message does not lock or allocate, so
+ * any number of threads can do it at once.  Only adding a type locks the table.  The table tracks
+ * a fixed number of types.  Types added after that still keep their forward policy, but are not
+ * tracked, so ForEach() skips them.  Add() only returns NULL once there is no room at all.
+ */
+class MessageTypeTable
+{
+public:
+	struct Entry
+	{
+		std::atomic<tmx::utils::message_id> id {0};
+
+		/// The name of the type, which is also its configuration key
+		std::string name;
+		std::string intervalStatus;
+		std::string totalStatus;
+
+		std::atomic<bool> forward {true};
+		std::atomic<uint64_t> count {0};
+
+		/// False for a type added after the table tracked all it can
+		bool tracked = true;
+	};
+
+	/**
+	 * @return The entry for the message ID, or NULL if it has not been added
+	 */
+	Entry *Find(tmx::utils::message_id id);
+
+	/**
+	 * Add the entry for a message ID, or find it if another thread added it first.
+	 *
+	 * @return The entry, or NULL if the table is full
+	 */
+	Entry *Add(tmx::utils::message_id id, const std::string &name, bool forward);
+
+	/**
+	 * @return The entry for the type with the name, or NULL if there is none
+	 */
+	Entry *FindByName(const std::string &name);
+
+	/**
+	 * Call the function for each tracked entry in the table.
+	 */
+	template <typename Function>
+	void ForEach(Function function)
+	{
+		for (size_t i = 0; i < Capacity; i++)
+		{
+			if (_entries[i].id.load(std::memory_order_acquire) != 0 && _entries[i].tracked)
+				function(_entries[i]);
+		}
+	}
+
+private:
+	// Open addressing, with room to spare so the probes stay short
+	static constexpr size_t Capacity = 256;
+	static constexpr size_t MaxTypes = Capacity / 2;
+	static constexpr size_t MaxEntries = Capacity * 3 / 4;
+
+	Entry _entries[Capacity];
+	size_t _size = 0;
+	std::mutex _lock;
+};
+
+} /* namespace MessageReceiver */
+
+#endif /* SRC_MESSAGETYPETABLE_H_ */
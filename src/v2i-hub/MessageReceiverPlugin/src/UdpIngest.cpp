@@ -0,0 +1,156 @@
+/*
+ * UdpIngest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "UdpIngest.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <Clock.h>
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::utils;
+
+// Datagrams read with each call
+#define BATCH_SIZE 32
+// Larger than any message the plugin receives
+#define MAX_DATAGRAM 4000
+// How often the threads check if they should stop
+#define POLL_WAIT_MS 100
+
+namespace MessageReceiver {
+
+UdpIngest::UdpIngest()
+{
+}
+
+UdpIngest::~UdpIngest()
+{
+	Stop();
+}
+
+void UdpIngest::Start(const string &address, const vector<int> &ports, size_t shards, handler_type handler)
+{
+	Stop();
+
+	_handler = handler;
+
+	try
+	{
+		for (size_t i = 0; i < shards; i++)
+		{
+			unique_ptr<Shard> shard(new Shard());
+			for (int port : ports)
+				shard->servers.emplace_back(new UdpServer(address, port, true));
+
+			_shards.push_back(move(shard));
+		}
+	}
+	catch (exception &)
+	{
+		_shards.clear();
+		throw;
+	}
+
+	_running = true;
+	for (size_t i = 0; i < _shards.size(); i++)
+		_shards[i]->thread = thread(&UdpIngest::Run, this, i);
+}
+
+void UdpIngest::Stop()
+{
+	_running = false;
+
+	for (auto &shard : _shards)
+	{
+		if (shard->thread.joinable())
+			shard->thread.join();
+	}
+
+	_shards.clear();
+}
+
+void UdpIngest::Run(size_t shardId)
+{
+	Shard &shard = *_shards[shardId];
+	size_t count = shard.servers.size();
+
+	vector<pollfd> fds(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		fds[i].fd = shard.servers[i]->GetSocket();
+		fds[i].events = POLLIN;
+	}
+
+	// One buffer for each datagram in a batch
+	vector<byte_t> buffers(BATCH_SIZE * MAX_DATAGRAM);
+	mmsghdr msgs[BATCH_SIZE];
+	iovec iovs[BATCH_SIZE];
+
+	while (_running)
+	{
+		int r = poll(fds.data(), count, POLL_WAIT_MS);
+		if (r <= 0)
+		{
+			if (r < 0 && errno != EINTR)
+				shard.stats.errors++;
+			continue;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!(fds[i].revents & POLLIN))
+				continue;
+
+			// Read until the socket is empty
+			while (_running)
+			{
+				memset(msgs, 0, sizeof(msgs));
+				for (int j = 0; j < BATCH_SIZE; j++)
+				{
+					iovs[j].iov_base = &buffers[j * MAX_DATAGRAM];
+					iovs[j].iov_len = MAX_DATAGRAM;
+					msgs[j].msg_hdr.msg_iov = &iovs[j];
+					msgs[j].msg_hdr.msg_iovlen = 1;
+				}
+
+				int n = recvmmsg(fds[i].fd, msgs, BATCH_SIZE, MSG_DONTWAIT, NULL);
+				if (n <= 0)
+				{
+					if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+						shard.stats.errors++;
+					break;
+				}
+
+				uint64_t time = Clock::GetMillisecondsSinceEpoch();
+				uint64_t bytes = 0;
+				uint64_t dropped = 0;
+
+				for (int j = 0; j < n; j++)
+				{
+					bytes += msgs[j].msg_len;
+					if (msgs[j].msg_len == 0 || !_handler(shardId, &buffers[j * MAX_DATAGRAM], msgs[j].msg_len, time))
+						dropped++;
+				}
+
+				shard.stats.datagrams.fetch_add(n, std::memory_order_relaxed);
+				shard.stats.bytes.fetch_add(bytes, std::memory_order_relaxed);
+				if (dropped)
+					shard.stats.dropped.fetch_add(dropped, std::memory_order_relaxed);
+
+				if (n < BATCH_SIZE)
+					break;
+			}
+		}
+	}
+}
+
+} /* namespace MessageReceiver */
@@ -0,0 +1,85 @@
+/*
+ * UdpIngest.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_UDPINGEST_H_
+#define SRC_UDPINGEST_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <UdpServer.h>
+#include <tmx/messages/byte_stream.hpp>
+
+namespace MessageReceiver {
+
+/**
+ * Receives UDP datagrams on one or more ports with several receiver threads, or shards.
+ *
+ * Each shard has its own socket on every port, all bound with SO_REUSEPORT, so the kernel spreads
+ * the senders over the shards by their source address and port.  All the datagrams of one sender
+ * go to the same shard, which keeps them in order.  Each shard reads its sockets with its own
+ * thread, in batches, and hands each datagram to the handler on that thread.
+ */
+class UdpIngest
+{
+public:
+	/**
+	 * The handler for each datagram received, called on the thread of the shard.
+	 *
+	 * @return False if the datagram was dropped
+	 */
+	typedef std::function<bool(size_t shard, const tmx::byte_t *bytes, size_t size, uint64_t timestamp)> handler_type;
+
+	struct Statistics
+	{
+		std::atomic<uint64_t> datagrams {0};
+		std::atomic<uint64_t> bytes {0};
+		std::atomic<uint64_t> dropped {0};
+		std::atomic<uint64_t> errors {0};
+	};
+
+	UdpIngest();
+	virtual ~UdpIngest();
+
+	/**
+	 * Open the sockets and start the receiver threads, after stopping any already running.
+	 *
+	 * @param address The address to receive on
+	 * @param ports The ports to receive on
+	 * @param shards The number of receiver threads
+	 * @param handler The handler for each datagram
+	 * @throws UdpServerRuntimeError if a socket could not be opened
+	 */
+	void Start(const std::string &address, const std::vector<int> &ports, size_t shards, handler_type handler);
+	void Stop();
+
+	size_t NumShards() const { return _shards.size(); }
+	const Statistics &GetStatistics(size_t shard) const { return _shards[shard]->stats; }
+
+private:
+	struct Shard
+	{
+		std::vector<std::unique_ptr<tmx::utils::UdpServer>> servers;
+		std::thread thread;
+		Statistics stats;
+	};
+
+	void Run(size_t shard);
+
+	std::vector<std::unique_ptr<Shard>> _shards;
+	handler_type _handler;
+	std::atomic<bool> _running {false};
+};
+
+} /* namespace MessageReceiver */
+
+#endif /* SRC_UDPINGEST_H_ */
@@ -0,0 +1,322 @@
+/*
+ * OdeUplinkSinkTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ *
+ * Sends numbered records through the ODE uplink to a sink on the loopback, and takes the sink
+ * down part way through to show the records being spooled and replayed once it returns.  Reports
+ * the throughput, and how many records were lost, repeated or out of order.
+ *
+ * Usage: OdeUplinkSinkTest [udp|tcp] [records] [record bytes] [batch bytes] [outage ms]
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../src/OdeUplink.h"
+
+using namespace std;
+using namespace ODE;
+
+#define SPOOL_FILE "/tmp/OdeUplinkSinkTest.spool"
+#define DRAIN_TIMEOUT_SEC 30
+
+/**
+ * Receives the records on the loopback and checks their sequence numbers, which are in the
+ * first 8 bytes of each record.
+ */
+class Sink
+{
+public:
+	Sink(bool tcp, bool prefixed, size_t records): _tcp(tcp), _prefixed(prefixed), _seen(records, 0) {}
+
+	~Sink() { Down(); }
+
+	bool Up(int port)
+	{
+		_fd = socket(AF_INET, _tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+		if (_fd < 0)
+			return false;
+
+		int on = 1;
+		int size = 8 * 1024 * 1024;
+		setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		setsockopt(_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		if (::bind(_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || (_tcp && listen(_fd, 4) < 0))
+		{
+			close(_fd);
+			_fd = -1;
+			return false;
+		}
+
+		socklen_t len = sizeof(addr);
+		getsockname(_fd, (struct sockaddr *)&addr, &len);
+		_port = ntohs(addr.sin_port);
+
+		_running = true;
+		_thread = thread(&Sink::Run, this);
+		return true;
+	}
+
+	void Down()
+	{
+		_running = false;
+		if (_thread.joinable())
+			_thread.join();
+
+		if (_fd >= 0)
+			close(_fd);
+		_fd = -1;
+	}
+
+	int Port() const { return _port; }
+	uint64_t Received() const { return _received; }
+
+	void Report(size_t records, uint64_t dropped)
+	{
+		lock_guard<mutex> lock(_lock);
+
+		uint64_t lost = 0;
+		uint64_t repeated = 0;
+		for (uint8_t count : _seen)
+		{
+			if (count == 0)
+				lost++;
+			else
+				repeated += count - 1;
+		}
+
+		cout << "Received " << _received << " of " << records << " records: " << lost << " lost (" <<
+				dropped << " dropped by the uplink), " << repeated << " repeated, " << _outOfOrder <<
+				" out of order" << endl;
+	}
+
+private:
+	void Run()
+	{
+		vector<uint8_t> buffer(128 * 1024);
+		vector<uint8_t> stream;
+		int conn = -1;
+
+		while (_running)
+		{
+			int fd = (_tcp && conn >= 0) ? conn : _fd;
+			struct pollfd pfd = { fd, POLLIN, 0 };
+			if (poll(&pfd, 1, 50) <= 0)
+				continue;
+
+			if (_tcp && conn < 0)
+			{
+				conn = accept(_fd, NULL, NULL);
+				stream.clear();
+				continue;
+			}
+
+			ssize_t n = recv(fd, buffer.data(), buffer.size(), 0);
+			if (n <= 0)
+			{
+				if (_tcp)
+				{
+					close(conn);
+					conn = -1;
+				}
+				continue;
+			}
+
+			if (!_prefixed)
+			{
+				Record(buffer.data(), n);
+				continue;
+			}
+
+			// Each record is preceded by its length as a 16-bit big endian number
+			stream.insert(stream.end(), buffer.begin(), buffer.begin() + n);
+
+			size_t pos = 0;
+			while (stream.size() - pos >= 2)
+			{
+				size_t length = (stream[pos] << 8) | stream[pos + 1];
+				if (stream.size() - pos - 2 < length)
+					break;
+
+				Record(stream.data() + pos + 2, length);
+				pos += 2 + length;
+			}
+
+			stream.erase(stream.begin(), stream.begin() + pos);
+
+			// A datagram always holds whole records
+			if (!_tcp)
+				stream.clear();
+		}
+
+		if (conn >= 0)
+			close(conn);
+	}
+
+	void Record(const uint8_t *data, size_t length)
+	{
+		uint64_t seq;
+		if (length < sizeof(seq))
+			return;
+
+		memcpy(&seq, data, sizeof(seq));
+
+		lock_guard<mutex> lock(_lock);
+		if (seq >= _seen.size())
+			return;
+
+		if (_received > 0 && seq <= _last)
+			_outOfOrder++;
+
+		_last = seq;
+		if (_seen[seq] < 255)
+			_seen[seq]++;
+		_received++;
+	}
+
+	bool _tcp;
+	bool _prefixed;
+	int _fd = -1;
+	int _port = 0;
+	atomic<bool> _running {false};
+	thread _thread;
+
+	mutex _lock;
+	vector<uint8_t> _seen;
+	atomic<uint64_t> _received {0};
+	uint64_t _last = 0;
+	uint64_t _outOfOrder = 0;
+};
+
+static double Seconds(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void PushRecords(OdeUplink &uplink, uint64_t first, uint64_t last, size_t recordBytes)
+{
+	vector<uint8_t> record(recordBytes, 0xA5);
+
+	for (uint64_t seq = first; seq < last; seq++)
+	{
+		memcpy(record.data(), &seq, sizeof(seq));
+		uplink.Push(record.data(), record.size());
+	}
+}
+
+// Wait for the uplink to send everything it has
+static bool Drain(OdeUplink &uplink)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	while (Seconds(start) < DRAIN_TIMEOUT_SEC)
+	{
+		OdeUplink::Statistics stats = uplink.GetStatistics();
+		if (stats.queuedRecords == 0 && stats.spooledRecords == 0)
+			return true;
+
+		this_thread::sleep_for(chrono::milliseconds(10));
+	}
+
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	bool tcp = argc > 1 && strcasecmp(argv[1], "tcp") == 0;
+	size_t records = argc > 2 ? strtoul(argv[2], NULL, 0) : 200000;
+	size_t recordBytes = argc > 3 ? strtoul(argv[3], NULL, 0) : 200;
+	size_t batchBytes = argc > 4 ? strtoul(argv[4], NULL, 0) : 1400;
+	int outageMs = argc > 5 ? atoi(argv[5]) : 500;
+
+	if (recordBytes < sizeof(uint64_t))
+		recordBytes = sizeof(uint64_t);
+
+	unlink(SPOOL_FILE);
+
+	Sink sink(tcp, tcp || batchBytes > 0, records);
+	if (!sink.Up(0))
+	{
+		cerr << "Unable to start the sink" << endl;
+		return -1;
+	}
+
+	int port = sink.Port();
+
+	OdeUplink::Config config;
+	config.ip = "127.0.0.1";
+	config.port = port;
+	config.tcp = tcp;
+	config.batchBytes = batchBytes;
+	config.spoolFile = SPOOL_FILE;
+
+	OdeUplink uplink;
+	uplink.Start(config);
+
+	cout << (tcp ? "TCP" : "UDP") << " sink on port " << port << ", " << records << " records of " <<
+			recordBytes << " bytes, batch " << batchBytes << " bytes" << endl;
+
+	// The first half with the sink up
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	PushRecords(uplink, 0, records / 2, recordBytes);
+	bool drained = Drain(uplink);
+	double elapsed = Seconds(start);
+
+	OdeUplink::Statistics stats = uplink.GetStatistics();
+	cout << "Sink up: " << fixed << setprecision(0) << (records / 2) / elapsed << " records/s, " <<
+			stats.batches << " batches, " << stats.spilled << " spilled" << (drained ? "" : ", NOT DRAINED") << endl;
+
+	// The second half while the sink is down, which has to be spooled
+	sink.Down();
+	PushRecords(uplink, records / 2, records, recordBytes);
+	this_thread::sleep_for(chrono::milliseconds(outageMs));
+
+	stats = uplink.GetStatistics();
+	cout << "Sink down: " << stats.queuedRecords << " queued, " << stats.spooledRecords << " spooled, " <<
+			stats.sendErrors << " send errors" << endl;
+
+	// Bring the sink back on the same port, and replay
+	if (!sink.Up(port))
+	{
+		cerr << "Unable to restart the sink" << endl;
+		return -1;
+	}
+
+	start = chrono::steady_clock::now();
+	drained = Drain(uplink);
+	elapsed = Seconds(start);
+
+	// Let the last datagrams arrive
+	this_thread::sleep_for(chrono::milliseconds(200));
+
+	stats = uplink.GetStatistics();
+	cout << "Replay: " << fixed << setprecision(3) << elapsed << " s" << (drained ? "" : ", NOT DRAINED") << endl;
+
+	uplink.Stop();
+	sink.Down();
+	sink.Report(records, stats.dropped);
+
+	unlink(SPOOL_FILE);
+	return drained ? 0 : 1;
+}
@@ -10,6 +10,7 @@
 #include <mutex>
 #include <stdexcept>
 #include <thread>
+#include <boost/algorithm/string.hpp>
 #include <tmx/apimessages/TmxEventLog.hpp>
 #include <tmx/j2735_messages/J2735MessageFactory.hpp>
 
@@ -30,65 +31,39 @@ mutex syncLock;
 
 ODEPlugin::ODEPlugin(std::string name): PluginClient(name)
 {
+	// The BSM is forwarded as is, so it is passed through without being decoded
 	AddMessageFilter<BsmMessage>(this, &ODEPlugin::handleBsm);
 	SubscribeToMessages();
 }
 
 ODEPlugin::~ODEPlugin()
 {
-	delete client;
+	_uplink.Stop();
 }
 
 void ODEPlugin::sendBytes(const byte_stream &bytes)
 {
-	static uint64_t totalBytes = 0;
-	static uint32_t totalCount = 0;
-
-	size_t sentBytes;
-
-PLOG(logDEBUG) <<"sendBytes";
+	// The uplink sends the bytes from its own thread, or spools them until the ODE can be reached
+	if (!_uplink.Push(bytes.data(), bytes.size()))
+		PLOG(logDEBUG) << "Uplink is full.  Dropped " << bytes.size() << " bytes.";
+}
 
-	try
-	{
-		syncLock.lock();
-		if (client && (client->GetAddress() != ip || client->GetPort() != port))
-			delete client;
+void ODEPlugin::UpdateUplinkStatus()
+{
+	static uint64_t lastSentBytes = 0;
 
-		if (!client && port > 0)
-			client = new UdpClient(ip, port);
-		syncLock.unlock();
+	OdeUplink::Statistics stats = _uplink.GetStatistics();
 
-		if (client)
-		{
-			sentBytes = client->Send((void *)bytes.data(), bytes.size());
+	SetStatus("Total BSM Messages Sent", stats.sent);
+	SetStatus("Total Bytes Sent", stats.sentBytes);
+	SetStatus("Bytes Sent per Second", 1.0 * (stats.sentBytes - lastSentBytes) / STATUS_WAIT_SEC);
+	SetStatus("Batches Sent", stats.batches);
+	SetStatus("Messages Queued", stats.queuedRecords);
+	SetStatus("Messages Spooled", stats.spooledRecords);
+	SetStatus("Messages Dropped", stats.dropped);
+	SetStatus("ODE Connected", stats.connected);
 
-			PLOG(logDEBUG) << "Sent " << sentBytes << " bytes to " <<
-					client->GetAddress() << ":" << client->GetPort() << ".";
-
-			totalCount ++;
-			totalBytes += sentBytes;
-		}
-		else
-		{
-			PLOG(logDEBUG)<<"client null";
-		}
-	}
-	catch (exception &ex)
-	{
-		if (errno <= 0 || _errThrottle.Monitor(errno))
-		{
-			TmxEventLogMessage elm(ex, "Unable to send message: ");
-			PLOG(logERROR) << elm.get_description();
-			BroadcastMessage(elm);
-		}
-	}
-
-	if (_statThrottle.Monitor(0))
-	{
-		SetStatus("Total BSM Messages Sent", totalCount);
-		SetStatus("Total Bytes Sent", totalBytes);
-		SetStatus("Bytes Sent per Second", 1.0 * totalBytes / STATUS_WAIT_SEC);
-	}
+	lastSentBytes = stats.sentBytes;
 }
 
 void ODEPlugin::recvBytes(const byte_stream &bytes)
@@ -124,12 +99,12 @@ void ODEPlugin::recvBytes(const byte_stream &bytes)
 	}
 }
 
-void ODEPlugin::handleBsm(BsmMessage &message, routeable_message &routeableMsg)
+void ODEPlugin::handleBsm(const MessageView &view, const byte_stream &bytes)
 {
 	try
 	{
 	PLOG(logDEBUG) << "Received BSM.  Forwarding.";
-	sendBytes(routeableMsg.get_payload_bytes());
+	sendBytes(bytes);
 	}
 	catch (exception &ex)
 	{
@@ -148,6 +123,24 @@ void ODEPlugin::UpdateConfigSettings()
 
 	GetConfigValue("ODEIP", ip);
 	GetConfigValue("ODEPort", port);
+
+	string protocol;
+	uint32_t batchBytes = 0;
+	uint32_t spoolMB = 64;
+	OdeUplink::Config config;
+
+	GetConfigValue("ODEProtocol", protocol);
+	GetConfigValue("ODEBatchBytes", batchBytes);
+	GetConfigValue("ODESpoolFile", config.spoolFile);
+	GetConfigValue("ODESpoolMB", spoolMB);
+
+	config.ip = ip;
+	config.port = port;
+	config.tcp = boost::iequals(protocol, TCP);
+	config.batchBytes = batchBytes;
+	config.spoolBytes = (size_t)spoolMB * 1024 * 1024;
+
+	_uplink.Start(config);
 }
 
 void ODEPlugin::OnConfigChanged(const char *key, const char *value)
@@ -170,14 +163,15 @@ int ODEPlugin::Main()
 {
 	PLOG(logINFO) << "Starting plugin.";
 
-	byte_stream incoming(4000);
-
 	while (_plugin->state != IvpPluginState_error)
 	{
-		// Wait a bit longer to try again
-		this_thread::sleep_for(std::chrono::milliseconds(10));
+		this_thread::sleep_for(std::chrono::seconds(STATUS_WAIT_SEC));
+
+		if (_plugin->state == IvpPluginState_registered)
+			UpdateUplinkStatus();
 	}
 
+	_uplink.Stop();
 	return 0;
 }
 
@@ -10,10 +10,11 @@
 
 #include <FrequencyThrottle.h>
 #include <PluginClient.h>
-#include <UdpClient.h>
 #include <boost/asio.hpp>
 #include <tmx/j2735_messages/BasicSafetyMessage.hpp>
 
+#include "OdeUplink.h"
+
 #define TCP "TCP"
 #define UDP "UDP"
 
@@ -24,7 +25,7 @@ class ODEPlugin: public tmx::utils::PluginClient {
 public:
 	ODEPlugin(std::string);
 	virtual ~ODEPlugin();
-	void handleBsm(tmx::messages::BsmMessage &, tmx::routeable_message &);
+	void handleBsm(const tmx::utils::MessageView &, const tmx::byte_stream &);
 
 	void sendBytes(const tmx::byte_stream &);
 	void recvBytes(const tmx::byte_stream &);
@@ -32,6 +33,7 @@ public:
 	int Main();
 protected:
 	void UpdateConfigSettings();
+	void UpdateUplinkStatus();
 
 	// Virtual method overrides.
 	void OnConfigChanged(const char *key, const char *value);
@@ -40,7 +42,7 @@ private:
 	std::string ip;
 	unsigned short port = 0;
 
-	tmx::utils::UdpClient *client = NULL;
+	OdeUplink _uplink;
 
 	tmx::utils::FrequencyThrottle<int> _errThrottle;
 	tmx::utils::FrequencyThrottle<int> _statThrottle;
@@ -0,0 +1,507 @@
+/*
+ * OdeUplink.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "OdeUplink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace ODE {
+
+#define RING_MAGIC 0x4f4445535030314cULL
+#define MAX_RECORD_LENGTH 0xFFFF
+#define TCP_BATCH_BYTES 65536
+#define CONNECT_TIMEOUT_MS 1000
+#define MIN_BACKOFF_MS 100
+#define MAX_BACKOFF_MS 2000
+
+RecordRing::RecordRing(): _header(NULL), _data(NULL), _mapLength(0), _mapped(false)
+{
+}
+
+RecordRing::~RecordRing()
+{
+	Close();
+}
+
+bool RecordRing::Open(size_t capacity, const string &file)
+{
+	Close();
+
+	if (capacity == 0)
+		return false;
+
+	size_t length = sizeof(Header) + capacity;
+	void *map = MAP_FAILED;
+	bool existing = false;
+
+	if (file.empty())
+	{
+		map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	}
+	else
+	{
+		int fd = open(file.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd < 0)
+		{
+			PLOG(logERROR) << "Unable to open spool file " << file << ": " << strerror(errno);
+			return false;
+		}
+
+		struct stat st;
+		memset(&st, 0, sizeof(st));
+		existing = (fstat(fd, &st) == 0 && (size_t)st.st_size == length);
+		if (!existing && st.st_size > 0)
+			PLOG(logWARNING) << "Spool file " << file << " does not match the spool size, so its records are discarded";
+
+		if (!existing && ftruncate(fd, length) < 0)
+		{
+			PLOG(logERROR) << "Unable to size spool file " << file << ": " << strerror(errno);
+			close(fd);
+			return false;
+		}
+
+		// Allocate every block now.  A write through the map to a hole in a full file system
+		// raises SIGBUS instead of returning an error.
+		int err = posix_fallocate(fd, 0, length);
+		if (err != 0)
+		{
+			PLOG(logERROR) << "Unable to allocate spool file " << file << ": " << strerror(err);
+			close(fd);
+			return false;
+		}
+
+		map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);
+	}
+
+	if (map == MAP_FAILED)
+	{
+		PLOG(logERROR) << "Unable to map " << (file.empty() ? "queue" : file) << ": " << strerror(errno);
+		return false;
+	}
+
+	_header = (Header *)map;
+	_data = (uint8_t *)map + sizeof(Header);
+	_mapLength = length;
+	_mapped = !file.empty();
+
+	if (existing && _header->magic == RING_MAGIC && _header->capacity == capacity &&
+			_header->head <= _header->tail && _header->tail - _header->head <= capacity)
+	{
+		// Count the records that are left, and drop any that were only partly written
+		uint64_t count = 0;
+		uint64_t pos = _header->head;
+		while (pos != _header->tail)
+		{
+			if (_header->tail - pos < sizeof(uint32_t) || Length(pos) > _header->tail - pos - sizeof(uint32_t))
+			{
+				_header->tail = pos;
+				break;
+			}
+
+			pos += sizeof(uint32_t) + Length(pos);
+			count++;
+		}
+
+		_header->count = count;
+
+		PLOG(logINFO) << "Replaying " << count << " records from spool file " << file;
+	}
+	else
+	{
+		_header->magic = RING_MAGIC;
+		_header->capacity = capacity;
+		_header->head = 0;
+		_header->tail = 0;
+		_header->count = 0;
+	}
+
+	return true;
+}
+
+void RecordRing::Close()
+{
+	if (!_header)
+		return;
+
+	if (_mapped)
+		msync(_header, _mapLength, MS_SYNC);
+
+	munmap(_header, _mapLength);
+	_header = NULL;
+	_data = NULL;
+	_mapLength = 0;
+	_mapped = false;
+}
+
+void RecordRing::copyIn(uint64_t pos, const void *data, size_t length)
+{
+	size_t offset = pos % _header->capacity;
+	size_t first = std::min(length, (size_t)(_header->capacity - offset));
+
+	memcpy(_data + offset, data, first);
+	memcpy(_data, (const uint8_t *)data + first, length - first);
+}
+
+void RecordRing::copyOut(uint64_t pos, void *data, size_t length) const
+{
+	size_t offset = pos % _header->capacity;
+	size_t first = std::min(length, (size_t)(_header->capacity - offset));
+
+	memcpy(data, _data + offset, first);
+	memcpy((uint8_t *)data + first, _data, length - first);
+}
+
+bool RecordRing::Push(const uint8_t *data, uint32_t length)
+{
+	if (!_header)
+		return false;
+
+	uint64_t need = sizeof(uint32_t) + length;
+	if (need > _header->capacity - Used())
+		return false;
+
+	// The tail is only moved once the record is all there
+	copyIn(_header->tail, &length, sizeof(uint32_t));
+	copyIn(_header->tail + sizeof(uint32_t), data, length);
+	_header->tail += need;
+	_header->count++;
+
+	return true;
+}
+
+uint32_t RecordRing::Length(uint64_t pos) const
+{
+	uint32_t length;
+	copyOut(pos, &length, sizeof(uint32_t));
+	return length;
+}
+
+uint64_t RecordRing::Read(uint64_t pos, uint8_t *buffer) const
+{
+	uint32_t length = Length(pos);
+	copyOut(pos + sizeof(uint32_t), buffer, length);
+	return pos + sizeof(uint32_t) + length;
+}
+
+void RecordRing::Release(uint64_t pos, uint64_t records)
+{
+	if (!_header)
+		return;
+
+	_header->head = pos;
+	_header->count -= std::min(records, (uint64_t)_header->count);
+}
+
+OdeUplink::OdeUplink()
+{
+}
+
+OdeUplink::~OdeUplink()
+{
+	Stop();
+}
+
+void OdeUplink::Start(const Config &config)
+{
+	lock_guard<mutex> lock(_lock);
+
+	if (_active)
+	{
+		if (config.ip != _config.ip || config.port != _config.port || config.tcp != _config.tcp)
+			_reconnect = true;
+
+		_config = config;
+		_ready.notify_all();
+		return;
+	}
+
+	_config = config;
+
+	if (!_queue.Open(config.queueBytes))
+		return;
+
+	if (!config.spoolFile.empty())
+		_spool.Open(config.spoolBytes, config.spoolFile);
+
+	_active = true;
+	_thread = thread(&OdeUplink::Run, this);
+}
+
+void OdeUplink::Stop()
+{
+	{
+		lock_guard<mutex> lock(_lock);
+		if (!_active)
+			return;
+
+		_active = false;
+		_ready.notify_all();
+	}
+
+	if (_thread.joinable())
+		_thread.join();
+
+	Disconnect();
+
+	// Anything still in the queue is lost, but the spool is kept for the next start
+	lock_guard<mutex> lock(_lock);
+	_queue.Close();
+	_spool.Close();
+}
+
+bool OdeUplink::Push(const uint8_t *data, size_t length)
+{
+	bool queued = false;
+
+	{
+		lock_guard<mutex> lock(_lock);
+		_stats.received++;
+
+		if (length <= MAX_RECORD_LENGTH)
+		{
+			// Records only go into the queue once the spool is empty, to keep them in order
+			if (_spool.Empty() && _queue.Push(data, length))
+			{
+				queued = true;
+			}
+			else if (_spool.Push(data, length))
+			{
+				_stats.spilled++;
+				queued = true;
+			}
+		}
+
+		if (!queued)
+			_stats.dropped++;
+	}
+
+	if (queued)
+		_ready.notify_one();
+
+	return queued;
+}
+
+OdeUplink::Statistics OdeUplink::GetStatistics()
+{
+	lock_guard<mutex> lock(_lock);
+
+	Statistics stats = _stats;
+	stats.queuedRecords = _queue.Count();
+	stats.spooledRecords = _spool.Count();
+	return stats;
+}
+
+bool OdeUplink::Connect(const Config &config)
+{
+	Disconnect();
+
+	if (config.ip.empty() || config.port <= 0)
+		return false;
+
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = config.tcp ? SOCK_STREAM : SOCK_DGRAM;
+
+	struct addrinfo *addr = NULL;
+	if (getaddrinfo(config.ip.c_str(), to_string(config.port).c_str(), &hints, &addr) != 0 || !addr)
+		return false;
+
+	int fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+	if (fd < 0)
+	{
+		freeaddrinfo(addr);
+		return false;
+	}
+
+	// Connect without blocking for long, since the ODE may not be there.  For UDP, connecting only
+	// sets the destination, and lets the ICMP error for a closed port fail the next send with
+	// ECONNREFUSED, which keeps that batch for a retry.
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	int rc = connect(fd, addr->ai_addr, addr->ai_addrlen);
+	freeaddrinfo(addr);
+
+	if (rc < 0 && errno == EINPROGRESS)
+	{
+		struct pollfd pfd = { fd, POLLOUT, 0 };
+		int err = 0;
+		socklen_t len = sizeof(err);
+
+		if (poll(&pfd, 1, CONNECT_TIMEOUT_MS) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0)
+			rc = 0;
+	}
+
+	if (rc < 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+
+	struct timeval timeout = { 1, 0 };
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	_socket = fd;
+	return true;
+}
+
+void OdeUplink::Disconnect()
+{
+	if (_socket >= 0)
+	{
+		close(_socket);
+		_socket = -1;
+	}
+}
+
+bool OdeUplink::SendAll(const uint8_t *data, size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t sent = send(_socket, data, length, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR)
+			continue;
+		if (sent <= 0)
+			return false;
+
+		data += sent;
+		length -= sent;
+	}
+
+	return true;
+}
+
+bool OdeUplink::TakeBatch(RecordRing *&ring, uint64_t &end, uint64_t &records)
+{
+	// The queue always holds older records than the spool
+	ring = _queue.Empty() ? &_spool : &_queue;
+	if (ring->Empty())
+		return false;
+
+	bool prefixed = _config.tcp || _config.batchBytes > 0;
+	size_t limit = _config.tcp ? TCP_BATCH_BYTES : _config.batchBytes;
+
+	_batch.clear();
+	records = 0;
+
+	for (end = ring->Begin(); end != ring->End(); records++)
+	{
+		uint32_t length = ring->Length(end);
+		size_t need = length + (prefixed ? 2 : 0);
+
+		// There is always at least one record in a batch
+		if (records > 0 && (!prefixed || _batch.size() + need > limit))
+			break;
+
+		size_t offset = _batch.size();
+		_batch.resize(offset + need);
+
+		if (prefixed)
+		{
+			_batch[offset++] = (uint8_t)(length >> 8);
+			_batch[offset++] = (uint8_t)length;
+		}
+
+		end = ring->Read(end, _batch.data() + offset);
+	}
+
+	return true;
+}
+
+void OdeUplink::Run()
+{
+	int backoffMs = MIN_BACKOFF_MS;
+	unique_lock<mutex> lock(_lock);
+
+	while (_active)
+	{
+		if (_reconnect)
+		{
+			_reconnect = false;
+			Disconnect();
+			_stats.connected = false;
+		}
+
+		if (_queue.Empty() && _spool.Empty())
+		{
+			_ready.wait_for(lock, chrono::seconds(1), [this]() {
+				return !_active || _reconnect || !_queue.Empty() || !_spool.Empty();
+			});
+			continue;
+		}
+
+		bool ok = (_socket >= 0);
+		if (!ok)
+		{
+			Config config = _config;
+
+			lock.unlock();
+			ok = Connect(config);
+			lock.lock();
+
+			_stats.connected = ok;
+			if (ok)
+				PLOG(logINFO) << "Connected to the ODE at " << config.ip << ":" << config.port << (config.tcp ? " over TCP" : " over UDP");
+		}
+
+		RecordRing *ring = NULL;
+		uint64_t end = 0;
+		uint64_t records = 0;
+
+		if (ok && TakeBatch(ring, end, records))
+		{
+			// Only this thread takes records out, so the batch stays valid without the lock
+			lock.unlock();
+			ok = SendAll(_batch.data(), _batch.size());
+			lock.lock();
+
+			if (ok)
+			{
+				ring->Release(end, records);
+				_stats.sent += records;
+				_stats.sentBytes += _batch.size();
+				_stats.batches++;
+				backoffMs = MIN_BACKOFF_MS;
+			}
+			else
+			{
+				PLOG(logDEBUG) << "Unable to send to the ODE: " << strerror(errno);
+				_stats.sendErrors++;
+			}
+		}
+
+		if (!ok)
+		{
+			// Keep the records, and try again later
+			Disconnect();
+			_stats.connected = false;
+
+			_ready.wait_for(lock, chrono::milliseconds(backoffMs), [this]() { return !_active || _reconnect; });
+			backoffMs = std::min(backoffMs * 2, MAX_BACKOFF_MS);
+		}
+	}
+}
+
+} /* namespace ODE */
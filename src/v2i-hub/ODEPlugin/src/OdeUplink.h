@@ -0,0 +1,202 @@
+/*
+ * OdeUplink.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SRC_ODEUPLINK_H_
+#define SRC_ODEUPLINK_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ODE {
+
+/**
+ * A circular buffer of variable length records, each one preceded by its 32-bit length.  The
+ * buffer is either in memory or in a memory mapped file, in which case the records that were not
+ * yet taken out are still there when the file is opened again, i.e. after the plugin restarts.
+ *
+ * The ring is not thread safe.
+ */
+class RecordRing
+{
+public:
+	RecordRing();
+	~RecordRing();
+
+	/**
+	 * Open the ring.
+	 *
+	 * @param capacity The number of bytes for the records and their lengths
+	 * @param file The file to map, or empty for memory only.  A file of the same capacity is
+	 * reopened with its records, any other is started over.
+	 * @return False if the file could not be mapped
+	 */
+	bool Open(size_t capacity, const std::string &file = "");
+	void Close();
+
+	inline bool IsOpen() const { return _header != NULL; }
+	inline bool Empty() const { return !_header || _header->head == _header->tail; }
+
+	/// @return The number of bytes used by the records and their lengths
+	inline uint64_t Used() const { return _header ? _header->tail - _header->head : 0; }
+
+	/// @return The number of records in the ring
+	inline uint64_t Count() const { return _header ? _header->count : 0; }
+
+	/**
+	 * Add a record to the end of the ring.
+	 *
+	 * @return False if there is not enough room
+	 */
+	bool Push(const uint8_t *data, uint32_t length);
+
+	/// @return The position of the first record
+	inline uint64_t Begin() const { return _header ? _header->head : 0; }
+
+	/// @return The position after the last record
+	inline uint64_t End() const { return _header ? _header->tail : 0; }
+
+	/**
+	 * @return The length of the record at the position
+	 */
+	uint32_t Length(uint64_t pos) const;
+
+	/**
+	 * Copy the record at the position into the buffer.
+	 *
+	 * @return The position of the next record
+	 */
+	uint64_t Read(uint64_t pos, uint8_t *buffer) const;
+
+	/**
+	 * Remove the records up to the position, i.e. the ones that have been sent.
+	 */
+	void Release(uint64_t pos, uint64_t records);
+
+private:
+	struct Header
+	{
+		uint64_t magic;
+		uint64_t capacity;
+		uint64_t head;
+		uint64_t tail;
+		uint64_t count;
+	};
+
+	void copyIn(uint64_t pos, const void *data, size_t length);
+	void copyOut(uint64_t pos, void *data, size_t length) const;
+
+	Header *_header;
+	uint8_t *_data;
+	size_t _mapLength;
+	bool _mapped;
+};
+
+/**
+ * The uplink of the ODE plugin, which stores and forwards the records sent to the ODE.
+ *
+ * Each record is put in a bounded queue in memory, and the records are sent to the ODE by a
+ * separate thread, so a slow or missing ODE never holds up the plugin.  If the queue fills up,
+ * because the ODE cannot be reached or is not keeping up, the records go to a spool file instead.
+ * The spool is memory mapped, so spilling a record is only a copy, and the records in it survive a
+ * restart of the plugin.  If the spool fills up as well, new records are dropped and counted.
+ *
+ * The records are sent in order: the queue is sent first, and while there is anything in the
+ * spool, new records are put in the spool after it, which is replayed once the queue is empty.
+ *
+ * The sender takes as many records as fit into one datagram, or one write on the TCP stream,
+ * at a time.  Over UDP, with no batch size, each record is its own datagram just as before.
+ * With a batch size, or over TCP, each record is preceded by its length as a 16-bit big endian
+ * number.  When a send fails, the records stay where they are and the send is tried again after a
+ * back off, reconnecting if it is TCP.  A TCP stream may therefore repeat, or lose, the records
+ * that were in flight when the connection dropped.  Over UDP, only an ODE port that is closed can be
+ * detected, from the ICMP error that the next datagram gets back.
+ */
+class OdeUplink
+{
+public:
+	struct Config
+	{
+		std::string ip;
+		int port = 0;
+		bool tcp = false;
+
+		/// The largest datagram of records over UDP, or 0 to send one record per datagram
+		size_t batchBytes = 0;
+
+		/// The size of the queue in memory
+		size_t queueBytes = 1024 * 1024;
+
+		/// The spool file, or empty for none
+		std::string spoolFile;
+		size_t spoolBytes = 64 * 1024 * 1024;
+	};
+
+	struct Statistics
+	{
+		uint64_t received = 0;
+		uint64_t sent = 0;
+		uint64_t sentBytes = 0;
+		uint64_t batches = 0;
+		uint64_t spilled = 0;
+		uint64_t dropped = 0;
+		uint64_t sendErrors = 0;
+		uint64_t queuedRecords = 0;
+		uint64_t spooledRecords = 0;
+		bool connected = false;
+	};
+
+	OdeUplink();
+	~OdeUplink();
+
+	/**
+	 * Start the sender with the configuration, or apply a new configuration.  Changing the ODE
+	 * address reconnects.  Changing the queue or spool sizes only takes effect on the next start.
+	 */
+	void Start(const Config &config);
+	void Stop();
+
+	/**
+	 * Queue a record to send to the ODE.  This does not block on the network.
+	 *
+	 * @return False if the record was dropped because the queue and spool are full
+	 */
+	bool Push(const uint8_t *data, size_t length);
+
+	Statistics GetStatistics();
+
+private:
+	void Run();
+	bool Connect(const Config &config);
+	void Disconnect();
+	bool SendAll(const uint8_t *data, size_t length);
+	bool TakeBatch(RecordRing *&ring, uint64_t &end, uint64_t &records);
+
+	std::mutex _lock;
+	std::condition_variable _ready;
+	Config _config;
+	bool _reconnect = false;
+	RecordRing _queue;
+	RecordRing _spool;
+	Statistics _stats;
+
+	std::thread _thread;
+	std::atomic<bool> _active {false};
+
+	// Only used by the sender thread
+	int _socket = -1;
+	std::vector<uint8_t> _batch;
+	std::vector<uint8_t> _record;
+};
+
+} /* namespace ODE */
+
+#endif /* SRC_ODEUPLINK_H_ */
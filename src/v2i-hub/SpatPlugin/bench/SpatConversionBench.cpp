@@ -0,0 +1,215 @@
+/*
+ * SpatConversionBench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ *
+ * Measures the cost of converting one NTCIP 1202 broadcast to the J2735 SPaT.
+ *
+ * The rebuild path is the conversion done for every packet before the SPaT was patched in
+ * place: a new SPAT structure is built by ToJ2735r41SPAT and wrapped in a new SpatMessage.
+ * The patch path is SignalController::ProcessPacket, which updates the back buffer of its
+ * double buffered SPaT.  The patch path is run again while another thread encodes the SPaT
+ * as fast as it can, to show that a packet does not wait on the sender.
+ *
+ * Reports the time and the number of heap allocations per packet for each path.
+ *
+ * Usage: SpatConversionBench [packets]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <PercentileStatistics.h>
+
+#include "../src/NTCIP1202.h"
+#include "../src/signalController.h"
+
+using namespace std;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+// Count the heap allocations made on each thread by the conversion, including those made by
+// the ASN.1 code
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static thread_local uint64_t allocations = 0;
+
+extern "C" void *malloc(size_t size)
+{
+	allocations++;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+	allocations++;
+	return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+	allocations++;
+	return __libc_realloc(ptr, size);
+}
+
+static const char *SignalGroupMapping = "{\"SignalGroups\":["
+		"{\"SignalGroupId\":1,\"Phase\":1,\"Type\":\"vehicle\"},{\"SignalGroupId\":2,\"Phase\":2,\"Type\":\"vehicle\"},"
+		"{\"SignalGroupId\":3,\"Phase\":3,\"Type\":\"vehicle\"},{\"SignalGroupId\":4,\"Phase\":4,\"Type\":\"vehicle\"},"
+		"{\"SignalGroupId\":5,\"Phase\":5,\"Type\":\"vehicle\"},{\"SignalGroupId\":6,\"Phase\":6,\"Type\":\"vehicle\"},"
+		"{\"SignalGroupId\":7,\"Phase\":7,\"Type\":\"vehicle\"},{\"SignalGroupId\":8,\"Phase\":8,\"Type\":\"vehicle\"},"
+		"{\"SignalGroupId\":22,\"Phase\":2,\"Type\":\"pedestrian\"},{\"SignalGroupId\":24,\"Phase\":4,\"Type\":\"pedestrian\"},"
+		"{\"SignalGroupId\":26,\"Phase\":6,\"Type\":\"pedestrian\"},{\"SignalGroupId\":28,\"Phase\":8,\"Type\":\"pedestrian\"}]}";
+
+static void Fill(Ntcip1202Ext &packet, int sequence)
+{
+	memset(&packet, 0, sizeof(packet));
+	packet.header = (int8_t)0xcd;
+	packet.numOfPhases = 8;
+
+	for (int p = 0; p < 8; p++)
+	{
+		Ntcip1202Ext_PhaseTime &phase = packet.phaseTimes[p];
+		phase.phaseNumber = p + 1;
+		phase.spatVehMinTimeToChange = htons(50 + 10 * p + sequence % 10);
+		phase.spatVehMaxTimeToChange = htons(100 + 10 * p + sequence % 10);
+		phase.spatPedMinTimeToChange = htons(50 + 10 * p);
+		phase.spatPedMaxTimeToChange = htons(100 + 10 * p);
+	}
+
+	// Cycle the main street through green, yellow and red
+	int state = (sequence / 30) % 3;
+	uint16_t main = 0x22, side = 0xcc;
+	packet.phaseStatusGroupGreens = htons(state == 0 ? main : 0);
+	packet.phaseStatusGroupYellows = htons(state == 1 ? main : 0);
+	packet.phaseStatusGroupReds = htons(state == 2 ? main | side : side);
+	packet.phaseStatusGroupDontWalks = htons(0xff);
+	packet.spatMessageSeqCounter = sequence;
+}
+
+struct Result
+{
+	PercentileStatistics time {100000};
+	uint64_t allocations = 0;
+	uint64_t packets = 0;
+};
+
+template <typename Convert>
+static void Run(Result &result, const vector<Ntcip1202Ext> &packets, size_t count, Convert convert)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const Ntcip1202Ext &packet = packets[i % packets.size()];
+
+		uint64_t before = allocations;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		convert(packet);
+
+		chrono::steady_clock::time_point end = chrono::steady_clock::now();
+		result.allocations += allocations - before;
+		result.packets++;
+		result.time.Add(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+
+		// Give the sender a chance to run between packets
+		this_thread::yield();
+	}
+}
+
+static void Report(const string &name, Result &result)
+{
+	cout << setw(22) << left << name << right
+		 << " P50 " << setw(8) << result.time.Percentile(50)
+		 << " ns, P99 " << setw(8) << result.time.Percentile(99)
+		 << " ns, mean " << setw(8) << result.time.Mean()
+		 << " ns, " << (double)result.allocations / result.packets << " allocations per packet" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t count = argc > 1 ? atoi(argv[1]) : 100000;
+	char name[] = "Bench";
+
+	vector<Ntcip1202Ext> packets(90);
+	for (size_t i = 0; i < packets.size(); i++)
+		Fill(packets[i], i);
+
+	// Before: a new SPaT for every packet
+	Result rebuild;
+	{
+		Ntcip1202 ntcip1202;
+		ntcip1202.setSignalGroupMappingList(SignalGroupMapping);
+
+		Run(rebuild, packets, count, [&](const Ntcip1202Ext &packet)
+		{
+			ntcip1202.copyBytesIntoNtcip1202((char *)&packet, sizeof(packet));
+
+			SPAT *spat = (SPAT *) calloc(1, sizeof(SPAT));
+			ntcip1202.ToJ2735r41SPAT(spat, name, 1);
+			SpatMessage *message = new SpatMessage(spat);
+			delete message;
+		});
+	}
+
+	// After: the SPaT patched in place
+	Result patch;
+	{
+		SignalController controller;
+		controller.setConfigs("127.0.0.1", "6053", "127.0.0.1", "501", "", name, 1);
+		controller.Initialize(SignalGroupMapping);
+
+		Run(patch, packets, count, [&](const Ntcip1202Ext &packet)
+		{
+			controller.ProcessPacket((const char *)&packet, sizeof(packet));
+		});
+	}
+
+	// After, with the SPaT encoded continuously on another thread
+	Result patchSending;
+	uint64_t encodes = 0;
+	{
+		SignalController controller;
+		controller.setConfigs("127.0.0.1", "6053", "127.0.0.1", "501", "", name, 1);
+		controller.Initialize(SignalGroupMapping);
+		controller.ProcessPacket((const char *)&packets[0], sizeof(packets[0]));
+
+		atomic<bool> active {true};
+		thread sender([&]()
+		{
+			SpatEncodedMessage message;
+			while (active)
+			{
+				if (controller.getEncodedSpat(&message, (encodes / 100) % 2 ? "1,2" : ""))
+					encodes++;
+				this_thread::yield();
+			}
+		});
+
+		Run(patchSending, packets, count, [&](const Ntcip1202Ext &packet)
+		{
+			controller.ProcessPacket((const char *)&packet, sizeof(packet));
+		});
+
+		active = false;
+		sender.join();
+	}
+
+	cout << fixed << setprecision(1);
+	cout << "Packets: " << count << endl;
+	Report("Rebuild (before)", rebuild);
+	Report("Patch (after)", patch);
+	Report("Patch while sending", patchSending);
+	cout << "SPaTs encoded while sending: " << encodes << endl;
+
+	return 0;
+}
@@ -0,0 +1,321 @@
+/*
+ * SpatEngineScale.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ *
+ * Scale test for the multiple intersection mode of the SPaT plugin.  Local UDP stand-ins for the
+ * signal controllers broadcast NTCIP 1202 data at 10 Hz, one SpatEngine receives them all, and the
+ * SPaTs are encoded on the staggered schedule used by the plugin.
+ *
+ * Reports the SPaT rate of each intersection, the transmit jitter, the age of the controller data
+ * when its SPaT is encoded, the CPU used by the process and its number of threads.
+ *
+ * With "shared", every stand-in sends to one port from its own loopback address (127.0.0.2 and
+ * up), so the engine has to tell the controllers apart by address.  Otherwise each intersection
+ * has its own port, starting at the base port.
+ *
+ * Usage: SpatEngineScale [intersections] [seconds] [base port] [shared]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <dirent.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <DeadlineTimer.h>
+#include <PercentileStatistics.h>
+
+#include "../src/NTCIP1202.h"
+#include "../src/SpatEngine.h"
+
+using namespace std;
+using namespace tmx::messages;
+using namespace tmx::utils;
+using namespace SpatPlugin;
+
+#define SPAT_PERIOD_MS 100
+
+static const char *SignalGroupMapping = "{\"SignalGroups\":["
+		"{\"SignalGroupId\":1,\"Phase\":1,\"Type\":\"vehicle\"},{\"SignalGroupId\":2,\"Phase\":2,\"Type\":\"vehicle\"},"
+		"{\"SignalGroupId\":3,\"Phase\":3,\"Type\":\"vehicle\"},{\"SignalGroupId\":4,\"Phase\":4,\"Type\":\"vehicle\"},"
+		"{\"SignalGroupId\":5,\"Phase\":5,\"Type\":\"vehicle\"},{\"SignalGroupId\":6,\"Phase\":6,\"Type\":\"vehicle\"},"
+		"{\"SignalGroupId\":7,\"Phase\":7,\"Type\":\"vehicle\"},{\"SignalGroupId\":8,\"Phase\":8,\"Type\":\"vehicle\"},"
+		"{\"SignalGroupId\":22,\"Phase\":2,\"Type\":\"pedestrian\"},{\"SignalGroupId\":24,\"Phase\":4,\"Type\":\"pedestrian\"},"
+		"{\"SignalGroupId\":26,\"Phase\":6,\"Type\":\"pedestrian\"},{\"SignalGroupId\":28,\"Phase\":8,\"Type\":\"pedestrian\"}]}";
+
+/**
+ * Broadcasts from the signal controllers, each at 10 Hz and spread out over the period
+ * the way unsynchronized controllers would be.
+ */
+class StandInControllers
+{
+public:
+	StandInControllers(size_t count, int basePort, bool shared): _sent(count), _lastSent(count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+			if (shared)
+			{
+				// Send from a different loopback address for each controller
+				struct sockaddr_in local;
+				memset(&local, 0, sizeof(local));
+				local.sin_family = AF_INET;
+				local.sin_addr.s_addr = htonl(INADDR_LOOPBACK + 1 + i);
+				if (::bind(fd, (struct sockaddr *)&local, sizeof(local)) < 0)
+					perror("bind");
+			}
+
+			struct sockaddr_in dest;
+			memset(&dest, 0, sizeof(dest));
+			dest.sin_family = AF_INET;
+			dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			dest.sin_port = htons(shared ? basePort : basePort + i);
+			if (connect(fd, (struct sockaddr *)&dest, sizeof(dest)) < 0)
+				perror("connect");
+
+			_sockets.push_back(fd);
+		}
+	}
+
+	~StandInControllers()
+	{
+		Stop();
+		for (int fd : _sockets)
+			close(fd);
+	}
+
+	void Start()
+	{
+		_active = true;
+		_thread = thread(&StandInControllers::Run, this);
+	}
+
+	void Stop()
+	{
+		_active = false;
+		if (_thread.joinable())
+			_thread.join();
+	}
+
+	uint64_t get_Sent(size_t i) const { return _sent[i]; }
+	chrono::steady_clock::time_point get_LastSent(size_t i) const
+	{
+		return chrono::steady_clock::time_point(chrono::steady_clock::duration(_lastSent[i].load()));
+	}
+
+private:
+	void Run()
+	{
+		size_t count = _sockets.size();
+		DeadlineTimer timer(chrono::nanoseconds(chrono::milliseconds(SPAT_PERIOD_MS)) / (count ? count : 1));
+		uint8_t sequence = 0;
+
+		for (size_t slot = 0; _active; slot = (slot + 1) % count)
+		{
+			timer.WaitForNextDeadline();
+
+			if (slot == 0)
+				sequence++;
+
+			Ntcip1202Ext packet;
+			Fill(packet, slot, sequence);
+
+			if (send(_sockets[slot], &packet, sizeof(packet), 0) == sizeof(packet))
+			{
+				_sent[slot]++;
+				_lastSent[slot] = chrono::steady_clock::now().time_since_epoch().count();
+			}
+		}
+	}
+
+	static void Fill(Ntcip1202Ext &packet, size_t intersection, uint8_t sequence)
+	{
+		memset(&packet, 0, sizeof(packet));
+		packet.header = (int8_t)0xcd;
+		packet.numOfPhases = 8;
+
+		for (int p = 0; p < 8; p++)
+		{
+			Ntcip1202Ext_PhaseTime &phase = packet.phaseTimes[p];
+			phase.phaseNumber = p + 1;
+			phase.spatVehMinTimeToChange = htons(50 + 10 * p);
+			phase.spatVehMaxTimeToChange = htons(100 + 10 * p);
+			phase.spatPedMinTimeToChange = htons(50 + 10 * p);
+			phase.spatPedMaxTimeToChange = htons(100 + 10 * p);
+		}
+
+		// Cycle the main street through green, yellow and red every few seconds
+		int state = ((sequence / 30) + intersection) % 3;
+		uint16_t main = 0x22, side = 0xcc;
+		packet.phaseStatusGroupGreens = htons(state == 0 ? main : 0);
+		packet.phaseStatusGroupYellows = htons(state == 1 ? main : 0);
+		packet.phaseStatusGroupReds = htons(state == 2 ? main | side : side);
+		packet.phaseStatusGroupDontWalks = htons(0xff);
+		packet.spatMessageSeqCounter = sequence;
+
+		time_t now = time(NULL);
+		struct tm t;
+		gmtime_r(&now, &t);
+		packet.spatTimestamp_hr = t.tm_hour;
+		packet.spatTimestamp_min = t.tm_min;
+		packet.spatTimestamp_sec = t.tm_sec;
+	}
+
+	vector<int> _sockets;
+	vector<atomic<uint64_t> > _sent;
+	vector<atomic<chrono::steady_clock::rep> > _lastSent;
+	atomic<bool> _active {false};
+	thread _thread;
+};
+
+static double CpuSeconds()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static int ThreadCount()
+{
+	int count = 0;
+	DIR *dir = opendir("/proc/self/task");
+	if (dir == NULL)
+		return -1;
+
+	while (struct dirent *entry = readdir(dir))
+	{
+		if (entry->d_name[0] != '.')
+			count++;
+	}
+
+	closedir(dir);
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t count = argc > 1 ? atoi(argv[1]) : 32;
+	int seconds = argc > 2 ? atoi(argv[2]) : 10;
+	int basePort = argc > 3 ? atoi(argv[3]) : 16053;
+	bool shared = argc > 4 && string(argv[4]) == "shared";
+
+	if (count < 1)
+		count = 1;
+
+	vector<SpatEngine::IntersectionConfig> configs;
+	for (size_t i = 0; i < count; i++)
+	{
+		SpatEngine::IntersectionConfig config;
+		config.id = i + 1;
+		config.name = "Intersection " + to_string(i + 1);
+		config.localIp = "127.0.0.1";
+		config.localUdpPort = to_string(shared ? basePort : basePort + (int)i);
+		config.tscIp = shared ? string(inet_ntoa(in_addr { htonl(INADDR_LOOPBACK + 1 + i) })) : "127.0.0.1";
+		// Nothing answers SNMP here, so the enable requests just time out in the background
+		config.tscRemoteSnmpPort = "1";
+		config.signalGroupMappingJson = SignalGroupMapping;
+		configs.push_back(config);
+	}
+
+	SpatEngine engine;
+	if (!engine.Start(configs))
+	{
+		cerr << "Unable to start the engine" << endl;
+		return 1;
+	}
+
+	StandInControllers controllers(count, basePort, shared);
+	controllers.Start();
+
+	// Let the first packets arrive so every SPaT has been built
+	this_thread::sleep_for(chrono::milliseconds(500));
+
+	vector<unique_ptr<SpatEncodedMessage> > messages;
+	for (size_t i = 0; i < count; i++)
+		messages.emplace_back(new SpatEncodedMessage());
+
+	vector<uint64_t> spats(count, 0);
+	PercentileStatistics jitter(100000);
+	PercentileStatistics age(100000);
+	PercentileStatistics encode(100000);
+
+	double cpuStart = CpuSeconds();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	chrono::steady_clock::time_point end = start + chrono::seconds(seconds);
+
+	DeadlineTimer timer(engine.get_SlotPeriod(chrono::milliseconds(SPAT_PERIOD_MS)));
+	size_t slot = 0;
+
+	while (chrono::steady_clock::now() < end)
+	{
+		chrono::nanoseconds late = timer.WaitForNextDeadline();
+		jitter.Add(chrono::duration_cast<chrono::microseconds>(late).count());
+
+		size_t index = slot;
+		slot = (slot + 1) % count;
+
+		SignalController &controller = engine.get_Controller(index);
+		if (!controller.getIsConnected())
+			continue;
+
+		chrono::steady_clock::time_point before = chrono::steady_clock::now();
+		if (controller.getEncodedSpat(messages[index].get()))
+		{
+			chrono::steady_clock::time_point after = chrono::steady_clock::now();
+			encode.Add(chrono::duration_cast<chrono::microseconds>(after - before).count());
+			age.Add(chrono::duration_cast<chrono::microseconds>(after - controllers.get_LastSent(index)).count());
+		}
+
+		spats[index]++;
+	}
+
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	double cpu = CpuSeconds() - cpuStart;
+	int threads = ThreadCount();
+
+	controllers.Stop();
+
+	uint64_t sent = 0;
+	for (size_t i = 0; i < count; i++)
+		sent += controllers.get_Sent(i);
+
+	double minRate = 1e9, maxRate = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		minRate = min(minRate, spats[i] / elapsed);
+		maxRate = max(maxRate, spats[i] / elapsed);
+	}
+
+	cout << fixed << setprecision(3);
+	cout << "Intersections:            " << count << (shared ? " on one shared port" : " on separate ports") << endl;
+	cout << "Connected:                " << engine.get_ConnectedCount() << " of " << engine.Count() << endl;
+	cout << "Packets sent / received:  " << sent << " / " << engine.get_PacketCount()
+			<< " (" << engine.get_UnknownPacketCount() << " unknown)" << endl;
+	cout << "SPaT rate per intersection (Hz): min " << minRate << ", max " << maxRate << endl;
+	cout << "Transmit jitter (ms):     P50 " << jitter.Percentile(50) / 1000.0 << ", P99 "
+			<< jitter.Percentile(99) / 1000.0 << ", max " << jitter.Max() / 1000.0 << endl;
+	cout << "Data age at encode (ms):  P50 " << age.Percentile(50) / 1000.0 << ", P99 "
+			<< age.Percentile(99) / 1000.0 << ", max " << age.Max() / 1000.0 << endl;
+	cout << "Encode time (ms):         P50 " << encode.Percentile(50) / 1000.0 << ", P99 "
+			<< encode.Percentile(99) / 1000.0 << endl;
+	cout << "CPU:                      " << 100.0 * cpu / elapsed << "% of one core, including the stand-ins" << endl;
+	cout << "Threads:                  " << threads << endl;
+
+	engine.Stop();
+
+	return 0;
+}
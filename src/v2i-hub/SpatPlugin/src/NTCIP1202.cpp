@@ -52,6 +52,16 @@ void Ntcip1202::setSignalGroupMappingList(string json)
 		sgm.Type = typeName;
 
 		signalGroupMappingList.push_back(sgm);
+
+		if (signalGroupId > 0)
+		{
+			if (boost::iequals(typeName, "vehicle"))
+				_vehicleSignalGroups.push_back(sgm);
+			else if (boost::iequals(typeName, "pedestrian"))
+				_pedestrianSignalGroups.push_back(sgm);
+			else if (boost::iequals(typeName, "overlap"))
+				_overlapSignalGroups.push_back(sgm);
+		}
 	}
 }
 
@@ -64,7 +74,7 @@ void Ntcip1202::copyBytesIntoNtcip1202(char* buff, int numBytes)
 	unsigned char * vptr = (unsigned char *)&(ntcip1202Data);
 
 	// map phase to array index for later use
-	_phaseToIndexMapping.clear();
+	memset(_phaseToIndexMapping, 0, sizeof(_phaseToIndexMapping));
 	for (int i = 0;i < 16;i++)
 	{
 		if (ntcip1202Data.phaseTimes[i].phaseNumber > 0)
@@ -81,32 +91,32 @@ void Ntcip1202::copyBytesIntoNtcip1202(char* buff, int numBytes)
 
 uint16_t Ntcip1202::getVehicleMinTime(int phaseNumber)
 {
-	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[phaseNumber]].spatVehMinTimeToChange)));
+	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[(uint8_t)phaseNumber]].spatVehMinTimeToChange)));
 }
 
 uint16_t Ntcip1202::getVehicleMaxTime(int phaseNumber)
 {
-	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[phaseNumber]].spatVehMaxTimeToChange)));
+	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[(uint8_t)phaseNumber]].spatVehMaxTimeToChange)));
 }
 
 uint16_t Ntcip1202::getPedMinTime(int phaseNumber)
 {
-	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[phaseNumber]].spatPedMinTimeToChange)));
+	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[(uint8_t)phaseNumber]].spatPedMinTimeToChange)));
 }
 
 uint16_t Ntcip1202::getPedMaxTime(int phaseNumber)
 {
-	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[phaseNumber]].spatPedMaxTimeToChange)));
+	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[(uint8_t)phaseNumber]].spatPedMaxTimeToChange)));
 }
 
 uint16_t Ntcip1202::getOverlapMinTime(int phaseNumber)
 {
-	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[phaseNumber]].spatOvlpMinTimeToChange)));
+	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[(uint8_t)phaseNumber]].spatOvlpMinTimeToChange)));
 }
 
 uint16_t Ntcip1202::getOverlapMaxTime(int phaseNumber)
 {
-	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[phaseNumber]].spatOvpMaxTimeToChange)));
+	return ((ntohs(ntcip1202Data.phaseTimes[_phaseToIndexMapping[(uint8_t)phaseNumber]].spatOvpMaxTimeToChange)));
 }
 
 bool Ntcip1202::getPhaseFlashingStatus(int phaseNumber)
@@ -217,20 +227,27 @@ void Ntcip1202::printDebug()
 
 }
 
-bool Ntcip1202::ToJ2735r41SPAT(SPAT* spat, char* intersectionName, IntersectionID_t intersectionId)
+void Ntcip1202::getSpatTimeStamp(long &minOfYear, long &msOfMin)
 {
 	chrono::system_clock::time_point now = chrono::system_clock::now();
 	time_t tt = chrono::system_clock::to_time_t(now);
-	struct tm * utctime = gmtime( &tt );
+	struct tm utctime;
+	gmtime_r(&tt, &utctime);
 
 	// In SPAT, the time stamp is split into minute of the year and millisecond of the minute
 	// Calculate the minute of the year
-	long minOfYear = utctime->tm_min + (utctime->tm_hour * 60) + (utctime->tm_yday * 24 * 60);
+	minOfYear = utctime.tm_min + (utctime.tm_hour * 60) + (utctime.tm_yday * 24 * 60);
 
 	// Calculate the millisecond of the minute
 	chrono::milliseconds epochMs = chrono::duration_cast<chrono::milliseconds>(now.time_since_epoch());
 	chrono::seconds epochS = chrono::duration_cast<chrono::seconds>(epochMs);
-	long msOfMin = 1000 * (epochS.count() % 60) + (epochMs.count() % 1000);
+	msOfMin = 1000 * (epochS.count() % 60) + (epochMs.count() % 1000);
+}
+
+bool Ntcip1202::ToJ2735r41SPAT(SPAT* spat, char* intersectionName, IntersectionID_t intersectionId)
+{
+	long minOfYear, msOfMin;
+	getSpatTimeStamp(minOfYear, msOfMin);
 
 	std::lock_guard<std::mutex> lock(_spat_lock);
 
@@ -269,53 +286,42 @@ bool Ntcip1202::ToJ2735r41SPAT(SPAT* spat, char* intersectionName, IntersectionI
 	{
 		int phase = ntcip1202Data.phaseTimes[m].phaseNumber;
 
-		for(std::list<SignalGroupMapping>::iterator it = signalGroupMappingList.begin(); it != signalGroupMappingList.end(); it++)
+		for (const SignalGroupMapping &sgm : _vehicleSignalGroups)
 		{
-			if(it->PhaseId == phase && boost::iequals(it->Type,"vehicle"))
+			if(sgm.PhaseId == phase)
 			{
-				if(it->SignalGroupId > 0)
-				{
-					MovementState *movement = (MovementState *) calloc(1, sizeof(MovementState));
-					movement->signalGroup = it->SignalGroupId;
+				MovementState *movement = (MovementState *) calloc(1, sizeof(MovementState));
+				movement->signalGroup = sgm.SignalGroupId;
 
-					populateVehicleSignalGroup(movement, phase);
-
-					ASN_SEQUENCE_ADD(&intersection->states.list, movement);
-				}
+				populateVehicleSignalGroup(movement, phase);
 
+				ASN_SEQUENCE_ADD(&intersection->states.list, movement);
 			}
 		}
 
-		for(std::list<SignalGroupMapping>::iterator it = signalGroupMappingList.begin(); it != signalGroupMappingList.end(); it++)
+		for (const SignalGroupMapping &sgm : _pedestrianSignalGroups)
 		{
-			if(it->PhaseId == phase && boost::iequals(it->Type,"pedestrian"))
+			if(sgm.PhaseId == phase)
 			{
-				if(it->SignalGroupId > 0)
-				{
-					MovementState *movement = (MovementState *) calloc(1, sizeof(MovementState));
-					movement->signalGroup = it->SignalGroupId;
+				MovementState *movement = (MovementState *) calloc(1, sizeof(MovementState));
+				movement->signalGroup = sgm.SignalGroupId;
 
-					populatePedestrianSignalGroup(movement, phase);
+				populatePedestrianSignalGroup(movement, phase);
 
-					ASN_SEQUENCE_ADD(&intersection->states.list, movement);
-				}
+				ASN_SEQUENCE_ADD(&intersection->states.list, movement);
 			}
 		}
 
-		for(std::list<SignalGroupMapping>::iterator it = signalGroupMappingList.begin(); it != signalGroupMappingList.end(); it++)
+		for (const SignalGroupMapping &sgm : _overlapSignalGroups)
 		{
-			if(it->PhaseId == phase && boost::iequals(it->Type,"overlap"))
+			if(sgm.PhaseId == phase)
 			{
-				if(it->SignalGroupId > 0)
-				{
-					MovementState *movement = (MovementState *) calloc(1, sizeof(MovementState));
-					movement->signalGroup = it->SignalGroupId;
-
-					populateOverlapSignalGroup(movement, phase);
+				MovementState *movement = (MovementState *) calloc(1, sizeof(MovementState));
+				movement->signalGroup = sgm.SignalGroupId;
 
-					ASN_SEQUENCE_ADD(&intersection->states.list, movement);
-				}
+				populateOverlapSignalGroup(movement, phase);
 
+				ASN_SEQUENCE_ADD(&intersection->states.list, movement);
 			}
 		}
 
@@ -327,40 +333,184 @@ bool Ntcip1202::ToJ2735r41SPAT(SPAT* spat, char* intersectionName, IntersectionI
 	return true;
 }
 
-void Ntcip1202::populateVehicleSignalGroup(MovementState *movement, int phase)
+bool Ntcip1202::UpdateJ2735r41SPAT(SPAT* spat, IntersectionID_t intersectionId)
 {
-	MovementEvent *stateTimeSpeed = (MovementEvent *) calloc(1, sizeof(MovementEvent));
+	long minOfYear, msOfMin;
+	getSpatTimeStamp(minOfYear, msOfMin);
+
+	std::lock_guard<std::mutex> lock(_spat_lock);
+
+	if (!spat || spat->intersections.list.count != 1)
+		return false;
+
+	IntersectionState *intersection = spat->intersections.list.array[0];
+	if (!intersection || intersection->id.id != intersectionId ||
+			!intersection->moy || !intersection->timeStamp || intersection->status.size != 2)
+		return false;
+
+	*(intersection->moy) = minOfYear;
+	*(intersection->timeStamp) = msOfMin;
+
+	uint16_t statusIntersection = ntcip1202Data.spatIntersectionStatus;
+	intersection->status.buf[1] = statusIntersection;
+	intersection->status.buf[0] = (statusIntersection >> 8);
+
+	// Walk the movements in the same order they were added by ToJ2735r41SPAT
+	int index = 0;
+	int count = intersection->states.list.count;
+
+	for (int m = 0; m < 16; m++)
+	{
+		int phase = ntcip1202Data.phaseTimes[m].phaseNumber;
+
+		for (const SignalGroupMapping &sgm : _vehicleSignalGroups)
+		{
+			if(sgm.PhaseId == phase)
+			{
+				if (index >= count || intersection->states.list.array[index]->signalGroup != sgm.SignalGroupId)
+					return false;
+
+				if (!updateSignalGroup(intersection->states.list.array[index++], getVehicleMovementPhaseState(phase),
+						getVehicleMinTime(phase), getVehicleMaxTime(phase), getVehicleMaxTime(phase) > 0, false))
+					return false;
+			}
+		}
+
+		for (const SignalGroupMapping &sgm : _pedestrianSignalGroups)
+		{
+			if(sgm.PhaseId == phase)
+			{
+				if (index >= count || intersection->states.list.array[index]->signalGroup != sgm.SignalGroupId)
+					return false;
+
+				if (!updateSignalGroup(intersection->states.list.array[index++], getPedestrianMovementPhaseState(phase),
+						getPedMinTime(phase), getPedMaxTime(phase), ntcip1202Data.phaseTimes[phase].spatPedMaxTimeToChange > 0,
+						getSpatPedestrianDetect(phase)))
+					return false;
+			}
+		}
+
+		for (const SignalGroupMapping &sgm : _overlapSignalGroups)
+		{
+			if(sgm.PhaseId == phase)
+			{
+				if (index >= count || intersection->states.list.array[index]->signalGroup != sgm.SignalGroupId)
+					return false;
+
+				if (!updateSignalGroup(intersection->states.list.array[index++], getOverlapMovementPhaseState(phase),
+						getOverlapMinTime(phase), getOverlapMaxTime(phase), getOverlapMaxTime(phase) > 0, false))
+					return false;
+			}
+		}
+	}
+
+	return index == count;
+}
+
+bool Ntcip1202::updateSignalGroup(MovementState *movement, e_MovementPhaseState state,
+		uint16_t minTime, uint16_t maxTime, bool hasMaxTime, bool pedDetect)
+{
+	if (!movement || movement->state_time_speed.list.count != 1)
+		return false;
+
+	MovementEvent *stateTimeSpeed = movement->state_time_speed.list.array[0];
+	if (!stateTimeSpeed || !stateTimeSpeed->timing)
+		return false;
+
+	// A change in the optional fields present changes the structure of the message
+	if ((stateTimeSpeed->timing->maxEndTime != NULL) != hasMaxTime)
+		return false;
+	if ((movement->maneuverAssistList != NULL) != pedDetect)
+		return false;
+
+	stateTimeSpeed->eventState = state;
+	stateTimeSpeed->timing->minEndTime = getAdjustedTime(minTime);
+
+	if (hasMaxTime)
+		*(stateTimeSpeed->timing->maxEndTime) = getAdjustedTime(maxTime);
+
+	return true;
+}
 
+e_MovementPhaseState Ntcip1202::getVehicleMovementPhaseState(int phase)
+{
 	bool isFlashing = getPhaseFlashingStatus(phase);
 	bool forceFlashing = isFlashingStatus() && !isPhaseFlashing();
 
 	if(forceFlashing || getPhaseRedStatus(phase))
 	{
 		if(forceFlashing || isFlashing)
-			stateTimeSpeed->eventState = MovementPhaseState_stop_Then_Proceed;
+			return MovementPhaseState_stop_Then_Proceed;
 		else
-			stateTimeSpeed->eventState = MovementPhaseState_stop_And_Remain;
+			return MovementPhaseState_stop_And_Remain;
 	}
 	else if(getPhaseYellowStatus(phase))
 	{
 		if(isFlashing)
-			stateTimeSpeed->eventState = MovementPhaseState_caution_Conflicting_Traffic;
+			return MovementPhaseState_caution_Conflicting_Traffic;
 		else
 		{
 			//TODO Add protected and permissive
-			stateTimeSpeed->eventState = MovementPhaseState_protected_clearance;
+			return MovementPhaseState_protected_clearance;
 		}
 	}
 	else if(getPhaseGreensStatus(phase))
 	{
 		//TODO Add protected and permissive
-		stateTimeSpeed->eventState = MovementPhaseState_permissive_Movement_Allowed;
+		return MovementPhaseState_permissive_Movement_Allowed;
 	}
-	else
+
+	return MovementPhaseState_dark;
+}
+
+e_MovementPhaseState Ntcip1202::getPedestrianMovementPhaseState(int phase)
+{
+	if(getPhaseDontWalkStatus(phase))
+		return MovementPhaseState_stop_And_Remain;
+	else if(getPhasePedClearsStatus(phase))
+		return MovementPhaseState_protected_clearance;
+	else if(getPhaseWalkStatus(phase))
+		return MovementPhaseState_permissive_Movement_Allowed;
+
+	return MovementPhaseState_dark;
+}
+
+e_MovementPhaseState Ntcip1202::getOverlapMovementPhaseState(int phase)
+{
+	bool isFlashing = getOverlapFlashingStatus(phase);
+
+	if(getOverlapRedStatus(phase))
+	{
+		if(isFlashing)
+			return MovementPhaseState_stop_Then_Proceed;
+		else
+			return MovementPhaseState_stop_And_Remain;
+	}
+	else if(getOverlapYellowStatus(phase))
+	{
+		if(isFlashing)
+			return MovementPhaseState_caution_Conflicting_Traffic;
+		else
+		{
+			//TODO Add protected and permissive
+			return MovementPhaseState_protected_clearance;
+		}
+	}
+	else if(getOverlapGreenStatus(phase))
 	{
-		stateTimeSpeed->eventState = MovementPhaseState_dark;
+		//TODO Add protected and permissive
+		return MovementPhaseState_permissive_Movement_Allowed;
 	}
 
+	return MovementPhaseState_dark;
+}
+
+void Ntcip1202::populateVehicleSignalGroup(MovementState *movement, int phase)
+{
+	MovementEvent *stateTimeSpeed = (MovementEvent *) calloc(1, sizeof(MovementEvent));
+
+	stateTimeSpeed->eventState = getVehicleMovementPhaseState(phase);
+
 	stateTimeSpeed->timing = (TimeChangeDetails * ) calloc(1, sizeof(TimeChangeDetails));
 	stateTimeSpeed->timing->minEndTime =  getAdjustedTime(getVehicleMinTime(phase));
 
@@ -389,22 +539,7 @@ void Ntcip1202::populatePedestrianSignalGroup(MovementState *movement, int phase
 {
 	MovementEvent *stateTimeSpeed = (MovementEvent *) calloc(1, sizeof(MovementEvent));
 
-	if(getPhaseDontWalkStatus(phase))
-	{
-		stateTimeSpeed->eventState = MovementPhaseState_stop_And_Remain;
-	}
-	else if(getPhasePedClearsStatus(phase))
-	{
-		stateTimeSpeed->eventState = MovementPhaseState_protected_clearance;
-	}
-	else if(getPhaseWalkStatus(phase))
-	{
-		stateTimeSpeed->eventState = MovementPhaseState_permissive_Movement_Allowed;
-	}
-	else
-	{
-		stateTimeSpeed->eventState = MovementPhaseState_dark;
-	}
+	stateTimeSpeed->eventState = getPedestrianMovementPhaseState(phase);
 
 	stateTimeSpeed->timing = (TimeChangeDetails * ) calloc(1, sizeof(TimeChangeDetails));
 	stateTimeSpeed->timing->minEndTime =  getAdjustedTime(getPedMinTime(phase));
@@ -432,35 +567,7 @@ void Ntcip1202::populateOverlapSignalGroup(MovementState *movement, int phase)
 {
 	MovementEvent *stateTimeSpeed = (MovementEvent *) calloc(1, sizeof(MovementEvent));
 
-	bool isFlashing = getOverlapFlashingStatus(phase);
-
-
-	if(getOverlapRedStatus(phase))
-	{
-		if(isFlashing)
-			stateTimeSpeed->eventState = MovementPhaseState_stop_Then_Proceed;
-		else
-			stateTimeSpeed->eventState = MovementPhaseState_stop_And_Remain;
-	}
-	else if(getOverlapYellowStatus(phase))
-	{
-		if(isFlashing)
-			stateTimeSpeed->eventState = MovementPhaseState_caution_Conflicting_Traffic;
-		else
-		{
-			//TODO Add protected and permissive
-			stateTimeSpeed->eventState = MovementPhaseState_protected_clearance;
-		}
-	}
-	else if(getOverlapGreenStatus(phase))
-	{
-		//TODO Add protected and permissive
-		stateTimeSpeed->eventState = MovementPhaseState_permissive_Movement_Allowed;
-	}
-	else
-	{
-		stateTimeSpeed->eventState = MovementPhaseState_dark;
-	}
+	stateTimeSpeed->eventState = getOverlapMovementPhaseState(phase);
 
 	stateTimeSpeed->timing = (TimeChangeDetails * ) calloc(1, sizeof(TimeChangeDetails));
 	stateTimeSpeed->timing->minEndTime =  getAdjustedTime(getOverlapMinTime(phase));
@@ -10,6 +10,7 @@
 
 #include <mutex>
 #include <list>
+#include <vector>
 
 #include <tmx/j2735_messages/SpatMessage.hpp>
 
@@ -102,16 +103,34 @@ class Ntcip1202
 
 		bool ToJ2735r41SPAT(SPAT* spat, char* intersectionName, IntersectionID_t intersectionId);
 
+		/**
+		 * Patch the time stamp, status, movement states and timing of a SPAT that was previously
+		 * built by ToJ2735r41SPAT with the current controller data, without reallocating it.
+		 *
+		 * @return False if the structure of the SPAT no longer matches the controller data
+		 * (e.g. the phases or the optional fields present have changed), in which case nothing
+		 * is guaranteed about the contents and the SPAT must be rebuilt with ToJ2735r41SPAT.
+		 */
+		bool UpdateJ2735r41SPAT(SPAT* spat, IntersectionID_t intersectionId);
+
 		void printDebug();
 	private:
 
 		Ntcip1202Ext ntcip1202Data;
-		std::map<uint8_t, int> _phaseToIndexMapping;
+
+		// The index into phaseTimes of each phase number, filled in for each packet
+		uint8_t _phaseToIndexMapping[256];
 
 		std::mutex _spat_lock;
 
 		list<SignalGroupMapping> signalGroupMappingList;
 
+		// The mapped signal groups split by type, in the order of the list, so the SPaT can be
+		// built and patched without comparing the type names for every packet
+		vector<SignalGroupMapping> _vehicleSignalGroups;
+		vector<SignalGroupMapping> _pedestrianSignalGroups;
+		vector<SignalGroupMapping> _overlapSignalGroups;
+
 		int getVehicleSignalGroupForPhase(int phase);
 		int getPedestrianSignalGroupForPhase(int phase);
 
@@ -119,6 +138,15 @@ class Ntcip1202
 		void populatePedestrianSignalGroup(MovementState *movement, int phase);
 		void populateOverlapSignalGroup(MovementState *movement, int phase);
 
+		e_MovementPhaseState getVehicleMovementPhaseState(int phase);
+		e_MovementPhaseState getPedestrianMovementPhaseState(int phase);
+		e_MovementPhaseState getOverlapMovementPhaseState(int phase);
+
+		bool updateSignalGroup(MovementState *movement, e_MovementPhaseState state,
+				uint16_t minTime, uint16_t maxTime, bool hasMaxTime, bool pedDetect);
+
+		void getSpatTimeStamp(long &minOfYear, long &msOfMin);
+
 		long getAdjustedTime(unsigned int offset);
 };
 
@@ -0,0 +1,421 @@
+/*
+ * SpatEngine.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#include "SpatEngine.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <map>
+#include <sstream>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#ifndef __CYGWIN__
+#include <sys/prctl.h>
+#endif
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace SpatPlugin {
+
+// The time without a broadcast after which an intersection is disconnected, and SPaT enabled again
+#define SPAT_ENGINE_RECEIVE_TIMEOUT_S 10
+
+// The largest packet read from a controller
+#define SPAT_ENGINE_MAX_PACKET 1000
+
+// The number of sockets handled from each call to epoll_wait
+#define SPAT_ENGINE_MAX_EVENTS 64
+
+struct SpatEngine::Intersection
+{
+	IntersectionConfig config;
+	SignalController controller;
+	chrono::steady_clock::time_point lastReceive;
+	bool receiving = false;
+	struct in_addr tscAddress;
+};
+
+struct SpatEngine::Socket
+{
+	int fd = -1;
+	string localIp;
+	string localUdpPort;
+	// The intersections that broadcast to this socket
+	vector<Intersection *> intersections;
+};
+
+vector<SpatEngine::IntersectionConfig> SpatEngine::ParseConfig(const string &json, const IntersectionConfig &defaults)
+{
+	vector<IntersectionConfig> intersections;
+
+	if (json.empty())
+		return intersections;
+
+	// The property tree needs an object at the top, so wrap the array in one
+	boost::property_tree::ptree pt;
+	istringstream is("{\"Intersections\":" + json + "}");
+	boost::property_tree::read_json(is, pt);
+
+	for (auto &child : pt.get_child("Intersections"))
+	{
+		const boost::property_tree::ptree &node = child.second;
+
+		IntersectionConfig config = defaults;
+		config.id = node.get<int>("Id", defaults.id);
+		config.name = node.get<string>("Name", defaults.name);
+		config.localIp = node.get<string>("LocalIp", defaults.localIp);
+		config.localUdpPort = node.get<string>("LocalUdpPort", defaults.localUdpPort);
+		config.tscIp = node.get<string>("TscIp", defaults.tscIp);
+		config.tscRemoteSnmpPort = node.get<string>("TscRemoteSnmpPort", defaults.tscRemoteSnmpPort);
+
+		// The mapping may be given either as an object or as a string of JSON
+		boost::optional<const boost::property_tree::ptree &> mapping = node.get_child_optional("SignalGroupMapping");
+		if (mapping)
+		{
+			if (mapping->empty())
+			{
+				config.signalGroupMappingJson = mapping->data();
+			}
+			else
+			{
+				ostringstream os;
+				boost::property_tree::write_json(os, *mapping, false);
+				config.signalGroupMappingJson = os.str();
+			}
+		}
+
+		intersections.push_back(config);
+	}
+
+	return intersections;
+}
+
+SpatEngine::SpatEngine()
+{
+}
+
+SpatEngine::~SpatEngine()
+{
+	Stop();
+}
+
+bool SpatEngine::Start(const vector<IntersectionConfig> &intersections)
+{
+	Stop();
+
+	_epollFd = epoll_create1(EPOLL_CLOEXEC);
+	_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_epollFd < 0 || _wakeFd < 0)
+	{
+		PLOG(logERROR) << "Unable to create the SPaT event loop: " << strerror(errno);
+		Close();
+		return false;
+	}
+
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+	epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &event);
+
+	map<string, Socket *> sockets;
+
+	for (const IntersectionConfig &config : intersections)
+	{
+		unique_ptr<Intersection> intersection(new Intersection());
+		intersection->config = config;
+		intersection->controller.setConfigs(config.localIp, config.localUdpPort, config.tscIp,
+				config.tscRemoteSnmpPort, "", config.name, config.id);
+		intersection->controller.Initialize(config.signalGroupMappingJson);
+		intersection->lastReceive = chrono::steady_clock::now();
+
+		if (inet_pton(AF_INET, config.tscIp.c_str(), &intersection->tscAddress) != 1)
+			intersection->tscAddress.s_addr = INADDR_ANY;
+
+		// Controllers that broadcast to the same address share one socket
+		string key = config.localIp + ":" + config.localUdpPort;
+		Socket *socket = sockets[key];
+		if (socket == NULL)
+		{
+			struct addrinfo hints, *servinfo;
+			memset(&hints, 0, sizeof hints);
+			hints.ai_family = AF_INET;
+			hints.ai_socktype = SOCK_DGRAM;
+			hints.ai_protocol = IPPROTO_UDP;
+			hints.ai_flags = AI_PASSIVE;
+
+			int rv = getaddrinfo(config.localIp.empty() ? NULL : config.localIp.c_str(),
+					config.localUdpPort.c_str(), &hints, &servinfo);
+			if (rv != 0)
+			{
+				PLOG(logERROR) << "Getaddrinfo Failed " << key << ": " << gai_strerror(rv);
+				Close();
+				return false;
+			}
+
+			unique_ptr<Socket> s(new Socket());
+			s->localIp = config.localIp;
+			s->localUdpPort = config.localUdpPort;
+			s->fd = ::socket(servinfo->ai_family, servinfo->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, servinfo->ai_protocol);
+
+			int on = 1;
+			if (s->fd < 0 ||
+				setsockopt(s->fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0 ||
+				bind(s->fd, servinfo->ai_addr, servinfo->ai_addrlen) < 0)
+			{
+				PLOG(logERROR) << "Could not bind to Socket " << key << ": " << strerror(errno);
+				freeaddrinfo(servinfo);
+				if (s->fd >= 0)
+					close(s->fd);
+				Close();
+				return false;
+			}
+
+			freeaddrinfo(servinfo);
+
+			memset(&event, 0, sizeof(event));
+			event.events = EPOLLIN;
+			event.data.ptr = s.get();
+			epoll_ctl(_epollFd, EPOLL_CTL_ADD, s->fd, &event);
+
+			socket = s.get();
+			sockets[key] = socket;
+			_sockets.push_back(move(s));
+		}
+
+		socket->intersections.push_back(intersection.get());
+		_intersections.push_back(move(intersection));
+	}
+
+	PLOG(logINFO) << "Receiving from " << _intersections.size() << " signal controllers on "
+			<< _sockets.size() << " sockets";
+
+	for (auto &intersection : _intersections)
+		EnableSpat(intersection.get());
+
+	_active = true;
+	_thread = thread(&SpatEngine::Run, this);
+
+	return true;
+}
+
+void SpatEngine::Stop()
+{
+	if (_thread.joinable())
+	{
+		_active = false;
+
+		uint64_t one = 1;
+		if (write(_wakeFd, &one, sizeof(one)) < 0)
+			PLOG(logWARNING) << "Unable to wake the SPaT event loop: " << strerror(errno);
+
+		_thread.join();
+	}
+
+	Close();
+}
+
+void SpatEngine::Close()
+{
+	for (auto &socket : _sockets)
+	{
+		if (socket->fd >= 0)
+			close(socket->fd);
+	}
+
+	if (_epollFd >= 0)
+		close(_epollFd);
+	if (_wakeFd >= 0)
+		close(_wakeFd);
+
+	_epollFd = -1;
+	_wakeFd = -1;
+
+	_sockets.clear();
+
+	for (auto &intersection : _intersections)
+		intersection->controller.SNMPCloseSession();
+
+	_intersections.clear();
+}
+
+size_t SpatEngine::Count() const
+{
+	return _intersections.size();
+}
+
+SignalController &SpatEngine::get_Controller(size_t index)
+{
+	return _intersections[index]->controller;
+}
+
+const SpatEngine::IntersectionConfig &SpatEngine::get_Config(size_t index) const
+{
+	return _intersections[index]->config;
+}
+
+chrono::nanoseconds SpatEngine::get_SlotPeriod(chrono::nanoseconds spatPeriod) const
+{
+	if (_intersections.empty())
+		return spatPeriod;
+
+	return spatPeriod / _intersections.size();
+}
+
+size_t SpatEngine::get_ConnectedCount() const
+{
+	size_t count = 0;
+	for (auto &intersection : _intersections)
+	{
+		if (intersection->controller.getIsConnected())
+			count++;
+	}
+
+	return count;
+}
+
+uint64_t SpatEngine::get_PacketCount() const
+{
+	return _packets;
+}
+
+uint64_t SpatEngine::get_UnknownPacketCount() const
+{
+	return _unknownPackets;
+}
+
+void SpatEngine::EnableSpat(Intersection *intersection)
+{
+	// 2 = enable SPaT.  The answer is not waited for, so one controller that is
+	// down does not hold up the others.
+	PLOG(logINFO) << "Enable SPAT Sent to " << intersection->config.name;
+	intersection->controller.SNMPSetAsync(TSC_ENABLE_SPAT_OID, 2);
+}
+
+void SpatEngine::Run()
+{
+#ifndef __CYGWIN__
+	prctl(PR_SET_NAME, "SpatEngine", 0, 0, 0);
+#endif
+
+	struct epoll_event events[SPAT_ENGINE_MAX_EVENTS];
+	chrono::steady_clock::time_point lastCheck = chrono::steady_clock::now();
+
+	while (_active)
+	{
+		// Wake at least once a second to check for controllers that have gone quiet
+		int n = epoll_wait(_epollFd, events, SPAT_ENGINE_MAX_EVENTS, 1000);
+		if (n < 0 && errno != EINTR)
+		{
+			PLOG(logERROR) << "SPaT event loop failed: " << strerror(errno);
+			break;
+		}
+
+		for (int i = 0; i < n; i++)
+		{
+			if (events[i].data.ptr != NULL)
+				Receive((Socket *)events[i].data.ptr);
+		}
+
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		if (now - lastCheck < chrono::seconds(1))
+			continue;
+		lastCheck = now;
+
+		for (auto &intersection : _intersections)
+		{
+			if (now - intersection->lastReceive <= chrono::seconds(SPAT_ENGINE_RECEIVE_TIMEOUT_S))
+				continue;
+
+			if (intersection->receiving)
+			{
+				PLOG(logINFO) << "Signal Controller " << intersection->config.name << " Timed out";
+				intersection->receiving = false;
+				intersection->controller.setIsReceiving(false);
+			}
+
+			// Ask again for the broadcasts every time the timeout passes without any
+			intersection->lastReceive = now;
+			EnableSpat(intersection.get());
+		}
+	}
+}
+
+void SpatEngine::Receive(Socket *socket)
+{
+	char buf[SPAT_ENGINE_MAX_PACKET];
+	struct sockaddr_in from;
+
+	// Read until the socket is empty, so one wake handles a burst from several controllers
+	while (true)
+	{
+		socklen_t fromLen = sizeof(from);
+		ssize_t numbytes = recvfrom(socket->fd, buf, sizeof(buf), 0, (struct sockaddr *)&from, &fromLen);
+		if (numbytes < 0)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				PLOG(logWARNING) << "Receive failed on " << socket->localIp << ":" << socket->localUdpPort << ": " << strerror(errno);
+			return;
+		}
+
+		if (numbytes == 0)
+			continue;
+
+		_packets++;
+
+		// A socket used by one controller takes any packet, as the single controller mode does
+		Intersection *intersection = NULL;
+		if (socket->intersections.size() == 1)
+		{
+			intersection = socket->intersections[0];
+		}
+		else
+		{
+			for (Intersection *i : socket->intersections)
+			{
+				if (i->tscAddress.s_addr == from.sin_addr.s_addr)
+				{
+					intersection = i;
+					break;
+				}
+			}
+		}
+
+		if (intersection == NULL)
+		{
+			if (_unknownPackets++ == 0)
+			{
+				char address[INET_ADDRSTRLEN];
+				inet_ntop(AF_INET, &from.sin_addr, address, sizeof(address));
+				PLOG(logWARNING) << "Dropping packets from " << address << ", which is not a configured TSC";
+			}
+			continue;
+		}
+
+		intersection->controller.ProcessPacket(buf, numbytes);
+		intersection->lastReceive = chrono::steady_clock::now();
+		if (!intersection->receiving)
+		{
+			intersection->receiving = true;
+			intersection->controller.setIsReceiving(true);
+		}
+	}
+}
+
+} /* namespace SpatPlugin */
@@ -0,0 +1,109 @@
+/*
+ * SpatEngine.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ivp
+ */
+
+#ifndef SPATENGINE_H_
+#define SPATENGINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "signalController.h"
+
+namespace SpatPlugin {
+
+/**
+ * Receives the NTCIP 1202 broadcasts of many signal controllers on one epoll loop, so a single
+ * plugin can generate the SPaT for a whole corridor.
+ *
+ * Each intersection keeps its own SignalController, which holds the Ntcip1202 state and the SPaT
+ * patched in place by every packet.  Controllers may broadcast to their own local port, or share
+ * one port, in which case the packets are told apart by the address of the controller.
+ *
+ * The SPaTs are sent by the caller on a shared schedule.  The SPaT period is divided into one
+ * slot for each intersection, so the intersections are sent in turn rather than all at once.
+ */
+class SpatEngine
+{
+public:
+	struct IntersectionConfig
+	{
+		int id = 0;
+		std::string name;
+		std::string localIp;
+		std::string localUdpPort;
+		std::string tscIp;
+		std::string tscRemoteSnmpPort;
+		std::string signalGroupMappingJson;
+	};
+
+	/**
+	 * Read the intersections from a JSON array such as
+	 * [{"Id":1,"Name":"Main","LocalUdpPort":"6053","TscIp":"192.168.25.50"}, ...]
+	 * Any field that is left out is taken from the defaults.
+	 */
+	static std::vector<IntersectionConfig> ParseConfig(const std::string &json, const IntersectionConfig &defaults);
+
+	SpatEngine();
+	~SpatEngine();
+
+	/**
+	 * Open the sockets for the intersections and start receiving.
+	 *
+	 * @return False if a socket could not be opened, in which case nothing is started.
+	 */
+	bool Start(const std::vector<IntersectionConfig> &intersections);
+	void Stop();
+
+	size_t Count() const;
+	SignalController &get_Controller(size_t index);
+	const IntersectionConfig &get_Config(size_t index) const;
+
+	/**
+	 * @return The length of the slot of each intersection within the SPaT period.
+	 */
+	std::chrono::nanoseconds get_SlotPeriod(std::chrono::nanoseconds spatPeriod) const;
+
+	/**
+	 * @return The number of intersections that have broadcast recently.
+	 */
+	size_t get_ConnectedCount() const;
+
+	uint64_t get_PacketCount() const;
+
+	/**
+	 * @return The number of packets that came from an address that is not one of the controllers.
+	 */
+	uint64_t get_UnknownPacketCount() const;
+
+private:
+	struct Intersection;
+	struct Socket;
+
+	void Run();
+	void Receive(Socket *socket);
+	void EnableSpat(Intersection *intersection);
+	void Close();
+
+	std::vector<std::unique_ptr<Intersection> > _intersections;
+	std::vector<std::unique_ptr<Socket> > _sockets;
+
+	int _epollFd = -1;
+	int _wakeFd = -1;
+	std::thread _thread;
+	std::atomic<bool> _active {false};
+
+	std::atomic<uint64_t> _packets {0};
+	std::atomic<uint64_t> _unknownPackets {0};
+};
+
+} /* namespace SpatPlugin */
+
+#endif /* SPATENGINE_H_ */
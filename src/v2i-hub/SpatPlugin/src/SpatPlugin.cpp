@@ -8,8 +8,14 @@ using namespace tmx::utils;
 
 namespace SpatPlugin {
 
+// The SPaT transmit period
+#define SPAT_PERIOD_MS 100
+
+// How often to update the transmit statistics in the plugin status, in transmit cycles
+#define SPAT_STATUS_CYCLES 50
+
 SpatPlugin::SpatPlugin(string name) :
-		PluginClient(name), intersectionId(0) {
+		PluginClient(name), intersectionId(0), _transmitJitter(600), _encodeTime(600) {
 	AddMessageFilter<PedestrianMessage>(this, &SpatPlugin::HandlePedestrianDetection);
 	SubscribeToMessages();
 }
@@ -36,6 +42,8 @@ void SpatPlugin::UpdateConfigSettings() {
 
 	GetConfigValue<int>("Intersection_Id", intersectionId, &data_lock);
 
+	GetConfigValue<string>("Intersections", intersectionsJson, &data_lock);
+
 	isConfigurationLoaded = true;
 }
 
@@ -52,6 +60,59 @@ void SpatPlugin::OnStateChange(IvpPluginState state) {
 	}
 }
 
+void SpatPlugin::UpdateTransmitStatus() {
+	SetStatus<double>("Transmit Jitter P50 (ms)", _transmitJitter.Percentile(50) / 1000.0, false, 3);
+	SetStatus<double>("Transmit Jitter P99 (ms)", _transmitJitter.Percentile(99) / 1000.0, false, 3);
+	SetStatus<double>("Transmit Jitter Max (ms)", _transmitJitter.Max() / 1000.0, false, 3);
+	SetStatus<double>("Encode Time P50 (ms)", _encodeTime.Percentile(50) / 1000.0, false, 3);
+	SetStatus<double>("Encode Time P99 (ms)", _encodeTime.Percentile(99) / 1000.0, false, 3);
+}
+
+bool SpatPlugin::StartEngine() {
+	vector<SpatEngine::IntersectionConfig> intersections;
+
+	try {
+		lock_guard<mutex> lock(data_lock);
+
+		// Any setting left out of an intersection is taken from the single intersection settings
+		SpatEngine::IntersectionConfig defaults;
+		defaults.id = intersectionId;
+		defaults.name = intersectionName;
+		defaults.localIp = localIp;
+		defaults.localUdpPort = localUdpPort;
+		defaults.tscIp = tscIp;
+		defaults.tscRemoteSnmpPort = tscRemoteSnmpPort;
+		defaults.signalGroupMappingJson = signalGroupMappingJson;
+
+		intersections = SpatEngine::ParseConfig(intersectionsJson, defaults);
+	} catch (exception &ex) {
+		PLOG(logERROR) << "Invalid Intersections configuration: " << ex.what();
+		return false;
+	}
+
+	if (intersections.empty() || !_engine.Start(intersections))
+		return false;
+
+	_engineMessages.clear();
+	for (size_t i = 0; i < intersections.size(); i++)
+		_engineMessages.emplace_back(new SpatEncodedMessage());
+
+	return true;
+}
+
+void SpatPlugin::SendSpat(SignalController &controller, SpatEncodedMessage &spatEncodedMsg, const string &pedZones) {
+	PerformanceTimer encodeTimer;
+	if (controller.getEncodedSpat(&spatEncodedMsg, pedZones))
+		_encodeTime.Add(encodeTimer.Elapsed().total_microseconds());
+
+	spatEncodedMsg.set_flags(IvpMsgFlags_RouteDSRC);
+	spatEncodedMsg.addDsrcMetadata(172, 0x8002);
+
+	//PLOG(logDEBUG) << spatEncodedMsg;
+
+	BroadcastMessage(static_cast<routeable_message &>(spatEncodedMsg));
+}
+
 void SpatPlugin::HandlePedestrianDetection(PedestrianMessage &pedMsg, routeable_message &routeableMsg) {
 	lock_guard<mutex> lock(data_lock);
 	_pedMessage = pedMsg;
@@ -60,10 +121,14 @@ void SpatPlugin::HandlePedestrianDetection(PedestrianMessage &pedMsg, routeable_
 int SpatPlugin::Main() {
 
 	int iCounter = 0;
+	int statusCounter = 0;
+	size_t slot = 0;
+	bool multiIntersection = false;
 	SpatEncodedMessage spatEncodedMsg;
 
-	// How long it took to update and send the SPaT message the last time through the loop.
-	__useconds_t sendElapsedMicroSec = 0;
+	// SPaT must be sent exactly every 100 ms.  The transmit deadlines are absolute, so
+	// the time taken to update and send the message does not accumulate as error.
+	DeadlineTimer transmitTimer(chrono::milliseconds(SPAT_PERIOD_MS));
 
 	try {
 		while (_plugin->state != IvpPluginState_error) {
@@ -73,6 +138,28 @@ int SpatPlugin::Main() {
 
 					usleep(200000);
 
+					string intersections;
+					{
+						lock_guard<mutex> lock(data_lock);
+						intersections = intersectionsJson;
+					}
+
+					if (!intersections.empty()) {
+						// Each intersection is sent in its own slot of the SPaT period,
+						// so the messages are spread out instead of sent in one burst
+						if (!StartEngine()) {
+							SetStatus<string>("TSC Connection", "Invalid Intersections configuration");
+							usleep(1000000);
+							continue;
+						}
+
+						multiIntersection = true;
+						isConfigured = true;
+						transmitTimer.set_Period(_engine.get_SlotPeriod(chrono::milliseconds(SPAT_PERIOD_MS)));
+						transmitTimer.Reset();
+						continue;
+					}
+
 					int action = sc.getActionNumber();
 
 					/*pthread_mutex_lock(&gSettingsMutex);
@@ -100,15 +187,47 @@ int SpatPlugin::Main() {
 
 					isConfigured = true;
 					//}
+
+					transmitTimer.Reset();
 				}
 
-				// SPaT must be sent exactly every 100 ms.  So adjust for how long it took to do the last send.
-				if (sendElapsedMicroSec < 100000)
-					usleep(100000 - sendElapsedMicroSec);
-				iCounter++;
+				chrono::nanoseconds late = transmitTimer.WaitForNextDeadline();
+				_transmitJitter.Add(chrono::duration_cast<chrono::microseconds>(late).count());
+
+				if (multiIntersection) {
+					size_t index = slot;
+					slot = (slot + 1) % _engine.Count();
+
+					SignalController &controller = _engine.get_Controller(index);
+					if (controller.getIsConnected()) {
+						// Pedestrian detections are only for the intersection configured in Intersection_Id
+						string pedZones;
+						{
+							lock_guard<mutex> lock(data_lock);
+							if (_engine.get_Config(index).id == intersectionId)
+								pedZones = _pedMessage.get_DetectionZones();
+						}
 
-				bool messageSent = false;
-				PerformanceTimer timer;
+						SendSpat(controller, *_engineMessages[index], pedZones);
+					}
+
+					// Once through all of the intersections is one SPaT period
+					if (slot == 0) {
+						SetStatus<string>("TSC Connection", "Connected to " + to_string(_engine.get_ConnectedCount())
+								+ " of " + to_string(_engine.Count()));
+
+						if (++statusCounter >= SPAT_STATUS_CYCLES) {
+							statusCounter = 0;
+							SetStatus<uint64_t>("TSC Packets", _engine.get_PacketCount());
+							SetStatus<uint64_t>("TSC Unknown Packets", _engine.get_UnknownPacketCount());
+							UpdateTransmitStatus();
+						}
+					}
+
+					continue;
+				}
+
+				iCounter++;
 
 				// Update PTLM file if the action number has changed.
 				int actionNumber = sc.getActionNumber();
@@ -139,14 +258,7 @@ int SpatPlugin::Main() {
 						PLOG(logDEBUG) << "Pedestrians detected in lanes " << pedZones;
 					}
 
-					sc.getEncodedSpat(&spatEncodedMsg, pedZones);
-
-					spatEncodedMsg.set_flags(IvpMsgFlags_RouteDSRC);
-					spatEncodedMsg.addDsrcMetadata(172, 0x8002);
-
-					//PLOG(logDEBUG) << spatEncodedMsg;
-
-					BroadcastMessage(static_cast<routeable_message &>(spatEncodedMsg));
+					SendSpat(sc, spatEncodedMsg, pedZones);
 
 					if (iCounter % 20 == 0) {
 						iCounter = 0;
@@ -163,8 +275,14 @@ int SpatPlugin::Main() {
 					SetStatus<string>("TSC Connection", "Disconnected");
 				}
 
-				sendElapsedMicroSec = timer.Elapsed().total_microseconds();
-//			LOG_DEBUGGING("SpatGen Main Loop Time: " << sendElapsedMicroSec / 1000.0 << " ms, Data sent? " << (messageSent ? "yes" : "no"));
+				if (++statusCounter >= SPAT_STATUS_CYCLES) {
+					statusCounter = 0;
+					UpdateTransmitStatus();
+				}
+			} else {
+				// Nothing waits on the transmit timer until the configuration is loaded, so wait here
+				// instead of spinning on the check
+				usleep(100000);
 			}
 		}
 	} catch (exception &ex) {
@@ -16,13 +16,16 @@
 #include "PluginClient.h"
 #include "UdpClient.h"
 #include "signalController.h"
+#include "SpatEngine.h"
 #include "utils/PerformanceTimer.h"
 
 #include <tmx/j2735_messages/SpatMessage.hpp>
 #include <tmx/messages/IvpSignalControllerStatus.h>
 #include <tmx/messages/IvpJ2735.h>
 #include <boost/chrono.hpp>
+#include <DeadlineTimer.h>
 #include <FrequencyThrottle.h>
+#include <PercentileStatistics.h>
 #include <PedestrianMessage.h>
 
 namespace SpatPlugin {
@@ -59,6 +62,7 @@ private:
 	std::string tscIp;
 	std::string tscRemoteSnmpPort;
 	std::string signalGroupMappingJson;
+	std::string intersectionsJson;
 
 	std::string intersectionName;
 
@@ -67,9 +71,21 @@ private:
 	bool isConfigurationLoaded = false;
 	bool isConfigured = false;
 
+	// Multiple intersection mode, used when the Intersections configuration is set
+	SpatEngine _engine;
+	std::vector<std::unique_ptr<tmx::messages::SpatEncodedMessage> > _engineMessages;
+
 	bool encodeSpat();
 	bool createUPERframe_DERencoded_msg();
 
+	bool StartEngine();
+	void SendSpat(SignalController &controller, tmx::messages::SpatEncodedMessage &spatEncodedMsg, const std::string &pedZones);
+	void UpdateTransmitStatus();
+
+	// Statistics on how late each SPaT transmission was, and how long each encoding took, in microseconds
+	tmx::utils::PercentileStatistics _transmitJitter;
+	tmx::utils::PercentileStatistics _encodeTime;
+
 	tmx::messages::PedestrianMessage _pedMessage;
 };
 } /* namespace SpatPlugin */
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <thread>
 
 #include <unistd.h>
 #include <netinet/in.h>
@@ -31,25 +32,52 @@ using namespace tmx::utils;
 using namespace std;
 
 SignalController::~SignalController() {
-	if (_spatMessage)
+	for (int i = 0; i < 2; i++)
 	{
-		delete _spatMessage;
-		_spatMessage = NULL;
+		if (_spatMessage[i])
+		{
+			delete _spatMessage[i];
+			_spatMessage[i] = NULL;
+		}
+
+		if (_spat[i])
+		{
+			ASN_STRUCT_FREE(asn_DEF_SPAT, _spat[i]);
+			_spat[i] = NULL;
+		}
+	}
+
+	if (_ntcip1202)
+	{
+		delete _ntcip1202;
+		_ntcip1202 = NULL;
 	}
 }
 
 void SignalController::Start(std::string signalGroupMappingJson)
+{
+	Initialize(signalGroupMappingJson);
+
+    // launch update thread
+    sigcon_thread_id = boost::thread(&SignalController::start_signalController, this);
+}
+
+void SignalController::Initialize(std::string signalGroupMappingJson)
 {
 	_signalGroupMappingJson = signalGroupMappingJson;
 
 	// Create mutex for the Spat message
 	pthread_mutex_init(&spat_message_mutex, NULL);
-    // launch update thread
-    sigcon_thread_id = boost::thread(&SignalController::start_signalController, this);
+
+	_ntcip1202 = new Ntcip1202();
+	_ntcip1202->setSignalGroupMappingList(_signalGroupMappingJson);
+
     // test code
     counter = 0;
     normalstate = 0x01;
     crossstate = 0x04;
+    EthernetIsConnected = 0;
+    IsReceiving = 0;
 }
 
 // get sockaddr, IPv4 or IPv6:
@@ -68,6 +96,8 @@ void SignalController::setConfigs(std::string localIp, std::string localUdpPort,
 	_localUdpPort = strdup(localUdpPort.c_str());
 	_intersectionId = intersectionId;
 	_intersectionName = strdup(intersectionName.c_str());
+	if (_tscIp != tscIp || _tscRemoteSnmpPort != (uint32_t)stoi(tscRemoteSnmpPort))
+		_snmpDestinationChanged = true;
 	_tscIp = tscIp;
 	_tscRemoteSnmpPort = stoi(tscRemoteSnmpPort);
 }
@@ -83,9 +113,6 @@ void SignalController::start_signalController()
 
 	int maxDataSize = 1000;
 
-	Ntcip1202* ntcip1202 = new Ntcip1202();
-	ntcip1202->setSignalGroupMappingList(_signalGroupMappingJson);
-
     int sockfd, numbytes;
     char buf[maxDataSize];
     struct addrinfo hints, *servinfo;
@@ -101,7 +128,7 @@ void SignalController::start_signalController()
 		// 2 = enable SPAT
 		// 6 = enable SPAT wit pedestrian data
 		PLOG(logINFO) << "Enable SPAT Sent";
-		SNMPSet("1.3.6.1.4.1.1206.3.5.2.9.44.1.0", 2);
+		SNMPSet(TSC_ENABLE_SPAT_OID, 2);
 		SNMPCloseSession();
 
 		counter++;
@@ -174,28 +201,7 @@ void SignalController::start_signalController()
 						IsReceiving = 0;
 					}
 					else {
-
-						IsReceiving = 1;
-						pthread_mutex_lock(&spat_message_mutex);
-
-						//printf("Signal Controller calling ntcip1202 copyBytesIntoNtcip1202");
-						ntcip1202->copyBytesIntoNtcip1202(buf, numbytes);
-
-						//printf("Signal Controller calling ntcip1202 ToJ2735r41SPAT");
-						SPAT *_spat = (SPAT *) calloc(1, sizeof(SPAT));
-						ntcip1202->ToJ2735r41SPAT(_spat, _intersectionName, _intersectionId);
-
-						//printf("Signal Controller calling _spatMessage set_j2735_data\n");
-						//_spatMessage.set_j2735_data(_spat);
-						if (_spatMessage != NULL)
-						{
-							delete _spatMessage;
-							_spatMessage = NULL;
-						}
-						_spatMessage = new tmx::messages::SpatMessage(_spat);
-
-						pthread_mutex_unlock(&spat_message_mutex);
-						PLOG(logDEBUG) << *_spatMessage;
+						ProcessPacket(buf, numbytes);
 					}
 				}
 			}
@@ -205,51 +211,152 @@ void SignalController::start_signalController()
 	}
 }
 
-void SignalController::getEncodedSpat(SpatEncodedMessage* spatEncodedMsg, std::string currentPedLanes)
+void SignalController::ProcessPacket(const char *buf, int numbytes)
 {
-	pthread_mutex_lock(&spat_message_mutex);
+	// Anything past the end of the NTCIP 1202 data is not used
+	if (numbytes > (int)sizeof(Ntcip1202Ext))
+		numbytes = sizeof(Ntcip1202Ext);
+
+	IsReceiving = 1;
+
+	// Claim the buffer that is not being sent.  It can only still be in use if the last encode
+	// started before the previous packet swapped the buffers, and has not finished yet.
+	int back = (_front < 0) ? 0 : 1 - _front;
+	_writing = back;
+	while (_reading == back)
+		std::this_thread::yield();
+
+	//printf("Signal Controller calling ntcip1202 copyBytesIntoNtcip1202");
+	_ntcip1202->copyBytesIntoNtcip1202((char *)buf, numbytes);
+
+	// Patch the existing SPaT in place.  It is only rebuilt if the phase structure has changed.
+	SPAT *&spat = _spat[back];
+	if (!spat || !_ntcip1202->UpdateJ2735r41SPAT(spat, _intersectionId))
+	{
+		PLOG(logDEBUG) << "Rebuilding SPaT structure";
+
+		if (!spat)
+			spat = (SPAT *) calloc(1, sizeof(SPAT));
+
+		//printf("Signal Controller calling ntcip1202 ToJ2735r41SPAT");
+		_ntcip1202->ToJ2735r41SPAT(spat, _intersectionName, _intersectionId);
+
+		// The intersection was re-created, so the pedestrian lanes need added again
+		_pedLanesApplied[back] = false;
+
+		// The message does not own the SPaT structure, which is reused
+		if (_spatMessage[back] == NULL)
+			_spatMessage[back] = new tmx::messages::SpatMessage(
+					std::shared_ptr<SPAT>(spat, [](SPAT *) {}));
+	}
+
+	_spatSequence[back] = ++_packetCount;
+
+	PLOG(logDEBUG) << *_spatMessage[back];
+
+	_front = back;
+	_writing = -1;
+}
+
+void SignalController::setIsReceiving(bool receiving)
+{
+	EthernetIsConnected = receiving;
+	IsReceiving = receiving;
+}
+
+bool SignalController::getEncodedSpat(SpatEncodedMessage* spatEncodedMsg, std::string currentPedLanes)
+{
+	bool encoded = false;
+
+	// Claim the front buffer.  If a packet has started writing to it, the buffers have been
+	// swapped since it was read, so the new front buffer is taken instead.
+	int front;
+	while (true)
+	{
+		front = _front;
+		if (front < 0)
+			return false;
+
+		_reading = front;
+		if (_writing != front)
+			break;
+		_reading = -1;
+	}
 
 	//printf("Signal Controller getEncodedSpat\n");
-	if (_spatMessage != NULL) {
+	if (_spatMessage[front] != NULL && _spat[front] != NULL) {
+		bool updated = (_spatSequence[front] != _encodedSequence);
+
 		// Add pedestrian lanes with active detections and clear the rest
-		auto spat = _spatMessage->get_j2735_data();
-		if (spat && spat->intersections.list.array && spat->intersections.list.count > 0) {
-			char *zoneList = strdup(currentPedLanes.c_str());
-			vector<LaneConnectionID_t> zones;
-			char *c = strtok(zoneList, ",");
-
-			while (c != NULL) {
-				zones.push_back(strtol(c, NULL, 0));
-
-				c = strtok(NULL, ",");
-			};
-
-			free(zoneList);
-			zoneList = NULL;
-			c = NULL;
-
-			if (!zones.empty()) {
-				ManeuverAssistList *&mas = spat->intersections.list.array[0]->maneuverAssistList;
-				mas = (ManeuverAssistList *) calloc(1, sizeof(ManeuverAssistList));
-
-				mas->list.count = zones.size();
-				mas->list.array = (ConnectionManeuverAssist **) calloc(1, sizeof(ConnectionManeuverAssist *));
-
-				std::sort(zones.begin(), zones.end());
-				for (size_t i = 0; i < zones.size(); i++) {
-					mas->list.array[i] = (ConnectionManeuverAssist *) calloc(1, sizeof(ConnectionManeuverAssist));
-					mas->list.array[i]->connectionID = zones[i];
-					mas->list.array[i]->pedBicycleDetect = (PedestrianBicycleDetect_t *) calloc(1, sizeof(PedestrianBicycleDetect_t));
-					*(mas->list.array[i]->pedBicycleDetect) = 1;
-				}
-			}
+		if (!_pedLanesApplied[front] || currentPedLanes != _pedLanes[front])
+		{
+			updatePedLanes(front, currentPedLanes);
+			updated = true;
 		}
 
-		spatEncodedMsg->initialize(*_spatMessage);
+		if (updated || spatEncodedMsg != _lastEncodedMsg)
+		{
+			spatEncodedMsg->initialize(*_spatMessage[front]);
+
+			_encodedSequence = _spatSequence[front];
+			_lastEncodedMsg = spatEncodedMsg;
+			encoded = true;
+		}
+		else
+		{
+			spatEncodedMsg->refresh_timestamp();
+		}
 	}
 
-	pthread_mutex_unlock(&spat_message_mutex);
+	_reading = -1;
 
+	return encoded;
+}
+
+void SignalController::updatePedLanes(int buffer, std::string currentPedLanes)
+{
+	SPAT *spat = _spat[buffer];
+
+	_pedLanes[buffer] = currentPedLanes;
+	_pedLanesApplied[buffer] = true;
+
+	if (!spat->intersections.list.array || spat->intersections.list.count <= 0)
+		return;
+
+	vector<LaneConnectionID_t> zones;
+	char *zoneList = strdup(currentPedLanes.c_str());
+	char *c = strtok(zoneList, ",");
+
+	while (c != NULL) {
+		zones.push_back(strtol(c, NULL, 0));
+
+		c = strtok(NULL, ",");
+	};
+
+	free(zoneList);
+	zoneList = NULL;
+	c = NULL;
+
+	// Remove the lanes from the last update
+	ManeuverAssistList *&mas = spat->intersections.list.array[0]->maneuverAssistList;
+	if (mas)
+	{
+		ASN_STRUCT_FREE(asn_DEF_ManeuverAssistList, mas);
+		mas = NULL;
+	}
+
+	if (!zones.empty()) {
+		mas = (ManeuverAssistList *) calloc(1, sizeof(ManeuverAssistList));
+
+		std::sort(zones.begin(), zones.end());
+		for (size_t i = 0; i < zones.size(); i++) {
+			ConnectionManeuverAssist *assist = (ConnectionManeuverAssist *) calloc(1, sizeof(ConnectionManeuverAssist));
+			assist->connectionID = zones[i];
+			assist->pedBicycleDetect = (PedestrianBicycleDetect_t *) calloc(1, sizeof(PedestrianBicycleDetect_t));
+			*(assist->pedBicycleDetect) = 1;
+			ASN_SEQUENCE_ADD(&mas->list, assist);
+		}
+	}
 }
 
 int SignalController::getIsConnected()
@@ -268,41 +375,40 @@ void SignalController::SNMPOpenSession()
 	if (_tscIp == "" || _tscRemoteSnmpPort == 0)
 		return;
 	//open snmp session
-	snmp_sess_init(&_session_info);
-	string peername = _tscIp;
-	peername.append(":");
-	peername.append(to_string(_tscRemoteSnmpPort));
-	_session_info.peername = (char*)peername.c_str();
-	_session_info.version = SNMP_VERSION_1;
-	_session_info.community = (u_char*)"public";
-	_session_info.community_len = strlen("public");
-	_session = snmp_open(&_session_info);
-	if (_session)
+	NtcipClient::DeviceOptions options;
+	options.community = "public";
+	options.version = SNMP_VERSION_1;
+	try
+	{
+		_snmpDevice = NtcipClient::Shared().OpenDevice(_tscIp, _tscRemoteSnmpPort, options);
 		_snmpSessionOpen = true;
+	}
+	catch (exception &ex)
+	{
+		PLOG(logERROR) << ex.what();
+	}
 }
 
 void SignalController::SNMPCloseSession()
 {
 	//close session
 	if (_snmpSessionOpen)
-		snmp_close(_session);
+		NtcipClient::Shared().CloseDevice(_snmpDevice);
 	_snmpSessionOpen = false;
 }
 
 bool SignalController::SNMPSet(string targetOid, int32_t value)
 {
-	return SNMPSet(targetOid, ASN_INTEGER, (const void *)&value, sizeof(value));
+	return SNMPSet(vector<NtcipClient::Variable> { NtcipClient::Variable(targetOid, (long)value) });
 }
 
 bool SignalController::SNMPSet(string targetOid, u_char type, const void *value, size_t len)
 {
-	struct snmp_pdu *pdu;
-	struct snmp_pdu *response;
-	oid anOID[MAX_OID_LEN];
-	size_t anOID_len = MAX_OID_LEN;
-	int status;
-	bool rc = true;
+	return SNMPSet(vector<NtcipClient::Variable> { NtcipClient::Variable(targetOid, type, value, len) });
+}
 
+bool SignalController::SNMPSet(const vector<NtcipClient::Variable> &variables)
+{
 	//check is snmp session open
 	if (!_snmpSessionOpen)
 	{
@@ -321,15 +427,31 @@ bool SignalController::SNMPSet(string targetOid, u_char type, const void *value,
 		_snmpDestinationChanged = false;
 	}
 
-	pdu = snmp_pdu_create(SNMP_MSG_SET);
-	read_objid(targetOid.c_str(), anOID, &anOID_len);
-	snmp_pdu_add_variable(pdu, anOID, anOID_len, type, value, len);
-	status = snmp_synch_response(_session, pdu, &response);
-	if (status != STAT_SUCCESS || response->errstat != SNMP_ERR_NOERROR)
-		rc = false;
-	if (response)
-		snmp_free_pdu(response);
+	// All of the variables go in one SET on the long lived session
+	NtcipClient::Response response = NtcipClient::Shared().Set(_snmpDevice, variables).get();
+	if (response.status == NtcipClient::Timeout)
+		PLOG(logWARNING) << "Timeout: No response from " << _tscIp << ":" << _tscRemoteSnmpPort;
 
-	return rc;
+	return response.Ok();
 }
 
+
+void SignalController::SNMPSetAsync(string targetOid, int32_t value)
+{
+	if (!_snmpSessionOpen || _snmpDestinationChanged)
+	{
+		SNMPCloseSession();
+		SNMPOpenSession();
+		if (!_snmpSessionOpen)
+			return;
+		_snmpDestinationChanged = false;
+	}
+
+	string tsc = _tscIp + ":" + to_string(_tscRemoteSnmpPort);
+	NtcipClient::Shared().Set(_snmpDevice, vector<NtcipClient::Variable> { NtcipClient::Variable(targetOid, (long)value) },
+			[tsc, targetOid](const NtcipClient::Response &response)
+	{
+		if (!response.Ok())
+			PLOG(logWARNING) << "Unable to set " << targetOid << " on " << tsc;
+	});
+}
@@ -8,6 +8,7 @@
 #ifndef SIGNALCONTROLLER_H_
 #define SIGNALCONTROLLER_H_
 
+#include <atomic>
 #include <pthread.h>
 #include <boost/thread.hpp>
 
@@ -15,7 +16,12 @@
 
 #include <net-snmp/net-snmp-config.h>
 #include <net-snmp/net-snmp-includes.h>
+#include <NtcipClient.h>
 
+// The TSC object that enables the SPaT broadcasts: 0 = disable, 2 = enable SPaT, 6 = enable SPaT with pedestrian data
+#define TSC_ENABLE_SPAT_OID "1.3.6.1.4.1.1206.3.5.2.9.44.1.0"
+
+class Ntcip1202;
 
 class SignalController
 {
@@ -23,6 +29,22 @@ class SignalController
 		~SignalController();
 
 		void Start(std::string signalGroupMappingJson);
+
+		/**
+		 * Prepare the controller state without starting the receive thread, for a caller that
+		 * receives the broadcasts itself and passes each packet to ProcessPacket.
+		 */
+		void Initialize(std::string signalGroupMappingJson);
+
+		/**
+		 * Update the SPaT from one NTCIP 1202 broadcast received from the TSC.
+		 */
+		void ProcessPacket(const char *buf, int numbytes);
+
+		/**
+		 * Set whether broadcasts are being received, for a caller that receives them itself.
+		 */
+		void setIsReceiving(bool receiving);
 		void spat_load();
 		void start_signalController();
 		int getActionNumber();
@@ -32,7 +54,18 @@ class SignalController
 
 		//int getDerEncodedSpat(unsigned char* derEncodedBuffer);
 
-		void getEncodedSpat(tmx::messages::SpatEncodedMessage* spatEncodedMsg, std::string currentPedLanes = "");
+		/**
+		 * Encode the latest SPaT into the message supplied.
+		 *
+		 * The SPaT is only re-encoded if it has changed since the last call, or if a different
+		 * message is supplied.  Otherwise the message is left as is, other than a refreshed
+		 * timestamp, so the caller should pass the same message on each call.
+		 *
+		 * This never waits on ProcessPacket, but must only be called from one thread at a time.
+		 *
+		 * @return True if the SPaT was re-encoded.
+		 */
+		bool getEncodedSpat(tmx::messages::SpatEncodedMessage* spatEncodedMsg, std::string currentPedLanes = "");
 
 		pthread_mutex_t spat_message_mutex;
 		boost::thread sigcon_thread_id;
@@ -41,6 +74,12 @@ class SignalController
 		void SNMPCloseSession();
 		bool SNMPSet(std::string targetOid, int32_t value);
 		bool SNMPSet(std::string targetOid, u_char type, const void *value, size_t len);
+		bool SNMPSet(const std::vector<tmx::utils::NtcipClient::Variable> &variables);
+
+		/**
+		 * Send a SET to the TSC without waiting for the answer.  Failures are only logged.
+		 */
+		void SNMPSetAsync(std::string targetOid, int32_t value);
 
 	private:
 		void *get_in_addr(struct sockaddr *);
@@ -51,10 +90,35 @@ class SignalController
 		char* _intersectionName;
 		int _intersectionId;
 		std::string _tscIp;
-		uint32_t _tscRemoteSnmpPort;
+		uint32_t _tscRemoteSnmpPort{0};
 
 		std::string _signalGroupMappingJson;
-		tmx::messages::SpatMessage *_spatMessage{NULL};
+		Ntcip1202 *_ntcip1202{NULL};
+
+		// There are two SPaT structures, each built once and then patched in place from the
+		// controller data, and only rebuilt when the phase structure changes.  Each packet is
+		// written to the back buffer, which then becomes the front buffer that is encoded.
+		// _writing and _reading hold the buffer in use by ProcessPacket and getEncodedSpat,
+		// or -1, so a packet never waits on an encode of the other buffer and an encode never
+		// waits on a packet.
+		SPAT *_spat[2]{NULL, NULL};
+		tmx::messages::SpatMessage *_spatMessage[2]{NULL, NULL};
+		std::atomic<int> _front{-1};
+		std::atomic<int> _writing{-1};
+		std::atomic<int> _reading{-1};
+
+		// Count of the packets written to each buffer, to tell if the front buffer has changed
+		// since the last encode
+		uint64_t _spatSequence[2]{0, 0};
+		uint64_t _packetCount{0};
+		uint64_t _encodedSequence{0};
+		tmx::messages::SpatEncodedMessage *_lastEncodedMsg{NULL};
+
+		// Pedestrian lanes currently added to the maneuver assist list of each SPaT
+		std::string _pedLanes[2];
+		bool _pedLanesApplied[2]{false, false};
+
+		void updatePedLanes(int buffer, std::string currentPedLanes);
 
 		int counter;
 		unsigned long normalstate;
@@ -62,9 +126,8 @@ class SignalController
 		int EthernetIsConnected;
 		int IsReceiving;
 
-		//snmp
-		struct snmp_session _session_info;
-		struct snmp_session *_session{NULL};
+		//snmp session to the TSC on the shared NTCIP client
+		tmx::utils::NtcipClient::DeviceId _snmpDevice{0};
 		bool _snmpSessionOpen{false};
 		bool _snmpDestinationChanged{false};
 